@@ -151,8 +151,11 @@ ImagePtr  SimCcd::getRawImage() {
 	// color (filterwheel)
 	starcamera.colorfactor(_locator.filterwheel()->currentPosition());
 
-	// temperature influence on noise
-	starcamera.noise(0.2 * exp2(-_locator.simcooler()->belowambient()));
+	// temperature influence on noise, the bias level is high enough
+	// that the noise is hardly ever clamped at zero
+	double	noise = 0.2 * exp2(-_locator.simcooler()->belowambient());
+	starcamera.noise(noise);
+	starcamera.pedestal(4 * noise);
 
 	// focuser effect
 	double	radius = _locator.simfocuser()->radius();
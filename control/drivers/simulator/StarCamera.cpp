@@ -6,6 +6,8 @@
 #include <Stars.h>
 #include <AstroAdapter.h>
 #include <Blurr.h>
+#include <AstroUtils.h>
+#include <cstdint>
 
 using namespace astro::image;
 using namespace astro::camera;
@@ -20,8 +22,8 @@ namespace astro {
  */
 StarCameraBase::StarCameraBase(const ImageRectangle& rectangle)
 	: _content(STARS), _rectangle(rectangle), _alpha(0), _stretch(1),
-	  _dark(0), _noise(0), _light(true), _color(0), _radius(0),
-	  _innerradius(0) {
+	  _dark(0), _noise(0), _pedestal(0), _light(true), _color(0), _radius(0),
+	  _innerradius(0), _rendertime(0) {
 	// check environement variable
 	char	*v = getenv("STARCONTENT");
 	if (NULL == v) {
@@ -59,41 +61,51 @@ void	StarCameraBase::addHotPixels(unsigned int npixels) {
 }
 
 /**
- * \brief Compute inverse error function using Newton's algorithm
+ * \brief Fast generator for normally distributed noise
  *
- * The error function in the C Library is defined as
- *
- * erf(x) = 2/sqrt(pi)*integral from 0 to x of exp(-t*t) dt.
- *
- * The derivative of erf(x) is of course
- *
- * erf'(x) = 2/sqrt(pi) exp(-t*t)
- *
- * 
+ * A xorshift generator combined with the polar method of Marsaglia is
+ * much faster than solving erf(x) = y with Newton's method for each
+ * pixel. Every row band of the image gets its own generator, so that
+ * noise can be added in parallel.
  */
-#define	epsilon	0.000001
-#define	maxiterations	10
-
-static double	inverf(double y) {
-	//debug(LOG_DEBUG, DEBUG_LOG, 0, "y = %f", y);
-	double	x = y - 0.5;
-	double	m = 2 / sqrt(M_PI);
-	double	delta = 1;
-	int	counter = 0;
-	while ((counter++ < maxiterations) && (delta > epsilon)) {
-		delta = (erf(x) - y) / (m * exp(-x * x));
-		x -= delta;
-		//debug(LOG_DEBUG, DEBUG_LOG, 0, "x = erf(y) = %f", x);
+class NoiseGenerator {
+	uint64_t	_state;
+	bool	_hasspare;
+	double	_spare;
+	double	uniform() {
+		_state ^= _state >> 12;
+		_state ^= _state << 25;
+		_state ^= _state >> 27;
+		uint64_t	x = _state * 2685821657736338717ULL;
+		return (x >> 11) * (1.0 / 9007199254740992.0);
 	}
-	return x;
-}
+public:
+	NoiseGenerator(uint64_t seed)
+		: _state(seed ? seed : 0x9e3779b97f4a7c15ULL),
+		  _hasspare(false), _spare(0) { }
+	double	gauss();
+};
 
-double	StarCameraBase::noisevalue() const {
-	double	x = random() / (double)0xffffffff;
-	return _noise * inverf(x);
+/**
+ * \brief Get a standard normally distributed random number
+ */
+double	NoiseGenerator::gauss() {
+	if (_hasspare) {
+		_hasspare = false;
+		return _spare;
+	}
+	double	u, v, s;
+	do {
+		u = 2 * uniform() - 1;
+		v = 2 * uniform() - 1;
+		s = u * u + v * v;
+	} while ((s >= 1) || (s == 0));
+	double	f = sqrt(-2 * log(s) / s);
+	_spare = v * f;
+	_hasspare = true;
+	return u * f;
 }
 
-
 void    StarCameraBase::noise(const double& n) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "set noise value to %f", n);
 	_noise = n;
@@ -170,67 +182,44 @@ Image<double>	*StarCameraBase::operator()(const StarField& field) const {
 
 	// fill in the points. 
 	ImagePoint	origin = rectangle().origin();
+	Point	corner(origin.x() - offset.x(), origin.y() - offset.y());
 
-	ImagePoint	body(340,220);
+	Timer	timer;
+	timer.start();
 
 	Image<double>	image(size);
+	image.clear();
 
-	for (int x = 0; x < size.width(); x++) {
+	switch (_content) {
+	case STARS:
+		if (light()) {
+			splat(image, field, transform, corner, multiplier);
+		}
+		break;
+	case SUN:
+	case PLANET: {
+		ImagePoint	body(340,220);
+		double	inner = (_content == SUN) ? 100 : 10;
+#pragma omp parallel for
 		for (int y = 0; y < size.height(); y++) {
-			// apply the transform to the current point
-			Point   where(origin.x() - offset.x() + x,
-					origin.y() - offset.y() + y);
-			Point   p = transform(where);
-			double  value = 0;
-
-			switch (_content) {
-			case STARS:
-				// compute the intensity
-				if (light()) {
-					switch (color()) {
-					case 0:
-						value = field.intensity(p);
-						break;
-					case 1:
-						value = field.intensityR(p);
-						break;
-					case 2:
-						value = field.intensityG(p);
-						break;
-					case 3:
-						value = field.intensityB(p);
-						break;
-					default:
-						break;
-					}
-				}
-				break;
-			case SUN: {
-				double	r = (p - body).abs();
-				if (r < 100) {
-					value = 1.;
-				} else if (r > 102) {
-					value = 0;
-				} else {
-					value = (102 - r) / 2;
-				}
-				}
-				break;
-			case PLANET: {
+			for (int x = 0; x < size.width(); x++) {
+				// apply the transform to the current point
+				Point	where(corner.x() + x, corner.y() + y);
+				Point	p = transform(where);
 				double	r = (p - body).abs();
-				if (r < 10) {
+				double	value = 0;
+				if (r < inner) {
 					value = 1.;
-				} else if (r > 12) {
+				} else if (r > inner + 2) {
 					value = 0;
 				} else {
-					value = (12 - r) / 2;
-				}
+					value = (inner + 2 - r) / 2;
 				}
-				break;
+				image.pixel(x, y) = value * multiplier;
 			}
-			value *= multiplier;
-			image.pixel(x, y) = value;
 		}
+		}
+		break;
 	}
 
 	// compute the blurr if necessary
@@ -245,23 +234,132 @@ Image<double>	*StarCameraBase::operator()(const StarField& field) const {
 	WindowAdapter<double>	wa(image, r);
 	Image<double>	*result = new Image<double>(wa);
 
-	// add noise to the image rectangle
-	if (noise()) {
+	// add bias and noise to the image rectangle
+	if (noise() || pedestal()) {
 		addnoise(*result);
 	}
 
+	timer.end();
+	_rendertime = timer.elapsed();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s frame with %d objects rendered "
+		"in %.3fs", result->size().toString().c_str(), field.size(),
+		_rendertime);
 	return result;
 }
 
 /**
- * \brief Add noise to the image
+ * \brief Intensity of an object for the color channel of the camera
+ */
+static inline double	channelintensity(const StellarObject& object,
+				const Point& p, int color) {
+	switch (color) {
+	case 0:	return object.intensity(p);
+	case 1:	return object.intensityR(p);
+	case 2:	return object.intensityG(p);
+	case 3:	return object.intensityB(p);
+	}
+	return 0;
+}
+
+#define	BAND_HEIGHT	32
+
+/**
+ * \brief Render the objects of a star field into an image
+ *
+ * Instead of evaluating every object at every pixel, each object is only
+ * evaluated inside the square footprint given by its extent. The image
+ * is divided into bands of BAND_HEIGHT rows, and every object is put
+ * into the buckets of all the bands its footprint touches. The bands
+ * are then rendered in parallel, each band only writes its own rows.
+ *
+ * \param image		image to add the objects to
+ * \param field		the star field
+ * \param transform	transform from image to star field coordinates
+ * \param corner	star field coordinates of the pixel (0,0)
+ * \param multiplier	factor to apply to all intensities
+ */
+void	StarCameraBase::splat(Image<double>& image, const StarField& field,
+		const astro::image::transform::Transform& transform,
+		const Point& corner, double multiplier) const {
+	int	width = image.size().width();
+	int	height = image.size().height();
+	int	nbands = (height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+
+	// find the image position of all objects and bucket them by band.
+	// The transform is an isometry, so the extent does not change.
+	astro::image::transform::Transform	inverse = transform.inverse();
+	std::vector<Point>	centers(field.size());
+	std::vector<std::vector<size_t> >	buckets(nbands);
+	for (size_t i = 0; i < field.size(); i++) {
+		centers[i] = inverse(field[i]->position()) - corner;
+		double	r = field[i]->extent() + 1;
+		if ((centers[i].x() + r < 0) || (centers[i].x() - r >= width)) {
+			continue;
+		}
+		int	ymin = std::max(0, (int)floor(centers[i].y() - r));
+		int	ymax = std::min(height - 1, (int)ceil(centers[i].y() + r));
+		for (int b = ymin / BAND_HEIGHT; (ymin <= ymax)
+			&& (b <= ymax / BAND_HEIGHT); b++) {
+			buckets[b].push_back(i);
+		}
+	}
+
+	// render the bands
+#pragma omp parallel for schedule(dynamic)
+	for (int b = 0; b < nbands; b++) {
+		int	y0 = b * BAND_HEIGHT;
+		int	y1 = std::min(height, y0 + BAND_HEIGHT);
+		std::vector<size_t>::const_iterator	i;
+		for (i = buckets[b].begin(); i != buckets[b].end(); i++) {
+			const StellarObject&	object = *field[*i];
+			const Point&	center = centers[*i];
+			double	r = object.extent() + 1;
+			int	xmin = std::max(0, (int)floor(center.x() - r));
+			int	xmax = std::min(width - 1, (int)ceil(center.x() + r));
+			int	ymin = std::max(y0, (int)floor(center.y() - r));
+			int	ymax = std::min(y1 - 1, (int)ceil(center.y() + r));
+			for (int y = ymin; y <= ymax; y++) {
+				for (int x = xmin; x <= xmax; x++) {
+					Point	p = transform(Point(
+						corner.x() + x, corner.y() + y));
+					image.pixel(x, y) += multiplier
+						* channelintensity(object, p,
+							color());
+				}
+			}
+		}
+	}
+}
+
+/**
+ * \brief Add bias and noise to the image
+ *
+ * The noise is gaussian with standard deviation noise() around the bias
+ * level pedestal(). Pixel values are clamped at 0 only after the bias
+ * has been added, because the camera converts them to unsigned pixel
+ * types. As long as the pedestal is a few standard deviations, hardly
+ * any values are clamped and the mean of a dark frame is the pedestal.
+ * The seeds for the row bands are taken from random(), so the noise is
+ * reproducible with srandom().
  */
 void	StarCameraBase::addnoise(Image<double>& image) const {
 	int	width = image.size().width();
 	int	height = image.size().height();
-	for (int x = 0; x < width; x++) {
-		for (int y = 0; y < height; y++) {
-			image.pixel(x, y) += noisevalue();
+	int	nbands = (height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+	std::vector<uint64_t>	seeds(nbands);
+	for (int b = 0; b < nbands; b++) {
+		seeds[b] = ((uint64_t)random() << 32) ^ random();
+	}
+#pragma omp parallel for
+	for (int b = 0; b < nbands; b++) {
+		NoiseGenerator	generator(seeds[b]);
+		int	y1 = std::min(height, (b + 1) * BAND_HEIGHT);
+		for (int y = b * BAND_HEIGHT; y < y1; y++) {
+			for (int x = 0; x < width; x++) {
+				double	v = image.pixel(x, y) + _pedestal
+					+ _noise * generator.gauss();
+				image.pixel(x, y) = (v < 0) ? 0 : v;
+			}
 		}
 	}
 }
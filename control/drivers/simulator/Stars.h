@@ -33,6 +33,10 @@ public:
 		_color = color;
 	}
 	virtual double	intensity(const Point& where) const = 0;
+	/**
+	 * \brief Radius outside of which the intensity vanishes
+	 */
+	virtual double	extent() const = 0;
 	double	intensityR(const Point& where) const;
 	double	intensityG(const Point& where) const;
 	double	intensityB(const Point& where) const;
@@ -53,6 +57,7 @@ public:
 	const double&	magnitude() const { return _magnitude; }
 	void	magnitude(const double& magnitude);
 	virtual double intensity(const Point& where) const;
+	virtual double	extent() const { return 10; }
 	virtual std::string	toString() const;
 };
 
@@ -72,6 +77,7 @@ public:
 	const double&	density() const { return _density; }
 	void	density(const double& density) { _density = density; }
 	virtual double intensity(const Point& where) const;
+	virtual double	extent() const { return _radius; }
 	virtual std::string	toString() const;
 };
 
@@ -97,6 +103,7 @@ public:
 	const StellarObjectPtr&	operator[](size_t index) const {
 		return objects[index];
 	}
+	size_t	size() const { return objects.size(); }
 };
 
 /**
@@ -136,6 +143,10 @@ private:
 	 * \brief Noise standard deviation
  	 */
 	double	_noise;
+	/**
+	 * \brief Bias level the noise is added to
+	 */
+	double	_pedestal;
 	/**
 	 * \brief Whether or not the camera shutter is open
 	 */
@@ -162,6 +173,13 @@ private:
 	 * \brief Binning mode to apply when exposing
 	 */
 	astro::image::Binning	_binning;
+	/**
+	 * \brief Time needed to render the most recent frame
+	 */
+	mutable double	_rendertime;
+	void	splat(Image<double>& image, const StarField& field,
+			const astro::image::transform::Transform& transform,
+			const Point& corner, double multiplier) const;
 	double	bin0(Image<double>& image, int x, int y) const;
 	void	fill0(Image<double>& image, const ImagePoint& point,
 			double fillvalue) const;
@@ -170,7 +188,6 @@ protected:
 	void	addhot(Image<double>& image, double hotvalue) const;
 	void	rescale(Image<double>& image, double scale) const;
 	void	bin(Image<double>& image) const;
-	double	noisevalue() const;
 	std::set<ImagePoint>	hotpixels;
 public:
 	StarCameraBase(const ImageRectangle& rectangle);
@@ -205,6 +222,10 @@ public:
 	//void	noise(const double& noise) { _noise = noise; }
 	void	noise(const double& noise);
 
+	// accessor for the bias level
+	const double&	pedestal() const { return _pedestal; }
+	void	pedestal(const double& pedestal) { _pedestal = pedestal; }
+
 	// accessor for the shutter flag
 	const bool&	light() const { return _light; }
 	void	light(const bool& light) { _light = light; }
@@ -227,6 +248,9 @@ public:
 	const astro::image::Binning&	binning() const { return _binning; }
 	void	binning(const astro::image::Binning& binning) { _binning = binning; }
 
+	// time in seconds needed to render the last frame
+	double	rendertime() const { return _rendertime; }
+
 	// imaging operator
 	Image<double>	*operator()(const StarField& field) const;
 };
@@ -22,9 +22,11 @@ public:
 	void	setUp();
 	void	tearDown();
 	void	testImage();
+	void	testDark();
 
 	CPPUNIT_TEST_SUITE(StarsTest);
 	CPPUNIT_TEST(testImage);
+	CPPUNIT_TEST(testDark);
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -49,5 +51,28 @@ void	StarsTest::testImage() {
 	out.write(image);
 }
 
+void	StarsTest::testDark() {
+	ImageSize	size(640, 480);
+	StarField	starfield(size, 100, 200);
+	StarCamera<unsigned short>	starcamera(size);
+	starcamera.light(false);
+	starcamera.noise(0.01);
+	starcamera.pedestal(0.05);
+	ImagePtr	image = starcamera(starfield);
+	Image<unsigned short>	*dark
+		= dynamic_cast<Image<unsigned short> *>(&*image);
+	CPPUNIT_ASSERT(NULL != dark);
+	double	sum = 0;
+	for (unsigned int i = 0; i < size.getPixels(); i++) {
+		sum += dark->pixels[i];
+	}
+	// the noise must not shift the mean of a dark frame
+	double	mean = sum / size.getPixels();
+	double	expected = 0.05 * std::numeric_limits<unsigned short>::max();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "dark mean %f, expected %f", mean,
+		expected);
+	CPPUNIT_ASSERT(fabs(mean - expected) < 0.002 * expected);
+}
+
 } // namespace test
 } // namespace astro
@@ -11,6 +11,7 @@
 #include <AstroFormat.h>
 #include <repository.h>
 #include <IceConversions.h>
+#include <ChunkedTransfer.h>
 #include <RepoReplicators.h>
 
 using namespace snowstar;
@@ -179,7 +180,7 @@ void	LocalRepoReplicator::push(int id) {
 	if (!dryrun()) {
 		astro::image::ImagePtr	imageptr
 			= localrepository->getImage(id);
-		remoterepository->save(convertfile(imageptr));
+		chunkedsave(remoterepository, imageptr);
 	}
 }
 
@@ -189,7 +190,7 @@ void	LocalRepoReplicator::pull(int id) {
 		std::cout << "pulling " << id << std::endl;
 	}
 	if (!dryrun()) {
-		ImageFile imagefile = remoterepository->getImage(id);
+		ImageFile imagefile = chunkedgetimage(remoterepository, id);
 		localrepository->save(convertfile(imagefile));
 	}
 }
@@ -230,8 +231,8 @@ void	RemoteRepoReplicator::push(int id) {
 		std::cout << "pushing " << id << std::endl;
 	}
 	if (!dryrun()) {
-		ImageFile imagefile = localrepository->getImage(id);
-		remoterepository->save(imagefile);
+		ImageFile imagefile = chunkedgetimage(localrepository, id);
+		chunkedsave(remoterepository, imagefile);
 	}
 }
 
@@ -241,8 +242,8 @@ void	RemoteRepoReplicator::pull(int id) {
 		std::cout << "pulling " << id << std::endl;
 	}
 	if (!dryrun()) {
-		ImageFile imagefile = remoterepository->getImage(id);
-		localrepository->save(imagefile);
+		ImageFile imagefile = chunkedgetimage(remoterepository, id);
+		chunkedsave(localrepository, imagefile);
 	}
 }
 
@@ -68,6 +68,8 @@ void	Guide::usage(const char *progname) {
 		<< std::endl;
 	std::cout << p << " [ options ] <service> <INSTRUMENT> history"
 		" [ trackid ]" << std::endl;
+	std::cout << p << " [ options ] <service> <INSTRUMENT> series"
+		" <trackid> [ GP | AO [ <binwidth> ] ]" << std::endl;
 	std::cout << p << " [ options ] <service> <INSTRUMENT> forget <trackid> ...";
 	std::cout << std::endl;
 
@@ -79,6 +81,8 @@ void	Guide::usage(const char *progname) {
 		<< std::endl;
 	std::cout << p << " [ options ] <service> <INSTRUMENT> images <path>"
 		<< std::endl;
+	std::cout << p << " [ options ] <service> <INSTRUMENT> callbacks"
+		<< std::endl;
 
 	std::cout << std::endl;
 	std::cout << "  Image or dark acquisition:" << std::endl;
@@ -266,6 +270,13 @@ int	Guide::help_command(const char *progname) {
 "history" << std::endl <<
 "    Display the tracking history of the current guiding run." << std::endl
 
+<< std::endl << 
+"series <trackid> [ GP | AO [ <binwidth> ] ]" << std::endl <<
+"    Display the tracking history of a track in columns. If <binwidth> is"
+<< std::endl <<
+"    given, the server averages the points over bins of <binwidth> seconds."
+<< std::endl
+
 << std::endl << 
 "monitor" << std::endl <<
 "    Monitor the guiding or calibration process. This subcommand reports all"
@@ -278,6 +289,13 @@ int	Guide::help_command(const char *progname) {
 << std::endl <<
 "    in the directory named <directory>." << std::endl
 
+<< std::endl <<
+"callbacks" << std::endl <<
+"    show how well the image and tracking subscribers of the guider keep up:"
+<< std::endl <<
+"    delivered, dropped and failed callbacks, queue length and lag."
+<< std::endl
+
 << std::endl <<
 "dark | flat" << std::endl <<
 "    create a dark or flat image" << std::endl
@@ -67,6 +67,7 @@ public:
 public:
 	int	monitor_command(GuiderPrx guider);
 	int	images_command(GuiderPrx guider, const std::string& path);
+	int	callbacks_command(GuiderPrx guider);
 
 	// commands related to calibration
 	int	calibration_command(GuiderFactoryPrx guiderfactory,
@@ -98,6 +99,8 @@ public:
 	int	history_command(GuiderFactoryPrx guiderfactory, long historyid);
 	int	history_command(GuiderFactoryPrx guiderfactory, long historyid,
 			ControlType type);
+	int	series_command(GuiderFactoryPrx guiderfactory, long historyid,
+			ControlType type, double binwidth);
 	int	forget_command(GuiderFactoryPrx guiderfactory,
 			const std::list<int>& ids);
 
@@ -140,6 +140,38 @@ int	Guide::history_command(GuiderFactoryPrx guiderfactory, long historyid,
 	return EXIT_SUCCESS;
 }
 
+/**
+ * \brief Implementation of the series command
+ *
+ * The series command retrieves the history in column form, optionally
+ * binned on the server, which is much faster for long tracks.
+ */
+int	Guide::series_command(GuiderFactoryPrx guiderfactory, long historyid,
+		ControlType type, double binwidth) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "retrieving series %d", historyid);
+	TrackingSeries	series = guiderfactory->getTrackingSeries(historyid,
+		type, 0, 0, binwidth);
+	if (series.time.size() == 0) {
+		std::cout << "no tracking points found" << std::endl;
+		return EXIT_SUCCESS;
+	}
+	if (!csv) {
+		std::cout << astro::stringprintf("%d values from %d points",
+			series.time.size(), series.count) << std::endl;
+		std::cout << "    time   xoffset   yoffset  racorrection "
+			"deccorrection" << std::endl;
+	}
+	const char	*format = (csv) ? "%.3f,%.4f,%.4f,%.4f,%.4f"
+					: "%8.1f %9.4f %9.4f %13.4f %13.4f";
+	for (unsigned int i = 0; i < series.time.size(); i++) {
+		std::cout << astro::stringprintf(format, series.time[i],
+			series.xoffset[i], series.yoffset[i],
+			series.racorrection[i], series.deccorrection[i])
+			<< std::endl;
+	}
+	return EXIT_SUCCESS;
+}
+
 /**
  * \brief Forget tracking histories
  */
@@ -7,6 +7,7 @@
 #include <cstdlib>
 #include <iostream>
 #include "monitor.h"
+#include <AstroFormat.h>
 
 namespace snowstar {
 namespace app {
@@ -34,6 +35,26 @@ int	Guide::monitor_command(GuiderPrx guider) {
 	return EXIT_FAILURE;
 }
 
+/**
+ * \brief Display the delivery statistics of the guider subscribers
+ */
+int	Guide::callbacks_command(GuiderPrx guider) {
+	CallbackStatisticsList	list = guider->getCallbackStatistics();
+	if (list.size() == 0) {
+		std::cout << "no subscribers" << std::endl;
+		return EXIT_SUCCESS;
+	}
+	for (auto i = list.begin(); i != list.end(); i++) {
+		std::cout << astro::stringprintf("%-24.24s delivered=%ld "
+			"dropped=%ld coalesced=%ld failed=%ld queued=%d (max %d) "
+			"lag=%.3fs (max %.3fs)", i->subscriber.c_str(),
+			(long)i->delivered, (long)i->dropped,
+			(long)i->coalesced, (long)i->failed, i->queued,
+			i->maxqueued, i->lag, i->maxlag) << std::endl;
+	}
+	return EXIT_SUCCESS;
+}
+
 } // namespace snowguide
 } // namespace app
 } // namespace snowstar
@@ -249,6 +249,22 @@ int	main(int argc, char *argv[]) {
 		}
 		return guide.history_command(guiderfactory, historyid);
 	}
+	if (command == "series") {
+		if (argc <= optind) {
+			throw std::runtime_error("missing history id");
+		}
+		long	historyid = std::stoi(argv[optind++]);
+		ControlType	type = ControlGuidePort;
+		if (argc > optind) {
+			type = Guide::string2type(argv[optind++]);
+		}
+		double	binwidth = 0;
+		if (argc > optind) {
+			binwidth = std::stod(argv[optind++]);
+		}
+		return guide.series_command(guiderfactory, historyid, type,
+			binwidth);
+	}
 	if (command == "trash") {
 		std::list<int>	ids;
 		while (optind < argc) {
@@ -334,6 +350,9 @@ int	main(int argc, char *argv[]) {
 	if (command == "monitor") {
 		return guide.monitor_command(guider);
 	}
+	if (command == "callbacks") {
+		return guide.callbacks_command(guider);
+	}
 	if (command == "uncalibrate") {
 		if (argc <= optind) {
 			throw std::runtime_error("missing type argument");
@@ -27,6 +27,7 @@ static void	short_usage(const char *progname) {
 	std::cout << p << " [ options ] <server> list [ <domain> [ <section> ] ]" << std::endl;
 	std::cout << p << " [ options ] <server> shutdown [ <delay> ]" << std::endl;
 	std::cout << p << " [ options ] <server> restart [ <delay> ]" << std::endl;
+	std::cout << p << " [ options ] <server> metrics [ reset ]" << std::endl;
 }
 
 /**
@@ -174,6 +175,24 @@ int	shutdown_command(ConfigurationPrx configuration,
 	return EXIT_SUCCESS;
 }
 
+/**
+ * \brief Display the counters and timers of the server, or reset them
+ */
+int	metrics_command(MetricsPrx metrics,
+			const std::list<std::string>& arguments) {
+	if (arguments.size() > 0) {
+		if (*arguments.begin() != "reset") {
+			std::cerr << "unknown metrics subcommand "
+				<< *arguments.begin() << std::endl;
+			return EXIT_FAILURE;
+		}
+		metrics->reset();
+		return EXIT_SUCCESS;
+	}
+	std::cout << metrics->dump();
+	return EXIT_SUCCESS;
+}
+
 int	help_command(const char *progname) {
 	usage(progname);
 	return EXIT_SUCCESS;
@@ -237,6 +256,16 @@ int	main(int argc, char *argv[]) {
 
 	// create a sever connection
 	astro::ServerName	servername(serverargument);
+	if ("metrics" == command) {
+		Ice::ObjectPrx	base = ic->stringToProxy(
+					servername.connect("Metrics"));
+		MetricsPrx	metrics = MetricsPrx::checkedCast(base);
+		if (!metrics) {
+			throw std::runtime_error("cannot connect to remote "
+				"server");
+		}
+		return metrics_command(metrics, arguments);
+	}
 	Ice::ObjectPrx	base = ic->stringToProxy(
 				servername.connect("Configuration"));
 	ConfigurationPrx	configuration
@@ -12,6 +12,7 @@
 #include <AstroIO.h>
 #include <repository.h>
 #include <IceConversions.h>
+#include <ChunkedTransfer.h>
 #include <RepoReplicators.h>
 
 using namespace snowstar;
@@ -288,7 +289,7 @@ int	command_add(const astro::ServerName& servername,
 	for (auto ptr = filenames.begin(); ptr != filenames.end(); ptr++) {
 		astro::io::FITSin	in(*ptr);
 		astro::image::ImagePtr	imageptr = in.read();
-		repository->save(convertfile(imageptr));
+		chunkedsave(repository, imageptr);
 	}
 	
 	return EXIT_SUCCESS;
@@ -306,7 +307,7 @@ int	command_get(const astro::ServerName& servername,
 	// get the repo
 	RepositoryPrx	repository = getRemoteRepo(servername, reponame);
 
-	ImageFile	image = repository->getImage(id);
+	ImageFile	image = chunkedgetimage(repository, id);
 	astro::io::FITSout	out(filename);
 	out.write(convertfile(image));
 	return EXIT_SUCCESS;
@@ -11,6 +11,7 @@
 #include <IceConversions.h>
 #include <AstroDebug.h>
 #include <CommonClientTasks.h>
+#include <ImageSinkI.h>
 
 namespace snowstar {
 namespace app {
@@ -19,7 +20,7 @@ namespace snowstream {
 /**
  * \brief Stream sink for this application
  */
-class StreamSink : public ImageSink {
+class StreamSink : public ImageSinkI {
 	std::mutex		_mutex;
 	std::condition_variable	_condition;
 public:
@@ -69,6 +70,15 @@ static void	usage(const char *progname) {
 		<< std::endl;
 	std::cout << " -C,--ccd=<ccd>       use CCD with index <ccd> (default 0)" << std::endl;
 	std::cout << " -d,--debug           increase debug level" << std::endl;
+	std::cout << " --format=<fmt>       convert images to <fmt> on the server: "
+		"native, rgb8" << std::endl;
+	std::cout << "                      or mono8" << std::endl;
+	std::cout << " --black=<b>          16 bit value mapped to black in 8 bit "
+		"formats" << std::endl;
+	std::cout << " --white=<w>          16 bit value mapped to white in 8 bit "
+		"formats," << std::endl;
+	std::cout << "                      e.g. 4095 for a 12 bit sensor"
+		<< std::endl;
 	std::cout << " -h,-?,--help         display this help message"
 		<< std::endl;
 }
@@ -78,6 +88,7 @@ static void	usage(const char *progname) {
  */
 static struct option	longopts[] = {
 { "binning",		required_argument,	NULL,	'b' },
+{ "black",		required_argument,	NULL,	 3  },
 { "config",		required_argument,	NULL,	'c' },
 { "ccd",		required_argument,	NULL,	'C' },
 { "debug",		no_argument,		NULL,	'd' },
@@ -85,9 +96,11 @@ static struct option	longopts[] = {
 { "filter",		required_argument,	NULL,	'f' },
 { "frame",		required_argument,	NULL,	 1  },
 { "focus",		required_argument,	NULL,	'F' },
+{ "format",		required_argument,	NULL,	 2  },
 { "help",		no_argument,		NULL,	'h' },
 { "purpose",		required_argument,	NULL,	'p' },
 { "temperature",	required_argument,	NULL,	't' },
+{ "white",		required_argument,	NULL,	 4  },
 { NULL,			0,			NULL,	 0  }
 };
 
@@ -104,6 +117,10 @@ int	main(int argc, char *argv[]) {
 	unsigned short	focusposition = 0;
 	std::string	filtername;
 	double	temperature = std::numeric_limits<double>::quiet_NaN();
+	astro::image::StreamFormat::format	format
+		= astro::image::StreamFormat::native;
+	unsigned short	black = 0;
+	unsigned short	white = 0xffff;
 
 	int	c;
 	int	longindex;
@@ -143,6 +160,16 @@ int	main(int argc, char *argv[]) {
 		case 1:
 			exposure.frame(astro::image::ImageRectangle(optarg));
 			break;
+		case 2:
+			format = astro::image::StreamFormat::string2format(
+				optarg);
+			break;
+		case 3:
+			black = std::stoi(optarg);
+			break;
+		case 4:
+			white = std::stoi(optarg);
+			break;
 		default:
 			throw std::runtime_error("unknown option");
 		}
@@ -207,6 +234,10 @@ int	main(int argc, char *argv[]) {
 	ccd->ice_getConnection()->setAdapter(adapter.adapter());
 	ccd->registerSink(ident);
 
+	// images are converted on the server before they are sent
+	ccd->setStreamFormat(convert(astro::image::StreamFormat(format, black,
+		white)));
+
 	// start the stream
 	ccd->startStream(convert(exposure));
 
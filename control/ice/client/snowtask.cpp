@@ -10,10 +10,12 @@
 #include <AstroConfig.h>
 #include <tasks.h>
 #include <IceConversions.h>
+#include <ChunkedTransfer.h>
 #include <CommonClientTasks.h>
 #include <AstroFormat.h>
 #include <AstroConfig.h>
 #include <AstroProject.h>
+#include <AstroIO.h>
 
 namespace snowstar {
 namespace app {
@@ -416,22 +418,44 @@ int	command_image(TaskQueuePrx tasks, int id, const std::string& filename) {
 
 	// get an interface for that particular image
 	ImagePrx	image = images->getImage(info.filename);
-	ImageFile	imagefile = image->file();
-
-	// write the image data into a file
-	int fd = open(filename.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0666);
-	if (fd < 0) {
-		throw std::runtime_error("cannot create file");
-	}
-	size_t	bytes = write(fd, imagefile.data(), imagefile.size());
-	if (imagefile.size() != bytes) {
-		std::string	msg = astro::stringprintf(
-			"cannot write data: %s", strerror(errno));
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "cannot write data");
-		close(fd);
-		throw std::runtime_error(msg);
-	}
-	close(fd);
+
+	// write the image data into a file chunk by chunk
+	chunkedfile(image, filename);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * \brief Implementation of the preview command
+ *
+ * Retrieves a stretched 8 bit preview of the image no larger than
+ * maxsize pixels, which is much faster than the complete image on slow
+ * links.
+ */
+int	command_preview(TaskQueuePrx tasks, int id, int maxsize,
+		const std::string& filename) {
+	// check whether the task really is completed
+	TaskInfo	info = tasks->info(id);
+	if (TskCOMPLETE != info.state) {
+		throw std::runtime_error("task not completed");
+	}
+
+	// get an interfaces for Images
+	Ice::CommunicatorPtr	ic = CommunicatorSingleton::get();
+        Ice::ObjectPrx  base = ic->stringToProxy(servername.connect("Images"));
+	ImagesPrx	images = ImagesPrx::checkedCast(base);
+
+	// get the preview and write it to a file
+	ImagePrx	image = images->getImage(info.filename);
+	ImagePreview	preview = image->preview(maxsize);
+	if (verbose) {
+		std::cout << "preview " << preview.size.width << "x"
+			<< preview.size.height << ", binning "
+			<< preview.binning << ", range " << preview.low
+			<< " - " << preview.high << std::endl;
+	}
+	astro::io::FITSout	out(filename);
+	out.setPrecious(false);
+	out.write(convertpreview(preview));
 	return EXIT_SUCCESS;
 }
 
@@ -464,10 +488,9 @@ int	command_repository(TaskQueuePrx tasks, int id,
 
 	// get an interface for that particular image
 	ImagePrx	image = images->getImage(info.filename);
-	ImageFile	imagefile = image->file();
 
 	// convert the image file to an ImagePtr
-	astro::image::ImagePtr	imageptr = convertfile(imagefile);
+	astro::image::ImagePtr	imageptr = convert(image);
 
 	// get the image repository
 	astro::config::ConfigurationPtr	config
@@ -500,6 +523,8 @@ static void	usage(const char *progname) {
 	std::cout << p << " [ options ] submit" << std::endl;
 	std::cout << p << " [ options ] project <projectname> <partno>" << std::endl;
 	std::cout << p << " [ options ] image <id> <filename>" << std::endl;
+	std::cout << p << " [ options ] preview <id> <maxsize> <filename>"
+		<< std::endl;
 	std::cout << p << " [ options ] remote <id> <imagerepo>" << std::endl;
 	std::cout << std::endl;
 	std::cout << "possible task states:" << std::endl;
@@ -696,6 +721,21 @@ int	main(int argc, char *argv[]) {
 		std::string	filename = argv[optind++];
 		return command_image(tasks, id, filename);
 	}
+	if (command == "preview") {
+		if (argc <= optind) {
+			throw std::runtime_error("no id argument specified");
+		}
+		int	id = std::stoi(argv[optind++]);
+		if (argc <= optind) {
+			throw std::runtime_error("no preview size");
+		}
+		int	maxsize = std::stoi(argv[optind++]);
+		if (argc <= optind) {
+			throw std::runtime_error("no image file name");
+		}
+		std::string	filename = argv[optind++];
+		return command_preview(tasks, id, maxsize, filename);
+	}
 	if (command == "remote") {
 		if (argc <= optind) {
 			throw std::runtime_error("no id argument specified");
@@ -0,0 +1,87 @@
+/*
+ * ChunkedTransfer.h -- transfer of image files in chunks
+ *
+ * Images may be larger than Ice.MessageSizeMax, and transferring them
+ * in a single message needs the complete file in memory on both ends.
+ * The chunked transfer operations in the image, repository and camera
+ * interfaces avoid this, the classes and functions declared here
+ * implement them on the server and the client side.
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _ChunkedTransfer_h
+#define _ChunkedTransfer_h
+
+#include <image.h>
+#include <repository.h>
+#include <AstroImage.h>
+#include <map>
+#include <mutex>
+
+namespace snowstar {
+
+/**
+ * \brief Size of the chunks, well below the Ice.MessageSizeMax limit
+ */
+#define	TRANSFER_CHUNKSIZE	(1 << 20)
+
+/**
+ * \brief CRC-32 checksum of transferred data
+ *
+ * The checksum of a block following data with checksum c is computed
+ * by passing c as the checksum argument.
+ */
+int	transferchecksum(const unsigned char *data, size_t length,
+		int checksum = 0);
+
+/**
+ * \brief Server side state of all chunked transfers
+ *
+ * Downloads read the chunks directly from a file, so the complete file
+ * is never held in memory. Uploads write the chunks to a temporary file.
+ * Transfers that are not used for some time are removed, so that a
+ * client that disappears does not leak open files.
+ */
+class ChunkedTransfers {
+	struct transfer {
+		std::string	filename;
+		bool	temporary;
+		bool	upload;
+		int	fd;
+		Ice::Long	size;
+		Ice::Long	received;
+		time_t	lastused;
+	};
+	std::map<std::string, transfer>	_transfers;
+	std::mutex	_mutex;
+	void	expire();
+	void	release(transfer& t);
+	transfer&	find(const std::string& id, bool upload);
+	// prevent copying
+	ChunkedTransfers(const ChunkedTransfers& other);
+	ChunkedTransfers&	operator=(const ChunkedTransfers& other);
+	ChunkedTransfers() { }
+public:
+	static ChunkedTransfers&	get();
+	FileTransfer	download(const std::string& filename,
+				bool temporary = false);
+	FileChunk	read(const std::string& id, Ice::Long offset,
+				int length);
+	std::string	upload(Ice::Long size);
+	void	write(const std::string& id, const FileChunk& chunk);
+	std::string	complete(const std::string& id, int checksum);
+	void	end(const std::string& id);
+};
+
+std::string	transferfilename();
+
+// client side of the chunked transfers
+void	chunkedfile(ImagePrx image, const std::string& filename);
+ImageFile	chunkedfile(ImagePrx image);
+ImageFile	chunkedgetimage(RepositoryPrx repository, int id);
+int	chunkedsave(RepositoryPrx repository, const ImageFile& imagefile);
+int	chunkedsave(RepositoryPrx repository, astro::image::ImagePtr image);
+
+} // namespace snowstar
+
+#endif /* _ChunkedTransfer_h */
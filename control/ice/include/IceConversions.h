@@ -15,6 +15,8 @@
 #include <AstroEvent.h>
 #include <AstroConfig.h>
 #include <AstroDiscovery.h>
+#include <AstroDisplay.h>
+#include <AstroMetrics.h>
 #include <types.h>
 #include <device.h>
 #include <camera.h>
@@ -68,6 +70,14 @@ astro::config::ConfigurationKey	convert(const struct ConfigurationKey& key);
 struct ConfigurationItem	convert(const astro::config::ConfigurationEntry& entry);
 astro::config::ConfigurationEntry	convert(const struct ConfigurationItem& entry);
 
+// Metrics
+MetricType	convert(astro::metrics::MetricValue::metric_type type);
+astro::metrics::MetricValue::metric_type	convert(MetricType type);
+struct Metric	convert(const astro::metrics::MetricValue& value);
+astro::metrics::MetricValue	convert(const struct Metric& metric);
+MetricList	convert(const astro::metrics::MetricsSnapshot& snapshot);
+astro::metrics::MetricsSnapshot	convert(const MetricList& list);
+
 // Device conversions
 DeviceNameList  convert(const astro::module::Devices::devicelist& list);
 astro::module::Devices::devicelist	convert(const DeviceNameList& list);
@@ -105,6 +115,9 @@ typedef std::shared_ptr<ImageQueueEntry>	ImageQueueEntryPtr;
 ImageQueueEntryPtr	convert(const astro::camera::ImageQueueEntry e);
 astro::camera::ImageQueueEntry	convert(ImageQueueEntryPtr e);
 
+StreamFormat	convert(const astro::image::StreamFormat& f);
+astro::image::StreamFormat	convert(const StreamFormat& f);
+
 // FilterWheel
 FilterwheelState convert(const astro::camera::FilterWheel::State& s);
 astro::camera::FilterWheel::State convert(const FilterwheelState& s);
@@ -135,9 +148,16 @@ astro::guiding::TrackingPoint	convert(const TrackingPoint& trackingpoint);
 TrackingHistory	convert(const astro::guiding::TrackingHistory& history);
 astro::guiding::TrackingHistory	convert(const TrackingHistory& history);
 
+TrackingSeries	convert(const astro::guiding::TrackingSeries& series);
+astro::guiding::TrackingSeries	convert(const TrackingSeries& series);
+
 TrackingSummary	convert(const astro::guiding::TrackingSummary& summary);
 astro::guiding::TrackingSummary	convert(const TrackingSummary& summary);
 
+CallbackStatistics	convert(const astro::callback::CallbackStatistics& s);
+CallbackStatisticsList	convert(
+	const std::vector<astro::callback::CallbackStatistics>& s);
+
 // calibration related
 CalibrationPoint	convert(const astro::guiding::CalibrationPoint& cp);
 astro::guiding::CalibrationPoint	convert(const CalibrationPoint& cp);
@@ -208,6 +228,9 @@ ImageFile	convertfile(astro::image::ImagePtr imageptr);
 astro::image::Metavalue	convert(const Metavalue& metavalue);
 Metavalue	convert(const astro::image::Metavalue& metavalue);
 
+ImagePreview	convert(const astro::image::ImagePreview& preview);
+astro::image::ImagePtr	convertpreview(const ImagePreview& preview);
+
 // Focusing
 FocusState	convert(astro::focusing::Focusing::state_type s);
 astro::focusing::Focusing::state_type	convert(FocusState s);
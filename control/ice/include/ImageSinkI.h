@@ -8,18 +8,33 @@
 
 #include <camera.h>
 #include <Ice/Ice.h>
+#include <map>
+#include <mutex>
 
 namespace snowstar {
 
 /**
  * \brief Base class of all image sink implementations
+ *
+ * Images too large for a single message arrive as chunks, the base class
+ * reassembles them and hands the complete entry to the image() method,
+ * so derived classes only have to implement image() and stop().
  */
 class ImageSinkI : public ImageSink {
+	struct partial {
+		ImageQueueEntry	entry;
+		Ice::Long	received;
+		time_t	lastused;
+	};
+	std::map<std::string, partial>	_partials;
+	std::mutex	_mutex;
 public:
 	ImageSinkI();
-	void	stop(const Ice::Current& current);
-	void	image(const ImageQueueEntry& entry,
-			const Ice::Current& current);
+	virtual void	stop(const Ice::Current& current);
+	virtual void	image(const ImageQueueEntry& entry,
+				const Ice::Current& current);
+	virtual void	imageChunk(const ImageChunk& chunk,
+				const Ice::Current& current);
 };
 
 } // namespace snowstar
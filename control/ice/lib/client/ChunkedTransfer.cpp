@@ -0,0 +1,344 @@
+/*
+ * ChunkedTransfer.cpp -- client side of chunked image transfers
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <ChunkedTransfer.h>
+#include <IceConversions.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroIO.h>
+#include <includes.h>
+#include <functional>
+
+namespace snowstar {
+
+/**
+ * \brief Table for the CRC-32 polynomial 0xedb88320
+ */
+static const uint32_t	*crctable() {
+	static uint32_t	table[256];
+	static std::once_flag	flag;
+	std::call_once(flag, []() {
+		for (uint32_t n = 0; n < 256; n++) {
+			uint32_t	c = n;
+			for (int k = 0; k < 8; k++) {
+				c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+			}
+			table[n] = c;
+		}
+	});
+	return table;
+}
+
+int	transferchecksum(const unsigned char *data, size_t length,
+		int checksum) {
+	const uint32_t	*table = crctable();
+	uint32_t	c = ~(uint32_t)checksum;
+	for (size_t i = 0; i < length; i++) {
+		c = table[(c ^ data[i]) & 0xff] ^ (c >> 8);
+	}
+	return (int)~c;
+}
+
+/**
+ * \brief Create a temporary file for a transfer and return its name
+ */
+std::string	transferfilename() {
+	const char	*tmpdir = "/tmp";
+	if (NULL != getenv("TMPDIR")) {
+		tmpdir = getenv("TMPDIR");
+	}
+	char	buffer[1024];
+	snprintf(buffer, sizeof(buffer), "%s/transfer-XXXXXX.fits", tmpdir);
+	int	fd = mkstemps(buffer, 5);
+	if (fd < 0) {
+		std::string	msg = astro::stringprintf("cannot create "
+			"temporary file: %s", strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	close(fd);
+	return std::string(buffer);
+}
+
+typedef std::function<FileChunk(Ice::Long offset, int length)>	chunkreader;
+typedef std::function<void(const FileChunk& chunk)>	chunkwriter;
+
+/**
+ * \brief Retrieve all chunks of a download
+ *
+ * Every chunk is verified against its own checksum, and the complete
+ * data against the checksum of the transfer.
+ */
+static void	download(const FileTransfer& transfer, chunkreader reader,
+			chunkwriter writer) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "downloading %ld bytes in transfer %s",
+		(long)transfer.size, transfer.id.c_str());
+	Ice::Long	offset = 0;
+	int	checksum = 0;
+	while (offset < transfer.size) {
+		int	length = std::min((Ice::Long)TRANSFER_CHUNKSIZE,
+					transfer.size - offset);
+		FileChunk	chunk = reader(offset, length);
+		if ((chunk.offset != offset) || (chunk.data.size() == 0)
+			|| (chunk.data.size() > (size_t)length)) {
+			std::string	msg = astro::stringprintf("bad chunk "
+				"%ld/%lu, expected offset %ld",
+				(long)chunk.offset,
+				(unsigned long)chunk.data.size(), (long)offset);
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+			throw std::runtime_error(msg);
+		}
+		if (transferchecksum(chunk.data.data(), chunk.data.size())
+			!= chunk.checksum) {
+			std::string	msg = astro::stringprintf("checksum error "
+				"in chunk at offset %ld", (long)offset);
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+			throw std::runtime_error(msg);
+		}
+		checksum = transferchecksum(chunk.data.data(),
+				chunk.data.size(), checksum);
+		writer(chunk);
+		offset += chunk.data.size();
+	}
+	if (checksum != transfer.checksum) {
+		std::string	msg = astro::stringprintf("checksum error in "
+			"transfer %s", transfer.id.c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+}
+
+/**
+ * \brief Writer that writes the chunks to a file descriptor
+ */
+static chunkwriter	filewriter(int fd) {
+	return [fd](const FileChunk& chunk) {
+		ssize_t	l = pwrite(fd, chunk.data.data(), chunk.data.size(),
+				chunk.offset);
+		if (l != (ssize_t)chunk.data.size()) {
+			std::string	msg = astro::stringprintf("cannot write "
+				"chunk: %s", strerror(errno));
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+			throw std::runtime_error(msg);
+		}
+	};
+}
+
+/**
+ * \brief Writer that appends the chunks to an image file buffer
+ */
+static chunkwriter	bufferwriter(ImageFile& imagefile) {
+	return [&imagefile](const FileChunk& chunk) {
+		imagefile.insert(imagefile.end(), chunk.data.begin(),
+			chunk.data.end());
+	};
+}
+
+/**
+ * \brief Write the file of an image to a local file
+ *
+ * Servers that do not implement the chunked transfer are asked for the
+ * complete file in a single message.
+ */
+void	chunkedfile(ImagePrx image, const std::string& filename) {
+	int	fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) {
+		std::string	msg = astro::stringprintf("cannot create %s: %s",
+			filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	try {
+		FileTransfer	transfer;
+		try {
+			transfer = image->beginFile();
+		} catch (const Ice::OperationNotExistException& x) {
+			ImageFile	file = image->file();
+			FileChunk	chunk;
+			chunk.offset = 0;
+			chunk.data = file;
+			filewriter(fd)(chunk);
+			close(fd);
+			return;
+		}
+		try {
+			download(transfer, [image, transfer](Ice::Long offset,
+				int length) {
+				return image->readFileChunk(transfer.id, offset,
+					length);
+			}, filewriter(fd));
+		} catch (...) {
+			image->endFile(transfer.id);
+			throw;
+		}
+		image->endFile(transfer.id);
+	} catch (...) {
+		close(fd);
+		unlink(filename.c_str());
+		throw;
+	}
+	close(fd);
+}
+
+/**
+ * \brief Get the file of an image
+ */
+ImageFile	chunkedfile(ImagePrx image) {
+	FileTransfer	transfer;
+	try {
+		transfer = image->beginFile();
+	} catch (const Ice::OperationNotExistException& x) {
+		return image->file();
+	}
+	ImageFile	result;
+	result.reserve(transfer.size);
+	try {
+		download(transfer, [image, transfer](Ice::Long offset,
+			int length) {
+			return image->readFileChunk(transfer.id, offset, length);
+		}, bufferwriter(result));
+	} catch (...) {
+		image->endFile(transfer.id);
+		throw;
+	}
+	image->endFile(transfer.id);
+	return result;
+}
+
+/**
+ * \brief Get an image from a repository
+ */
+ImageFile	chunkedgetimage(RepositoryPrx repository, int id) {
+	FileTransfer	transfer;
+	try {
+		transfer = repository->beginGetImage(id);
+	} catch (const Ice::OperationNotExistException& x) {
+		return repository->getImage(id);
+	}
+	ImageFile	result;
+	result.reserve(transfer.size);
+	try {
+		download(transfer, [repository, transfer](Ice::Long offset,
+			int length) {
+			return repository->readImageChunk(transfer.id, offset,
+				length);
+		}, bufferwriter(result));
+	} catch (...) {
+		repository->endGetImage(transfer.id);
+		throw;
+	}
+	repository->endGetImage(transfer.id);
+	return result;
+}
+
+/**
+ * \brief Upload size bytes to a repository, chunks come from a reader
+ *
+ * If the upload fails before it is complete, the transfer is aborted so
+ * that the server does not keep the partial file until it expires.
+ */
+static int	upload(RepositoryPrx repository, Ice::Long size,
+			chunkreader reader) {
+	std::string	id = repository->beginSave(size);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "uploading %ld bytes in transfer %s",
+		(long)size, id.c_str());
+	Ice::Long	offset = 0;
+	int	checksum = 0;
+	try {
+		while (offset < size) {
+			int	length = std::min((Ice::Long)TRANSFER_CHUNKSIZE,
+						size - offset);
+			FileChunk	chunk = reader(offset, length);
+			chunk.checksum = transferchecksum(chunk.data.data(),
+						chunk.data.size());
+			checksum = transferchecksum(chunk.data.data(),
+					chunk.data.size(), checksum);
+			repository->writeImageChunk(id, chunk);
+			offset += length;
+		}
+	} catch (...) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "aborting upload %s", id.c_str());
+		try {
+			repository->abortSave(id);
+		} catch (const std::exception& x) {
+			debug(LOG_ERR, DEBUG_LOG, 0, "cannot abort upload %s: %s",
+				id.c_str(), x.what());
+		}
+		throw;
+	}
+	// endSave removes the file itself if it fails
+	return repository->endSave(id, checksum);
+}
+
+/**
+ * \brief Save an image file in a repository
+ */
+int	chunkedsave(RepositoryPrx repository, const ImageFile& imagefile) {
+	try {
+		return upload(repository, imagefile.size(),
+			[&imagefile](Ice::Long offset, int length) {
+				FileChunk	chunk;
+				chunk.offset = offset;
+				chunk.data.assign(imagefile.begin() + offset,
+					imagefile.begin() + offset + length);
+				return chunk;
+			});
+	} catch (const Ice::OperationNotExistException& x) {
+		return repository->save(imagefile);
+	}
+}
+
+/**
+ * \brief Save an image in a repository
+ *
+ * The image is written to a temporary FITS file which is then uploaded
+ * chunk by chunk, so the encoded image is never held in memory.
+ */
+int	chunkedsave(RepositoryPrx repository, astro::image::ImagePtr image) {
+	std::string	filename = transferfilename();
+	int	fd = -1;
+	try {
+		unlink(filename.c_str());
+		astro::io::FITSout	out(filename);
+		out.setPrecious(false);
+		out.write(image);
+		fd = open(filename.c_str(), O_RDONLY);
+		struct stat	sb;
+		if ((fd < 0) || (fstat(fd, &sb) < 0)) {
+			std::string	msg = astro::stringprintf("cannot read "
+				"%s: %s", filename.c_str(), strerror(errno));
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+			throw std::runtime_error(msg);
+		}
+		int	result;
+		try {
+			result = upload(repository, sb.st_size,
+				[fd](Ice::Long offset, int length) {
+				FileChunk	chunk;
+				chunk.offset = offset;
+				chunk.data.resize(length);
+				if (length != pread(fd, chunk.data.data(),
+					length, offset)) {
+					throw std::runtime_error("cannot read "
+						"image file");
+				}
+				return chunk;
+			});
+		} catch (const Ice::OperationNotExistException& x) {
+			result = repository->save(convertfile(image));
+		}
+		close(fd);
+		unlink(filename.c_str());
+		return result;
+	} catch (...) {
+		if (fd >= 0) {
+			close(fd);
+		}
+		unlink(filename.c_str());
+		throw;
+	}
+}
+
+} // namespace snowstar
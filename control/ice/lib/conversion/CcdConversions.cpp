@@ -7,6 +7,7 @@
 #include <includes.h>
 #include <AstroIO.h>
 #include <AstroUtils.h>
+#include <AstroFormat.h>
 
 namespace snowstar {
 
@@ -224,4 +225,45 @@ astro::camera::ImageQueueEntry	convert(ImageQueueEntryPtr e) {
 	return result;
 }
 
+StreamFormat	convert(const astro::image::StreamFormat& f) {
+	StreamFormat	result;
+	switch (f.getFormat()) {
+	case astro::image::StreamFormat::native:
+		result.format = StreamNATIVE;
+		break;
+	case astro::image::StreamFormat::rgb8:
+		result.format = StreamRGB8;
+		break;
+	case astro::image::StreamFormat::mono8:
+		result.format = StreamMONO8;
+		break;
+	}
+	result.black = f.black();
+	result.white = f.white();
+	return result;
+}
+
+astro::image::StreamFormat	convert(const StreamFormat& f) {
+	astro::image::StreamFormat::format	format
+		= astro::image::StreamFormat::native;
+	switch (f.format) {
+	case StreamNATIVE:
+		format = astro::image::StreamFormat::native;
+		break;
+	case StreamRGB8:
+		format = astro::image::StreamFormat::rgb8;
+		break;
+	case StreamMONO8:
+		format = astro::image::StreamFormat::mono8;
+		break;
+	}
+	if ((f.black < 0) || (f.white > 0xffff)) {
+		std::string	msg = astro::stringprintf("stream range [%d,%d] "
+			"outside 16 bit", f.black, f.white);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+	return astro::image::StreamFormat(format, f.black, f.white);
+}
+
 } // namespace snowstar
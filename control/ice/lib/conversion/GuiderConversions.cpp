@@ -285,6 +285,59 @@ TrackingHistory	convert(const astro::guiding::TrackingHistory& history) {
 	return result;
 }
 
+TrackingSeries	convert(const astro::guiding::TrackingSeries& series) {
+	TrackingSeries	result;
+	result.trackid = series.trackid;
+	result.timeago = converttime(series.whenstarted);
+	result.type = convertcontroltype(series.type);
+	result.binwidth = series.binwidth;
+	result.count = series.count;
+	result.time = series.time;
+	result.xoffset = series.xoffset;
+	result.yoffset = series.yoffset;
+	result.racorrection = series.racorrection;
+	result.deccorrection = series.deccorrection;
+	return result;
+}
+
+astro::guiding::TrackingSeries	convert(const TrackingSeries& series) {
+	astro::guiding::TrackingSeries	result;
+	result.trackid = series.trackid;
+	result.whenstarted = converttime(series.timeago);
+	result.type = convertcontroltype(series.type);
+	result.binwidth = series.binwidth;
+	result.count = series.count;
+	result.time = series.time;
+	result.xoffset = series.xoffset;
+	result.yoffset = series.yoffset;
+	result.racorrection = series.racorrection;
+	result.deccorrection = series.deccorrection;
+	return result;
+}
+
+CallbackStatistics	convert(const astro::callback::CallbackStatistics& s) {
+	CallbackStatistics	result;
+	result.subscriber = s.subscriber;
+	result.delivered = s.delivered;
+	result.dropped = s.dropped;
+	result.coalesced = s.coalesced;
+	result.failed = s.failed;
+	result.queued = s.queued;
+	result.maxqueued = s.maxqueued;
+	result.lag = s.lag;
+	result.maxlag = s.maxlag;
+	return result;
+}
+
+CallbackStatisticsList	convert(
+	const std::vector<astro::callback::CallbackStatistics>& s) {
+	CallbackStatisticsList	result;
+	for (auto i = s.begin(); i != s.end(); i++) {
+		result.push_back(convert(*i));
+	}
+	return result;
+}
+
 ControlType     convertcontroltype(
 	const astro::guiding::ControlDeviceType& caltype) {
 	switch (caltype) {
@@ -4,10 +4,12 @@
  * (c) 2014 Prof Dr Andreas Mueller, 
  */
 #include <IceConversions.h>
+#include <ChunkedTransfer.h>
 #include <type_traits>
 #include <limits>
 #include <includes.h>
 #include <AstroIO.h>
+#include <AstroDisplay.h>
 #include <AstroFormat.h>
 #include <typeinfo>
 
@@ -17,10 +19,6 @@ namespace snowstar {
  * \brief Convert an Imge Proxy into an image
  */
 astro::image::ImagePtr	convert(ImagePrx image) {
-	// get the image data from the server
-	ImageFile	file = image->file();
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "got image of size %d", file.size());
-
 	// construct a temporary file name
 	char	buffer[1024];
 	if (getenv("TMPDIR")) {
@@ -35,16 +33,14 @@ astro::image::ImagePtr	convert(ImagePrx image) {
 			strerror(errno));
 		throw std::runtime_error("cannot create tmp file name");
 	}
+	close(fd);
 	std::string	filename(buffer);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "temporary image file: %s", buffer);
 
-	int	s = file.size();
-	if (s != write(fd, file.data(), s)) {
-		debug(LOG_ERR, DEBUG_LOG, 0, "writing temp file failed: %s",
-			strerror(errno));
-		close(fd);
-	}
-	close(fd);
+	// get the image data from the server in chunks, so that large
+	// images neither exceed the message size nor have to be kept in
+	// memory
+	chunkedfile(image, filename);
 
 	// use FITS classes to read the temporary file
 	astro::io::FITSin	in(filename);
@@ -341,4 +337,88 @@ astro::image::Metavalue	convert(const Metavalue& metavalue) {
 		metavalue.comment);
 }
 
+/**
+ * \brief Convert a preview, only the binned values are included
+ */
+ImagePreview	convert(const astro::image::ImagePreview& preview) {
+	ImagePreview	result;
+	result.source = convert(preview.source());
+	result.binning = preview.binning();
+	result.size = convert(preview.size());
+	result.planes = preview.planes();
+	result.minimum = preview.minimum();
+	result.maximum = preview.maximum();
+	result.low = preview.minimum();
+	result.high = preview.maximum();
+	result.values = preview.values();
+	return result;
+}
+
+/**
+ * \brief Convert a preview received from the server into an image
+ *
+ * If the preview contains an 8 bit rendering, an image with unsigned
+ * char pixels is returned, otherwise an image with float pixels.
+ */
+astro::image::ImagePtr	convertpreview(const ImagePreview& preview) {
+	astro::image::ImageSize	size = convert(preview.size);
+	size_t	n = size.getPixels() * preview.planes;
+	bool	rendered = (preview.bytes.size() > 0);
+	if ((rendered) ? (preview.bytes.size() != n)
+			: (preview.values.size() != n)) {
+		std::string	msg = astro::stringprintf("preview data does "
+			"not match size %s", size.toString().c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	astro::image::ImagePtr	result;
+	if (rendered) {
+		if (preview.planes == 3) {
+			astro::image::Image<astro::image::RGB<unsigned char> >
+				*imagep = new astro::image::Image<
+					astro::image::RGB<unsigned char> >(size);
+			for (unsigned int i = 0; i < size.getPixels(); i++) {
+				imagep->pixels[i]
+					= astro::image::RGB<unsigned char>(
+					preview.bytes[3 * i],
+					preview.bytes[3 * i + 1],
+					preview.bytes[3 * i + 2]);
+			}
+			result = astro::image::ImagePtr(imagep);
+		} else {
+			astro::image::Image<unsigned char>	*imagep
+				= new astro::image::Image<unsigned char>(size);
+			std::copy(preview.bytes.begin(), preview.bytes.end(),
+				imagep->pixels);
+			result = astro::image::ImagePtr(imagep);
+		}
+	} else {
+		if (preview.planes == 3) {
+			astro::image::Image<astro::image::RGB<float> >
+				*imagep = new astro::image::Image<
+					astro::image::RGB<float> >(size);
+			for (unsigned int i = 0; i < size.getPixels(); i++) {
+				imagep->pixels[i] = astro::image::RGB<float>(
+					preview.values[3 * i],
+					preview.values[3 * i + 1],
+					preview.values[3 * i + 2]);
+			}
+			result = astro::image::ImagePtr(imagep);
+		} else {
+			astro::image::Image<float>	*imagep
+				= new astro::image::Image<float>(size);
+			std::copy(preview.values.begin(), preview.values.end(),
+				imagep->pixels);
+			result = astro::image::ImagePtr(imagep);
+		}
+	}
+	// remember where the preview came from
+	result->setOrigin(convert(preview.source.origin));
+	result->setMetadata(astro::io::FITSKeywords::meta(
+		std::string("XBINNING"), (long)preview.binning));
+	result->setMetadata(astro::io::FITSKeywords::meta(
+		std::string("YBINNING"), (long)preview.binning));
+	return result;
+}
+
 } // namespace snowstar
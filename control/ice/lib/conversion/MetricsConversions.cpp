@@ -0,0 +1,78 @@
+/*
+ * MetricsConversions.cpp -- conversions of metrics between ice and astro
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <IceConversions.h>
+
+namespace snowstar {
+
+MetricType	convert(astro::metrics::MetricValue::metric_type type) {
+	switch (type) {
+	case astro::metrics::MetricValue::counter:
+		return MetricCounter;
+	case astro::metrics::MetricValue::gauge:
+		return MetricGauge;
+	case astro::metrics::MetricValue::histogram:
+		return MetricHistogram;
+	}
+	throw std::runtime_error("unknown metric type");
+}
+
+astro::metrics::MetricValue::metric_type	convert(MetricType type) {
+	switch (type) {
+	case MetricCounter:
+		return astro::metrics::MetricValue::counter;
+	case MetricGauge:
+		return astro::metrics::MetricValue::gauge;
+	case MetricHistogram:
+		return astro::metrics::MetricValue::histogram;
+	}
+	throw std::runtime_error("unknown metric type");
+}
+
+struct Metric	convert(const astro::metrics::MetricValue& value) {
+	struct Metric	result;
+	result.name = value.name;
+	result.type = convert(value.type);
+	result.count = value.count;
+	result.value = value.value;
+	result.mean = value.mean;
+	result.p50 = value.p50;
+	result.p90 = value.p90;
+	result.p99 = value.p99;
+	result.max = value.max;
+	return result;
+}
+
+astro::metrics::MetricValue	convert(const struct Metric& metric) {
+	astro::metrics::MetricValue	result;
+	result.name = metric.name;
+	result.type = convert(metric.type);
+	result.count = metric.count;
+	result.value = metric.value;
+	result.mean = metric.mean;
+	result.p50 = metric.p50;
+	result.p90 = metric.p90;
+	result.p99 = metric.p99;
+	result.max = metric.max;
+	return result;
+}
+
+MetricList	convert(const astro::metrics::MetricsSnapshot& snapshot) {
+	MetricList	result;
+	for (auto ptr = snapshot.begin(); ptr != snapshot.end(); ptr++) {
+		result.push_back(convert(*ptr));
+	}
+	return result;
+}
+
+astro::metrics::MetricsSnapshot	convert(const MetricList& list) {
+	astro::metrics::MetricsSnapshot	result;
+	for (auto ptr = list.begin(); ptr != list.end(); ptr++) {
+		result.push_back(convert(*ptr));
+	}
+	return result;
+}
+
+} // namespace snowstar
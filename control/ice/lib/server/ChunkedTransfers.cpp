@@ -0,0 +1,323 @@
+/*
+ * ChunkedTransfers.cpp -- server side state of chunked file transfers
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <ChunkedTransfer.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <IceUtil/UUID.h>
+#include <includes.h>
+
+namespace snowstar {
+
+/**
+ * \brief Seconds after which an unused transfer is removed
+ */
+#define	TRANSFER_TIMEOUT	600
+
+ChunkedTransfers&	ChunkedTransfers::get() {
+	static ChunkedTransfers	transfers;
+	return transfers;
+}
+
+/**
+ * \brief Close the file of a transfer and remove it if it is temporary
+ */
+void	ChunkedTransfers::release(transfer& t) {
+	if (t.fd >= 0) {
+		close(t.fd);
+		t.fd = -1;
+	}
+	if (t.temporary) {
+		unlink(t.filename.c_str());
+	}
+}
+
+/**
+ * \brief Remove transfers the client has abandoned, lock must be held
+ */
+void	ChunkedTransfers::expire() {
+	time_t	now = time(NULL);
+	std::map<std::string, transfer>::iterator	i = _transfers.begin();
+	while (i != _transfers.end()) {
+		if ((now - i->second.lastused) > TRANSFER_TIMEOUT) {
+			debug(LOG_DEBUG, DEBUG_LOG, 0, "transfer %s expired",
+				i->first.c_str());
+			release(i->second);
+			_transfers.erase(i++);
+		} else {
+			i++;
+		}
+	}
+}
+
+/**
+ * \brief Find a transfer, lock must be held
+ */
+ChunkedTransfers::transfer&	ChunkedTransfers::find(const std::string& id,
+		bool upload) {
+	std::map<std::string, transfer>::iterator	i = _transfers.find(id);
+	if ((i == _transfers.end()) || (i->second.upload != upload)) {
+		std::string	msg = astro::stringprintf("no %s transfer %s",
+			(upload) ? "upload" : "download", id.c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw NotFound(msg);
+	}
+	time(&i->second.lastused);
+	return i->second;
+}
+
+/**
+ * \brief Start a download of a file
+ *
+ * The file is read once to compute the checksum. If temporary is set,
+ * the file is removed when the transfer ends.
+ */
+FileTransfer	ChunkedTransfers::download(const std::string& filename,
+			bool temporary) {
+	transfer	t;
+	t.filename = filename;
+	t.temporary = temporary;
+	t.upload = false;
+	t.fd = open(filename.c_str(), O_RDONLY);
+	if (t.fd < 0) {
+		std::string	msg = astro::stringprintf("cannot open %s: %s",
+			filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		if (temporary) {
+			unlink(filename.c_str());
+		}
+		throw NotFound(msg);
+	}
+
+	// compute the checksum of the complete file
+	FileTransfer	result;
+	result.size = 0;
+	result.checksum = 0;
+	std::vector<unsigned char>	buffer(TRANSFER_CHUNKSIZE);
+	ssize_t	l;
+	while ((l = ::read(t.fd, buffer.data(), buffer.size())) > 0) {
+		result.checksum = transferchecksum(buffer.data(), l,
+			result.checksum);
+		result.size += l;
+	}
+	if (l < 0) {
+		std::string	msg = astro::stringprintf("cannot read %s: %s",
+			filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		release(t);
+		throw NotFound(msg);
+	}
+	t.size = result.size;
+	t.received = 0;
+	time(&t.lastused);
+	result.id = IceUtil::generateUUID();
+
+	std::unique_lock<std::mutex>	lock(_mutex);
+	expire();
+	_transfers.insert(std::make_pair(result.id, t));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "download %s of %s (%ld bytes)",
+		result.id.c_str(), filename.c_str(), (long)result.size);
+	return result;
+}
+
+/**
+ * \brief Read a chunk of a download
+ */
+FileChunk	ChunkedTransfers::read(const std::string& id, Ice::Long offset,
+			int length) {
+	int	fd;
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		transfer&	t = find(id, false);
+		if ((offset < 0) || (offset > t.size) || (length < 0)
+			|| (length > TRANSFER_CHUNKSIZE)) {
+			std::string	msg = astro::stringprintf("bad chunk "
+				"%ld/%d of %ld bytes", (long)offset, length,
+				(long)t.size);
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+			throw BadParameter(msg);
+		}
+		length = std::min((Ice::Long)length, t.size - offset);
+		// end() or expire() may close the transfer while we read,
+		// and the descriptor number could then be reused for some
+		// other file. A duplicate refers to the same open file and
+		// stays valid until we close it ourselves.
+		fd = dup(t.fd);
+		if (fd < 0) {
+			std::string	msg = astro::stringprintf("cannot dup "
+				"descriptor of %s: %s", id.c_str(),
+				strerror(errno));
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+			throw BadParameter(msg);
+		}
+	}
+
+	// pread does not use the file position, so chunks of the same
+	// transfer can be read concurrently
+	FileChunk	result;
+	result.offset = offset;
+	result.data.resize(length);
+	ssize_t	l = pread(fd, result.data.data(), length, offset);
+	int	e = errno;
+	close(fd);
+	if (l != length) {
+		std::string	msg = astro::stringprintf("cannot read chunk "
+			"%ld/%d: %s", (long)offset, length,
+			(l < 0) ? strerror(e) : "short read");
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw BadParameter(msg);
+	}
+	result.checksum = transferchecksum(result.data.data(), length);
+	return result;
+}
+
+/**
+ * \brief Start an upload of size bytes into a temporary file
+ */
+std::string	ChunkedTransfers::upload(Ice::Long size) {
+	if (size <= 0) {
+		std::string	msg = astro::stringprintf("bad upload size %ld",
+			(long)size);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw BadParameter(msg);
+	}
+	transfer	t;
+	t.filename = transferfilename();
+	t.temporary = true;
+	t.upload = true;
+	t.fd = open(t.filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (t.fd < 0) {
+		std::string	msg = astro::stringprintf("cannot create %s: %s",
+			t.filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw BadParameter(msg);
+	}
+	t.size = size;
+	t.received = 0;
+	time(&t.lastused);
+	std::string	id = IceUtil::generateUUID();
+
+	std::unique_lock<std::mutex>	lock(_mutex);
+	expire();
+	_transfers.insert(std::make_pair(id, t));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "upload %s of %ld bytes to %s",
+		id.c_str(), (long)size, t.filename.c_str());
+	return id;
+}
+
+/**
+ * \brief Write a chunk of an upload
+ */
+void	ChunkedTransfers::write(const std::string& id, const FileChunk& chunk) {
+	Ice::Long	length = chunk.data.size();
+	if (transferchecksum(chunk.data.data(), length) != chunk.checksum) {
+		std::string	msg = astro::stringprintf("checksum error in "
+			"chunk %ld/%ld", (long)chunk.offset, (long)length);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw BadParameter(msg);
+	}
+	int	fd;
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		transfer&	t = find(id, true);
+		if ((chunk.offset < 0) || (chunk.offset + length > t.size)) {
+			std::string	msg = astro::stringprintf("chunk %ld/%ld "
+				"outside upload of %ld bytes",
+				(long)chunk.offset, (long)length, (long)t.size);
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+			throw BadParameter(msg);
+		}
+		// see read() why we write through a duplicate
+		fd = dup(t.fd);
+		if (fd < 0) {
+			std::string	msg = astro::stringprintf("cannot dup "
+				"descriptor of %s: %s", id.c_str(),
+				strerror(errno));
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+			throw BadParameter(msg);
+		}
+	}
+
+	// chunks of the same upload go to disjoint ranges of the file,
+	// so they can be written concurrently
+	ssize_t	l = pwrite(fd, chunk.data.data(), length, chunk.offset);
+	int	e = errno;
+	close(fd);
+	if (l != length) {
+		std::string	msg = astro::stringprintf("cannot write chunk "
+			"%ld/%ld: %s", (long)chunk.offset, (long)length,
+			(l < 0) ? strerror(e) : "short write");
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw BadParameter(msg);
+	}
+
+	std::unique_lock<std::mutex>	lock(_mutex);
+	find(id, true).received += length;
+}
+
+/**
+ * \brief Complete an upload
+ *
+ * This method verifies that the file is complete and has the right
+ * checksum. It returns the name of the file, which the caller has to
+ * remove when it no longer needs it.
+ */
+std::string	ChunkedTransfers::complete(const std::string& id,
+			int checksum) {
+	// once the transfer is removed from the map it belongs to us
+	// alone, so the file can be verified without holding the lock
+	transfer	t;
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		t = find(id, true);
+		_transfers.erase(id);
+	}
+	close(t.fd);
+	t.fd = -1;
+	if (t.received != t.size) {
+		std::string	msg = astro::stringprintf("upload incomplete: "
+			"%ld of %ld bytes", (long)t.received, (long)t.size);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		release(t);
+		throw BadParameter(msg);
+	}
+
+	// verify the checksum of the file
+	int	fd = open(t.filename.c_str(), O_RDONLY);
+	int	c = 0;
+	if (fd >= 0) {
+		std::vector<unsigned char>	buffer(TRANSFER_CHUNKSIZE);
+		ssize_t	l;
+		while ((l = ::read(fd, buffer.data(), buffer.size())) > 0) {
+			c = transferchecksum(buffer.data(), l, c);
+		}
+		close(fd);
+	}
+	if ((fd < 0) || (c != checksum)) {
+		std::string	msg = astro::stringprintf("checksum mismatch in "
+			"upload %s", id.c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		release(t);
+		throw BadParameter(msg);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "upload %s complete", id.c_str());
+	return t.filename;
+}
+
+/**
+ * \brief End a transfer and release its resources
+ */
+void	ChunkedTransfers::end(const std::string& id) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	std::map<std::string, transfer>::iterator	i = _transfers.find(id);
+	if (i == _transfers.end()) {
+		return;
+	}
+	release(i->second);
+	_transfers.erase(i);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "transfer %s ended", id.c_str());
+}
+
+} // namespace snowstar
@@ -6,6 +6,7 @@
 #include <ImageSinkI.h>
 #include <AstroDebug.h>
 #include <IceConversions.h>
+#include <ChunkedTransfer.h>
 
 namespace snowstar {
 
@@ -32,4 +33,73 @@ void	ImageSinkI::image(const ImageQueueEntry& entry,
 		convert(entry.exposure0).toString().c_str());
 }
 
+/**
+ * \brief Handle a chunk of an image from the stream
+ *
+ * The chunks are placed at their offset, so they may arrive in any order.
+ * When all chunks have arrived and the checksum of the complete image is
+ * correct, the image is handed to the image() method. Incomplete images
+ * whose chunks stop arriving are discarded after a minute.
+ */
+void	ImageSinkI::imageChunk(const ImageChunk& chunk,
+		const Ice::Current& current) {
+	const FileTransfer&	transfer = chunk.transfer;
+	const FileChunk&	c = chunk.chunk;
+	ImageQueueEntry	entry;
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		time_t	now = time(NULL);
+		std::map<std::string, partial>::iterator	i = _partials.begin();
+		while (i != _partials.end()) {
+			if ((now - i->second.lastused) > 60) {
+				debug(LOG_WARNING, DEBUG_LOG, 0,
+					"incomplete image %s discarded",
+					i->first.c_str());
+				_partials.erase(i++);
+			} else {
+				i++;
+			}
+		}
+		if ((c.offset < 0)
+			|| (c.offset + (Ice::Long)c.data.size() > transfer.size)
+			|| (transferchecksum(c.data.data(), c.data.size())
+				!= c.checksum)) {
+			debug(LOG_ERR, DEBUG_LOG, 0, "bad chunk %ld/%lu in %s, "
+				"image discarded", (long)c.offset,
+				(unsigned long)c.data.size(),
+				transfer.id.c_str());
+			_partials.erase(transfer.id);
+			return;
+		}
+		i = _partials.find(transfer.id);
+		if (i == _partials.end()) {
+			partial	p;
+			p.entry.exposure0 = chunk.exposure0;
+			p.entry.imagedata.resize(transfer.size);
+			p.received = 0;
+			i = _partials.insert(std::make_pair(transfer.id, p)).first;
+		}
+		partial&	p = i->second;
+		std::copy(c.data.begin(), c.data.end(),
+			p.entry.imagedata.begin() + c.offset);
+		p.received += c.data.size();
+		p.lastused = now;
+		if (p.received < transfer.size) {
+			return;
+		}
+		entry.exposure0 = p.entry.exposure0;
+		entry.imagedata.swap(p.entry.imagedata);
+		_partials.erase(i);
+	}
+	if (transferchecksum(entry.imagedata.data(), entry.imagedata.size())
+		!= transfer.checksum) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "checksum error in image %s",
+			transfer.id.c_str());
+		return;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "image %s of %ld bytes complete",
+		transfer.id.c_str(), (long)transfer.size);
+	image(entry, current);
+}
+
 } // namespace snowstar
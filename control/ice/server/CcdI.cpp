@@ -210,4 +210,20 @@ void	CcdI::unregisterSink(const ::Ice::Current& current) {
 	_sink = NULL;
 }
 
+/**
+ * \brief Set the format of streamed images, also while streaming
+ */
+void	CcdI::setStreamFormat(const StreamFormat& format,
+		const Ice::Current& /* current */) {
+	try {
+		_ccd->streamFormat(convert(format));
+	} catch (const std::range_error& x) {
+		throw BadParameter(x.what());
+	}
+}
+
+StreamFormat	CcdI::getStreamFormat(const Ice::Current& /* current */) {
+	return convert(_ccd->streamFormat());
+}
+
 } // namespace snowstar
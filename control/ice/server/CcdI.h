@@ -17,6 +17,11 @@ namespace snowstar {
  */
 class CcdSink : public astro::camera::ImageSink {
 	ImageSinkPrx	sinkprx;
+	typedef enum { chunks_unknown, chunks_supported, chunks_unsupported }
+		chunk_support;
+	chunk_support	_chunks;
+	void	send(const ImageQueueEntry& entry);
+	void	sinkfailed(const std::exception& x);
 public:
 	CcdSink(const Ice::Identity& identity, const Ice::Current& current);
 	void	operator()(const astro::camera::ImageQueueEntry& entry);
@@ -68,6 +73,9 @@ public:
 			const Ice::Current& current);
 	void	stopStream(const ::Ice::Current& current);
 	void	unregisterSink(const ::Ice::Current& current);
+	void	setStreamFormat(const StreamFormat& format,
+			const Ice::Current& current);
+	StreamFormat	getStreamFormat(const Ice::Current& current);
 };
 
 } // namespace snowstar
@@ -7,6 +7,8 @@
 #include <Ice/Connection.h>
 #include <IceConversions.h>
 #include <AstroUtils.h>
+#include <ChunkedTransfer.h>
+#include <IceUtil/UUID.h>
 
 namespace snowstar {
 
@@ -16,7 +18,8 @@ namespace snowstar {
  * The constructor creates the ImageSink proxy via which it will talk
  * to the client
  */
-CcdSink::CcdSink(const Ice::Identity& identity, const Ice::Current& current) {
+CcdSink::CcdSink(const Ice::Identity& identity, const Ice::Current& current)
+	: _chunks(chunks_unknown) {
 	std::string	is = identity.name + "@" + identity.category;
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "construct a CcdSink: %s", is.c_str());
 	Ice::ObjectPrx	oneway = current.con->createProxy(identity)
@@ -26,6 +29,61 @@ CcdSink::CcdSink(const Ice::Identity& identity, const Ice::Current& current) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "cast completed");
 }
 
+/**
+ * \brief Give up on a sink whose client has gone away
+ */
+void	CcdSink::sinkfailed(const std::exception& x) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "sink connection lost: %s %s",
+		astro::demangle(typeid(x).name()).c_str(), x.what());
+	sinkprx = NULL;
+}
+
+/**
+ * \brief Send an image too large for a single message in chunks
+ *
+ * The transfer descriptor identifies the image by a fresh uuid and
+ * carries the CRC of the complete image, every chunk carries its own
+ * CRC. The client reassembles the image once all chunks have arrived,
+ * so there is no separate end call.
+ *
+ * The sink proxy is oneway, so a client that does not implement the
+ * imageChunk operation would silently drop the chunks. The first chunk
+ * is therefore sent twoway, if the client does not know the operation,
+ * this method throws Ice::OperationNotExistException, and all further
+ * images are sent in a single message.
+ */
+void	CcdSink::send(const ImageQueueEntry& entry) {
+	const ImageFile&	data = entry.imagedata;
+	ImageChunk	chunk;
+	chunk.exposure0 = entry.exposure0;
+	chunk.transfer.id = IceUtil::generateUUID();
+	chunk.transfer.size = data.size();
+	chunk.transfer.checksum = transferchecksum(data.data(), data.size());
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "sending %ld bytes in transfer %s",
+		(long)chunk.transfer.size, chunk.transfer.id.c_str());
+	Ice::Long	offset = 0;
+	while (offset < chunk.transfer.size) {
+		Ice::Long	length = std::min((Ice::Long)TRANSFER_CHUNKSIZE,
+					chunk.transfer.size - offset);
+		chunk.chunk.offset = offset;
+		chunk.chunk.data.assign(data.begin() + offset,
+			data.begin() + offset + length);
+		chunk.chunk.checksum = transferchecksum(chunk.chunk.data.data(),
+			length);
+		if (_chunks == chunks_unknown) {
+			ImageSinkPrx::uncheckedCast(sinkprx->ice_twoway())
+				->imageChunk(chunk);
+			debug(LOG_DEBUG, DEBUG_LOG, 0, "sink accepts chunks");
+			_chunks = chunks_supported;
+		} else {
+			sinkprx->imageChunk(chunk);
+		}
+		offset += length;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "transfer %s complete",
+		chunk.transfer.id.c_str());
+}
+
 /**
  * \brief Image sink main method
  *
@@ -43,13 +101,33 @@ void	CcdSink::operator()(const astro::camera::ImageQueueEntry& entry) {
 			entry.exposure.toString().c_str(),
 			e->imagedata.size());
 		try {
+			if ((e->imagedata.size() > TRANSFER_CHUNKSIZE)
+				&& (_chunks != chunks_unsupported)) {
+				try {
+					send(*e);
+					return;
+				} catch (const Ice::OperationNotExistException& x) {
+					debug(LOG_WARNING, DEBUG_LOG, 0,
+						"sink does not accept chunks, "
+						"sending complete images");
+					_chunks = chunks_unsupported;
+				}
+			}
 			sinkprx->image(*e);
+		} catch (const Ice::SocketException& x) {
+			sinkfailed(x);
+		} catch (const Ice::TimeoutException& x) {
+			sinkfailed(x);
+		} catch (const Ice::ObjectNotExistException& x) {
+			sinkfailed(x);
+		} catch (const Ice::CommunicatorDestroyedException& x) {
+			sinkfailed(x);
 		} catch (const std::exception& x) {
-			debug(LOG_DEBUG, DEBUG_LOG, 0,
+			// the sink is still there, only this image is lost
+			debug(LOG_ERR, DEBUG_LOG, 0,
 				"cannot send image: %s %s",
 				astro::demangle(typeid(x).name()).c_str(),
 				x.what());
-			sinkprx = NULL;
 		}
 	} else {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "ImageQueueEntry: sink stalled");
@@ -8,14 +8,16 @@
 
 namespace snowstar {
 
-DeviceLocatorLocator::DeviceLocatorLocator(astro::module::Repository& repository) : _repository(repository) {
+DeviceLocatorLocator::DeviceLocatorLocator(astro::module::Repository& repository)
+	: _repository(repository), _timers("devicelocator") {
 }
 
 DeviceLocatorLocator::~DeviceLocatorLocator() {
 }
 
 Ice::ObjectPtr	DeviceLocatorLocator::locate(const Ice::Current& current,
-			Ice::LocalObjectPtr& /* cookie */) {
+			Ice::LocalObjectPtr& cookie) {
+	_timers.start(cookie);
 	std::string	modulename = current.id.name;
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "request for locator in module '%s'",
 		modulename.c_str());
@@ -24,9 +26,10 @@ Ice::ObjectPtr	DeviceLocatorLocator::locate(const Ice::Current& current,
 	return new DeviceLocatorI(module->getDeviceLocator());
 }
 
-void	DeviceLocatorLocator::finished(const Ice::Current& /* current */,
+void	DeviceLocatorLocator::finished(const Ice::Current& current,
 				const Ice::ObjectPtr& /* servant */,
-				const Ice::LocalObjectPtr& /* cookie */) {
+				const Ice::LocalObjectPtr& cookie) {
+	_timers.finished(current, cookie);
 }
 
 void	DeviceLocatorLocator::deactivate(const std::string& /* category */) {
@@ -7,12 +7,14 @@
 #define _DeviceLocatorLocator_h
 
 #include <Ice/Ice.h>
+#include "ServantTimer.h"
 #include <AstroLoader.h>
 
 namespace snowstar {
 
 class DeviceLocatorLocator : public Ice::ServantLocator {
 	astro::module::Repository	_repository;
+	ServantTimers	_timers;
 public:
 	DeviceLocatorLocator(astro::module::Repository& repository);
 	virtual ~DeviceLocatorLocator();
@@ -28,14 +28,16 @@ namespace snowstar {
  * \brief Create the locator for device servants
  */
 DeviceServantLocator::DeviceServantLocator(
-	astro::module::Repository& repository) : _repository(repository) {
+	astro::module::Repository& repository)
+	: _repository(repository), _timers("device") {
 }
 
 /**
  * \brief Create a servant 
  */
 Ice::ObjectPtr	DeviceServantLocator::locate(const Ice::Current& current,
-			Ice::LocalObjectPtr& /* cookie */) {
+			Ice::LocalObjectPtr& cookie) {
+	_timers.start(cookie);
 	std::string	name = NameConverter::urldecode(current.id.name);
 
 	// the device we are going to return
@@ -133,9 +135,10 @@ Ice::ObjectPtr	DeviceServantLocator::locate(const Ice::Current& current,
 	return ptr;
 }
 
-void	DeviceServantLocator::finished(const Ice::Current& /* current */,
+void	DeviceServantLocator::finished(const Ice::Current& current,
 		const Ice::ObjectPtr& /* servant */,
-		const Ice::LocalObjectPtr& /* cookie */) {
+		const Ice::LocalObjectPtr& cookie) {
+	_timers.finished(current, cookie);
 }
 
 void	DeviceServantLocator::deactivate(const std::string& /* category */) {
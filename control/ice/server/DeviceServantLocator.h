@@ -7,6 +7,7 @@
 #define _DeviceServantLocator_h
 
 #include <Ice/Ice.h>
+#include "ServantTimer.h"
 #include <AstroLoader.h>
 
 namespace snowstar {
@@ -15,6 +16,7 @@ class DeviceServantLocator : public Ice::ServantLocator {
 	astro::module::Repository	_repository;
 	typedef std::map<std::string, Ice::ObjectPtr>	devicemap;
 	devicemap	devices;
+	ServantTimers	_timers;
 public:
 	DeviceServantLocator(astro::module::Repository& repository);
 
@@ -9,14 +9,15 @@
 namespace snowstar {
 
 DriverModuleLocator::DriverModuleLocator(astro::module::Repository& repository)
-	: _repository(repository) {
+	: _repository(repository), _timers("drivermodule") {
 }
 
 DriverModuleLocator::~DriverModuleLocator() {
 }
 
 Ice::ObjectPtr	DriverModuleLocator::locate(const Ice::Current& current,
-			Ice::LocalObjectPtr& /* cookie */) {
+			Ice::LocalObjectPtr& cookie) {
+	_timers.start(cookie);
 	std::string	modulename = current.id.name;
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "request for module %s",
 		modulename.c_str());
@@ -25,9 +26,10 @@ Ice::ObjectPtr	DriverModuleLocator::locate(const Ice::Current& current,
 	return new DriverModuleI(_repository.getModule(modulename));
 }
 
-void	DriverModuleLocator::finished(const Ice::Current& /* current */,
+void	DriverModuleLocator::finished(const Ice::Current& current,
 		const Ice::ObjectPtr& /* servant */,
-		const Ice::LocalObjectPtr& /* cookie */) {
+		const Ice::LocalObjectPtr& cookie) {
+	_timers.finished(current, cookie);
 }
 
 void	DriverModuleLocator::deactivate(const std::string& /* category */) {
@@ -7,12 +7,14 @@
 #define _DriverModuleLocator_h
 
 #include <Ice/Ice.h>
+#include "ServantTimer.h"
 #include <AstroLoader.h>
 
 namespace snowstar {
 
 class DriverModuleLocator : public Ice::ServantLocator {
 	astro::module::Repository	_repository;
+	ServantTimers	_timers;
 public:
 	DriverModuleLocator(astro::module::Repository& repository);
 	virtual ~DriverModuleLocator();
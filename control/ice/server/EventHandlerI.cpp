@@ -71,6 +71,11 @@ EventHandlerI::~EventHandlerI() {
  */
 Event	EventHandlerI::eventId(int id, const Ice::Current& /* current */) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "event id %d requested", id);
+	// recent events are still in memory
+	astro::events::EventRecord	recent(id);
+	if (astro::events::EventHandler::journal().find(id, recent)) {
+		return convert(recent);
+	}
 	astro::config::ConfigurationPtr	configuration
                 = astro::config::Configuration::get();
 	astro::persistence::Database	database = configuration->database();
@@ -94,6 +99,18 @@ Event	EventHandlerI::eventId(int id, const Ice::Current& /* current */) {
  */
 eventlist	EventHandlerI::eventsBetween(double fromago, double toago,
 					const Ice::Current& current) {
+	// answer from memory if the journal still has all these events
+	std::list<astro::events::EventRecord>	events;
+	if (astro::events::EventHandler::journal().recent(
+		astro::Timer::gettime() - fromago,
+		astro::Timer::gettime() - toago, events)) {
+		eventlist	result;
+		std::list<astro::events::EventRecord>::const_iterator	i;
+		for (i = events.begin(); i != events.end(); i++) {
+			result.push_back(convert(*i));
+		}
+		return result;
+	}
 	std::string	condition
 		= astro::stringprintf("eventtime between %f and %f", 
 			astro::Timer::gettime() - fromago,
@@ -10,18 +10,20 @@
 namespace snowstar {
 
 
-FocusingLocator::FocusingLocator() {
+FocusingLocator::FocusingLocator() : _timers("focusing") {
 }
 
 Ice::ObjectPtr  FocusingLocator::locate(const Ice::Current& current,
-		Ice::LocalObjectPtr& /* cookie */) {
+		Ice::LocalObjectPtr& cookie) {
+	_timers.start(cookie);
 	int	id = std::stoi(current.id.name);
 	return FocusingSingleton::get(id).focusingptr;
 }
 
-void	FocusingLocator::finished(const Ice::Current& /* current */,
+void	FocusingLocator::finished(const Ice::Current& current,
 			const Ice::ObjectPtr& /* servant */,
-			const Ice::LocalObjectPtr& /* cookie */) {
+			const Ice::LocalObjectPtr& cookie) {
+	_timers.finished(current, cookie);
 }
 
 void	FocusingLocator::deactivate(const std::string& /* category */) {
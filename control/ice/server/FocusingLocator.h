@@ -7,11 +7,13 @@
 #define _FocusingLocator_h
 
 #include <Ice/Ice.h>
+#include "ServantTimer.h"
 #include <map>
 
 namespace snowstar {
 
 class FocusingLocator : public Ice::ServantLocator {
+	ServantTimers	_timers;
 public:
 	FocusingLocator();
 
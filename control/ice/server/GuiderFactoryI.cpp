@@ -290,6 +290,35 @@ TrackingHistory	GuiderFactoryI::getTrackingHistoryType(int id,
 	throw std::runtime_error("internal error");
 }
 
+/**
+ * \brief Get a column oriented tracking history
+ *
+ * In contrast to getTrackingHistory, the size of the result can be
+ * bounded by the client by requesting a time range and a bin width.
+ */
+TrackingSeries	GuiderFactoryI::getTrackingSeries(int id, ControlType type,
+	double fromtime, double totime, double binwidth,
+	const Ice::Current& /* current */) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "retrieve series %d", id);
+	try {
+		astro::guiding::TrackingStore	store(database);
+		return convert(store.getSeries(id, convertcontroltype(type),
+			fromtime, totime, binwidth));
+	} catch (const astro::persistence::NotFound& ex) {
+		std::string	msg = astro::stringprintf("tracking history %d "
+			"not found: %s", id, ex.what());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw NotFound(msg);
+	} catch (const std::exception& ex) {
+		std::string	cause
+			= astro::stringprintf("no history: %s(%s)",
+				astro::demangle(typeid(ex).name()).c_str(),
+					ex.what());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", cause.c_str());
+		throw NotFound(cause);
+	}
+}
+
 /**
  * \brief Get a summary of the track
  *
@@ -46,6 +46,9 @@ public:
 	TrackingHistory	getTrackingHistory(int id, const Ice::Current& current);
 	TrackingHistory	getTrackingHistoryType(int id, ControlType type,
 		const Ice::Current& current);
+	TrackingSeries	getTrackingSeries(int id, ControlType type,
+		double fromtime, double totime, double binwidth,
+		const Ice::Current& current);
 	TrackingSummary	getTrackingSummary(int id, const Ice::Current& current);
 	TrackingSummary	getTrackingSummary(int id, ControlType type,
 		const Ice::Current& current);
@@ -43,15 +43,23 @@ GuiderI::GuiderI(astro::guiding::GuiderPtr _guider,
 	guider->addCalibrationCallback(_calibrationcallback);
 
 	// image callback, called for every image taken by the imager of
-	// the guider
+	// the guider. Images are sent to clients from a separate thread,
+	// so that slow clients cannot delay guiding. If clients cannot
+	// keep up, only the latest image is sent.
 	GuiderIImageCallback	*icallback = new GuiderIImageCallback(*this);
-	_imagecallback = astro::callback::CallbackPtr(icallback);
+	_imagecallback = astro::callback::AsynchronousCallbackPtr(
+		new astro::callback::AsynchronousCallback(
+			astro::callback::CallbackPtr(icallback), 1, true));
 	guider->addImageCallback(_imagecallback);
 
 	// tracking callback, called for every tracking point processed by
-	// either of the control devices of the guider
+	// either of the control devices of the guider. Tracking points
+	// are not coalesced, a client only loses points if it falls
+	// behind by more than the queue capacity.
 	GuiderITrackingCallback	*tcallback = new GuiderITrackingCallback(*this);
-	_trackingcallback = astro::callback::CallbackPtr(tcallback);
+	_trackingcallback = astro::callback::AsynchronousCallbackPtr(
+		new astro::callback::AsynchronousCallback(
+			astro::callback::CallbackPtr(tcallback), 64));
 	guider->addTrackingCallback(_trackingcallback);
 
 	// calibration image callback, called when the calibration image
@@ -78,6 +86,14 @@ GuiderI::~GuiderI() {
 	guider->removeCalibrationCallback(_calibrationcallback);
 	guider->removeImageCallback(_imagecallback);
 	guider->removeTrackingCallback(_trackingcallback);
+	// the worker threads refer to this object, so they must be
+	// stopped before it goes away
+	_imagecallback->stop();
+	_trackingcallback->stop();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "image callback %s",
+		_imagecallback->statistics().toString().c_str());
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "tracking callback %s",
+		_trackingcallback->statistics().toString().c_str());
 	guider->removeCalibrationImageCallback(_calibrationimagecallback);
 	guider->removeBacklashCallback(_backlashcallback);
 }
@@ -215,6 +231,14 @@ void    GuiderI::unregisterImageMonitor(const Ice::Identity& imagecallback,
 	imagecallbacks.unregisterCallback(imagecallback, current);
 }
 
+/**
+ * \brief Get the delivery statistics of the guider subscribers
+ */
+CallbackStatisticsList	GuiderI::getCallbackStatistics(
+		const Ice::Current& /* current */) {
+	return convert(guider->callbackStatistics());
+}
+
 /**
  * \brief Set the repository name
  */
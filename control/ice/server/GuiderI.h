@@ -51,9 +51,9 @@ class GuiderI : virtual public Guider, virtual public RepositoryUser {
 	astro::guiding::TrackerPtr	getTracker();
 
 	// callbacks that we need to remove when this object is destroyed
-	astro::callback::CallbackPtr	_imagecallback;
+	astro::callback::AsynchronousCallbackPtr	_imagecallback;
 	astro::callback::CallbackPtr	_calibrationcallback;
-	astro::callback::CallbackPtr	_trackingcallback;
+	astro::callback::AsynchronousCallbackPtr	_trackingcallback;
 	astro::callback::CallbackPtr	_calibrationimagecallback;
 	astro::callback::CallbackPtr	_backlashcallback;
 
@@ -109,6 +109,9 @@ public:
 			const Ice::Current& current);
 	virtual TrackingHistory getTrackingHistoryType(Ice::Int,
 			ControlType type, const Ice::Current& current);
+	virtual TrackingSeries	getTrackingSeries(Ice::Int id,
+			ControlType type, double fromtime, double totime,
+			double binwidth, const Ice::Current& current);
 	virtual TrackingSummary	getTrackingSummary(const Ice::Current& current);
 
 	// repository
@@ -139,6 +142,8 @@ public:
 	virtual void	unregisterImageMonitor(
 				const Ice::Identity& imagecallback,
 				const Ice::Current& current);
+	virtual CallbackStatisticsList	getCallbackStatistics(
+				const Ice::Current& current);
 
 	virtual void	registerTrackingMonitor(
 				const Ice::Identity& trackingcallback,
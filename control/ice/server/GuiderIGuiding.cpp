@@ -133,6 +133,31 @@ TrackingHistory GuiderI::getTrackingHistoryType(Ice::Int id,
 	throw BadState("not a valid control type");
 }
 
+/**
+ * \brief Get a column oriented tracking history
+ */
+TrackingSeries	GuiderI::getTrackingSeries(Ice::Int id, ControlType type,
+	double fromtime, double totime, double binwidth,
+	const Ice::Current& /* current */) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "get tracking series %d", id);
+	try {
+		astro::guiding::TrackingStore	store(database);
+		return convert(store.getSeries(id, convertcontroltype(type),
+			fromtime, totime, binwidth));
+	} catch (const astro::persistence::NotFound& ex) {
+		std::string	msg = astro::stringprintf("tracking history %d "
+			"not found: %s", id, ex.what());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw NotFound(msg);
+	} catch (const std::exception& ex) {
+		std::string	cause = astro::stringprintf(
+			"cannot get tracking series %d: %s(%s)", id,
+			astro::demangle(typeid(ex).name()).c_str(), ex.what());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", cause.c_str());
+		throw BadState(cause);
+	}
+}
+
 /**
  * \brief Register a callback for monitoring the tracking
  */
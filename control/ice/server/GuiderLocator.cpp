@@ -11,7 +11,7 @@
 
 namespace snowstar {
 
-GuiderLocator::GuiderLocator() {
+GuiderLocator::GuiderLocator() : _timers("guider") {
 }
 
 /**
@@ -38,7 +38,8 @@ bool	GuiderLocator::has(const std::string& guidername) {
  * \brief locate a guider in the map
  */
 Ice::ObjectPtr	GuiderLocator::locate(const Ice::Current& current,
-			Ice::LocalObjectPtr& /* cookie */) {
+			Ice::LocalObjectPtr& cookie) {
+	_timers.start(cookie);
 	std::string	guidername = NameConverter::urldecode(current.id.name);
 	//debug(LOG_DEBUG, DEBUG_LOG, 0, "looking for guider %s",
 	//	guidername.c_str());
@@ -53,9 +54,10 @@ Ice::ObjectPtr	GuiderLocator::locate(const Ice::Current& current,
 	return i->second;
 }
 
-void	GuiderLocator::finished(const Ice::Current& /* current */,
+void	GuiderLocator::finished(const Ice::Current& current,
 				const Ice::ObjectPtr& /* servant */,
-				const Ice::LocalObjectPtr& /* cookie */) {
+				const Ice::LocalObjectPtr& cookie) {
+	_timers.finished(current, cookie);
 }
 
 void	GuiderLocator::deactivate(const std::string& /* category */) {
@@ -7,12 +7,14 @@
 #define _GuiderLocator_h
 
 #include <Ice/Ice.h>
+#include "ServantTimer.h"
 
 namespace snowstar {
 
 class GuiderLocator : public Ice::ServantLocator {
 	typedef std::map<std::string, Ice::ObjectPtr>	guidermap;
 	guidermap	guiders;
+	ServantTimers	_timers;
 public:
 	GuiderLocator();
 
@@ -11,6 +11,7 @@
 #include <includes.h>
 #include <AstroImage.h>
 #include <AstroIO.h>
+#include <AstroDisplay.h>
 #include <AstroConfig.h>
 #include <IceConversions.h>
 #include <Ice/ObjectAdapter.h>
@@ -18,6 +19,7 @@
 #include <ProxyCreator.h>
 #include <ImagesI.h>
 #include <ImageDirectory.h>
+#include <ChunkedTransfer.h>
 
 namespace snowstar {
 
@@ -233,6 +235,97 @@ int     ImageI::filesize(const Ice::Current& /* current */) {
 	return _imagedirectory.fileSize(_filename);
 }
 
+/**
+ * \brief Start a chunked transfer of the FITS file
+ */
+FileTransfer	ImageI::beginFile(const Ice::Current& /* current */) {
+	astro::image::ImageDirectory	_imagedirectory;
+	return ChunkedTransfers::get().download(
+		_imagedirectory.fullname(_filename));
+}
+
+/**
+ * \brief Read a chunk of the FITS file
+ */
+FileChunk	ImageI::readFileChunk(const std::string& transferid,
+			Ice::Long offset, int length,
+			const Ice::Current& /* current */) {
+	return ChunkedTransfers::get().read(transferid, offset, length);
+}
+
+/**
+ * \brief End a chunked transfer of the FITS file
+ */
+void	ImageI::endFile(const std::string& transferid,
+		const Ice::Current& /* current */) {
+	ChunkedTransfers::get().end(transferid);
+}
+
+/**
+ * \brief Get binned pixel values of a rectangle of the image
+ *
+ * The preview is computed from the image kept by the servant, so a
+ * client browsing an image in several resolutions does not cause the
+ * file to be read again.
+ */
+ImagePreview	ImageI::binned(const ImageRectangle& source, int binning,
+			const Ice::Current& /* current */) {
+	try {
+		astro::image::ImagePreview	preview(image(), convert(source),
+							binning);
+		time(&_lastused);
+		return convert(preview);
+	} catch (const std::exception& x) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "cannot bin %s: %s",
+			_filename.c_str(), x.what());
+		throw BadParameter(x.what());
+	}
+}
+
+/**
+ * \brief Get an 8 bit rendering of a rectangle of the image
+ */
+ImagePreview	ImageI::rendered(const ImageRectangle& source, int binning,
+			float low, float high, float gamma,
+			const Ice::Current& /* current */) {
+	try {
+		astro::image::ImagePreview	preview(image(), convert(source),
+							binning);
+		time(&_lastused);
+		if (low >= high) {
+			preview.limits(0.01, 0.999, low, high);
+			if (low >= high) {
+				high = low + 1;
+			}
+		}
+		ImagePreview	result = convert(preview);
+		result.low = low;
+		result.high = high;
+		result.bytes = preview.stretch(low, high, gamma);
+		result.values.clear();
+		return result;
+	} catch (const std::exception& x) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "cannot render %s: %s",
+			_filename.c_str(), x.what());
+		throw BadParameter(x.what());
+	}
+}
+
+/**
+ * \brief Get an automatically stretched preview of the complete image
+ */
+ImagePreview	ImageI::preview(int maxsize, const Ice::Current& current) {
+	int	binning;
+	try {
+		binning = astro::image::ImagePreview::binningFor(
+			image()->size(), maxsize);
+	} catch (const std::exception& x) {
+		throw BadParameter(x.what());
+	}
+	return rendered(convert(astro::image::ImageRectangle()), binning,
+		0, 0, 1, current);
+}
+
 /**
  * \brief Save an image in a repository
  */
@@ -248,8 +341,11 @@ void	ImageI::toRepository(const std::string& reponame,
 	}
 	astro::project::ImageRepoPtr	repo = repoconf->repo(reponame);
 
-	// add the image to the repository;
-	repo->save(image());
+	// add the image to the repository, saving may add a UUID to the
+	// image, so the shared image from the cache cannot be used
+	astro::image::ImageDirectory	_imagedirectory;
+	astro::io::FITSin	in(_imagedirectory.fullname(_filename));
+	repo->save(in.read());
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "image saved");
 }
 
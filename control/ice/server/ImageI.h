@@ -52,6 +52,19 @@ public:
 				const Ice::Current& current);
 	virtual ImageFile	file(const Ice::Current& current);
 	virtual int	filesize(const Ice::Current& current);
+	virtual FileTransfer	beginFile(const Ice::Current& current);
+	virtual FileChunk	readFileChunk(const std::string& transferid,
+				Ice::Long offset, int length,
+				const Ice::Current& current);
+	virtual void	endFile(const std::string& transferid,
+				const Ice::Current& current);
+	virtual ImagePreview	binned(const ImageRectangle& source,
+				int binning, const Ice::Current& current);
+	virtual ImagePreview	rendered(const ImageRectangle& source,
+				int binning, float low, float high,
+				float gamma, const Ice::Current& current);
+	virtual ImagePreview	preview(int maxsize,
+				const Ice::Current& current);
 	virtual void	toRepository(const std::string& reponame,
 				const Ice::Current& current);
 	virtual void	remove(const Ice::Current& current);
@@ -8,6 +8,7 @@
 #include <AstroDebug.h>
 #include <AstroFilterfunc.h>
 #include <ImageDirectory.h>
+#include <ImageCache.h>
 
 namespace snowstar {
 
@@ -22,9 +23,10 @@ static void	launch_expiration(ImageLocator *imagelocator) {
 /**
  * \brief Constructor for an ImageLocator
  */
-ImageLocator::ImageLocator() {
+ImageLocator::ImageLocator() : _timers("image") {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "image locator created");
 	_stop = false;
+	_cacherequests = 0;
 	_thread = std::thread(launch_expiration, this);
 }
 
@@ -45,7 +47,8 @@ ImageLocator::~ImageLocator() {
  * This method creates an image servant of the correct pixel type
  */
 Ice::ObjectPtr	ImageLocator::locate(const Ice::Current& current,
-					Ice::LocalObjectPtr& /* cookie */) {
+					Ice::LocalObjectPtr& cookie) {
+	_timers.start(cookie);
 	std::unique_lock<std::mutex>	lock(_mutex);
 
 	std::string	name = current.id.name;
@@ -123,9 +126,10 @@ Ice::ObjectPtr	ImageLocator::locate(const Ice::Current& current,
 /**
  * \brief finished locator interface method
  */
-void	ImageLocator::finished(const Ice::Current& /* current */,
+void	ImageLocator::finished(const Ice::Current& current,
 				const Ice::ObjectPtr& /* servant */,
-				const Ice::LocalObjectPtr& /* cookie */) {
+				const Ice::LocalObjectPtr& cookie) {
+	_timers.finished(current, cookie);
 }
 
 /**
@@ -159,6 +163,18 @@ void	ImageLocator::expire() {
 	if (counter > 0) {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "%d images expired", counter);
 	}
+
+	// log the cache statistics when they have changed, the cache
+	// publishes the same numbers as imagecache.* metrics
+	astro::image::ImageCacheStatistics	statistics
+		= astro::image::ImageCache::get().statistics();
+	unsigned long	requests = statistics.hits + statistics.misses
+		+ statistics.headerhits + statistics.headermisses;
+	if (requests != _cacherequests) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "image cache: %s",
+			statistics.toString().c_str());
+		_cacherequests = requests;
+	}
 }
 
 /**
@@ -7,6 +7,7 @@
 #define _ImageLocator_h
 
 #include <Ice/Ice.h>
+#include "ServantTimer.h"
 #include <map>
 #include <ImageI.h>
 #include <mutex>
@@ -33,6 +34,7 @@ class ImageLocator : public Ice::ServantLocator {
 	std::mutex	_mutex;
 	std::condition_variable	_condition;
 	std::thread	_thread;
+	ServantTimers	_timers;
 private:
 	ImageLocator(const ImageLocator& other);
 	ImageLocator&	operator=(const ImageLocator& other);
@@ -52,6 +54,7 @@ public:
 	// methods related to expiration
 private:
 	bool	_stop;
+	unsigned long	_cacherequests;
 public:
 	void	stop();
 	void	expire();
@@ -9,11 +9,12 @@
 
 namespace snowstar {
 
-InstrumentLocator::InstrumentLocator() {
+InstrumentLocator::InstrumentLocator() : _timers("instrument") {
 }
 
 Ice::ObjectPtr	InstrumentLocator::locate(const Ice::Current& current,
-			Ice::LocalObjectPtr& /* cookie */) {
+			Ice::LocalObjectPtr& cookie) {
+	_timers.start(cookie);
 	std::string	name = current.id.name;
 
 	// check whether we already have an Instrument of this name
@@ -30,9 +31,10 @@ Ice::ObjectPtr	InstrumentLocator::locate(const Ice::Current& current,
 	return ptr;
 }
 
-void	InstrumentLocator::finished(const Ice::Current& /* current */,
+void	InstrumentLocator::finished(const Ice::Current& current,
 		const Ice::ObjectPtr& /* servant */,
-		const Ice::LocalObjectPtr& /* cookie */) {
+		const Ice::LocalObjectPtr& cookie) {
+	_timers.finished(current, cookie);
 }
 
 void	InstrumentLocator::deactivate(const std::string& /* category */) {
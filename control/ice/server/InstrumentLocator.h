@@ -7,6 +7,7 @@
 #define _InstrumentLocator_h
 
 #include <Ice/Ice.h>
+#include "ServantTimer.h"
 #include <instruments.h>
 #include <map>
 
@@ -15,6 +16,7 @@ namespace snowstar {
 class InstrumentLocator : public Ice::ServantLocator {
 	typedef std::map<std::string, Ice::ObjectPtr>	instrumentmap;
 	instrumentmap	instruments;
+	ServantTimers	_timers;
 public:
 	InstrumentLocator();
 
@@ -0,0 +1,26 @@
+/*
+ * MetricsI.cpp -- metrics servant implementation
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include "MetricsI.h"
+#include <AstroMetrics.h>
+#include <AstroDebug.h>
+#include <IceConversions.h>
+
+namespace snowstar {
+
+MetricList	MetricsI::snapshot(const Ice::Current& /* current */) {
+	return convert(astro::metrics::Metrics::snapshot());
+}
+
+std::string	MetricsI::dump(const Ice::Current& /* current */) {
+	return astro::metrics::Metrics::dump();
+}
+
+void	MetricsI::reset(const Ice::Current& /* current */) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "reset metrics");
+	astro::metrics::Metrics::reset();
+}
+
+} // namespace snowstar
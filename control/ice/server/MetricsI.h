@@ -0,0 +1,23 @@
+/*
+ * MetricsI.h -- metrics servant definition
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _MetricsI_h
+#define _MetricsI_h
+
+#include <types.h>
+
+namespace snowstar {
+
+class MetricsI : virtual public Metrics {
+public:
+	MetricsI() { }
+	MetricList	snapshot(const Ice::Current& current);
+	std::string	dump(const Ice::Current& current);
+	void	reset(const Ice::Current& current);
+};
+
+} // namespace snowstar
+
+#endif /* _MetricsI_h */
@@ -6,6 +6,8 @@
 #include <RepositoryI.h>
 #include <IceConversions.h>
 #include <AstroDebug.h>
+#include <ChunkedTransfer.h>
+#include <AstroIO.h>
 
 namespace snowstar {
 
@@ -100,6 +102,77 @@ int    RepositoryI::save(const ImageFile& image,
 	}
 }
 
+/**
+ * \brief Start a chunked transfer of an image file in the repository
+ */
+FileTransfer	RepositoryI::beginGetImage(int id,
+			const Ice::Current& /* current */) {
+	if (!_repo.has(id)) {
+		std::string	msg = astro::stringprintf("repo does not have "
+			"%d", id);
+		throw NotFound(msg);
+	}
+	return ChunkedTransfers::get().download(_repo.pathname(id));
+}
+
+FileChunk	RepositoryI::readImageChunk(const std::string& transferid,
+			Ice::Long offset, int length,
+			const Ice::Current& /* current */) {
+	return ChunkedTransfers::get().read(transferid, offset, length);
+}
+
+void	RepositoryI::endGetImage(const std::string& transferid,
+		const Ice::Current& /* current */) {
+	ChunkedTransfers::get().end(transferid);
+}
+
+/**
+ * \brief Start a chunked upload of an image file of the given size
+ */
+std::string	RepositoryI::beginSave(Ice::Long size,
+			const Ice::Current& /* current */) {
+	return ChunkedTransfers::get().upload(size);
+}
+
+void	RepositoryI::writeImageChunk(const std::string& transferid,
+		const FileChunk& chunk, const Ice::Current& /* current */) {
+	ChunkedTransfers::get().write(transferid, chunk);
+}
+
+/**
+ * \brief Complete a chunked upload and save the image in the repository
+ */
+int	RepositoryI::endSave(const std::string& transferid, int checksum,
+		const Ice::Current& /* current */) {
+	std::string	filename = ChunkedTransfers::get().complete(transferid,
+					checksum);
+	astro::image::ImagePtr	imageptr;
+	try {
+		astro::io::FITSin	in(filename);
+		imageptr = in.read();
+	} catch (const std::exception& x) {
+		unlink(filename.c_str());
+		std::string	msg = astro::stringprintf("cannot read uploaded "
+			"image: %s", x.what());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw BadParameter(msg);
+	}
+	unlink(filename.c_str());
+	try {
+		return _repo.save(imageptr);
+	} catch (...) {
+		throw Exists("Image already exists");
+	}
+}
+
+/**
+ * \brief Abort a chunked upload and remove the partial file
+ */
+void	RepositoryI::abortSave(const std::string& transferid,
+		const Ice::Current& /* current */) {
+	ChunkedTransfers::get().end(transferid);
+}
+
 int	RepositoryI::count(const Ice::Current& /* current */) {
 	try {
 		return _repo.count();
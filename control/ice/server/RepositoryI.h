@@ -33,6 +33,22 @@ public:
 	virtual ImageInfo	getInfo(int id, const Ice::Current& current);
 	virtual int	save(const ImageFile& image,
 				const Ice::Current& current);
+	virtual FileTransfer	beginGetImage(int id,
+					const Ice::Current& current);
+	virtual FileChunk	readImageChunk(const std::string& transferid,
+					Ice::Long offset, int length,
+					const Ice::Current& current);
+	virtual void	endGetImage(const std::string& transferid,
+				const Ice::Current& current);
+	virtual std::string	beginSave(Ice::Long size,
+					const Ice::Current& current);
+	virtual void	writeImageChunk(const std::string& transferid,
+				const FileChunk& chunk,
+				const Ice::Current& current);
+	virtual int	endSave(const std::string& transferid, int checksum,
+				const Ice::Current& current);
+	virtual void	abortSave(const std::string& transferid,
+				const Ice::Current& current);
 	virtual int	count(const Ice::Current& current);
 	virtual void	remove(int id, const Ice::Current& current);
 };
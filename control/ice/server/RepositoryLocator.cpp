@@ -10,7 +10,7 @@
 
 namespace snowstar {
 
-RepositoryLocator::RepositoryLocator() {
+RepositoryLocator::RepositoryLocator() : _timers("repository") {
 }
 
 /** 
@@ -30,7 +30,8 @@ void	RepositoryLocator::add(const std::string& name,
  * \brief locate a repository in the map, create it if necessary
  */
 Ice::ObjectPtr	RepositoryLocator::locate(const Ice::Current& current,
-		Ice::LocalObjectPtr& /* cookie */) {
+		Ice::LocalObjectPtr& cookie) {
+	_timers.start(cookie);
 	// determine the repository name
 	std::string	repositoryname = current.id.name;
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "locate = %s", repositoryname.c_str());
@@ -56,9 +57,10 @@ Ice::ObjectPtr	RepositoryLocator::locate(const Ice::Current& current,
 /**
  * \brief Stop using a servant
  */
-void	RepositoryLocator::finished(const Ice::Current& /* current */,
+void	RepositoryLocator::finished(const Ice::Current& current,
 		const Ice::ObjectPtr& /* servant */,
-		const Ice::LocalObjectPtr& /* cookie */) {
+		const Ice::LocalObjectPtr& cookie) {
+	_timers.finished(current, cookie);
 }
 
 /**
@@ -7,6 +7,7 @@
 #define _RepositoryLocator_h
 
 #include <Ice/Ice.h>
+#include "ServantTimer.h"
 #include <repository.h>
 
 namespace snowstar {
@@ -14,6 +15,7 @@ namespace snowstar {
 class RepositoryLocator : public Ice::ServantLocator {
 	typedef std::map<std::string, Ice::ObjectPtr>	repositorymap;
 	repositorymap	repositories;
+	ServantTimers	_timers;
 public:
 	RepositoryLocator();
 
@@ -0,0 +1,83 @@
+/*
+ * ServantTimer.cpp -- measure the time servants need to process calls
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include "ServantTimer.h"
+
+namespace snowstar {
+
+double	ServantTimer::elapsed() const {
+	std::chrono::duration<double>	d
+		= std::chrono::steady_clock::now() - _start;
+	return d.count();
+}
+
+/**
+ * \brief Maximum number of operations timed separately by a locator
+ */
+const size_t	ServantTimers::maxoperations = 256;
+
+ServantTimers::ServantTimers(const std::string& category)
+	: _category(category),
+	  _other(astro::metrics::Metrics::histogram(
+		std::string("ice.") + category + ".other")) {
+	pthread_rwlock_init(&_lock, NULL);
+}
+
+ServantTimers::~ServantTimers() {
+	pthread_rwlock_destroy(&_lock);
+}
+
+/**
+ * \brief Get the histogram for an operation
+ */
+astro::metrics::Histogram&	ServantTimers::histogram(
+		const std::string& operation) {
+	astro::metrics::Histogram	*h = NULL;
+	pthread_rwlock_rdlock(&_lock);
+	histogrammap::const_iterator	i = _histograms.find(operation);
+	if (i != _histograms.end()) {
+		h = i->second;
+	}
+	pthread_rwlock_unlock(&_lock);
+	if (NULL != h) {
+		return *h;
+	}
+
+	// first call of this operation, check again under the write lock
+	// because another thread may have added it in the meantime
+	pthread_rwlock_wrlock(&_lock);
+	i = _histograms.find(operation);
+	if (i != _histograms.end()) {
+		h = i->second;
+	} else if (_histograms.size() < maxoperations) {
+		h = &astro::metrics::Metrics::histogram(
+			std::string("ice.") + _category + "." + operation);
+		_histograms.insert(std::make_pair(operation, h));
+	} else {
+		h = &_other;
+	}
+	pthread_rwlock_unlock(&_lock);
+	return *h;
+}
+
+/**
+ * \brief Start timing a call, to be used in the locate method
+ */
+void	ServantTimers::start(Ice::LocalObjectPtr& cookie) {
+	cookie = new ServantTimer();
+}
+
+/**
+ * \brief Stop timing a call, to be used in the finished method
+ */
+void	ServantTimers::finished(const Ice::Current& current,
+		const Ice::LocalObjectPtr& cookie) {
+	ServantTimer	*timer = dynamic_cast<ServantTimer *>(cookie.get());
+	if (NULL != timer) {
+		histogram(current.operation).record(timer->elapsed());
+	}
+}
+
+} // namespace snowstar
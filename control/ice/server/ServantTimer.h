@@ -0,0 +1,61 @@
+/*
+ * ServantTimer.h -- measure the time servants need to process calls
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _ServantTimer_h
+#define _ServantTimer_h
+
+#include <Ice/Ice.h>
+#include <AstroMetrics.h>
+#include <pthread.h>
+#include <map>
+
+namespace snowstar {
+
+/**
+ * \brief Servant locator cookie that remembers when a call started
+ */
+class ServantTimer : public Ice::LocalObject {
+	std::chrono::steady_clock::time_point	_start;
+public:
+	ServantTimer() : _start(std::chrono::steady_clock::now()) { }
+	double	elapsed() const;
+};
+
+/**
+ * \brief Per locator cache of the call duration histograms
+ *
+ * A servant locator owns one of these and calls start() in locate()
+ * and finished() in its finished() method. Ice only calls finished()
+ * if a servant was found, so histograms ice.<category>.<operation> are
+ * only created for calls that reached a servant. Since the operation
+ * name is chosen by the client, the number of histograms per locator
+ * is limited, further operations are all recorded in the histogram
+ * ice.<category>.other.
+ *
+ * Lookups of known operations only take a read lock on the cache of
+ * the locator, the global metrics registry is only consulted the first
+ * time an operation is seen.
+ */
+class ServantTimers {
+	std::string	_category;
+	typedef std::map<std::string, astro::metrics::Histogram*>	histogrammap;
+	histogrammap	_histograms;
+	astro::metrics::Histogram&	_other;
+	pthread_rwlock_t	_lock;
+	ServantTimers(const ServantTimers& other);
+	ServantTimers&	operator=(const ServantTimers& other);
+public:
+	static const size_t	maxoperations;
+	ServantTimers(const std::string& category);
+	~ServantTimers();
+	astro::metrics::Histogram&	histogram(const std::string& operation);
+	void	start(Ice::LocalObjectPtr& cookie);
+	void	finished(const Ice::Current& current,
+			const Ice::LocalObjectPtr& cookie);
+};
+
+} // namespace snowstar
+
+#endif /* _ServantTimer_h */
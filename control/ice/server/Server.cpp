@@ -14,6 +14,7 @@
 #include <AstroDebug.h>
 #include <DeviceServantLocator.h>
 #include <ImageLocator.h>
+#include <ImageCache.h>
 #include <AstroTask.h>
 #include <TaskQueueI.h>
 #include <TaskLocator.h>
@@ -37,6 +38,7 @@
 #include <EventHandlerI.h>
 #include <EventServantLocator.h>
 #include <ConfigurationI.h>
+#include <MetricsI.h>
 
 namespace snowstar {
 
@@ -123,6 +125,12 @@ void	Server::add_configuration_servant() {
 		"Configuration server added");
 }
 
+void	Server::add_metrics_servant() {
+	Ice::ObjectPtr	object = new MetricsI();
+	adapter->add(object, ic->stringToIdentity("Metrics"));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "Metrics servant added");
+}
+
 void	Server::add_images_servant() {
 	Ice::ObjectPtr	object = new ImagesI();
 	adapter->add(object, ic->stringToIdentity("Images"));
@@ -229,6 +237,14 @@ Server::Server(Ice::CommunicatorPtr _ic, const std::string& dbfilename)
 
 	// initialize servants
 
+	// memory budget in MB of the image cache shared by the image and
+	// repository servants
+	astro::config::ConfigurationPtr	configuration
+		= astro::config::Configuration::get();
+	size_t	cachesize = std::stoul(configuration->get("snowstar", "images",
+				"cachesize", "256"));
+	astro::image::ImageCache::get().budget(cachesize << 20);
+
 	// create the adapter
 	std::string	connectstring = astro::stringprintf(
 		"default -p %hu", location.port());
@@ -246,6 +262,9 @@ Server::Server(Ice::CommunicatorPtr _ic, const std::string& dbfilename)
 	// add a servant for configuration data
 	add_configuration_servant();
 
+	// add a servant for the server metrics
+	add_metrics_servant();
+
 	// add a servant for devices to the device adapter
 	if (sp->has(astro::discover::ServiceSubset::DEVICES)) {
 		add_devices_servant();
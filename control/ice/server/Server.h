@@ -37,6 +37,7 @@ class Server {
 	void	add_devices_servant();
 	void	add_event_servant();
 	void	add_configuration_servant();
+	void	add_metrics_servant();
 	void	add_images_servant();
 	void	add_tasks_servant();
 	void	add_instruments_servant();
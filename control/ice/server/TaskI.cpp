@@ -14,6 +14,7 @@
 #include <AstroUtils.h>
 #include <AstroConfig.h>
 #include <ImageDirectory.h>
+#include <AstroIO.h>
 
 namespace snowstar {
 
@@ -77,7 +78,9 @@ int	TaskI::imageToRepo(const std::string& reponame,
 		debug(LOG_ERR, DEBUG_LOG, 0, "%s", exception.cause.c_str());
 		throw exception;
 	}
-	astro::image::ImagePtr	image = imagedir.getImagePtr(filename);
+	// saving may add a UUID, so the shared cached image cannot be used
+	astro::io::FITSin	in(imagedir.fullname(filename));
+	astro::image::ImagePtr	image = in.read();
 
 	// now get the named image repository configuration
 	astro::config::ConfigurationPtr	configuration
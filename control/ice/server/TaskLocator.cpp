@@ -10,11 +10,12 @@
 namespace snowstar {
 
 TaskLocator::TaskLocator(astro::persistence::Database& _database)
-	: database(_database) {
+	: database(_database), _timers("task") {
 }
 
 Ice::ObjectPtr	TaskLocator::locate(const Ice::Current& current,
-		Ice::LocalObjectPtr& /* cookie */) {
+		Ice::LocalObjectPtr& cookie) {
+	_timers.start(cookie);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "get a task %s",
 		current.id.name.c_str());
 
@@ -30,9 +31,10 @@ Ice::ObjectPtr	TaskLocator::locate(const Ice::Current& current,
 	return object;
 }
 
-void	TaskLocator::finished(const Ice::Current& /* current */,
+void	TaskLocator::finished(const Ice::Current& current,
 			const Ice::ObjectPtr& /* servant */,
-			const Ice::LocalObjectPtr& /* cookie */) {
+			const Ice::LocalObjectPtr& cookie) {
+	_timers.finished(current, cookie);
 }
 
 void	TaskLocator::deactivate(const std::string& /* category */) {
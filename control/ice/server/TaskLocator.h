@@ -7,12 +7,14 @@
 #define _TaskLocator_h
 
 #include <Ice/Ice.h>
+#include "ServantTimer.h"
 #include <AstroPersistence.h>
 
 namespace snowstar {
 
 class TaskLocator : public Ice::ServantLocator {
 	astro::persistence::Database&	database;
+	ServantTimers	_timers;
 public:
 	TaskLocator(astro::persistence::Database& database);
 
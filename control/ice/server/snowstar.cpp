@@ -307,6 +307,10 @@ int	snowstar_main(int argc, char *argv[]) {
 	astro::event(EVENT_GLOBAL, astro::events::INFO,
 		astro::events::Event::SERVER, "snowstar server shutdown");
 
+	// the journal writes asynchronously, make sure the shutdown event
+	// reaches the database before exec replaces the process
+	astro::events::EventHandler::flush();
+
 	// executing the new server
 	restart.exec();
 
@@ -140,6 +140,7 @@ public:
 	WindowAdapter(const ConstImageAdapter<Pixel>& image, const ImageRectangle& frame);
 	
 	virtual Pixel	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const;
 };
 
 /**
@@ -163,6 +164,11 @@ Pixel	WindowAdapter<Pixel>::pixel(int x, int y) const {
 	return	image.pixel(frame.origin().x() + x, frame.origin().y() + y);
 }
 
+template<typename Pixel>
+void	WindowAdapter<Pixel>::fillRow(int y, int x0, int n, Pixel *out) const {
+	image.fillRow(frame.origin().y() + y, frame.origin().x() + x0, n, out);
+}
+
 template<typename Pixel>
 class SubimageAdapter : public ImageAdapter<Pixel> {
 	ImageAdapter<Pixel>&	_image;
@@ -279,6 +285,7 @@ class ConvertingAdapter : public ConstImageAdapter<TargetPixel> {
 public:
 	ConvertingAdapter(const ConstImageAdapter<SourcePixel>& image);
 	virtual TargetPixel	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, TargetPixel *out) const;
 };
 
 template<typename TargetPixel, typename SourcePixel>
@@ -295,6 +302,16 @@ TargetPixel	ConvertingAdapter<TargetPixel, SourcePixel>::pixel(int x, int y) con
 	return p;
 }
 
+template<typename TargetPixel, typename SourcePixel>
+void	ConvertingAdapter<TargetPixel, SourcePixel>::fillRow(int y, int x0,
+		int n, TargetPixel *out) const {
+	std::vector<SourcePixel>	row(n);
+	image.fillRow(y, x0, n, row.data());
+	for (int i = 0; i < n; i++) {
+		out[i] = TargetPixel(row[i]);
+	}
+}
+
 //////////////////////////////////////////////////////////////////////
 // Adapter for access to a subgrid
 //////////////////////////////////////////////////////////////////////
@@ -310,8 +327,31 @@ public:
 	ConstSubgridAdapter(const ConstImageAdapter<Pixel>& image,
 		const Subgrid& subgrid);
 	virtual Pixel	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const;
 };
 
+/**
+ * \brief Retrieve every step-th pixel of a row segment of an adapter
+ */
+template<typename Pixel>
+void	fillSubgridRow(const ConstImageAdapter<Pixel>& image,
+		const Subgrid& subgrid, int y, int x0, int n, Pixel *out) {
+	if (n <= 0) {
+		return;
+	}
+	int	step = subgrid.stepsize.width();
+	if (step == 1) {
+		image.fillRow(subgrid.y(y), subgrid.x(x0), n, out);
+		return;
+	}
+	int	span = (n - 1) * step + 1;
+	std::vector<Pixel>	row(span);
+	image.fillRow(subgrid.y(y), subgrid.x(x0), span, row.data());
+	for (int i = 0; i < n; i++) {
+		out[i] = row[i * step];
+	}
+}
+
 template<typename Pixel>
 ConstSubgridAdapter<Pixel>::ConstSubgridAdapter(
 	const ConstImageAdapter<Pixel>& _image, const Subgrid& _subgrid)
@@ -328,6 +368,12 @@ Pixel	ConstSubgridAdapter<Pixel>::pixel(int x, int y) const {
 	return image.pixel(subgrid.x(x), subgrid.y(y));
 }
 
+template<typename Pixel>
+void	ConstSubgridAdapter<Pixel>::fillRow(int y, int x0, int n,
+		Pixel *out) const {
+	fillSubgridRow(image, subgrid, y, x0, n, out);
+}
+
 /**
  * \brief Mutable adapter to a subgrid
  */
@@ -339,6 +385,7 @@ public:
 	SubgridAdapter(ImageAdapter<Pixel>& image,
 		const Subgrid& subgrid);
 	virtual Pixel	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const;
 	virtual Pixel&	writablepixel(int x, int y);
 };
 
@@ -358,6 +405,12 @@ Pixel	SubgridAdapter<Pixel>::pixel(int x, int y) const {
 	return image.pixel(subgrid.x(x), subgrid.y(y));
 }
 
+template<typename Pixel>
+void	SubgridAdapter<Pixel>::fillRow(int y, int x0, int n,
+		Pixel *out) const {
+	fillSubgridRow<Pixel>(image, subgrid, y, x0, n, out);
+}
+
 template<typename Pixel>
 Pixel&	SubgridAdapter<Pixel>::writablepixel(int x, int y) {
 	return image.writablepixel(subgrid.x(x), subgrid.y(y));
@@ -408,6 +461,7 @@ public:
 	AddAdapter(const ConstImageAdapter<Pixel>& summand1,
 		const ConstImageAdapter<Pixel>& summand2);
 	virtual double	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, double *out) const;
 };
 
 /**
@@ -430,12 +484,27 @@ double	AddAdapter<Pixel>::pixel(int x, int y) const {
 	return result;
 }
 
+template<typename Pixel>
+void	AddAdapter<Pixel>::fillRow(int y, int x0, int n, double *out) const {
+	std::vector<Pixel>	row1(n);
+	std::vector<Pixel>	row2(n);
+	ArithmeticAdapter<Pixel>::operand1.fillRow(y, x0, n, row1.data());
+	ArithmeticAdapter<Pixel>::operand2.fillRow(y, x0, n, row2.data());
+	for (int i = 0; i < n; i++) {
+		double	result = 0;
+		result += row1[i];
+		result += row2[i];
+		out[i] = result;
+	}
+}
+
 template<typename Pixel>
 class MultiplyAdapter : public ArithmeticAdapter<Pixel> {
 public:
 	MultiplyAdapter(const ConstImageAdapter<Pixel>& operand1,
 		const ConstImageAdapter<Pixel>& operand2);
 	virtual double	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, double *out) const;
 };
 
 template<typename Pixel>
@@ -453,6 +522,21 @@ double	MultiplyAdapter<Pixel>::pixel(int x, int y) const {
 	return result;
 }
 
+template<typename Pixel>
+void	MultiplyAdapter<Pixel>::fillRow(int y, int x0, int n,
+		double *out) const {
+	std::vector<Pixel>	row1(n);
+	std::vector<Pixel>	row2(n);
+	ArithmeticAdapter<Pixel>::operand1.fillRow(y, x0, n, row1.data());
+	ArithmeticAdapter<Pixel>::operand2.fillRow(y, x0, n, row2.data());
+	for (int i = 0; i < n; i++) {
+		double	result = 1;
+		result *= row1[i];
+		result *= row2[i];
+		out[i] = result;
+	}
+}
+
 /**
  * \brief Adapter to add a constant
  */
@@ -470,6 +554,12 @@ public:
 		Pixel	result = _image.pixel(x, y) + _offset;
 		return result;
 	}
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const {
+		_image.fillRow(y, x0, n, out);
+		for (int i = 0; i < n; i++) {
+			out[i] = out[i] + _offset;
+		}
+	}
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -740,6 +830,7 @@ class LuminanceAdapter : public ConstImageAdapter<T> {
 public:
 	LuminanceAdapter(const ConstImageAdapter<Pixel>& image);
 	T	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, T *out) const;
 };
 
 template<typename Pixel, typename T>
@@ -754,6 +845,16 @@ T	LuminanceAdapter<Pixel, T>::pixel(int x, int y) const {
 	return v;
 }
 
+template<typename Pixel, typename T>
+void	LuminanceAdapter<Pixel, T>::fillRow(int y, int x0, int n,
+		T *out) const {
+	std::vector<Pixel>	row(n);
+	image.fillRow(y, x0, n, row.data());
+	for (int i = 0; i < n; i++) {
+		out[i] = luminance(row[i]);
+	}
+}
+
 template<typename Pixel, typename T>
 Image<T>	*luminance(const ConstImageAdapter<Pixel>& image) {
 	adapter::LuminanceAdapter<Pixel, T>	luminance(image);
@@ -876,6 +977,7 @@ public:
 	RescalingAdapter(const ConstImageAdapter<Pixel>& image,
 		double _minpixel, double scale);
 	virtual Pixel	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const;
 };
 
 template<typename Pixel>
@@ -890,6 +992,15 @@ Pixel	RescalingAdapter<Pixel>::pixel(int x, int y) const {
 	return (image.pixel(x, y) - zero) * scale;
 }
 
+template<typename Pixel>
+void	RescalingAdapter<Pixel>::fillRow(int y, int x0, int n,
+		Pixel *out) const {
+	image.fillRow(y, x0, n, out);
+	for (int i = 0; i < n; i++) {
+		out[i] = (out[i] - zero) * scale;
+	}
+}
+
 //////////////////////////////////////////////////////////////////////
 // PixelValue adapter, works for any image and returns float or double
 // result types
@@ -2133,38 +2244,243 @@ public:
 //////////////////////////////////////////////////////////////////////
 // Convolution without Fourier transform
 //////////////////////////////////////////////////////////////////////
+/**
+ * \brief Type used to accumulate weighted sums of pixels
+ *
+ * Integer pixels would lose precision in every step of a sum, so
+ * monochrome and RGB pixels are accumulated in double precision.
+ */
+template<typename Pixel>
+struct convolution_accumulator {
+	typedef Pixel	type;
+};
+
+#define	convolution_accumulator_double(Pixel)				\
+template<>								\
+struct convolution_accumulator<Pixel> {				\
+	typedef double	type;						\
+};
+
+convolution_accumulator_double(unsigned char)
+convolution_accumulator_double(unsigned short)
+convolution_accumulator_double(unsigned int)
+convolution_accumulator_double(unsigned long)
+convolution_accumulator_double(float)
+convolution_accumulator_double(double)
+
+template<typename P>
+struct convolution_accumulator<RGB<P> > {
+	typedef RGB<double>	type;
+};
+
+/**
+ * \brief Precomputed weights of a convolution kernel
+ *
+ * The kernel is evaluated once, and checked for separability. A
+ * separable kernel (e.g. a gaussian or a box) is the product of a
+ * horizontal and a vertical one dimensional kernel, and convolution
+ * with it can be done in two one dimensional passes. Convolution here
+ * means the same as in the ConvolutionAdapter: the kernel pixel (i,j)
+ * is multiplied with the image pixel (x + i - center.x, y + j - center.y).
+ */
+class ConvolutionKernel {
+	ImageSize	_size;
+	ImagePoint	_center;
+	std::vector<double>	_weights;
+	bool	_separable;
+	std::vector<double>	_horizontal;
+	std::vector<double>	_vertical;
+	void	analyze();
+public:
+	ConvolutionKernel(const ConstImageAdapter<double>& psf);
+	ConvolutionKernel(const std::vector<double>& horizontal,
+		const std::vector<double>& vertical);
+	static ConvolutionKernel	gauss(double sigma, double cutoff = 3);
+	static ConvolutionKernel	box(int width, int height);
+
+	const ImageSize&	size() const { return _size; }
+	const ImagePoint&	center() const { return _center; }
+	bool	separable() const { return _separable; }
+	double	weight(int x, int y) const {
+		return _weights[x + _size.width() * y];
+	}
+	const std::vector<double>&	horizontal() const { return _horizontal; }
+	const std::vector<double>&	vertical() const { return _vertical; }
+private:
+	template<typename Pixel>
+	static void	borderRow(const ConstImageAdapter<Pixel>& image,
+				bool periodic, int y, int x0, int n,
+				Pixel *out);
+public:
+	template<typename Pixel>
+	Pixel	pixel(const ConstImageAdapter<Pixel>& image, bool periodic,
+			int x, int y) const;
+	template<typename Pixel>
+	void	fillRow(const ConstImageAdapter<Pixel>& image, bool periodic,
+			int y, int x0, int n, Pixel *out) const;
+};
+
+/**
+ * \brief Retrieve a row segment, extending the image beyond its border
+ *
+ * Outside the image, pixels are either 0 or the image is repeated
+ * periodically.
+ */
+template<typename Pixel>
+void	ConvolutionKernel::borderRow(const ConstImageAdapter<Pixel>& image,
+		bool periodic, int y, int x0, int n, Pixel *out) {
+	int	w = image.getSize().width();
+	int	h = image.getSize().height();
+	Pixel	zero = 0;
+	if (periodic) {
+		y = ((y % h) + h) % h;
+		int	i = 0;
+		while (i < n) {
+			int	x = (((x0 + i) % w) + w) % w;
+			int	l = std::min(n - i, w - x);
+			image.fillRow(y, x, l, out + i);
+			i += l;
+		}
+		return;
+	}
+	if ((y < 0) || (y >= h)) {
+		std::fill(out, out + n, zero);
+		return;
+	}
+	int	left = std::min(n, std::max(0, -x0));
+	int	right = std::max(left, std::min(n, w - x0));
+	std::fill(out, out + left, zero);
+	if (right > left) {
+		image.fillRow(y, x0 + left, right - left, out + left);
+	}
+	std::fill(out + right, out + n, zero);
+}
+
+/**
+ * \brief Compute a single pixel of the convolution
+ */
+template<typename Pixel>
+Pixel	ConvolutionKernel::pixel(const ConstImageAdapter<Pixel>& image,
+		bool periodic, int x, int y) const {
+	typedef typename convolution_accumulator<Pixel>::type	Acc;
+	int	kw = _size.width();
+	std::vector<Pixel>	row(kw);
+	Acc	result = 0;
+	for (int j = 0; j < _size.height(); j++) {
+		borderRow(image, periodic, y + j - _center.y(),
+			x - _center.x(), kw, row.data());
+		const double	*w = &_weights[j * kw];
+		for (int i = 0; i < kw; i++) {
+			result = result + Acc(row[i]) * w[i];
+		}
+	}
+	return Pixel(result);
+}
+
+/**
+ * \brief Compute a row segment of the convolution
+ *
+ * The source rows covered by the kernel are retrieved with fillRow.
+ * For a separable kernel they are first combined with the vertical
+ * weights, and the horizontal kernel is applied to the result, so
+ * the cost per pixel is proportional to width + height of the kernel
+ * instead of its area.
+ */
+template<typename Pixel>
+void	ConvolutionKernel::fillRow(const ConstImageAdapter<Pixel>& image,
+		bool periodic, int y, int x0, int n, Pixel *out) const {
+	typedef typename convolution_accumulator<Pixel>::type	Acc;
+	int	kw = _size.width();
+	int	span = n + kw - 1;
+	std::vector<Pixel>	row(span);
+	Acc	zero = 0;
+	if (_separable) {
+		std::vector<Acc>	column(span, zero);
+		for (int j = 0; j < _size.height(); j++) {
+			double	v = _vertical[j];
+			if (v == 0) {
+				continue;
+			}
+			borderRow(image, periodic, y + j - _center.y(),
+				x0 - _center.x(), span, row.data());
+			for (int k = 0; k < span; k++) {
+				column[k] = column[k] + Acc(row[k]) * v;
+			}
+		}
+		for (int i = 0; i < n; i++) {
+			Acc	result = zero;
+			for (int k = 0; k < kw; k++) {
+				result = result + column[i + k] * _horizontal[k];
+			}
+			out[i] = Pixel(result);
+		}
+		return;
+	}
+	std::vector<Acc>	result(n, zero);
+	for (int j = 0; j < _size.height(); j++) {
+		borderRow(image, periodic, y + j - _center.y(),
+			x0 - _center.x(), span, row.data());
+		const double	*w = &_weights[j * kw];
+		for (int k = 0; k < kw; k++) {
+			if (w[k] == 0) {
+				continue;
+			}
+			for (int i = 0; i < n; i++) {
+				result[i] = result[i] + Acc(row[i + k]) * w[k];
+			}
+		}
+	}
+	for (int i = 0; i < n; i++) {
+		out[i] = Pixel(result[i]);
+	}
+}
+
+/**
+ * \brief Convolution of an image with a small kernel
+ *
+ * Outside the image, pixels are taken to be zero. The kernel weights are
+ * precomputed, and rows are computed with the separable or the direct
+ * method of the ConvolutionKernel.
+ */
 template<typename Pixel>
 class ConvolutionAdapter : public ConstImageAdapter<Pixel> {
-	const ConstImageAdapter<double>&	_psf;
-	FundamentalAdapter<Pixel>	_embedded;
-	ImagePoint	_offset;
+	const ConstImageAdapter<Pixel>&	_image;
+	ConvolutionKernel	_kernel;
 public:
 	ConvolutionAdapter(const ConstImageAdapter<Pixel>& image,
 		const ConstImageAdapter<double>& psf);
+	ConvolutionAdapter(const ConstImageAdapter<Pixel>& image,
+		const ConvolutionKernel& kernel);
+	const ConvolutionKernel&	kernel() const { return _kernel; }
 	virtual Pixel	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const;
 };
 
 template<typename Pixel>
 ConvolutionAdapter<Pixel>::ConvolutionAdapter(
 	const ConstImageAdapter<Pixel>& image,
 	const ConstImageAdapter<double>& psf)
-	: ConstImageAdapter<Pixel>(image.getSize()), _psf(psf),
-	  _embedded(image),
-	  _offset(psf.getSize().width() / 2, psf.getSize().height() / 2) {
+	: ConstImageAdapter<Pixel>(image.getSize()), _image(image),
+	  _kernel(psf) {
+}
+
+template<typename Pixel>
+ConvolutionAdapter<Pixel>::ConvolutionAdapter(
+	const ConstImageAdapter<Pixel>& image,
+	const ConvolutionKernel& kernel)
+	: ConstImageAdapter<Pixel>(image.getSize()), _image(image),
+	  _kernel(kernel) {
 }
 
 template<typename Pixel>
 Pixel	ConvolutionAdapter<Pixel>::pixel(int x, int y) const {
-	Pixel	result = 0;
-	for (int xx = 0; xx < _psf.getSize().width(); xx++) {
-		for (int yy = 0; yy < _psf.getSize().height(); yy++) {
-			int	xi = x + xx - _offset.x();
-			int	yi = y + yy - _offset.y();
-			result = result
-				+ _embedded.pixel(xi, yi) * _psf.pixel(xx, yy);
-		}
-	}
-	return result;
+	return _kernel.pixel(_image, false, x, y);
+}
+
+template<typename Pixel>
+void	ConvolutionAdapter<Pixel>::fillRow(int y, int x0, int n,
+		Pixel *out) const {
+	_kernel.fillRow(_image, false, y, x0, n, out);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -2370,6 +2686,7 @@ class	UnsharpMaskBase {
 protected:
 	double	_weight;
 	int	_top;
+	std::vector<double>	_weights;
 public:
 	double	radius() const { return _radius; }
 	void	radius(double r);
@@ -2378,6 +2695,7 @@ protected:
 	double	weight() const { return _weight; }
 public:
 	UnsharpMaskBase();
+	ConvolutionKernel	kernel() const;
 };
 
 template<typename T>
@@ -2389,15 +2707,16 @@ public:
 	}
 	virtual T	pixel(int x, int y) const {
 		T	s = 0;
+		int	n = 2 * _top + 1;
 		for (int xi = -_top; xi <= _top; xi++) {
 			for (int yi = -_top; yi <= _top; yi++) {
-				double	t = w(xi, yi);
+				double	t = _weights[(xi + _top) + n * (yi + _top)];
 				if (t > 0) {
 					s += _image.pixel(x + xi, y + yi) * t;
 				}
 			}
 		}
-		return _weight * s;
+		return s;
 	}
 };
 
@@ -2479,12 +2798,21 @@ ImagePtr	logimage(ImagePtr image);
 //////////////////////////////////////////////////////////////////////
 // spatial median filter
 //////////////////////////////////////////////////////////////////////
+/**
+ * \brief Half widths of the rows of a disk of radius r
+ *
+ * Entry j is the largest x with x^2 + (j - r)^2 <= r^2, so the disk
+ * contains the pixels with |x| <= halfwidth[j] in row j - r.
+ */
+std::vector<int>	diskHalfwidths(int r);
+
 template<typename T>
 class MedianRadiusAdapter : public ConstImageAdapter<T> {
 	const ConstImageAdapter<T>&	_image;
 	int	_r;
 	int	_w;
 	int	_h;
+	std::vector<int>	_halfwidth;
 	T	rawpixel(int x, int y) const {
 		if (x < 0) { return 0; }
 		if (y < 0) { return 0; }
@@ -2494,31 +2822,80 @@ class MedianRadiusAdapter : public ConstImageAdapter<T> {
 	}
 public:
 	MedianRadiusAdapter(const ConstImageAdapter<T>& image, int r)
-		: ConstImageAdapter<T>(image.getSize()), _image(image), _r(r) {
+		: ConstImageAdapter<T>(image.getSize()), _image(image), _r(r),
+		  _halfwidth(diskHalfwidths(r)) {
 		_w = ConstImageAdapter<T>::getSize().width();
 		_h = ConstImageAdapter<T>::getSize().height();
 	}
 	virtual T	pixel(int x, int y) const {
-		astro::Median<T>	m;
-		for (int X = -_r; X <= _r; X++) {
-			for (int Y = -_r; Y <= _r; Y++) {
-				if (hypot(X, Y) <= _r) {
-					m.add(rawpixel(x + X, y + Y));
-				}
+		std::vector<T>	values;
+		for (int Y = -_r; Y <= _r; Y++) {
+			int	hw = _halfwidth[Y + _r];
+			for (int X = -hw; X <= hw; X++) {
+				values.push_back(rawpixel(x + X, y + Y));
 			}
 		}
-		return m.median();
+		// the disk always contains an odd number of pixels
+		size_t	k = (values.size() - 1) / 2;
+		std::nth_element(values.begin(), values.begin() + k,
+			values.end());
+		return values[k];
 	}
 };
 
+/**
+ * \brief Median filter with a sliding window histogram
+ *
+ * This computes the same values as the MedianRadiusAdapter, but instead
+ * of collecting and partially sorting all pixels in the disk for every
+ * pixel, it keeps a histogram of the disk (Huang's algorithm). Moving
+ * the disk one pixel to the right only changes one pixel at each end of
+ * each of its rows, and the median moves only a little, so the cost per
+ * pixel is proportional to the radius instead of its square.
+ *
+ * The histogram bins are the distinct pixel values of the image, so
+ * this works for floating point images as well. A coarse histogram with
+ * one bin per 64 values lets the median skip over empty ranges. Images
+ * with more than 65536 distinct values, typically floating point images,
+ * are processed in bands of rows, each with a histogram over the values
+ * of that band only. Rows or bands are computed in parallel.
+ */
+template<typename T>
+class SlidingMedian {
+	int	_r;
+	bool	_clamp;
+	std::vector<int>	_halfwidth;
+public:
+	SlidingMedian(int r, bool clamp = false);
+	int	radius() const { return _r; }
+	bool	clamp() const { return _clamp; }
+	Image<T>	*operator()(const ConstImageAdapter<T>& image) const;
+	Image<T>	*select(const ConstImageAdapter<T>& image) const;
+};
+
 template<typename T>
 Image<T>	*destar(const ConstImageAdapter<T>& image, int radius) {
-	adapter::MedianRadiusAdapter<T>	mra(image, radius);
-	return new Image<T>(mra);
+	SlidingMedian<T>	median(radius);
+	return median(image);
 }
 
 ImagePtr	destarptr(ImagePtr image, int radius);
 
+/**
+ * \brief Replace hot and cold pixels by the median of their neighbourhood
+ *
+ * A pixel is considered defective if it deviates from the median of the
+ * disk of the given radius around it by more than threshold times the
+ * noise, which is estimated from the median absolute deviation of all
+ * pixels. Bayer mosaic images are corrected separately on each of
+ * the four color subgrids.
+ */
+template<typename T>
+Image<T>	*hotpixels(const Image<T>& image, int radius, double threshold,
+			size_t *corrected = NULL);
+
+ImagePtr	hotpixelsptr(ImagePtr image, int radius, double threshold);
+
 //////////////////////////////////////////////////////////////////////
 // Color correction adapter
 //////////////////////////////////////////////////////////////////////
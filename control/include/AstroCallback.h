@@ -9,6 +9,10 @@
 #include <AstroImage.h>
 #include <AstroUtils.h>
 #include <set>
+#include <vector>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
 
 namespace astro {
 namespace callback {
@@ -52,12 +56,120 @@ public:
 
 typedef	std::shared_ptr<Callback>	CallbackPtr;
 
+/**
+ * \brief Delivery statistics of an asynchronous subscriber
+ *
+ * The lag is the time in seconds between the moment a callback data
+ * object was handed to the dispatcher and the moment the subscriber
+ * started processing it. A subscriber with a growing lag or with many
+ * drops is not able to keep up with the data rate.
+ */
+class CallbackStatistics {
+public:
+	std::string	subscriber;
+	unsigned long	delivered;
+	unsigned long	dropped;
+	unsigned long	coalesced;
+	unsigned long	failed;
+	size_t	queued;
+	size_t	maxqueued;
+	double	lag;
+	double	maxlag;
+	CallbackStatistics();
+	std::string	toString() const;
+};
+
+/**
+ * \brief Asynchronous callback dispatcher
+ *
+ * This callback hands the data to a worker thread that calls the wrapped
+ * callback, so the thread producing the data (e.g. the guiding loop)
+ * never waits for a slow subscriber. The queue has a fixed capacity
+ * and does not allocate after construction. If coalescing is enabled,
+ * a new data object replaces a queued object of the same type, so that
+ * e.g. only the latest image waits for delivery. If the queue is full,
+ * the oldest entry is dropped.
+ */
+class AsynchronousCallback : public Callback {
+	CallbackPtr	_callback;
+	bool	_coalesce;
+	struct entry {
+		CallbackDataPtr	data;
+		double	when;
+	};
+	std::vector<entry>	_queue;
+	size_t	_head;
+	size_t	_count;
+	CallbackStatistics	_statistics;
+	bool	_terminate;
+	bool	_busy;
+	mutable std::mutex	_mutex;
+	std::condition_variable	_condition;
+	std::thread	_thread;
+	void	run();
+	static void	main(AsynchronousCallback *callback);
+	// prevent copying
+	AsynchronousCallback(const AsynchronousCallback& other);
+	AsynchronousCallback&	operator=(const AsynchronousCallback& other);
+public:
+	AsynchronousCallback(CallbackPtr callback, size_t capacity = 4,
+		bool coalesce = false);
+	virtual ~AsynchronousCallback();
+	CallbackPtr	callback() const { return _callback; }
+	bool	coalesce() const { return _coalesce; }
+	size_t	capacity() const { return _queue.size(); }
+	virtual CallbackDataPtr	operator()(CallbackDataPtr data);
+	CallbackStatistics	statistics() const;
+	bool	wait(double timeout);
+	void	stop();
+};
+typedef std::shared_ptr<AsynchronousCallback>	AsynchronousCallbackPtr;
+
+/**
+ * \brief Pool of reusable callback data objects
+ *
+ * Producers of high rate callback data can take the data objects from a
+ * pool instead of allocating a new one for every event. An object is
+ * reused as soon as no queue and no subscriber holds a reference to it
+ * any longer. The data class must be copy assignable.
+ */
+template<typename T>
+class CallbackDataPool {
+	std::vector<std::shared_ptr<T> >	_pool;
+	size_t	_next;
+	unsigned long	_misses;
+	std::mutex	_mutex;
+public:
+	CallbackDataPool(size_t size, const T& prototype) : _next(0),
+		_misses(0) {
+		for (size_t i = 0; i < size; i++) {
+			_pool.push_back(std::make_shared<T>(prototype));
+		}
+	}
+	unsigned long	misses() const { return _misses; }
+	std::shared_ptr<T>	get(const T& value) {
+		std::unique_lock<std::mutex>	lock(_mutex);
+		for (size_t i = 0; i < _pool.size(); i++) {
+			std::shared_ptr<T>&	candidate = _pool[_next];
+			_next = (_next + 1) % _pool.size();
+			if (candidate.use_count() == 1) {
+				std::atomic_thread_fence(std::memory_order_acquire);
+				*candidate = value;
+				return candidate;
+			}
+		}
+		_misses++;
+		return std::make_shared<T>(value);
+	}
+};
+
 /**
  * \brief a class to fan out callbacks to many receivers
  */
 class CallbackSet : public std::set<CallbackPtr> {
 public:
 	CallbackDataPtr	operator()(CallbackDataPtr data);
+	std::vector<CallbackStatistics>	statistics() const;
 };
 
 /**
@@ -8,6 +8,7 @@
 #define _AstroCamera_h
 
 #include <AstroImage.h>
+#include <AstroConversion.h>
 #include <AstroDevice.h>
 #include <AstroTypes.h>
 #include <vector>
@@ -311,6 +312,7 @@ private:
 	ImageQueue&	operator=(const ImageQueue& other);
 public:
 	ImageQueue(unsigned long maxqueuelength = 10);
+	~ImageQueue();
 	bool	hasEntry();
 	ImageQueueEntry	getEntry(bool block);
 	void	add(const Exposure& exposure, ImagePtr image);
@@ -336,12 +338,18 @@ public:
 
 /**
  * \brief Interface for Image Streams
+ *
+ * Images are converted to the stream format before they are handed to
+ * the sink or the queue, so that clients displaying a live view do not
+ * have to do the conversion themselves on every frame.
  */
 class ImageStream : public ImageQueue, public ImageSink {
 protected:
 	ImageSink	*_imagesink;
 	Exposure	_streamexposure;
 private:
+	astro::image::StreamFormat	_streamformat;
+	std::mutex	_streamformatmutex;
 	void	*private_data;
 	void	cleanup();
 	ImageStream(const ImageStream& other);
@@ -357,6 +365,9 @@ public:
 	virtual bool	streaming();
 	virtual void	streamExposure(const Exposure& exposure);
 	virtual const Exposure&	streamExposure();
+	// the stream thread reads the format for every image
+	astro::image::StreamFormat	streamFormat();
+	void	streamFormat(const astro::image::StreamFormat& f);
 	virtual void	operator()(const ImageQueueEntry& entry);
 };
 
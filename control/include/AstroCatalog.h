@@ -8,6 +8,9 @@
 
 #include <AstroCoordinates.h>
 #include <set>
+#include <map>
+#include <vector>
+#include <memory>
 #include <limits.h>
 #include <string>
 #include <AstroImage.h>
@@ -105,6 +108,46 @@ public:
 	virtual std::string	toString() const;
 };
 
+/**
+ * \brief Columnar result of a star query
+ *
+ * Each attribute of the stars is kept in a separate array, so that a
+ * query result with many stars needs a few large allocations instead of
+ * a tree node and a couple of strings per star, and that consumers like
+ * chart drawing can traverse positions and magnitudes sequentially.
+ * Star names are computed from the catalog and the catalog number only
+ * when they are asked for. Only stars from catalogs whose names cannot
+ * be derived from the catalog number have their name stored.
+ */
+class StarTable {
+public:
+	std::vector<double>	ra;		// radians
+	std::vector<double>	dec;		// radians
+	std::vector<float>	pmra;		// radians per year
+	std::vector<float>	pmdec;		// radians per year
+	std::vector<float>	mag;
+	std::vector<char>	catalog;
+	std::vector<uint64_t>	catalognumber;
+private:
+	std::map<size_t, std::string>	_names;
+public:
+	StarTable() { }
+	size_t	size() const { return ra.size(); }
+	bool	empty() const { return ra.empty(); }
+	void	reserve(size_t n);
+	void	clear();
+	void	add(double ra, double dec, float pmra, float pmdec, float mag,
+			char catalog, uint64_t catalognumber);
+	void	add(const Star& star);
+	void	append(const StarTable& other);
+	RaDec	position(size_t i) const;
+	std::string	name(size_t i) const;
+	Star	star(size_t i) const;
+	static bool	hasname(char catalog);
+	static std::string	name(char catalog, uint64_t catalognumber);
+};
+typedef std::shared_ptr<StarTable>	StarTablePtr;
+
 /**
  * \brief Deep Sky objects
  */
@@ -204,6 +247,9 @@ public:
 					const MagnitudeRange& magrange) = 0;
 	virtual CatalogIterator	findIter(const SkyWindow& window,
 					const MagnitudeRange& magrange);
+	// find the stars in a window as a columnar table
+	virtual StarTablePtr	findTable(const SkyWindow& window,
+					const MagnitudeRange& magrange);
 	// some information about the size of the catalog
 	virtual unsigned long	numberOfStars() = 0;
 
@@ -223,7 +269,8 @@ public:
 		Hipparcos = 2,
 		Ucac4 = 3,
 		Combined = 4,
-		Database = 5
+		Database = 5,
+		Index = 6
 	} BackendType;
 	static CatalogPtr	get(BackendType type,
 					const std::string& parameter);
@@ -155,6 +155,45 @@ public:
 	virtual double	pixel(int x, int y) const;
 };
 
+/**
+ * \brief Point spread function sampled at sub pixel phases
+ *
+ * The stamps cover the square where the point spread function exceeds a
+ * small fraction of its peak, at most maxradius pixels from the center.
+ * For each of phases x phases sub pixel offsets of the star a separate
+ * stamp is computed, so drawing a star only needs additions.
+ */
+class PointSpreadFunctionStamps {
+	int	_phases;
+	int	_radius;
+	std::vector<double>	_values;
+public:
+	int	phases() const { return _phases; }
+	int	radius() const { return _radius; }
+	int	width() const { return 2 * _radius + 1; }
+	PointSpreadFunctionStamps(const PointSpreadFunction& psf,
+		double angularpixelsize, int maxradius, int phases = 4);
+	const double	*stamp(int xphase, int yphase) const;
+};
+
+/**
+ * \brief Renderer accumulating star stamps into an image
+ *
+ * The image is divided into horizontal bands of tileheight rows, which
+ * are rendered in parallel. Each star is drawn into every band its stamp
+ * touches, stars whose stamps miss the image are skipped.
+ */
+class StampRenderer {
+	const PointSpreadFunctionStamps&	_stamps;
+	int	_tileheight;
+public:
+	StampRenderer(const PointSpreadFunctionStamps& stamps,
+		int tileheight = 64);
+	void	operator()(Image<double>& image, const std::vector<double>& x,
+			const std::vector<double>& y,
+			const std::vector<double>& intensity) const;
+};
+
 class ChartFactoryBase {
 // parameters valid for all images
 protected:
@@ -187,11 +226,11 @@ public:
 	}
 
 protected:
+	double	intensity(double mag) const;
+	bool	draw(Image<double>& image, const Point& p, double mag) const;
 	void	draw(Image<double>& image, const Point& p,
 			const Star& star) const;
 	void	limit(Image<double>& image, double limit) const;
-	void	spread(Image<double>& image, int morepixels,
-			const ImageGeometry& geometry) const;
 };
 
 /**
@@ -218,6 +257,9 @@ private:
 			const Catalog::starsetptr star) const;
 	void	draw(Image<double>& image, const SkyRectangle& rectangle,
 			const Star& star) const;
+	void	draw(Image<double>& image, const SkyRectangle& rectangle,
+			const StarTable& stars,
+			const PointSpreadFunctionStamps& stamps) const;
 };
 
 /**
@@ -274,6 +316,10 @@ private:
 	void	draw(Image<double>& image,
 			const astro::image::transform::StereographicProjection& projection,
 			const Catalog::starset& stars) const;
+
+	void	draw(Image<double>& image,
+			const astro::image::transform::StereographicProjection& projection,
+			const StarTable& stars) const;
 };
 
 } // namespace catalog
@@ -450,6 +450,10 @@ static ImageRepoConfigurationPtr	get(ConfigurationPtr config);
 	virtual std::list<project::ImageRepoInfo>	listrepo(bool hidden_only) = 0;
 	virtual bool	hidden(const std::string& name) = 0;
 	virtual void	setHidden(const std::string& name, bool hidden) = 0;
+	// FITS compression for images saved in a repository
+	virtual std::string	compression(const std::string& name) = 0;
+	virtual void	setCompression(const std::string& name,
+				const std::string& compression) = 0;
 };
 
 class ProjectConfiguration;
@@ -0,0 +1,83 @@
+/*
+ * AstroConversion.h -- fast conversion kernels for streaming cameras
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _AstroConversion_h
+#define _AstroConversion_h
+
+#include <AstroImage.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace astro {
+namespace image {
+
+/**
+ * \brief Whole buffer conversion kernels for 8 bit color formats
+ *
+ * The generic conversion templates in AstroPixel.h convert one pixel
+ * (or pixel pair) at a time through double precision formulae. The
+ * kernels below process whole buffers with the fixed point formulae
+ * also used by the unsigned char specializations in Pixel.cpp, written
+ * as branch free loops the compiler can vectorize.
+ *
+ * The buffer kernels work on packed data as delivered by webcam class
+ * cameras: YUYV is two bytes per pixel (Y0 U Y1 V), RGB three bytes per
+ * pixel. The number of pixels of YUYV buffers must be even.
+ */
+namespace kernels {
+
+void	yuyv2rgb(const uint8_t *yuyv, uint8_t *rgb, size_t pixels);
+void	yuyv2luminance(const uint8_t *yuyv, uint8_t *luminance,
+		size_t pixels);
+void	rgb2mono(const uint8_t *rgb, uint8_t *mono, size_t pixels);
+void	scale16to8(const uint16_t *src, uint8_t *dest, size_t pixels,
+		uint16_t black = 0, uint16_t white = 0xffff);
+
+} // namespace kernels
+
+// the same conversions for complete images
+Image<RGB<unsigned char> >	*yuyv2rgb(
+					const Image<YUYV<unsigned char> >& image);
+Image<unsigned char>	*yuyv2luminance(
+				const Image<YUYV<unsigned char> >& image);
+Image<unsigned char>	*rgb2mono(const Image<RGB<unsigned char> >& image);
+Image<unsigned char>	*scale16to8(const Image<unsigned short>& image,
+				unsigned short black = 0,
+				unsigned short white = 0xffff);
+
+/**
+ * \brief Target format for images of a stream
+ *
+ * native leaves images as the camera delivers them, rgb8 converts color
+ * images to 8 bit RGB and mono8 converts all images to 8 bit luminance.
+ * Images for which there is no fast conversion are left unchanged.
+ *
+ * 16 bit images are mapped to 8 bit by stretching [black, white] to the
+ * full range. The default is the full 16 bit range, a 12 or 14 bit
+ * sensor needs a smaller white point or its frames look almost black.
+ */
+class StreamFormat {
+public:
+	typedef enum { native, rgb8, mono8 } format;
+	static std::string	format2string(format f);
+	static format	string2format(const std::string& s);
+private:
+	format	_format;
+	unsigned short	_black;
+	unsigned short	_white;
+public:
+	StreamFormat(format f = native, unsigned short black = 0,
+		unsigned short white = 0xffff);
+	format	getFormat() const { return _format; }
+	unsigned short	black() const { return _black; }
+	unsigned short	white() const { return _white; }
+	ImagePtr	convert(ImagePtr image) const;
+	std::string	toString() const;
+};
+
+} // namespace image
+} // namespace astro
+
+#endif /* _AstroConversion_h */
@@ -8,12 +8,23 @@
 #define _AstroConvolve_h
 
 #include <AstroImage.h>
+#include <AstroAdapter.h>
 #include <AstroTypes.h>
 #include <fftw3.h>
+#include <mutex>
 
 namespace astro {
 namespace image {
 
+/**
+ * \brief Mutex serializing access to the FFTW planner
+ *
+ * Only fftw_execute is thread safe, so all code that creates or destroys
+ * plans must hold this mutex. fftw_cleanup must not be called at all,
+ * because it would invalidate plans still in use by other threads.
+ */
+extern std::mutex	fftw_planner_mutex;
+
 class FourierImage;
 typedef std::shared_ptr<FourierImage>	FourierImagePtr;
 
@@ -119,6 +130,37 @@ public:
 
 ImagePtr	smallConvolve(const ConstImageAdapter<double>& small, ImagePtr image);
 
+/**
+ * \brief Convolution of double images with a precomputed kernel
+ *
+ * Separable and small kernels are applied row by row in the spatial
+ * domain, with rows computed in parallel. For large kernels that are not
+ * separable, the image and the kernel are multiplied in the Fourier
+ * domain. Outside the image, pixels are zero or the image is repeated
+ * periodically. The result is the same as that of the ConvolutionAdapter.
+ */
+class ConvolutionEngine {
+public:
+	typedef enum { automatic, spatial, fourier } method_type;
+private:
+	adapter::ConvolutionKernel	_kernel;
+	bool	_periodic;
+	method_type	_method;
+	Image<double>	*spatialconvolve(
+				const ConstImageAdapter<double>& image) const;
+	Image<double>	*fourierconvolve(
+				const ConstImageAdapter<double>& image) const;
+public:
+	ConvolutionEngine(const adapter::ConvolutionKernel& kernel,
+		bool periodic = false);
+	const adapter::ConvolutionKernel&	kernel() const { return _kernel; }
+	bool	periodic() const { return _periodic; }
+	method_type	method() const { return _method; }
+	void	method(method_type m) { _method = m; }
+	method_type	method(const ImageSize& size) const;
+	ImagePtr	operator()(const ConstImageAdapter<double>& image) const;
+};
+
 class VanCittertOperator {
 	Image<double>	_psf;
 	int	_iterations;
@@ -8,6 +8,7 @@
 #define _AstroDisplay_h
 
 #include <AstroImage.h>
+#include <vector>
 
 namespace astro {
 namespace image {
@@ -42,6 +43,47 @@ public:
 	Image<RGB<unsigned char> >	*operator()(const ImagePtr image);
 };
 
+/**
+ * \brief Downsampled rendering of a rectangle of an image
+ *
+ * The preview averages blocks of binning x binning pixels of the source
+ * rectangle, blocks at the right and upper border may be incomplete.
+ * The values are stored row by row, one value per pixel for monochrome
+ * images and three (R, G, B) for color images. YUYV images are
+ * previewed by their luminance. Previews are much smaller than the
+ * image, so they are well suited to send to clients on slow links.
+ */
+class ImagePreview {
+	ImageRectangle	_source;
+	int	_binning;
+	ImageSize	_size;
+	int	_planes;
+	std::vector<float>	_values;
+	float	_minimum;
+	float	_maximum;
+public:
+	ImagePreview(const ImagePtr image, const ImageRectangle& source,
+		int binning);
+	ImagePreview(const ImagePtr image, int maxsize);
+	const ImageRectangle&	source() const { return _source; }
+	int	binning() const { return _binning; }
+	const ImageSize&	size() const { return _size; }
+	int	planes() const { return _planes; }
+	const std::vector<float>&	values() const { return _values; }
+	float	minimum() const { return _minimum; }
+	float	maximum() const { return _maximum; }
+
+	static int	binningFor(const ImageSize& size, int maxsize);
+	void	limits(double lowfraction, double highfraction,
+			float& low, float& high) const;
+	std::vector<unsigned char>	stretch(float low, float high,
+						float gamma = 1) const;
+	ImagePtr	image() const;
+	ImagePtr	image(float low, float high, float gamma = 1) const;
+private:
+	void	build(const ImagePtr image);
+};
+
 } // namespace image
 } // namespace astro
 
@@ -9,6 +9,9 @@
 #include <AstroPersistence.h>
 #include <AstroUtils.h>
 #include <AstroCallback.h>
+#include <deque>
+#include <map>
+#include <mutex>
 
 namespace astro {
 namespace events {
@@ -76,17 +79,116 @@ static astro::persistence::UpdateSpec
 
 typedef astro::persistence::Table<EventRecord, EventTableAdapter> EventTable;
 
+/**
+ * \brief Counters of the event journal
+ */
+class EventJournalStatistics {
+public:
+	unsigned long	written;
+	unsigned long	batches;
+	unsigned long	dropped;	// the queue was full
+	unsigned long	coalesced;	// merged with an identical event
+	unsigned long	suppressed;	// exceeded the subsystem rate limit
+	unsigned long	failed;		// could not be written
+	size_t	queued;
+	size_t	maxqueued;
+	EventJournalStatistics();
+	std::string	toString() const;
+};
+
+/**
+ * \brief Token bucket rate limit for the events of a subsystem
+ *
+ * Every event takes a token, tokens are refilled at rate per second up
+ * to burst tokens. An event that finds no token is suppressed.
+ */
+class EventRateLimit {
+	double	_rate;
+	double	_burst;
+	double	_tokens;
+	double	_last;
+public:
+	EventRateLimit(double rate = 0, double burst = 1);
+	double	rate() const { return _rate; }
+	double	burst() const { return _burst; }
+	bool	admit(double now);
+};
+
+/**
+ * \brief Asynchronous journal of events
+ *
+ * Events are kept in a bounded queue and written to the events table
+ * in batched transactions by a writer thread, so that threads raising
+ * events never wait for the database. An event identical to the last
+ * queued event of the same subsystem only increments a repeat count,
+ * and the events of a subsystem can be rate limited. Events lost to a
+ * full queue or a rate limit are reported by a summary event. The most
+ * recently written events are kept in memory and can be queried without
+ * going to the database. Callbacks are called after the events have been
+ * written, so that they see the id of the event record.
+ */
+class EventJournal {
+	persistence::Database	_database;
+	callback::CallbackPtr	_callback;
+	struct entry {
+		EventRecord	record;
+		int	repeats;
+		entry(const EventRecord& r) : record(r), repeats(0) { }
+	};
+	std::deque<entry>	_queue;
+	size_t	_capacity;
+	size_t	_batchsize;
+	size_t	_writing;
+	std::map<std::string, EventRateLimit>	_limits;
+	std::map<std::string, unsigned long>	_suppressed;
+	unsigned long	_dropped;
+	std::deque<EventRecord>	_history;
+	size_t	_historysize;
+	double	_historystart;
+	long	_historybase;
+	EventJournalStatistics	_statistics;
+	bool	_terminate;
+	mutable std::mutex	_mutex;
+	std::condition_variable	_condition;
+	std::thread	_thread;
+	void	run();
+	static void	main(EventJournal *journal);
+	void	enqueue(const EventRecord& record);
+	// prevent copying
+	EventJournal(const EventJournal& other);
+	EventJournal&	operator=(const EventJournal& other);
+public:
+	EventJournal(size_t capacity = 1024, size_t batchsize = 256,
+		size_t historysize = 1024);
+	~EventJournal();
+	void	database(persistence::Database database);
+	void	callback(callback::CallbackPtr callback);
+	void	ratelimit(const std::string& subsystem, double rate,
+			double burst = 1);
+	bool	add(const EventRecord& record);
+	bool	wait(double timeout);
+	void	stop();
+	bool	recent(double from, double to,
+			std::list<EventRecord>& events) const;
+	bool	find(int id, EventRecord& record) const;
+	EventJournalStatistics	statistics() const;
+};
+
 /**
  * \brief Handler for callbacks
  */
 class EventHandler {
 	bool	_active;
 	persistence::Database	database;
-	callback::CallbackPtr	_callback;
+	EventJournal	_journal;
 public:
 static bool	active();
 static void	active(bool a);
 static void	callback(callback::CallbackPtr);
+static EventJournal&	journal();
+static void	ratelimit(Event::Subsystem subsystem, double rate,
+			double burst = 1);
+static bool	flush(double timeout = 10);
 private:
 	EventHandler(const EventHandler& other);
 	EventHandler&	operator=(const EventHandler& other);
@@ -796,6 +796,10 @@ private:
 	callback::CallbackSet	_trackingcallback;
 	callback::CallbackSet	_calibrationimagecallback;
 	callback::CallbackSet	_backlashcallback;
+	// images and tracking points are sent for every guide cycle, so
+	// the callback data objects are reused
+	callback::CallbackDataPool<callback::ImageCallbackData>	_imagepool;
+	callback::CallbackDataPool<TrackingPoint>	_trackingpool;
 public:
 	void	addImageCallback(callback::CallbackPtr i);
 	void	addCalibrationCallback(callback::CallbackPtr c);
@@ -811,6 +815,7 @@ public:
 	void	removeTrackingCallback(callback::CallbackPtr t);
 	void	removeCalibrationImageCallback(callback::CallbackPtr t);
 	void	removeBacklashCallback(callback::CallbackPtr t);
+	std::vector<callback::CallbackStatistics>	callbackStatistics() const;
 	
 	void	callback(image::ImagePtr image);
 	void	callback(const CalibrationPoint& point);
@@ -1236,6 +1241,32 @@ public:
 	}
 };
 
+/**
+ * \brief Column oriented tracking data of one control device
+ *
+ * Long guide runs contain many thousand tracking points. For plotting
+ * and transfer, one vector per attribute is much more compact than a
+ * list of TrackingPoint objects. Times are in seconds since the start
+ * of the track. If the series is binned, each entry is the average of
+ * all points in a bin of width binwidth.
+ */
+class TrackingSeries {
+public:
+	long	trackid;
+	time_t	whenstarted;
+	ControlDeviceType	type;
+	double	binwidth;
+	long	count;	// number of tracking points used
+	std::vector<double>	time;
+	std::vector<double>	xoffset;
+	std::vector<double>	yoffset;
+	std::vector<double>	racorrection;
+	std::vector<double>	deccorrection;
+	TrackingSeries() : trackid(-1), whenstarted(0), type(GP),
+		binwidth(0), count(0) { }
+	size_t	size() const { return time.size(); }
+};
+
 /**
  * \brief Calibration class 
  */
@@ -1321,6 +1352,8 @@ public:
 	TrackingHistory	get(long id);
 	TrackingHistory	get(long id,
 		ControlDeviceType type);
+	TrackingSeries	getSeries(long id, ControlDeviceType type,
+		double fromtime = 0, double totime = 0, double binwidth = 0);
 	void	deleteTrackingHistory(long id);
 	bool	contains(long id);
 	TrackingSummary	getSummary(long id);
@@ -95,6 +95,46 @@ void	copy_metadata(const srctype& src, desttype& dest) {
 	copy_metadata<srctype, desttype>(src, dest, FITSKeywords::names());
 }
 
+/**
+ * \brief Tile compression settings for FITS output files
+ *
+ * The CFITSIO library can store images as tile compressed binary tables.
+ * RICE, GZIP, HCOMPRESS and PLIO are lossless for integer pixel types.
+ * Floating point pixels are only compressed losslessly if the quantization
+ * level is 0, a positive level quantizes the values to a fraction of the
+ * noise in each tile before compression, which gives much better
+ * compression ratios. CFITSIO can compress unquantized floating point
+ * pixels only with GZIP, so GZIP is used for them whatever the method. Reading compressed files is transparent, the
+ * FITSinfileBase class always moves to the first image HDU.
+ *
+ * A compression can also be specified as a string of the form
+ * method[:quantize], e.g. "rice" or "rice:16".
+ */
+class FITScompression {
+public:
+	typedef enum { NONE, RICE, GZIP, HCOMPRESS, PLIO } method_t;
+static std::string	method2string(method_t method);
+static method_t	string2method(const std::string& method);
+private:
+	method_t	_method;
+	float	_quantize;
+public:
+	FITScompression(method_t method = NONE, float quantize = 0);
+	explicit FITScompression(const std::string& spec);
+	method_t	method() const { return _method; }
+	void	method(method_t m) { _method = m; }
+	float	quantize() const { return _quantize; }
+	void	quantize(float q);
+	bool	enabled() const { return _method != NONE; }
+	int	fitstype() const;
+	std::string	toString() const;
+	operator std::string() const { return toString(); }
+	bool	operator==(const FITScompression& other) const;
+	bool	operator!=(const FITScompression& other) const {
+		return !(*this == other);
+	}
+};
+
 /**
  * \brief FITS file base class
  *
@@ -321,6 +361,8 @@ Image<Pixel>	*FITSinfile<Pixel>::read() {
  */
 class FITSoutfileBase : public FITSfile {
 	bool	_precious;
+	FITScompression	_compression;
+	void	setupCompression();
 public:
 	FITSoutfileBase(const std::string & filename,
 		int _pixeltype, int _planes, int _imgtype);
@@ -328,6 +370,10 @@ public:
 	void	postwrite();
 	bool	precious() const { return _precious; }
 	void	setPrecious(bool precious) { _precious = precious; }	
+	const FITScompression&	compression() const { return _compression; }
+	void	setCompression(const FITScompression& compression) {
+		_compression = compression;
+	}
 };
 
 /**
@@ -638,12 +684,17 @@ void	FITSoutfile<Pixel>::write(const Image<Pixel>& image) {
 class FITSout {
 	std::string	filename;
 	bool	_precious;
+	FITScompression	_compression;
 public:
 	FITSout(const std::string& filename);
 	bool	exists() const;
 	void	unlink();
 	bool	precious() const { return _precious; }
 	void	setPrecious(bool precious) { _precious = precious; }
+	const FITScompression&	compression() const { return _compression; }
+	void	setCompression(const FITScompression& compression) {
+		_compression = compression;
+	}
 	void	write(const ImagePtr image);
 };
 
@@ -569,6 +569,22 @@ public:
 		return pixel(p.x(), p.y());
 	}
 
+	/**
+	 * \brief Compute n consecutive pixels of row y, starting at x0
+	 *
+	 * Evaluating a chain of adapters pixel by pixel costs a virtual
+	 * call per adapter and pixel. Adapters that can compute a row
+	 * segment more efficiently, e.g. by retrieving the row from the
+	 * adapter they are based on and processing it in a tight loop,
+	 * should override this method. The default implementation falls
+	 * back to the pixel method.
+	 */
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const {
+		for (int i = 0; i < n; i++) {
+			out[i] = pixel(x0 + i, y);
+		}
+	}
+
 	/**
 	 * \brief Give some information about the image (including pixel type)
 	 */
@@ -688,10 +704,20 @@ public:
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "copy %s alloc %d pixels at %p",
 			frame.size().toString().c_str(),
 			frame.size().getPixels(), pixels);
-#		pragma omp parallel for
-		for (int x = 0; x < frame.size().width(); x++) {
-			for (int y = 0; y < frame.size().height(); y++) {
-				pixel(x, y) = adapter.pixel(x, y);
+		int	w = frame.size().width();
+		int	h = frame.size().height();
+		// rows are computed through the row interface of the adapter,
+		// each thread uses its own row buffer
+#		pragma omp parallel
+		{
+			std::vector<srcPixel>	row(w);
+#			pragma omp for
+			for (int y = 0; y < h; y++) {
+				adapter.fillRow(y, 0, w, row.data());
+				Pixel	*target = pixels + y * w;
+				for (int x = 0; x < w; x++) {
+					target[x] = row[x];
+				}
 			}
 		}
 	}
@@ -714,11 +740,18 @@ public:
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "copy %s alloc %d pixels at %p",
 			frame.size().toString().c_str(),
 			frame.size().getPixels(), pixels);
-#		pragma omp parallel for
-		for (int x = 0; x < frame.size().width(); x++) {
-			for (int y = 0; y < frame.size().height(); y++) {
-//debug(LOG_DEBUG, DEBUG_LOG, 0, "x = %4d, y = %4d, scalefactor = %f", x, y, scalefactor);
-				pixel(x, y) = adapter.pixel(x, y) * scalefactor;
+		int	w = frame.size().width();
+		int	h = frame.size().height();
+#		pragma omp parallel
+		{
+			std::vector<srcPixel>	row(w);
+#			pragma omp for
+			for (int y = 0; y < h; y++) {
+				adapter.fillRow(y, 0, w, row.data());
+				Pixel	*target = pixels + y * w;
+				for (int x = 0; x < w; x++) {
+					target[x] = row[x] * scalefactor;
+				}
 			}
 		}
 	}
@@ -869,6 +902,21 @@ public:
 		return pixel(p.x(), p.y());
 	}
 
+	/**
+	 * \brief Copy a row segment directly from the pixel array
+	 */
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const {
+		if (n <= 0) {
+			return;
+		}
+		if ((y < 0) || (y >= frame.size().height()) || (x0 < 0)
+			|| (x0 + n > frame.size().width())) {
+			throw std::range_error("row segment outside image");
+		}
+		const Pixel	*row = pixels + y * frame.size().width() + x0;
+		std::copy(row, row + n, out);
+	}
+
 	/**
 	 * \brief Read/write access to pixels specified by image coordinates
  	 */
@@ -0,0 +1,164 @@
+/*
+ * AstroMetrics.h -- counters, gauges and latency histograms
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _AstroMetrics_h
+#define _AstroMetrics_h
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace astro {
+namespace metrics {
+
+/**
+ * \brief Monotonically increasing event counter
+ */
+class Counter {
+	std::string	_name;
+	std::atomic<uint64_t>	_value;
+	Counter(const Counter& other);
+	Counter&	operator=(const Counter& other);
+public:
+	Counter(const std::string& name) : _name(name), _value(0) { }
+	const std::string&	name() const { return _name; }
+	void	increment(uint64_t n = 1) {
+		_value.fetch_add(n, std::memory_order_relaxed);
+	}
+	uint64_t	value() const {
+		return _value.load(std::memory_order_relaxed);
+	}
+	void	reset() { _value.store(0, std::memory_order_relaxed); }
+};
+
+/**
+ * \brief Current value of some quantity, e.g. a queue length
+ */
+class Gauge {
+	std::string	_name;
+	std::atomic<int64_t>	_value;
+	Gauge(const Gauge& other);
+	Gauge&	operator=(const Gauge& other);
+public:
+	Gauge(const std::string& name) : _name(name), _value(0) { }
+	const std::string&	name() const { return _name; }
+	void	set(int64_t v) { _value.store(v, std::memory_order_relaxed); }
+	void	add(int64_t d) {
+		_value.fetch_add(d, std::memory_order_relaxed);
+	}
+	int64_t	value() const {
+		return _value.load(std::memory_order_relaxed);
+	}
+};
+
+/**
+ * \brief Latency histogram
+ *
+ * Durations are counted in buckets whose upper bounds are powers of two
+ * microseconds, from 1us up to about 36 minutes. Recording a duration
+ * is a handful of relaxed atomic operations, so histograms can be used
+ * in hot paths from any thread.
+ */
+class Histogram {
+public:
+	enum { nbuckets = 32 };
+	static double	upperbound(int bucket);
+private:
+	std::string	_name;
+	std::atomic<uint64_t>	_buckets[nbuckets];
+	std::atomic<uint64_t>	_count;
+	std::atomic<uint64_t>	_sum;	// microseconds
+	std::atomic<uint64_t>	_max;	// microseconds
+	Histogram(const Histogram& other);
+	Histogram&	operator=(const Histogram& other);
+public:
+	Histogram(const std::string& name);
+	const std::string&	name() const { return _name; }
+	void	record(double seconds);
+	uint64_t	count() const {
+		return _count.load(std::memory_order_relaxed);
+	}
+	double	sum() const;
+	double	max() const;
+	double	quantile(double q) const;
+	void	reset();
+};
+
+/**
+ * \brief Record the time spent in a scope in a histogram
+ *
+ * The timer uses the monotonic clock and does not log anything, unlike
+ * the BlockStopWatch, so it is cheap enough for every tracking step or
+ * servant call.
+ */
+class ScopedTimer {
+	Histogram&	_histogram;
+	std::chrono::steady_clock::time_point	_start;
+public:
+	ScopedTimer(Histogram& histogram) : _histogram(histogram),
+		_start(std::chrono::steady_clock::now()) { }
+	~ScopedTimer() {
+		std::chrono::duration<double>	d
+			= std::chrono::steady_clock::now() - _start;
+		_histogram.record(d.count());
+	}
+};
+
+/**
+ * \brief Value of a metric at the time of a snapshot
+ *
+ * For counters and gauges only the value is set. For histograms, count
+ * is the number of recorded durations, value is their sum, and the
+ * remaining fields are in seconds.
+ */
+class MetricValue {
+public:
+	typedef enum { counter, gauge, histogram } metric_type;
+	static std::string	type2string(metric_type t);
+	std::string	name;
+	metric_type	type;
+	uint64_t	count;
+	double	value;
+	double	mean;
+	double	p50;
+	double	p90;
+	double	p99;
+	double	max;
+	MetricValue();
+	std::string	toString() const;
+};
+
+class MetricsSnapshot : public std::vector<MetricValue> {
+public:
+	std::string	toString() const;
+};
+
+/**
+ * \brief Registry of all metrics of the process
+ *
+ * Metrics are created on first use and live until the process ends, so
+ * hot paths look them up once and keep the reference, e.g.
+ *
+ *     static Histogram&	h = Metrics::histogram("tracking.step");
+ *     ScopedTimer	timer(h);
+ *
+ * Only creation and snapshots take a lock, updating a metric does not.
+ */
+class Metrics {
+public:
+	static Counter&	counter(const std::string& name);
+	static Gauge&	gauge(const std::string& name);
+	static Histogram&	histogram(const std::string& name);
+	static MetricsSnapshot	snapshot();
+	static std::string	dump();
+	static void	reset();
+};
+
+} // namespace metrics
+} // namespace astro
+
+#endif /* _AstroMetrics_h */
@@ -166,6 +166,7 @@ public:
 	}
 	void	bind(int colno, const FieldValuePtr& value);
 	virtual void execute() = 0;
+	virtual void	reset() = 0;
 protected:
 	virtual Field	field(int colno) = 0;
 	virtual Row	row() = 0;
@@ -178,6 +179,24 @@ public:
 
 typedef std::shared_ptr<Statement>	StatementPtr;
 
+/**
+ * \brief Performance counters of a database backend
+ */
+class DatabaseStatistics {
+public:
+	unsigned long	cachehits;
+	unsigned long	cachemisses;
+	double	preparetime;	// total time spent preparing statements
+	unsigned long	lockwaits;
+	double	lockwaittime;	// total time spent waiting for locks
+	unsigned long	connectionwaits;
+	double	connectionwaittime;	// waiting for other threads to
+					// finish on the same connection
+	unsigned long	readerqueries;	// served by a reader connection
+	DatabaseStatistics();
+	std::string	toString() const;
+};
+
 /**
  * \brief The generic backend interface
  *
@@ -199,15 +218,30 @@ public:
 	virtual void	rollback(const std::string& savepoint) = 0;
 	virtual StatementPtr	statement(const std::string& query) = 0;
 	virtual bool	hastable(const std::string& tablename) = 0;
+	virtual DatabaseStatistics	statistics() = 0;
 };
 typedef std::shared_ptr<DatabaseBackend>	Database;
 
 /**
  * \brief A factory for creating backends
+ *
+ * The readers argument specifies how many additional read only
+ * connections the backend may use for select queries, 0 means that
+ * all queries go through a single connection. Without the readers
+ * argument, two reader connections are used.
+ *
+ * Reader connections need the database in WAL journal mode, so if
+ * readers > 0, the backend converts the database file to WAL mode. The
+ * conversion is permanent: the database keeps the -wal and -shm files
+ * next to it while it is open, every process accessing it must run on
+ * the same host (WAL does not work on network file systems), and
+ * sqlite versions older than 3.7.0 can no longer open it. Use
+ * readers = 0 to leave the journal mode of the database alone.
  */
 class DatabaseFactory {
 public:
 static Database	get(const std::string& name);
+static Database	get(const std::string& name, int readers);
 };
 
 /**
@@ -244,6 +278,7 @@ public:
 	long	lastid();
 	long	nextid();
 	long	addrow(const UpdateSpec& updatespec);
+	std::vector<long>	addrows(const std::vector<UpdateSpec>& updatespecs);
 	virtual long	id(const std::string& condition);
 	long	count();
 	long	count(const std::string& condition);
@@ -324,6 +359,7 @@ public:
 			dbadapter::createstatement()) { }
 	object	byid(long objectid);
 	long	add(const object&);
+	std::vector<long>	add(const std::vector<object>& objects);
 	void	update(long objectid, const object& o);
 	std::list<object>	select(const std::string& condition) {
 		std::list<object>	result;
@@ -347,6 +383,21 @@ long	Table<object, dbadapter>::add(const object& o) {
 	return addrow(dbadapter::object_to_updatespec(o));
 }
 
+/**
+ * \brief Add a vector of objects in a single transaction
+ */
+template<typename object, typename dbadapter>
+std::vector<long>	Table<object, dbadapter>::add(
+				const std::vector<object>& objects) {
+	std::vector<UpdateSpec>	updatespecs;
+	updatespecs.reserve(objects.size());
+	typename std::vector<object>::const_iterator	i;
+	for (i = objects.begin(); i != objects.end(); i++) {
+		updatespecs.push_back(dbadapter::object_to_updatespec(*i));
+	}
+	return addrows(updatespecs);
+}
+
 template<typename object, typename dbadapter>
 void	Table<object, dbadapter>::update(long objectid, const object& o) {
 	updaterow(objectid, dbadapter::object_to_updatespec(o));
@@ -494,6 +494,28 @@ public:
 	virtual std::string	what() const;
 };
 
+/**
+ * \brief Hot pixel correction step
+ *
+ * Pixels that deviate from the median of their neighbourhood by more
+ * than threshold times the noise are replaced by that median.
+ */
+class HotPixelStep : public ImageStep {
+	int	_radius;
+public:
+	int	radius() const { return _radius; }
+	void	radius(int r) { _radius = r; }
+private:
+	double	_threshold;
+public:
+	double	threshold() const { return _threshold; }
+	void	threshold(double t) { _threshold = t; }
+public:
+	HotPixelStep();
+	virtual ProcessingStep::state	do_work();
+	virtual std::string	what() const;
+};
+
 /**
  * \brief Step to stretch the luminance using a suitable stretching function
  */
@@ -169,6 +169,23 @@ public:
 	std::string	toString() const;
 };
 
+/**
+ * \brief Statistics of an image repository directory scan
+ */
+class ImageRepoScanStatistics {
+public:
+	int	files;		// FITS files found in the directory
+	int	unchanged;	// files skipped because size and mtime match
+	int	added;		// files added to the database
+	int	updated;	// files whose headers were read again
+	int	failed;		// files that could not be read
+	int	removed;	// images whose files have disappeared
+	double	duration;	// duration of the scan in seconds
+	ImageRepoScanStatistics();
+	double	throughput() const;
+	std::string	toString() const;
+};
+
 /**
  * \brief A server for images
  *
@@ -179,16 +196,21 @@ class ImageRepo {
 	std::string	_name;
 	astro::persistence::Database	_database;
 	std::string	_directory;
+	std::string	_compression;
 	long	id(const std::string& filename);
 	void	scan_directory(bool recurse = false);
 	void	scan_recursive();
-	void	scan_file(const std::string& filename);
 	void	update_filename(long id, const std::string& filename);
 public:
 	ImageRepo(const std::string& name,
 		astro::persistence::Database database,
 		const std::string& directory, bool scan = false);
 	const std::string&	name() const { return _name; }
+	const std::string&	directory() const { return _directory; }
+	ImageRepoScanStatistics	scan(int threads = 0, int batchsize = 100);
+	// FITS tile compression used for new images, see FITScompression
+	const std::string&	compression() const { return _compression; }
+	void	compression(const std::string& c);
 	bool	has(long id);
 	bool	has(const UUID& uuid);
 	std::string	filename(long id);
@@ -0,0 +1,170 @@
+/*
+ * AstroSolver.h -- blind plate solving based on geometric hashing
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _AstroSolver_h
+#define _AstroSolver_h
+
+#include <AstroCatalog.h>
+#include <AstroTransform.h>
+#include <memory>
+#include <vector>
+
+namespace astro {
+namespace catalog {
+
+/**
+ * \brief World coordinate system of an image
+ *
+ * The WCS maps pixel coordinates to the sky using a gnomonic (tangent
+ * plane) projection around the reference point crval, which is located
+ * at pixel crpix. The CD matrix maps pixel offsets to standard
+ * coordinates in the tangent plane, in radians per pixel. This is the
+ * same information as in the FITS keywords CRVAL, CRPIX and CD.
+ */
+class WCS {
+	RaDec	_crval;
+	Point	_crpix;
+	double	_cd[4];
+public:
+	WCS();
+	WCS(const RaDec& crval, const Point& crpix, const double cd[4]);
+	const RaDec&	crval() const { return _crval; }
+	const Point&	crpix() const { return _crpix; }
+	double	cd(int i) const { return _cd[i]; }
+	double	scale() const;
+	Angle	rotation() const;
+	bool	mirrored() const;
+	RaDec	operator()(const Point& pixel) const;
+	Point	operator()(const RaDec& position) const;
+	void	addMetadata(ImageBase& image) const;
+	std::string	toString() const;
+	static Point	tangent(const RaDec& center, const RaDec& position);
+	static RaDec	untangent(const RaDec& center, const Point& standard);
+};
+
+class SkyTiling;
+
+/**
+ * \brief Geometric hash index of star quads
+ *
+ * The index contains the brightest stars of each tile of the sky, and
+ * quads of nearby stars of a diameter between a quarter of the quad size
+ * and the quad size. Each quad is described by a code that does not
+ * depend on position, rotation and scale: the two stars furthest apart
+ * are mapped to (0,0) and (1,1), the coordinates of the other two stars
+ * in this frame form the code. Looking up the code of a quad of image
+ * stars yields candidate quads on the sky.
+ *
+ * Building an index takes a while, so indices are usually built offline
+ * and saved to a file. The get method keeps loaded indices, so that
+ * a long running server only loads them once. All query methods are
+ * const and can be used from multiple threads.
+ */
+class SolverIndex {
+public:
+	struct IndexStar {
+		double	ra;		// radians
+		double	dec;		// radians
+		float	mag;
+		uint32_t	reserved;
+	};
+	struct Quad {
+		uint32_t	star[4];
+		float	code[4];
+	};
+private:
+	double	_quadsize;
+	std::shared_ptr<SkyTiling>	_tiling;
+	std::vector<uint64_t>	_tileoffsets;
+	std::vector<IndexStar>	_stars;
+	std::vector<Quad>	_quads;
+	std::vector<std::pair<uint32_t, uint32_t> >	_hash;
+	void	buildhash();
+	// prevent copying
+	SolverIndex(const SolverIndex& other);
+	SolverIndex&	operator=(const SolverIndex& other);
+public:
+	static const float	binsize;
+	static const char	*magic;
+	SolverIndex(const StarTable& stars, double quadsize,
+		int starspertile = 10);
+	SolverIndex(const std::string& filename);
+	~SolverIndex();
+	void	save(const std::string& filename) const;
+	static std::shared_ptr<SolverIndex>	get(const std::string& filename);
+
+	double	quadsize() const { return _quadsize; }
+	size_t	numberOfStars() const { return _stars.size(); }
+	size_t	numberOfQuads() const { return _quads.size(); }
+	const IndexStar&	star(uint32_t i) const { return _stars[i]; }
+	const Quad&	quad(uint32_t i) const { return _quads[i]; }
+	std::vector<uint32_t>	stars(const RaDec& center,
+					double radius) const;
+	std::vector<uint32_t>	candidates(const float code[4],
+					float tolerance) const;
+	static bool	code(const Point points[4], float code[4],
+				int order[4]);
+};
+typedef std::shared_ptr<SolverIndex>	SolverIndexPtr;
+
+/**
+ * \brief Blind plate solver
+ *
+ * The solver forms quads from the brightest image stars, brightest first,
+ * and looks up their codes in the index. Each candidate quad gives a
+ * hypothesis for the WCS, which is verified by counting the image stars
+ * that have an index star close to their position. The first hypothesis
+ * with enough matching stars is refined with all matches and returned.
+ */
+class PlateSolver {
+	SolverIndexPtr	_index;
+	int	_numberofstars;
+public:
+	int	numberofstars() const { return _numberofstars; }
+	void	numberofstars(int n) { _numberofstars = n; }
+private:
+	double	_tolerance;
+public:
+	double	tolerance() const { return _tolerance; }
+	void	tolerance(double t) { _tolerance = t; }
+private:
+	double	_matchradius;
+public:
+	double	matchradius() const { return _matchradius; }
+	void	matchradius(double m) { _matchradius = m; }
+private:
+	int	_minmatches;
+public:
+	int	minmatches() const { return _minmatches; }
+	void	minmatches(int m) { _minmatches = m; }
+private:
+	double	_minscale;
+	double	_maxscale;
+public:
+	double	minscale() const { return _minscale; }
+	double	maxscale() const { return _maxscale; }
+	void	scalerange(double minscale, double maxscale);
+private:
+	int	verify(const std::vector<Point>& pixels, const ImageSize& size,
+			const WCS& wcs, std::vector<Point>& matchedpixels,
+			std::vector<RaDec>& matchedstars) const;
+	bool	hypothesis(const Point pixels[4], const int order[4],
+			const SolverIndex::Quad& quad,
+			const std::vector<Point>& allpixels,
+			const ImageSize& size, WCS& wcs) const;
+public:
+	PlateSolver(SolverIndexPtr index);
+	WCS	operator()(const std::vector<image::transform::Star>& stars,
+			const ImageSize& size) const;
+	WCS	operator()(ImagePtr image) const;
+	static WCS	fit(const std::vector<Point>& pixels,
+				const std::vector<RaDec>& stars,
+				const ImageSize& size);
+};
+
+} // namespace catalog
+} // namespace astro
+
+#endif /* _AstroSolver_h */
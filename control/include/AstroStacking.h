@@ -49,6 +49,11 @@ class Stacker;
 typedef std::shared_ptr<Stacker>	StackerPtr;
 /**
  * \brief Stacker class
+ *
+ * Without rejection, the stacker adds all images to an accumulator
+ * image. With a rejection method, the registered images are written
+ * to a scratch cube on disk, and image() combines them with outlier
+ * rejection into the weighted mean of the remaining samples.
  */
 class Stacker {
 protected:
@@ -92,6 +97,53 @@ private:
 public:
 	bool	rigid() const { return _rigid; }
 	void	rigid(bool r) { _rigid = r; }
+public:
+	typedef enum { none, sigmaclip, winsorized, percentile }
+		rejection_method;
+	static std::string	rejection2string(rejection_method r);
+	static rejection_method	string2rejection(const std::string& r);
+private:
+	// outlier rejection method, none means the images are just added
+	rejection_method	_rejection;
+public:
+	rejection_method	rejection() const { return _rejection; }
+	void	rejection(rejection_method r) { _rejection = r; }
+private:
+	// clipping limits in standard deviations for the sigma methods
+	double	_klow;
+	double	_khigh;
+public:
+	double	klow() const { return _klow; }
+	void	klow(double k) { _klow = k; }
+	double	khigh() const { return _khigh; }
+	void	khigh(double k) { _khigh = k; }
+private:
+	// fraction of samples rejected at each end for percentile rejection
+	double	_clipfraction;
+public:
+	double	clipfraction() const { return _clipfraction; }
+	void	clipfraction(double f) { _clipfraction = f; }
+private:
+	int	_iterations;
+public:
+	int	iterations() const { return _iterations; }
+	void	iterations(int i) { _iterations = i; }
+private:
+	// weight frames by the inverse of their noise variance
+	bool	_weighted;
+public:
+	bool	weighted() const { return _weighted; }
+	void	weighted(bool w) { _weighted = w; }
+private:
+	// directory for the scratch cube, empty means $TMPDIR or /tmp
+	std::string	_scratchdirectory;
+public:
+	const std::string&	scratchdirectory() const {
+		return _scratchdirectory;
+	}
+	void	scratchdirectory(const std::string& s) {
+		_scratchdirectory = s;
+	}
 
 	static StackerPtr	get(ImagePtr baseimage);
 protected:
@@ -99,10 +151,18 @@ protected:
 		: _baseimage(baseimage),
 		  _patchsize(256), _residual(30),
 		  _numberofstars(0), _searchradius(16),
-		  _notransform(true), _usetriangles(false), _rigid(false) {
+		  _notransform(true), _usetriangles(false), _rigid(false),
+		  _rejection(none), _klow(3), _khigh(3), _clipfraction(0.2),
+		  _iterations(5), _weighted(true) {
 	}
 public:
+	virtual ~Stacker() { }
 	virtual void	add(ImagePtr) = 0;
+	// find the transform for an image, may be called concurrently
+	virtual transform::Transform	registration(ImagePtr image) const = 0;
+	// add an image for which the transform is already known
+	virtual void	add(ImagePtr image,
+				const transform::Transform& transform) = 0;
 	virtual ImagePtr	image() = 0;
 
 protected:
@@ -110,6 +170,30 @@ protected:
 				const ConstImageAdapter<double>& image) const;
 };
 
+/**
+ * \brief Pipeline to stack a list of FITS files
+ *
+ * A reader thread reads the files ahead, a pool of threads computes the
+ * transforms of the images concurrently, and the calling thread adds the
+ * registered images to the stacker in the order of the file list. At most
+ * readahead() images are in memory at any time.
+ */
+class StackingPipeline {
+	StackerPtr	_stacker;
+	int	_threads;
+public:
+	int	threads() const { return _threads; }
+	void	threads(int t) { _threads = t; }
+private:
+	int	_readahead;
+public:
+	int	readahead() const { return _readahead; }
+	void	readahead(int r) { _readahead = r; }
+
+	StackingPipeline(StackerPtr stacker);
+	void	operator()(const std::vector<std::string>& filenames);
+};
+
 } // namespace stacking
 } // namespace image
 } // namespace astro
@@ -20,6 +20,7 @@ class GammaAdapter : public ConstImageAdapter<Pixel> {
 public:
 	GammaAdapter(const ConstImageAdapter<Pixel>& image, const float gamma = 1);
 	virtual Pixel	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const;
 	float	gamma() const { return _gamma; }
 	void	gamma(float gamma) { _gamma = gamma; }
 };
@@ -42,6 +43,18 @@ Pixel	GammaAdapter<Pixel>::pixel(int x, int y)
 
 }
 
+template<typename Pixel>
+void	GammaAdapter<Pixel>::fillRow(int y, int x0, int n, Pixel *out) const {
+	image.fillRow(y, x0, n, out);
+	for (int i = 0; i < n; i++) {
+		if (out[i] < 0) {
+			out[i] = 0;
+		} else {
+			out[i] = pow(out[i], _gamma);
+		}
+	}
+}
+
 /**
  * \brief Cauchy Adapter
  */
@@ -76,6 +89,7 @@ public:
 	LuminanceScalingAdapter(const ConstImageAdapter<Pixel>& image,
 		double scalefactor = 1);
 	virtual Pixel	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const;
 	double	scalefactor() const { return _scalefactor; }
 	void	scalefactor(double scalefactor) { _scalefactor = scalefactor; }
 };
@@ -92,6 +106,15 @@ Pixel	LuminanceScalingAdapter<Pixel>::pixel(int x, int y) const {
 	return image.pixel(x, y) * _scalefactor;
 }
 
+template<typename Pixel>
+void	LuminanceScalingAdapter<Pixel>::fillRow(int y, int x0, int n,
+		Pixel *out) const {
+	image.fillRow(y, x0, n, out);
+	for (int i = 0; i < n; i++) {
+		out[i] = out[i] * _scalefactor;
+	}
+}
+
 /**
  * \brief Luminance extraction
  */
@@ -253,6 +276,7 @@ public:
 	RangeAdapter(const ConstImageAdapter<Pixel>& image,
 		float min = 0, float max = 1);
 	virtual Pixel	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const;
 	double	min() const { return -b; }
 	double	max() const { return 1/m - b; }
 	void	setRange(float min = 0, float max = 1);
@@ -276,6 +300,14 @@ Pixel RangeAdapter<Pixel>::pixel(int x, int y) const {
 	return m * (_image.pixel(x, y) + b);
 }
 
+template<typename Pixel>
+void	RangeAdapter<Pixel>::fillRow(int y, int x0, int n, Pixel *out) const {
+	_image.fillRow(y, x0, n, out);
+	for (int i = 0; i < n; i++) {
+		out[i] = m * (out[i] + b);
+	}
+}
+
 /**
  * \brief RGB32 extraction
  */
@@ -342,6 +342,7 @@ public:
 	TransformAdapter(const ConstImageAdapter<Pixel>& image,
 		const Transform& transform);
 	virtual Pixel	pixel(int x, int y) const;
+	virtual void	fillRow(int y, int x0, int n, Pixel *out) const;
 };
 
 template<typename Pixel>
@@ -367,6 +368,24 @@ Pixel	TransformAdapter<Pixel>::pixel(int x, int y) const {
 	return image.pixel(t);
 }
 
+/**
+ * \brief Compute a row segment
+ *
+ * The transform is affine, so the preimages of the pixels of a row
+ * are equally spaced, and only the first two have to be computed.
+ */
+template<typename Pixel>
+void	TransformAdapter<Pixel>::fillRow(int y, int x0, int n,
+		Pixel *out) const {
+	Point	t0 = inverse(Point(x0, y));
+	Point	t1 = inverse(Point(x0 + 1, y));
+	double	dx = t1.x() - t0.x();
+	double	dy = t1.y() - t0.y();
+	for (int i = 0; i < n; i++) {
+		out[i] = image.pixel(Point(t0.x() + i * dx, t0.y() + i * dy));
+	}
+}
+
 ImagePtr	transform(ImagePtr image, const Transform& transform);
 
 /**
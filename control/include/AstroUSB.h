@@ -14,6 +14,7 @@
 #include <iostream>
 #include <memory>
 #include <cstring>
+#include <cstdio>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -516,6 +517,7 @@ public:
  * segment.
  */
 class	IsoTransfer;
+class	PacketSink;
 
 /**
  * \brief Isochronous transfer
@@ -536,6 +538,7 @@ public:
 	~IsoSegment();
 	void	submit();
 	int	extract(std::list<std::string>& packets);
+	int	extract(PacketSink& sink);
 };
 
 typedef std::shared_ptr<IsoSegment>	IsoSegmentPtr;
@@ -930,6 +933,103 @@ public:
 };
 typedef std::shared_ptr<Frame>	FramePtr;
 
+/**
+ * \brief Pool of frame buffers
+ *
+ * Frames handed out by the pool have their capacity reserved for a
+ * complete video frame. When the last reference to a frame is released,
+ * the frame goes back into the pool instead of being deallocated, so
+ * that continuous capture does not allocate a buffer per frame.
+ */
+class FramePool : public std::enable_shared_from_this<FramePool> {
+	int	_width;
+	int	_height;
+	size_t	_capacity;
+	size_t	_maxfree;
+	std::mutex	_mutex;
+	std::vector<Frame *>	_free;
+	unsigned long	_allocated;
+	unsigned long	_reused;
+	void	recycle(Frame *frame);
+	// prevent copying
+	FramePool(const FramePool& other);
+	FramePool&	operator=(const FramePool& other);
+public:
+	FramePool(int width, int height, size_t capacity, size_t maxfree = 16);
+	~FramePool();
+	int	width() const { return _width; }
+	int	height() const { return _height; }
+	size_t	capacity() const { return _capacity; }
+	unsigned long	allocated() const { return _allocated; }
+	unsigned long	reused() const { return _reused; }
+	FramePtr	get();
+};
+typedef std::shared_ptr<FramePool>	FramePoolPtr;
+
+/**
+ * \brief Consumer of USB payload packets
+ *
+ * Transfers hand each packet to a sink directly from the transfer buffer,
+ * the data is only valid during the call.
+ */
+class PacketSink {
+public:
+	virtual ~PacketSink() { }
+	virtual void	packet(const unsigned char *data, size_t length) = 0;
+};
+
+/**
+ * \brief Sink that collects copies of the packets in a list
+ */
+class PacketList : public PacketSink {
+public:
+	std::list<std::string>	packets;
+	virtual void	packet(const unsigned char *data, size_t length);
+};
+
+/**
+ * \brief Sink that records packets to a file
+ *
+ * The file starts with a magic string, followed by the packets, each
+ * preceded by its length as a 32 bit little endian number. Packets are
+ * forwarded to the next sink if there is one, so the recorder can be
+ * inserted in front of the sink that would otherwise get the packets.
+ */
+class PacketRecorder : public PacketSink {
+	FILE	*_file;
+	PacketSink	*_next;
+	unsigned long	_packets;
+	// prevent copying
+	PacketRecorder(const PacketRecorder& other);
+	PacketRecorder&	operator=(const PacketRecorder& other);
+public:
+	static const char	*magic;
+	PacketRecorder(const std::string& filename, PacketSink *next = NULL);
+	~PacketRecorder();
+	unsigned long	packets() const { return _packets; }
+	virtual void	packet(const unsigned char *data, size_t length);
+};
+
+/**
+ * \brief Replay packets recorded by a PacketRecorder
+ *
+ * The complete recording is read into memory, so that replaying only
+ * measures the speed of the sink. To test how the sink handles damaged
+ * streams, packets can be dropped at random with a given probability.
+ */
+class PacketReplay {
+	std::string	_data;
+	std::vector<std::pair<size_t, size_t> >	_packets;
+	double	_elapsed;
+public:
+	PacketReplay(const std::string& filename);
+	size_t	packets() const { return _packets.size(); }
+	size_t	bytes() const;
+	double	elapsed() const { return _elapsed; }
+	unsigned long	replay(PacketSink& sink, double loss = 0,
+				unsigned int seed = 0);
+};
+
 
 } // namespace usb
 } // namespace astro
@@ -1173,6 +1173,7 @@ typedef struct analog_lock_status_control_s {
 	uint16_t	wBrightness;
 } __attribute__((packed)) analog_lock_status_control_t;
 
+class FrameAssembler;
 
 /**
  * \brief UVC Camera
@@ -1292,6 +1293,16 @@ public:
 	 * \brief maximum payload transfer size
 	 */
 	uint32_t	maxpayloadtransfersize;
+
+	/**
+	 * \brief Pool of frame buffers for the currently selected format
+	 */
+	FramePoolPtr	framepool;
+
+	/**
+	 * \brief File to record the payload packets to, if not empty
+	 */
+	std::string	packetfile;
 public:
 	// constructors
 	UVCCamera(Device& device, bool force = false);
@@ -1464,11 +1475,15 @@ public:
 
 	// access to frames
 private:
+	size_t	minframesize() const;
+	FramePoolPtr	getFramePool();
+	std::vector<FramePtr>	assembledFrames(FrameAssembler& assembler);
 	std::vector<FramePtr>	getIsoFrames(uint8_t interface,
 					unsigned int nframes);
 	std::vector<FramePtr>	getBulkFrames(uint8_t interface,
 					unsigned int nframes);
 public:
+	void	recordPackets(const std::string& filename);
 	FramePtr	getFrame(uint8_t interface);
 	std::vector<FramePtr>	getFrames(uint8_t interface,
 		unsigned int nframes);
@@ -1566,10 +1581,10 @@ class UVCBulkTransfer : public Transfer {
 private:
         virtual void    submit(libusb_device_handle *devhandle);
 public:
-	std::vector<FramePtr>	frames;
-	std::list<std::string>	packets;
+	PacketSink&	sink;
 	UVCBulkTransfer(EndpointDescriptorPtr endpoint, int nframes,
-		size_t payloadtransfersize, size_t framesize);
+		size_t payloadtransfersize, size_t framesize,
+		PacketSink& sink);
 	virtual	~UVCBulkTransfer();
 	virtual void	callback(libusb_transfer *transfer);
 };
@@ -1594,14 +1609,42 @@ class UVCIsochronousTransfer : public Transfer {
 private:
         virtual void    submit(libusb_device_handle *devhandle);
 public:
-	std::vector<FramePtr>	frames;
-	std::list<std::string>	packets;
+	PacketSink&	sink;
 	UVCIsochronousTransfer(EndpointDescriptorPtr endpoint, int nframes,
-		int frameinterval);
+		int frameinterval, PacketSink& sink);
 	virtual	~UVCIsochronousTransfer();
 	virtual void	callback(libusb_transfer *transfer);
 };
 
+/**
+ * \brief Assemble video frames from payload packets
+ *
+ * The assembler parses the payload header of each packet in place and
+ * appends the payload directly to a frame taken from a frame pool. A frame
+ * is complete when the frame id toggles or a packet has the end of frame
+ * bit set. Frames that are shorter than the minimum size or contain
+ * a packet with the error bit set are dropped.
+ */
+class FrameAssembler : public PacketSink {
+	FramePoolPtr	_pool;
+	size_t	_minsize;
+	FramePtr	_current;
+	bool	_fid;
+	bool	_error;
+	void	finish();
+public:
+	std::vector<FramePtr>	frames;
+	unsigned long	packets;	// number of packets received
+	unsigned long	bytes;		// payload bytes received
+	unsigned long	ignored;	// packets with an invalid header
+	unsigned long	errors;		// packets with the error bit set
+	unsigned long	dropped;	// incomplete or damaged frames
+	FrameAssembler(FramePoolPtr pool, size_t minsize);
+	virtual void	packet(const unsigned char *data, size_t length);
+	void	flush();
+	std::string	toString() const;
+};
+
 /**
  * \brief Frame factory
  *
@@ -0,0 +1,105 @@
+/*
+ * ImageCache.h -- in process cache of decoded images and FITS headers
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _ImageCache_h
+#define _ImageCache_h
+
+#include <AstroImage.h>
+#include <list>
+#include <map>
+#include <mutex>
+#include <sys/stat.h>
+
+namespace astro {
+namespace image {
+
+/**
+ * \brief Header information of a FITS file
+ *
+ * This is all the image directory and the servants need to know about
+ * an image without decoding the pixels.
+ */
+class ImageHeader {
+public:
+	int	imgtype;
+	int	planes;
+	ImageSize	size;
+	ImageMetadata	metadata;
+	ImageHeader() : imgtype(0), planes(0) { }
+};
+
+/**
+ * \brief Hit and miss counters of the image cache
+ */
+class ImageCacheStatistics {
+public:
+	unsigned long	hits;
+	unsigned long	misses;
+	unsigned long	headerhits;
+	unsigned long	headermisses;
+	unsigned long	evictions;
+	unsigned long	invalidations;
+	size_t	bytes;
+	size_t	budget;
+	size_t	entries;
+	ImageCacheStatistics();
+	std::string	toString() const;
+};
+
+/**
+ * \brief Cache of decoded images and headers, keyed by file name
+ *
+ * Servants for images in the image directory or in a repository ask for
+ * the same file many times, and decoding a FITS file is expensive. The
+ * cache keeps decoded images and parsed headers up to a memory budget
+ * and evicts the least recently used ones when the budget is exceeded.
+ * An entry is only used as long as modification time, size and inode of
+ * the file are unchanged, so files replaced behind the back of the cache
+ * are read again.
+ *
+ * Images returned by the cache are shared by all users of the same file,
+ * they must not be modified. Hits, misses, evictions and the memory
+ * used are published as imagecache.* metrics.
+ */
+class ImageCache {
+	struct entry {
+		time_t	mtime;
+		off_t	filesize;
+		ino_t	inode;
+		ImagePtr	image;
+		bool	hasheader;
+		ImageHeader	header;
+		size_t	bytes;
+		std::list<std::string>::iterator	lru;
+	};
+	typedef std::map<std::string, entry>	entrymap;
+	entrymap	_entries;
+	std::list<std::string>	_lru;
+	ImageCacheStatistics	_statistics;
+	mutable std::mutex	_mutex;
+	entry	*lookup(const std::string& filename, const struct stat& sb);
+	entry&	insert(const std::string& filename, const struct stat& sb);
+	void	erase(entrymap::iterator i);
+	void	shrink();
+	// prevent copying
+	ImageCache(const ImageCache& other);
+	ImageCache&	operator=(const ImageCache& other);
+public:
+	ImageCache(size_t budget = 256 * 1024 * 1024);
+	~ImageCache();
+	static ImageCache&	get();
+	size_t	budget() const;
+	void	budget(size_t b);
+	ImagePtr	image(const std::string& filename);
+	ImageHeader	header(const std::string& filename);
+	void	invalidate(const std::string& filename);
+	void	clear();
+	ImageCacheStatistics	statistics() const;
+};
+
+} // namespace image
+} // namespace astro
+
+#endif /* _ImageCache_h */
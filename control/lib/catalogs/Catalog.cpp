@@ -82,6 +82,25 @@ CatalogIterator	Catalog::findIter(const SkyWindow& window,
 	return CatalogIterator(impl);
 }
 
+/**
+ * \brief Default columnar window query
+ *
+ * This implementation converts the result of the set based find method.
+ * Backends that can access their records directly should override it
+ * to fill the table without creating Star objects.
+ */
+StarTablePtr	Catalog::findTable(const SkyWindow& window,
+		const MagnitudeRange& magrange) {
+	starsetptr	stars = find(window, magrange);
+	StarTablePtr	result(new StarTable());
+	result->reserve(stars->size());
+	starset::const_iterator	s;
+	for (s = stars->begin(); s != stars->end(); s++) {
+		result->add(*s);
+	}
+	return result;
+}
+
 /**
  * \brief Dummy implementation of begin()
  */
@@ -50,6 +50,8 @@ public:
 						const MagnitudeRange& magrange);
 	virtual CatalogIterator	findIter(const SkyWindow& window,
 						const MagnitudeRange& magrange);
+	virtual StarTablePtr	findTable(const SkyWindow& window,
+						const MagnitudeRange& magrange);
 	virtual Star	find(const std::string& name);
 	virtual unsigned long	numberOfStars();
 	virtual CatalogIterator	begin();
@@ -9,6 +9,7 @@
 #include <Tycho2.h>
 #include <Ucac4.h>
 #include <CatalogBackend.h>
+#include <StarIndex.h>
 
 namespace astro {
 namespace catalog {
@@ -28,6 +29,8 @@ CatalogPtr	CatalogFactory::get(BackendType type,
 		return CatalogPtr(new FileBackend(parameter));
 	case Database:
 		return CatalogPtr(new DatabaseBackend(parameter));;
+	case Index:
+		return CatalogPtr(new IndexBackend(parameter));
 	}
 	throw std::runtime_error("unknown catalog");
 }
@@ -36,15 +36,16 @@ Chart	ChartFactory::chart(const RaDec& center, const ImageGeometry& geometry) co
 
 	// next find a window to get all the stars in the window
 	SkyWindow	window = rectangle.containedin();
-	Catalog::starsetptr	stars = _catalog->find(window,
-                                        MagnitudeRange(-30, limit_magnitude()));
+	StarTablePtr	stars = _catalog->findTable(window,
+				MagnitudeRange(-30, limit_magnitude()));
 
-	// add the stars to the image
-	draw(*chart._image, rectangle, stars);
-
-	// apply the point spread function
+	// add the stars to the image, using stamps of the point spread
+	// function no larger than the old convolution kernel
 	int	morepixels = 100;
-	spread(*chart._image, morepixels, geometry);
+	PointSpreadFunctionStamps	stamps(pointspreadfunction,
+						geometry.angularpixelsize(),
+						morepixels);
+	draw(*chart._image, rectangle, *stars, stamps);
 
 	// limit the pixel values to 1
 	limit(*chart._image, 1.);
@@ -77,6 +78,43 @@ void	ChartFactory::draw(Image<double>& image, const SkyRectangle& rectangle,
 	}
 }
 
+/**
+ * \brief draw the stars of a star table into the chart
+ *
+ * The stars are first projected into the image in parallel, stars that
+ * cannot be mapped are marked with a zero intensity and skipped by the
+ * renderer. Only position and magnitude columns are used.
+ */
+void	ChartFactory::draw(Image<double>& image, const SkyRectangle& rectangle,
+		const StarTable& stars,
+		const PointSpreadFunctionStamps& stamps) const {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "create image for %u stars",
+		stars.size());
+	ImageSize	size = image.size();
+	int	n = stars.size();
+	std::vector<double>	x(n), y(n), I(n);
+	int	unmapped = 0;
+#pragma omp parallel for reduction(+:unmapped)
+	for (int i = 0; i < n; i++) {
+		try {
+			astro::Point	p = rectangle.point(size,
+						stars.position(i));
+			x[i] = p.x();
+			y[i] = p.y();
+			I[i] = intensity(stars.mag[i]);
+		} catch (const std::exception&) {
+			I[i] = 0;
+			unmapped++;
+		}
+	}
+	if (unmapped) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "%d stars cannot be mapped",
+			unmapped);
+	}
+	StampRenderer	renderer(stamps);
+	renderer(image, x, y, I);
+}
+
 /**
  * \brief Draw a sets of of stars to the chart
  */
@@ -122,6 +122,53 @@ Catalog::starsetptr	FileBackend::find(const SkyWindow& window,
 	return resultptr;
 }
 
+/**
+ * \brief retrieve stars from all catalogs combined as a columnar table
+ *
+ * This uses the same catalogs with the same cutover magnitudes as the
+ * set based find method. The bright stars from the Hipparcos and Tycho-2
+ * catalogs are few, they are converted from the star sets, while the
+ * UCAC4 stars, which make up almost all of a deep query, are appended
+ * directly from the zone files.
+ */
+StarTablePtr	FileBackend::findTable(const SkyWindow& window,
+				const MagnitudeRange& magrange) {
+	StarTablePtr	result(new StarTable());
+
+	// brightest stars from the Hipparcos catalog
+	{
+		Hipparcos::starsetptr	stars
+			= hipparcos_catalog->find(window, magrange);
+		Hipparcos::starset::const_iterator	s;
+		for (s = stars->begin(); s != stars->end(); s++) {
+			result->add(*s);
+		}
+	}
+	if (magrange.faintest() < Hipparcos_Complete_Magnitude) {
+		return result;
+	}
+
+	// intermediate stars from Tycho-2 that are not Hipparcos stars
+	{
+		Tycho2::starsetptr	stars
+			= tycho2_catalog->find(window, magrange);
+		Tycho2::starset::const_iterator	s;
+		for (s = stars->begin(); s != stars->end(); s++) {
+			if (!s->isDuplicate()) {
+				result->add(*s);
+			}
+		}
+	}
+	if (magrange.faintest() < Tycho2_Complete_Magnitude) {
+		return result;
+	}
+
+	// all matching stars from the UCAC4 catalog
+	result->append(*ucac4_catalog->findTable(window, magrange));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u stars found", result->size());
+	return result;
+}
+
 CatalogIterator	FileBackend::findIter(const SkyWindow& window,
 			const MagnitudeRange& magrange) {
 	IteratorImplementationPtr	impl(
@@ -0,0 +1,220 @@
+/*
+ * IndexBackend.cpp -- catalog backend based on a star index file
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include "StarIndex.h"
+#include <AstroFormat.h>
+#include <AstroDebug.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace astro {
+namespace catalog {
+
+#define	MARCSEC_to_RADIANS	(M_PI / (180. * 60 * 60 * 1000))
+
+const char	*IndexBackend::magic = "ASTRIDX1";
+
+/**
+ * \brief Open and map an index file
+ */
+IndexBackend::IndexBackend(const std::string& indexfilename)
+	: _data(NULL), _length(0), _tiling(NULL) {
+	backendname = indexfilename;
+	int	fd = open(indexfilename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::string	msg = stringprintf("cannot open %s: %s",
+			indexfilename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	struct stat	sb;
+	if (fstat(fd, &sb) < 0) {
+		std::string	msg = stringprintf("cannot stat %s: %s",
+			indexfilename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		close(fd);
+		throw std::runtime_error(msg);
+	}
+	_length = sb.st_size;
+	if (_length < sizeof(StarIndexHeader)) {
+		close(fd);
+		std::string	msg = stringprintf("%s too short",
+			indexfilename.c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	void	*data = mmap(NULL, _length, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (MAP_FAILED == data) {
+		std::string	msg = stringprintf("cannot map %s: %s",
+			indexfilename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	_data = (const char *)data;
+
+	// verify the header
+	_header = (const StarIndexHeader *)_data;
+	size_t	offsetslength = (_header->tiles + 1) * sizeof(uint64_t);
+	if ((memcmp(_header->magic, magic, sizeof(_header->magic)) != 0)
+		|| (_header->version != 1)
+		|| (_length != sizeof(StarIndexHeader) + offsetslength
+			+ _header->nstars * sizeof(StarIndexRecord))) {
+		munmap(data, _length);
+		std::string	msg = stringprintf("%s is not a star index",
+			indexfilename.c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	_offsets = (const uint64_t *)(_data + sizeof(StarIndexHeader));
+	_stars = (const StarIndexRecord *)(_data + sizeof(StarIndexHeader)
+			+ offsetslength);
+	_tiling = new SkyTiling(_header->zoneheight);
+	if (_tiling->tiles() != _header->tiles) {
+		delete _tiling;
+		munmap(data, _length);
+		std::string	msg = stringprintf("%s: tiling mismatch",
+			indexfilename.c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "index %s: %llu stars in %u tiles",
+		indexfilename.c_str(), (unsigned long long)_header->nstars,
+		_header->tiles);
+}
+
+IndexBackend::~IndexBackend() {
+	delete _tiling;
+	munmap((void *)_data, _length);
+}
+
+static bool	magless(const StarIndexRecord& star, float mag) {
+	return star.mag < mag;
+}
+
+static bool	maggreater(float mag, const StarIndexRecord& star) {
+	return mag < star.mag;
+}
+
+/**
+ * \brief Add the stars of a tile inside window and magnitude range
+ *
+ * Since the tile is sorted by magnitude, only the part of the tile
+ * inside the magnitude range is read.
+ */
+void	IndexBackend::add(StarTable& table, uint32_t tile,
+		const SkyWindow& window, const MagnitudeRange& magrange) const {
+	const StarIndexRecord	*begin = _stars + _offsets[tile];
+	const StarIndexRecord	*end = _stars + _offsets[tile + 1];
+	begin = std::lower_bound(begin, end, magrange.brightest(), magless);
+	end = std::upper_bound(begin, end, magrange.faintest(), maggreater);
+	for (const StarIndexRecord *s = begin; s < end; s++) {
+		double	ra = s->ra * MARCSEC_to_RADIANS;
+		double	dec = s->dec * MARCSEC_to_RADIANS;
+		if (window.contains(RaDec(Angle(ra), Angle(dec)))) {
+			table.add(ra, dec, s->pmra, s->pmdec, s->mag,
+				s->catalog, s->catalognumber);
+		}
+	}
+}
+
+/**
+ * \brief Retrieve the stars in a window as a columnar table
+ */
+StarTablePtr	IndexBackend::findTable(const SkyWindow& window,
+		const MagnitudeRange& magrange) {
+	StarTablePtr	result(new StarTable());
+	std::vector<uint32_t>	tiles = _tiling->tiles(window);
+	std::vector<uint32_t>::const_iterator	t;
+	for (t = tiles.begin(); t != tiles.end(); t++) {
+		add(*result, *t, window, magrange);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u stars from %u tiles",
+		result->size(), tiles.size());
+	return result;
+}
+
+/**
+ * \brief Retrieve the stars in a window
+ */
+Catalog::starsetptr	IndexBackend::find(const SkyWindow& window,
+		const MagnitudeRange& magrange) {
+	StarTablePtr	table = findTable(window, magrange);
+	Catalog::starsetptr	result(new Catalog::starset());
+	for (size_t i = 0; i < table->size(); i++) {
+		result->insert(table->star(i));
+	}
+	return result;
+}
+
+/**
+ * \brief Parse a star name into catalog and catalog number
+ */
+static bool	parsename(const std::string& name, char& catalog,
+			uint64_t& catalognumber) {
+	unsigned short	zone;
+	unsigned int	a, b, c;
+	if (2 == sscanf(name.c_str(), "UCAC4-%hu-%u", &zone, &a)) {
+		catalog = 'U';
+		catalognumber = 1000000ull * zone + a;
+		return true;
+	}
+	if (1 == sscanf(name.c_str(), "BSC%u", &a)) {
+		catalog = 'B';
+		catalognumber = a;
+		return true;
+	}
+	if (1 == sscanf(name.c_str(), "HIP%u", &a)) {
+		catalog = 'H';
+		catalognumber = a;
+		return true;
+	}
+	if (3 == sscanf(name.c_str(), "T%u %u %u", &a, &b, &c)) {
+		catalog = 'T';
+		catalognumber = 1000000ull * a + 10ull * b + c;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * \brief Find a star by name
+ *
+ * The index is organized for window queries, so this has to scan all
+ * records.
+ */
+Star	IndexBackend::find(const std::string& name) {
+	char	catalog;
+	uint64_t	catalognumber;
+	if (parsename(name, catalog, catalognumber)) {
+		for (uint64_t i = 0; i < _header->nstars; i++) {
+			const StarIndexRecord	*s = _stars + i;
+			if ((s->catalognumber == catalognumber)
+				&& (s->catalog == catalog)) {
+				StarTable	table;
+				table.add(s->ra * MARCSEC_to_RADIANS,
+					s->dec * MARCSEC_to_RADIANS,
+					s->pmra, s->pmdec, s->mag, s->catalog,
+					s->catalognumber);
+				return table.star(0);
+			}
+		}
+	}
+	std::string	msg = stringprintf("star %s not found", name.c_str());
+	debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+	throw std::runtime_error(msg);
+}
+
+unsigned long	IndexBackend::numberOfStars() {
+	return _header->nstars;
+}
+
+} // namespace catalog
+} // namespace astro
@@ -0,0 +1,183 @@
+/*
+ * IndexBackendCreator.cpp -- create a star index file
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include "StarIndex.h"
+#include <AstroFormat.h>
+#include <AstroDebug.h>
+#include <AstroUtils.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace astro {
+namespace catalog {
+
+#define	RADIANS_to_MARCSEC	(180. * 60 * 60 * 1000 / M_PI)
+#define	FULLCIRCLE_MARCSEC	1296000000u
+
+/**
+ * \brief Star record in the scratch file, together with its tile
+ */
+struct ScratchRecord {
+	uint32_t	tile;
+	uint32_t	reserved;
+	StarIndexRecord	star;
+};
+
+/**
+ * \brief Create an index creator
+ *
+ * \param filename	name of the index file to create
+ * \param zoneheight	height of the declination zones in radians
+ */
+IndexBackendCreator::IndexBackendCreator(const std::string& filename,
+	double zoneheight)
+	: _filename(filename), _tiling(zoneheight), _scratch(NULL),
+	  _counts(_tiling.tiles(), 0), _nstars(0) {
+	std::string	scratchname = filename + ".XXXXXX";
+	std::vector<char>	name(scratchname.begin(), scratchname.end());
+	name.push_back('\0');
+	int	fd = mkstemp(&name[0]);
+	if (fd < 0) {
+		std::string	msg = stringprintf("cannot create scratch file "
+			"%s: %s", &name[0], strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	unlink(&name[0]);
+	_scratch = fdopen(fd, "w+");
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "creating index %s with %u tiles",
+		filename.c_str(), _tiling.tiles());
+}
+
+IndexBackendCreator::~IndexBackendCreator() {
+	if (_scratch) {
+		fclose(_scratch);
+	}
+}
+
+/**
+ * \brief Add a star to the index
+ */
+void	IndexBackendCreator::add(const Star& star) {
+	ScratchRecord	record;
+	memset(&record, 0, sizeof(record));
+	double	ra = star.ra().radians();
+	ra = ra - 2 * M_PI * floor(ra / (2 * M_PI));
+	record.tile = _tiling.tile(ra, star.dec().radians());
+	uint32_t	ramas = lround(ra * RADIANS_to_MARCSEC);
+	record.star.ra = (ramas >= FULLCIRCLE_MARCSEC) ? 0 : ramas;
+	record.star.dec = lround(star.dec().radians() * RADIANS_to_MARCSEC);
+	record.star.pmra = star.pm().ra().radians();
+	record.star.pmdec = star.pm().dec().radians();
+	record.star.mag = star.mag();
+	record.star.catalog = star.catalog();
+	record.star.catalognumber = star.catalognumber();
+	if (1 != fwrite(&record, sizeof(record), 1, _scratch)) {
+		std::string	msg = stringprintf("cannot write scratch "
+			"record: %s", strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	_counts[record.tile]++;
+	_nstars++;
+}
+
+static bool	brighter(const StarIndexRecord& a, const StarIndexRecord& b) {
+	if (a.mag != b.mag) {
+		return a.mag < b.mag;
+	}
+	return a.catalognumber < b.catalognumber;
+}
+
+/**
+ * \brief Write the index file
+ *
+ * The stars are distributed from the scratch file to their tiles in the
+ * mapped index file, then the tiles are sorted by magnitude in parallel.
+ */
+void	IndexBackendCreator::finalize() {
+	Timer	timer;
+	timer.start();
+	uint32_t	tiles = _tiling.tiles();
+	size_t	offsetslength = (tiles + 1) * sizeof(uint64_t);
+	size_t	length = sizeof(StarIndexHeader) + offsetslength
+			+ _nstars * sizeof(StarIndexRecord);
+
+	// create and map the index file
+	int	fd = open(_filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		std::string	msg = stringprintf("cannot create %s: %s",
+			_filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	if (ftruncate(fd, length) < 0) {
+		std::string	msg = stringprintf("cannot resize %s: %s",
+			_filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		close(fd);
+		throw std::runtime_error(msg);
+	}
+	char	*data = (char *)mmap(NULL, length, PROT_READ | PROT_WRITE,
+		MAP_SHARED, fd, 0);
+	close(fd);
+	if (MAP_FAILED == data) {
+		std::string	msg = stringprintf("cannot map %s: %s",
+			_filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+
+	// header and tile offsets
+	StarIndexHeader	*header = (StarIndexHeader *)data;
+	memset(header, 0, sizeof(StarIndexHeader));
+	memcpy(header->magic, IndexBackend::magic, sizeof(header->magic));
+	header->version = 1;
+	header->tiles = tiles;
+	header->zoneheight = _tiling.zoneheight();
+	header->nstars = _nstars;
+	uint64_t	*offsets = (uint64_t *)(data + sizeof(StarIndexHeader));
+	offsets[0] = 0;
+	for (uint32_t t = 0; t < tiles; t++) {
+		offsets[t + 1] = offsets[t] + _counts[t];
+	}
+	StarIndexRecord	*stars = (StarIndexRecord *)(data
+				+ sizeof(StarIndexHeader) + offsetslength);
+
+	// distribute the stars to their tiles
+	std::vector<uint64_t>	cursor(offsets, offsets + tiles);
+	fflush(_scratch);
+	rewind(_scratch);
+	std::vector<ScratchRecord>	buffer(65536);
+	size_t	n;
+	while (0 < (n = fread(&buffer[0], sizeof(ScratchRecord),
+		buffer.size(), _scratch))) {
+		for (size_t i = 0; i < n; i++) {
+			stars[cursor[buffer[i].tile]++] = buffer[i].star;
+		}
+	}
+
+	// sort all tiles by magnitude
+#pragma omp parallel for schedule(dynamic, 64)
+	for (uint32_t t = 0; t < tiles; t++) {
+		std::sort(stars + offsets[t], stars + offsets[t + 1],
+			brighter);
+	}
+
+	msync(data, length, MS_SYNC);
+	munmap(data, length);
+	timer.end();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "index %s with %llu stars written "
+		"in %.3fs", _filename.c_str(), (unsigned long long)_nstars,
+		timer.elapsed());
+}
+
+} // namespace catalog
+} // namespace astro
@@ -85,5 +85,18 @@ std::string	MappedFile::get(size_t record_number) const {
 		_recordlength);
 }
 
+/**
+ * \brief access a record in place
+ *
+ * The pointer returned points into the mapped file, it remains valid as
+ * long as the MappedFile object exists.
+ */
+const char	*MappedFile::record(size_t record_number) const {
+	if (record_number >= _nrecords) {
+		throw std::runtime_error("record number too large");
+	}
+	return &((const char *)data_ptr)[_recordlength * record_number];
+}
+
 } // namespace catalog
 } // namespace astro
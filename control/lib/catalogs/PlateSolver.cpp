@@ -0,0 +1,322 @@
+/*
+ * PlateSolver.cpp -- blind plate solver using the quad index
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroSolver.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroUtils.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace astro::image;
+
+namespace astro {
+namespace catalog {
+
+typedef astro::image::transform::Star	ImageStar;
+
+PlateSolver::PlateSolver(SolverIndexPtr index) : _index(index),
+	_numberofstars(30), _tolerance(0.01), _matchradius(3),
+	_minmatches(8), _minscale(0), _maxscale(0) {
+}
+
+/**
+ * \brief Restrict the pixel scale of solutions, in radians per pixel
+ *
+ * A maxscale of 0 means that the scale is not restricted.
+ */
+void	PlateSolver::scalerange(double minscale, double maxscale) {
+	_minscale = minscale;
+	_maxscale = maxscale;
+}
+
+/**
+ * \brief Solve a 3x3 linear system by Gaussian elimination
+ */
+static bool	solve3(double a[3][3], double b[3], double x[3]) {
+	for (int i = 0; i < 3; i++) {
+		int	p = i;
+		for (int j = i + 1; j < 3; j++) {
+			if (fabs(a[j][i]) > fabs(a[p][i])) {
+				p = j;
+			}
+		}
+		if (fabs(a[p][i]) < 1e-300) {
+			return false;
+		}
+		std::swap(a[i], a[p]);
+		std::swap(b[i], b[p]);
+		for (int j = i + 1; j < 3; j++) {
+			double	f = a[j][i] / a[i][i];
+			for (int k = i; k < 3; k++) {
+				a[j][k] -= f * a[i][k];
+			}
+			b[j] -= f * b[i];
+		}
+	}
+	for (int i = 2; i >= 0; i--) {
+		double	s = b[i];
+		for (int k = i + 1; k < 3; k++) {
+			s -= a[i][k] * x[k];
+		}
+		x[i] = s / a[i][i];
+	}
+	return true;
+}
+
+/**
+ * \brief Fit a WCS with reference pixel at the image center
+ *
+ * The affine map from pixels to the tangent plane is fitted by least
+ * squares. The tangent point is then moved to the sky position of the
+ * reference pixel, and the fit is repeated.
+ */
+WCS	PlateSolver::fit(const std::vector<Point>& pixels,
+		const std::vector<RaDec>& stars, const ImageSize& size) {
+	if ((pixels.size() < 3) || (pixels.size() != stars.size())) {
+		std::string	msg = stringprintf("cannot fit WCS to %u points",
+			pixels.size());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	Point	crpix(size.width() / 2., size.height() / 2.);
+	Vector	sum;
+	for (size_t i = 0; i < stars.size(); i++) {
+		sum = sum + UnitVector(stars[i]);
+	}
+	RaDec	crval(sum);
+	double	cd[4];
+	for (int iteration = 0; iteration < 3; iteration++) {
+		double	n[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+		double	bx[3] = { 0, 0, 0 };
+		double	by[3] = { 0, 0, 0 };
+		for (size_t i = 0; i < pixels.size(); i++) {
+			Point	s = WCS::tangent(crval, stars[i]);
+			double	v[3] = { pixels[i].x() - crpix.x(),
+					pixels[i].y() - crpix.y(), 1 };
+			for (int j = 0; j < 3; j++) {
+				for (int k = 0; k < 3; k++) {
+					n[j][k] += v[j] * v[k];
+				}
+				bx[j] += v[j] * s.x();
+				by[j] += v[j] * s.y();
+			}
+		}
+		double	n2[3][3];
+		std::copy(&n[0][0], &n[0][0] + 9, &n2[0][0]);
+		double	px[3], py[3];
+		if (!solve3(n, bx, px) || !solve3(n2, by, py)) {
+			std::string	msg("degenerate star configuration");
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+			throw std::runtime_error(msg);
+		}
+		cd[0] = px[0]; cd[1] = px[1];
+		cd[2] = py[0]; cd[3] = py[1];
+		crval = WCS::untangent(crval, Point(px[2], py[2]));
+	}
+	return WCS(crval, crpix, cd);
+}
+
+/**
+ * \brief Count the image stars that have an index star close by
+ *
+ * \return	the number of matched stars
+ */
+int	PlateSolver::verify(const std::vector<Point>& pixels,
+		const ImageSize& size, const WCS& wcs,
+		std::vector<Point>& matchedpixels,
+		std::vector<RaDec>& matchedstars) const {
+	matchedpixels.clear();
+	matchedstars.clear();
+	Point	center(size.width() / 2., size.height() / 2.);
+	double	radius = wcs.scale() * 0.55
+			* hypot(size.width(), size.height());
+	if (radius > M_PI / 4) {
+		return 0;
+	}
+	std::vector<uint32_t>	candidates = _index->stars(wcs(center),
+						radius);
+
+	// project the index stars into the image
+	std::vector<Point>	projected;
+	std::vector<RaDec>	positions;
+	std::vector<uint32_t>::const_iterator	i;
+	for (i = candidates.begin(); i != candidates.end(); i++) {
+		const SolverIndex::IndexStar&	s = _index->star(*i);
+		RaDec	position(Angle(s.ra), Angle(s.dec));
+		try {
+			Point	p = wcs(position);
+			if ((p.x() < -_matchradius)
+				|| (p.x() > size.width() + _matchradius)
+				|| (p.y() < -_matchradius)
+				|| (p.y() > size.height() + _matchradius)) {
+				continue;
+			}
+			projected.push_back(p);
+			positions.push_back(position);
+		} catch (const std::exception&) {
+		}
+	}
+
+	// match each image star with the nearest unused index star
+	std::vector<bool>	used(projected.size(), false);
+	for (size_t k = 0; k < pixels.size(); k++) {
+		int	best = -1;
+		double	bestdistance = _matchradius;
+		for (size_t j = 0; j < projected.size(); j++) {
+			double	d = (projected[j] - pixels[k]).abs();
+			if ((!used[j]) && (d <= bestdistance)) {
+				best = j;
+				bestdistance = d;
+			}
+		}
+		if (best >= 0) {
+			used[best] = true;
+			matchedpixels.push_back(pixels[k]);
+			matchedstars.push_back(positions[best]);
+		}
+	}
+	return matchedpixels.size();
+}
+
+/**
+ * \brief Test the hypothesis that an image quad is an index quad
+ *
+ * \return	true if the hypothesis was verified, the refined WCS is
+ *		returned in wcs
+ */
+bool	PlateSolver::hypothesis(const Point pixels[4], const int order[4],
+		const SolverIndex::Quad& quad,
+		const std::vector<Point>& allpixels, const ImageSize& size,
+		WCS& wcs) const {
+	std::vector<Point>	quadpixels;
+	std::vector<RaDec>	quadstars;
+	for (int k = 0; k < 4; k++) {
+		const SolverIndex::IndexStar&	s = _index->star(quad.star[k]);
+		quadpixels.push_back(pixels[order[k]]);
+		quadstars.push_back(RaDec(Angle(s.ra), Angle(s.dec)));
+	}
+	WCS	candidate;
+	try {
+		candidate = fit(quadpixels, quadstars, size);
+	} catch (const std::exception&) {
+		return false;
+	}
+	double	scale = candidate.scale();
+	if ((_maxscale > 0)
+		&& ((scale < _minscale) || (scale > _maxscale))) {
+		return false;
+	}
+	std::vector<Point>	matchedpixels;
+	std::vector<RaDec>	matchedstars;
+	int	matches = verify(allpixels, size, candidate, matchedpixels,
+				matchedstars);
+	if (matches < _minmatches) {
+		return false;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "hypothesis %s has %d matches",
+		candidate.toString().c_str(), matches);
+
+	// refine with all matched stars
+	for (int iteration = 0; iteration < 2; iteration++) {
+		candidate = fit(matchedpixels, matchedstars, size);
+		verify(allpixels, size, candidate, matchedpixels,
+			matchedstars);
+	}
+	wcs = candidate;
+	return true;
+}
+
+static bool	brighter(const ImageStar& a, const ImageStar& b) {
+	return b < a;
+}
+
+/**
+ * \brief Solve an image given the stars extracted from it
+ */
+WCS	PlateSolver::operator()(const std::vector<ImageStar>& stars,
+		const ImageSize& size) const {
+	Timer	timer;
+	timer.start();
+	std::vector<ImageStar>	sorted(stars);
+	std::sort(sorted.begin(), sorted.end(), brighter);
+	std::vector<Point>	pixels(sorted.begin(), sorted.end());
+	int	n = std::min((int)pixels.size(), _numberofstars);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "solving %s image with %d of %u stars",
+		size.toString().c_str(), n, stars.size());
+
+	// quads of image stars with a diameter outside this range cannot
+	// match an index quad
+	double	mindiameter = 0;
+	double	maxdiameter = hypot(size.width(), size.height());
+	if (_maxscale > 0) {
+		mindiameter = _index->quadsize() / 4 / _maxscale;
+		if (_minscale > 0) {
+			maxdiameter = std::min(maxdiameter,
+				_index->quadsize() / _minscale);
+		}
+	}
+
+	// form quads from the brightest stars first
+	int	tested = 0;
+	for (int d = 3; d < n; d++)
+	for (int c = 2; c < d; c++)
+	for (int b = 1; b < c; b++)
+	for (int a = 0; a < b; a++) {
+		Point	points[4] = { pixels[a], pixels[b], pixels[c],
+					pixels[d] };
+		for (int parity = 0; parity < 2; parity++) {
+			Point	q[4];
+			for (int k = 0; k < 4; k++) {
+				q[k] = (parity) ? Point(-points[k].x(),
+						points[k].y()) : points[k];
+			}
+			float	code[4];
+			int	order[4];
+			if (!SolverIndex::code(q, code, order)) {
+				continue;
+			}
+			double	diameter = (q[order[1]] - q[order[0]]).abs();
+			if ((diameter < mindiameter)
+				|| (diameter > maxdiameter)) {
+				continue;
+			}
+			std::vector<uint32_t>	candidates
+				= _index->candidates(code, _tolerance);
+			std::vector<uint32_t>::const_iterator	i;
+			for (i = candidates.begin(); i != candidates.end();
+				i++) {
+				tested++;
+				WCS	wcs;
+				if (hypothesis(points, order,
+					_index->quad(*i), pixels, size, wcs)) {
+					timer.end();
+					debug(LOG_DEBUG, DEBUG_LOG, 0,
+						"solved after %d hypotheses "
+						"in %.3fs: %s", tested,
+						timer.elapsed(),
+						wcs.toString().c_str());
+					return wcs;
+				}
+			}
+		}
+	}
+	std::string	msg = stringprintf("no solution found after %d "
+		"hypotheses", tested);
+	debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+	throw std::runtime_error(msg);
+}
+
+/**
+ * \brief Solve an image
+ */
+WCS	PlateSolver::operator()(ImagePtr image) const {
+	transform::StarExtractor	extractor(_numberofstars, 10);
+	std::vector<ImageStar>	stars = extractor.stars(image);
+	return (*this)(stars, image->size());
+}
+
+} // namespace catalog
+} // namespace astro
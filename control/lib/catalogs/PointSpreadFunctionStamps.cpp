@@ -0,0 +1,120 @@
+/*
+ * PointSpreadFunctionStamps.cpp -- point spread function sampled at
+ *                                  sub pixel phases
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroChart.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <cmath>
+
+namespace astro {
+namespace catalog {
+
+/**
+ * \brief Fraction of the peak below which the PSF is considered zero
+ */
+static const double	threshold = 1e-6;
+
+/**
+ * \brief Evaluate the point spread function at a distance in pixels
+ *
+ * Some point spread functions cannot be evaluated at the center, e.g.
+ * the diffraction function is 0/0 there, so we use a point very close
+ * to the center instead.
+ */
+static double	evaluate(const PointSpreadFunction& psf, double r,
+			double angularpixelsize) {
+	double	v = psf(r * angularpixelsize);
+	if (!std::isfinite(v)) {
+		v = psf((r + 1e-6) * angularpixelsize);
+	}
+	return (std::isfinite(v)) ? v : 0.;
+}
+
+/**
+ * \brief Compute the stamps for a point spread function
+ *
+ * \param psf			the point spread function
+ * \param angularpixelsize	angular size of a pixel in radians
+ * \param maxradius		maximum radius of the stamps in pixels
+ * \param phases		number of sub pixel phases in each direction
+ */
+PointSpreadFunctionStamps::PointSpreadFunctionStamps(
+	const PointSpreadFunction& psf, double angularpixelsize,
+	int maxradius, int phases) : _phases(phases), _radius(1) {
+	if ((phases < 1) || (maxradius < 1)) {
+		std::string	msg = stringprintf("bad stamp parameters: "
+			"phases = %d, maxradius = %d", phases, maxradius);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+
+	// a Dirac point spread function is distributed over the four
+	// neighbouring pixels, as ChartFactoryBase::draw does it
+	bool	dirac = (NULL != dynamic_cast<const DiracPointSpreadFunction*>(
+				&psf));
+
+	// find the radius outside which the psf is negligible
+	if (!dirac) {
+		std::vector<double>	profile;
+		double	peak = 0;
+		for (double r = 0; r <= maxradius + 1; r += 0.25) {
+			double	v = fabs(evaluate(psf, r, angularpixelsize));
+			profile.push_back(v);
+			if (v > peak) {
+				peak = v;
+			}
+		}
+		double	last = 0;
+		for (size_t i = 0; i < profile.size(); i++) {
+			if (profile[i] > threshold * peak) {
+				last = 0.25 * i;
+			}
+		}
+		_radius = std::min(maxradius, (int)ceil(last) + 1);
+	}
+
+	// compute the stamps
+	int	w = width();
+	_values.resize(_phases * _phases * w * w, 0.);
+	for (int yphase = 0; yphase < _phases; yphase++) {
+		double	fy = yphase / (double)_phases;
+		for (int xphase = 0; xphase < _phases; xphase++) {
+			double	fx = xphase / (double)_phases;
+			double	*s = &_values[(yphase * _phases + xphase) * w * w];
+			if (dirac) {
+				s[_radius * w + _radius] = (1 - fx) * (1 - fy);
+				s[_radius * w + _radius + 1] = fx * (1 - fy);
+				s[(_radius + 1) * w + _radius] = (1 - fx) * fy;
+				s[(_radius + 1) * w + _radius + 1] = fx * fy;
+				continue;
+			}
+			for (int dy = -_radius; dy <= _radius; dy++) {
+				for (int dx = -_radius; dx <= _radius; dx++) {
+					s[(dy + _radius) * w + dx + _radius]
+						= evaluate(psf,
+							hypot(dx - fx, dy - fy),
+							angularpixelsize);
+				}
+			}
+		}
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%d x %d stamps of radius %d",
+		_phases, _phases, _radius);
+}
+
+/**
+ * \brief Get the stamp for a sub pixel phase
+ *
+ * The stamp is a width() x width() array, the center of the star is
+ * at index radius() in both directions, shifted by the phase.
+ */
+const double	*PointSpreadFunctionStamps::stamp(int xphase, int yphase) const {
+	int	w = width();
+	return &_values[(yphase * _phases + xphase) * w * w];
+}
+
+} // namespace catalog
+} // namespace astro
@@ -0,0 +1,125 @@
+/*
+ * SkyTiling.cpp -- tiling of the sky into zones and cells
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include "StarIndex.h"
+#include <AstroFormat.h>
+#include <AstroDebug.h>
+#include <algorithm>
+#include <cmath>
+
+namespace astro {
+namespace catalog {
+
+/**
+ * \brief Create a tiling with zones of a given height
+ *
+ * \param zoneheight	height of the declination zones in radians
+ */
+SkyTiling::SkyTiling(double zoneheight) : _zoneheight(zoneheight) {
+	if ((zoneheight <= 0) || (zoneheight > M_PI)) {
+		std::string	msg = stringprintf("bad zone height %f",
+			zoneheight);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	int	nzones = ceil(M_PI / _zoneheight - 1e-9);
+	_firsttile.reserve(nzones + 1);
+	_firsttile.push_back(0);
+	uint32_t	first = 0;
+	for (int z = 0; z < nzones; z++) {
+		first += cells(z);
+		_firsttile.push_back(first);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "tiling with %d zones, %u tiles",
+		nzones, tiles());
+}
+
+/**
+ * \brief Number of cells in a zone
+ */
+uint32_t	SkyTiling::cells(int zone) const {
+	double	dec = -M_PI / 2 + (zone + 0.5) * _zoneheight;
+	int	n = ceil(2 * M_PI * cos(dec) / _zoneheight);
+	return (n < 1) ? 1 : n;
+}
+
+/**
+ * \brief Zone containing a declination
+ */
+int	SkyTiling::zone(double dec) const {
+	int	z = floor((dec + M_PI / 2) / _zoneheight);
+	if (z < 0) {
+		return 0;
+	}
+	if (z >= zones()) {
+		return zones() - 1;
+	}
+	return z;
+}
+
+/**
+ * \brief Tile containing a position
+ */
+uint32_t	SkyTiling::tile(double ra, double dec) const {
+	int	z = zone(dec);
+	uint32_t	n = cells(z);
+	double	r = ra - 2 * M_PI * floor(ra / (2 * M_PI));
+	uint32_t	c = floor(n * r / (2 * M_PI));
+	if (c >= n) {
+		c = n - 1;
+	}
+	return _firsttile[z] + c;
+}
+
+/**
+ * \brief Center of a tile
+ */
+RaDec	SkyTiling::center(uint32_t tile) const {
+	if (tile >= tiles()) {
+		std::string	msg = stringprintf("bad tile %u", tile);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	int	z = std::upper_bound(_firsttile.begin(), _firsttile.end(), tile)
+			- _firsttile.begin() - 1;
+	double	dec = -M_PI / 2 + (z + 0.5) * _zoneheight;
+	if (dec > M_PI / 2) {
+		dec = M_PI / 2;
+	}
+	double	ra = 2 * M_PI * (tile - _firsttile[z] + 0.5) / cells(z);
+	return RaDec(Angle(ra), Angle(dec));
+}
+
+/**
+ * \brief Tiles touching a window
+ */
+std::vector<uint32_t>	SkyTiling::tiles(const SkyWindow& window) const {
+	std::vector<uint32_t>	result;
+	double	bottom = window.center().dec().radians()
+			- window.decheight().radians() / 2;
+	double	top = window.center().dec().radians()
+			+ window.decheight().radians() / 2;
+	double	width = window.rawidth().radians();
+	double	left = window.center().ra().radians() - width / 2;
+	left = left - 2 * M_PI * floor(left / (2 * M_PI));
+	int	zmax = zone(top);
+	for (int z = zone(bottom); z <= zmax; z++) {
+		uint32_t	n = cells(z);
+		double	cellwidth = 2 * M_PI / n;
+		int	cstart = floor(left / cellwidth);
+		int	cend = floor((left + width) / cellwidth);
+		if ((width >= 2 * M_PI - 1e-9) || (cend - cstart + 1 >= (int)n)) {
+			cstart = 0;
+			cend = n - 1;
+		}
+		for (int c = cstart; c <= cend; c++) {
+			result.push_back(_firsttile[z] + (c % n));
+		}
+	}
+	return result;
+}
+
+} // namespace catalog
+} // namespace astro
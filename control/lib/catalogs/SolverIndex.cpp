@@ -0,0 +1,434 @@
+/*
+ * SolverIndex.cpp -- geometric hash index of star quads for plate solving
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroSolver.h>
+#include "StarIndex.h"
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroUtils.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace astro {
+namespace catalog {
+
+const float	SolverIndex::binsize = 0.02;
+const char	*SolverIndex::magic = "ASTRSLV1";
+
+/**
+ * \brief Maximum number of stars of a neighbourhood used to form quads
+ */
+#define	QUADSTARS	8
+
+/**
+ * \brief Maximum number of quads formed around each tile
+ */
+#define	QUADSPERTILE	16
+
+/**
+ * \brief Header of an index file
+ */
+struct SolverIndexHeader {
+	char	magic[8];
+	uint32_t	version;
+	uint32_t	tiles;
+	double	quadsize;
+	uint64_t	nstars;
+	uint64_t	nquads;
+};
+
+/**
+ * \brief Compute the code of a quad
+ *
+ * The two points furthest apart are A and B, the code consists of the
+ * coordinates of the other two points C and D in the frame where A is
+ * (0,0) and B is (1,1). The symmetries of this construction are broken
+ * by requiring xc + xd <= 1 and xc <= xd.
+ *
+ * \param points	the four points of the quad
+ * \param code		the code (xc, yc, xd, yd)
+ * \param order		indices of the points A, B, C and D
+ * \return		false if the quad is degenerate
+ */
+bool	SolverIndex::code(const Point points[4], float code[4], int order[4]) {
+	// find the pair of points furthest apart
+	int	a = 0, b = 1;
+	double	dmax = -1;
+	for (int i = 0; i < 4; i++) {
+		for (int j = i + 1; j < 4; j++) {
+			double	d = (points[j] - points[i]).abs();
+			if (d > dmax) {
+				dmax = d;
+				a = i;
+				b = j;
+			}
+		}
+	}
+	if (dmax <= 0) {
+		return false;
+	}
+	int	c = -1, d = -1;
+	for (int i = 0; i < 4; i++) {
+		if ((i != a) && (i != b)) {
+			if (c < 0) { c = i; } else { d = i; }
+		}
+	}
+
+	// coordinates in the frame of A and B
+	Point	ab = points[b] - points[a];
+	double	l2 = ab.x() * ab.x() + ab.y() * ab.y();
+	double	xy[4];
+	int	cd[2] = { c, d };
+	for (int k = 0; k < 2; k++) {
+		Point	z = points[cd[k]] - points[a];
+		double	u = (z.x() * ab.x() + z.y() * ab.y()) / l2;
+		double	v = (z.y() * ab.x() - z.x() * ab.y()) / l2;
+		xy[2 * k] = u - v;
+		xy[2 * k + 1] = u + v;
+	}
+
+	// break the symmetries
+	if (xy[0] + xy[2] > 1) {
+		std::swap(a, b);
+		for (int i = 0; i < 4; i++) {
+			xy[i] = 1 - xy[i];
+		}
+	}
+	if (xy[0] > xy[2]) {
+		std::swap(c, d);
+		std::swap(xy[0], xy[2]);
+		std::swap(xy[1], xy[3]);
+	}
+	order[0] = a; order[1] = b; order[2] = c; order[3] = d;
+	for (int i = 0; i < 4; i++) {
+		code[i] = xy[i];
+	}
+	return true;
+}
+
+/**
+ * \brief Hash bin of a code coordinate
+ */
+static inline int	codebin(float c) {
+	int	q = floor((c + 1) / SolverIndex::binsize);
+	return (q < 0) ? 0 : ((q > 255) ? 255 : q);
+}
+
+static inline uint32_t	codekey(const int q[4]) {
+	return (q[0] << 24) | (q[1] << 16) | (q[2] << 8) | q[3];
+}
+
+/**
+ * \brief Build the lookup table of quad codes
+ */
+void	SolverIndex::buildhash() {
+	_hash.resize(_quads.size());
+	for (size_t i = 0; i < _quads.size(); i++) {
+		int	q[4];
+		for (int k = 0; k < 4; k++) {
+			q[k] = codebin(_quads[i].code[k]);
+		}
+		_hash[i] = std::make_pair(codekey(q), (uint32_t)i);
+	}
+	std::sort(_hash.begin(), _hash.end());
+}
+
+/**
+ * \brief Indices of the index stars within radius of a point
+ */
+std::vector<uint32_t>	SolverIndex::stars(const RaDec& center,
+		double radius) const {
+	std::vector<uint32_t>	result;
+	double	dec = center.dec().radians();
+	double	width = 2 * M_PI;
+	if (fabs(dec) + radius < M_PI / 2) {
+		width = std::min(2 * M_PI, 2 * asin(sin(radius) / cos(dec))
+				+ 1e-9);
+	}
+	SkyWindow	window(center, Angle(width), Angle(2 * radius));
+	UnitVector	c(center);
+	double	cosradius = cos(radius);
+	std::vector<uint32_t>	tiles = _tiling->tiles(window);
+	std::vector<uint32_t>::const_iterator	t;
+	for (t = tiles.begin(); t != tiles.end(); t++) {
+		for (uint64_t i = _tileoffsets[*t]; i < _tileoffsets[*t + 1];
+			i++) {
+			UnitVector	s(RaDec(Angle(_stars[i].ra),
+						Angle(_stars[i].dec)));
+			if (s * c >= cosradius) {
+				result.push_back(i);
+			}
+		}
+	}
+	return result;
+}
+
+/**
+ * \brief Find the quads with a code close to a given code
+ */
+std::vector<uint32_t>	SolverIndex::candidates(const float code[4],
+		float tolerance) const {
+	std::vector<uint32_t>	result;
+	int	lo[4], hi[4];
+	for (int k = 0; k < 4; k++) {
+		lo[k] = codebin(code[k] - tolerance);
+		hi[k] = codebin(code[k] + tolerance);
+	}
+	float	tolerance2 = tolerance * tolerance;
+	int	q[4];
+	for (q[0] = lo[0]; q[0] <= hi[0]; q[0]++)
+	for (q[1] = lo[1]; q[1] <= hi[1]; q[1]++)
+	for (q[2] = lo[2]; q[2] <= hi[2]; q[2]++)
+	for (q[3] = lo[3]; q[3] <= hi[3]; q[3]++) {
+		uint32_t	key = codekey(q);
+		std::vector<std::pair<uint32_t, uint32_t> >::const_iterator
+			i = std::lower_bound(_hash.begin(), _hash.end(),
+				std::make_pair(key, (uint32_t)0));
+		for (; (i != _hash.end()) && (i->first == key); i++) {
+			const float	*c = _quads[i->second].code;
+			float	d2 = 0;
+			for (int k = 0; k < 4; k++) {
+				d2 += (c[k] - code[k]) * (c[k] - code[k]);
+			}
+			if (d2 <= tolerance2) {
+				result.push_back(i->second);
+			}
+		}
+	}
+	return result;
+}
+
+static bool	quadless(const SolverIndex::Quad& a, const SolverIndex::Quad& b) {
+	return std::lexicographical_compare(a.star, a.star + 4,
+		b.star, b.star + 4);
+}
+
+static bool	quadequal(const SolverIndex::Quad& a,
+			const SolverIndex::Quad& b) {
+	return std::equal(a.star, a.star + 4, b.star);
+}
+
+/**
+ * \brief Build an index from a star table
+ *
+ * The sky is tiled with tiles of half the quad size, and the brightest
+ * stars of each tile are kept. Around each tile center, quads are formed
+ * from the brightest kept stars, brightest first.
+ *
+ * \param stars		stars to build the index from
+ * \param quadsize	maximum diameter of a quad in radians, should be
+ *			somewhat smaller than the field of view
+ * \param starspertile	number of stars kept in each tile
+ */
+SolverIndex::SolverIndex(const StarTable& stars, double quadsize,
+	int starspertile) : _quadsize(quadsize),
+	_tiling(new SkyTiling(quadsize / 2)) {
+	Timer	timer;
+	timer.start();
+
+	// sort the stars by tile and magnitude
+	uint32_t	ntiles = _tiling->tiles();
+	std::vector<std::pair<std::pair<uint32_t, float>, uint32_t> >	order;
+	order.reserve(stars.size());
+	for (size_t i = 0; i < stars.size(); i++) {
+		uint32_t	tile = _tiling->tile(stars.ra[i], stars.dec[i]);
+		order.push_back(std::make_pair(std::make_pair(tile,
+			stars.mag[i]), (uint32_t)i));
+	}
+	std::sort(order.begin(), order.end());
+
+	// keep the brightest stars of each tile
+	_tileoffsets.resize(ntiles + 1, 0);
+	size_t	i = 0;
+	for (uint32_t t = 0; t < ntiles; t++) {
+		_tileoffsets[t] = _stars.size();
+		int	kept = 0;
+		for (; (i < order.size()) && (order[i].first.first == t); i++) {
+			if (kept++ >= starspertile) {
+				continue;
+			}
+			IndexStar	s;
+			uint32_t	j = order[i].second;
+			s.ra = stars.ra[j];
+			s.dec = stars.dec[j];
+			s.mag = stars.mag[j];
+			s.reserved = 0;
+			_stars.push_back(s);
+		}
+	}
+	_tileoffsets[ntiles] = _stars.size();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u of %u stars kept in %u tiles",
+		_stars.size(), stars.size(), ntiles);
+
+	// form quads around each tile
+#pragma omp parallel for schedule(dynamic, 16)
+	for (uint32_t t = 0; t < ntiles; t++) {
+		RaDec	center = _tiling->center(t);
+		std::vector<uint32_t>	neighbours = this->stars(center,
+							_quadsize / 2);
+		if (neighbours.size() < 4) {
+			continue;
+		}
+		std::vector<std::pair<float, uint32_t> >	bright;
+		for (size_t k = 0; k < neighbours.size(); k++) {
+			bright.push_back(std::make_pair(
+				_stars[neighbours[k]].mag, neighbours[k]));
+		}
+		std::sort(bright.begin(), bright.end());
+		if (bright.size() > QUADSTARS) {
+			bright.resize(QUADSTARS);
+		}
+		Point	p[QUADSTARS];
+		for (size_t k = 0; k < bright.size(); k++) {
+			const IndexStar&	s = _stars[bright[k].second];
+			p[k] = WCS::tangent(center,
+				RaDec(Angle(s.ra), Angle(s.dec)));
+		}
+		std::vector<Quad>	quads;
+		int	n = bright.size();
+		for (int d = 3; (d < n) && (quads.size() < QUADSPERTILE); d++)
+		for (int c = 2; c < d; c++)
+		for (int b = 1; b < c; b++)
+		for (int a = 0; a < b; a++) {
+			if (quads.size() >= QUADSPERTILE) {
+				continue;
+			}
+			int	idx[4] = { a, b, c, d };
+			Point	points[4] = { p[a], p[b], p[c], p[d] };
+			Quad	quad;
+			int	o[4];
+			if (!code(points, quad.code, o)) {
+				continue;
+			}
+			double	diameter = (points[o[1]] - points[o[0]]).abs();
+			if ((diameter < _quadsize / 4)
+				|| (diameter > _quadsize)) {
+				continue;
+			}
+			for (int k = 0; k < 4; k++) {
+				quad.star[k] = bright[idx[o[k]]].second;
+			}
+			quads.push_back(quad);
+		}
+#pragma omp critical
+		_quads.insert(_quads.end(), quads.begin(), quads.end());
+	}
+
+	// quads found from neighbouring tiles may be the same
+	std::sort(_quads.begin(), _quads.end(), quadless);
+	_quads.erase(std::unique(_quads.begin(), _quads.end(), quadequal),
+		_quads.end());
+	buildhash();
+	timer.end();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "index with %u quads built in %.3fs",
+		_quads.size(), timer.elapsed());
+}
+
+/**
+ * \brief Read an index from a file
+ */
+SolverIndex::SolverIndex(const std::string& filename) {
+	FILE	*in = fopen(filename.c_str(), "rb");
+	if (NULL == in) {
+		std::string	msg = stringprintf("cannot open %s: %s",
+			filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	SolverIndexHeader	header;
+	bool	ok = (1 == fread(&header, sizeof(header), 1, in))
+		&& (0 == memcmp(header.magic, magic, sizeof(header.magic)))
+		&& (1 == header.version);
+	if (ok) {
+		_quadsize = header.quadsize;
+		_tiling = std::shared_ptr<SkyTiling>(
+			new SkyTiling(_quadsize / 2));
+		ok = (_tiling->tiles() == header.tiles);
+	}
+	if (ok) {
+		_tileoffsets.resize(header.tiles + 1);
+		_stars.resize(header.nstars);
+		_quads.resize(header.nquads);
+		ok = (_tileoffsets.size() == fread(_tileoffsets.data(),
+				sizeof(uint64_t), _tileoffsets.size(), in))
+			&& (_stars.size() == fread(_stars.data(),
+				sizeof(IndexStar), _stars.size(), in))
+			&& (_quads.size() == fread(_quads.data(),
+				sizeof(Quad), _quads.size(), in));
+	}
+	fclose(in);
+	if (!ok) {
+		std::string	msg = stringprintf("%s is not a solver index",
+			filename.c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	buildhash();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "index %s: %u stars, %u quads",
+		filename.c_str(), _stars.size(), _quads.size());
+}
+
+SolverIndex::~SolverIndex() {
+}
+
+/**
+ * \brief Write the index to a file
+ */
+void	SolverIndex::save(const std::string& filename) const {
+	FILE	*out = fopen(filename.c_str(), "wb");
+	if (NULL == out) {
+		std::string	msg = stringprintf("cannot create %s: %s",
+			filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	SolverIndexHeader	header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, magic, sizeof(header.magic));
+	header.version = 1;
+	header.tiles = _tiling->tiles();
+	header.quadsize = _quadsize;
+	header.nstars = _stars.size();
+	header.nquads = _quads.size();
+	bool	ok = (1 == fwrite(&header, sizeof(header), 1, out))
+		&& (_tileoffsets.size() == fwrite(_tileoffsets.data(),
+			sizeof(uint64_t), _tileoffsets.size(), out))
+		&& (_stars.size() == fwrite(_stars.data(),
+			sizeof(IndexStar), _stars.size(), out))
+		&& (_quads.size() == fwrite(_quads.data(),
+			sizeof(Quad), _quads.size(), out));
+	if ((0 != fclose(out)) || !ok) {
+		std::string	msg = stringprintf("cannot write %s",
+			filename.c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+}
+
+static std::mutex	indexes_mutex;
+static std::map<std::string, SolverIndexPtr>	indexes;
+
+/**
+ * \brief Get an index file, loading it only once per process
+ */
+SolverIndexPtr	SolverIndex::get(const std::string& filename) {
+	std::unique_lock<std::mutex>	lock(indexes_mutex);
+	std::map<std::string, SolverIndexPtr>::iterator	i
+		= indexes.find(filename);
+	if (i != indexes.end()) {
+		return i->second;
+	}
+	SolverIndexPtr	index(new SolverIndex(filename));
+	indexes.insert(std::make_pair(filename, index));
+	return index;
+}
+
+} // namespace catalog
+} // namespace astro
@@ -0,0 +1,114 @@
+/*
+ * StampRenderer.cpp -- render stars by accumulating PSF stamps
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroChart.h>
+#include <AstroDebug.h>
+#include <AstroUtils.h>
+#include <cmath>
+
+namespace astro {
+namespace catalog {
+
+StampRenderer::StampRenderer(const PointSpreadFunctionStamps& stamps,
+	int tileheight) : _stamps(stamps), _tileheight(tileheight) {
+	if (_tileheight < 1) {
+		_tileheight = 1;
+	}
+}
+
+/**
+ * \brief Star reduced to the stamp and its position
+ */
+struct StampPlacement {
+	int	x;
+	int	y;
+	const double	*stamp;
+	double	intensity;
+};
+
+/**
+ * \brief Draw stars given by columns of coordinates and intensities
+ *
+ * Stars with zero intensity or whose stamp does not touch the image are
+ * skipped. Each band of the image is only written by a single thread, so
+ * no synchronization is needed.
+ */
+void	StampRenderer::operator()(Image<double>& image,
+		const std::vector<double>& x, const std::vector<double>& y,
+		const std::vector<double>& intensity) const {
+	Timer	timer;
+	timer.start();
+	int	width = image.size().width();
+	int	height = image.size().height();
+	int	radius = _stamps.radius();
+	int	w = _stamps.width();
+	int	phases = _stamps.phases();
+	int	nbands = (height + _tileheight - 1) / _tileheight;
+
+	// find the stamp for each star and sort the stars into bands
+	std::vector<StampPlacement>	placements;
+	placements.reserve(x.size());
+	std::vector<std::vector<uint32_t> >	bands(nbands);
+	for (size_t i = 0; i < x.size(); i++) {
+		if ((intensity[i] == 0) || !std::isfinite(x[i])
+			|| !std::isfinite(y[i])) {
+			continue;
+		}
+		// reject stars far outside before converting to int
+		if ((x[i] < -radius - 1) || (x[i] > width + radius)
+			|| (y[i] < -radius - 1) || (y[i] > height + radius)) {
+			continue;
+		}
+		StampPlacement	p;
+		p.x = floor(x[i]);
+		p.y = floor(y[i]);
+		int	xphase = lround((x[i] - p.x) * phases);
+		int	yphase = lround((y[i] - p.y) * phases);
+		if (xphase == phases) { p.x++; xphase = 0; }
+		if (yphase == phases) { p.y++; yphase = 0; }
+		if ((p.x + radius < 0) || (p.x - radius >= width)
+			|| (p.y + radius < 0) || (p.y - radius >= height)) {
+			continue;
+		}
+		p.stamp = _stamps.stamp(xphase, yphase);
+		p.intensity = intensity[i];
+		int	first = std::max(0, p.y - radius) / _tileheight;
+		int	last = std::min(height - 1, p.y + radius) / _tileheight;
+		for (int b = first; b <= last; b++) {
+			bands[b].push_back(placements.size());
+		}
+		placements.push_back(p);
+	}
+
+	// render the bands in parallel
+#pragma omp parallel for schedule(dynamic)
+	for (int b = 0; b < nbands; b++) {
+		int	ymin = b * _tileheight;
+		int	ymax = std::min(height, ymin + _tileheight) - 1;
+		std::vector<uint32_t>::const_iterator	i;
+		for (i = bands[b].begin(); i != bands[b].end(); i++) {
+			const StampPlacement&	p = placements[*i];
+			int	y0 = std::max(ymin, p.y - radius);
+			int	y1 = std::min(ymax, p.y + radius);
+			int	x0 = std::max(0, p.x - radius);
+			int	x1 = std::min(width - 1, p.x + radius);
+			for (int yy = y0; yy <= y1; yy++) {
+				const double	*s = p.stamp
+					+ (yy - p.y + radius) * w - p.x + radius;
+				double	*row = image.pixels + yy * width;
+				for (int xx = x0; xx <= x1; xx++) {
+					row[xx] += p.intensity * s[xx];
+				}
+			}
+		}
+	}
+	timer.end();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u of %u stars rendered in %d bands "
+		"in %.3fs", placements.size(), x.size(), nbands,
+		timer.elapsed());
+}
+
+} // namespace catalog
+} // namespace astro
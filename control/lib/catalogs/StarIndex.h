@@ -0,0 +1,123 @@
+/*
+ * StarIndex.h -- tiled, magnitude sorted binary star index
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _StarIndex_h
+#define _StarIndex_h
+
+#include <AstroCatalog.h>
+#include <cstdio>
+#include <vector>
+
+namespace astro {
+namespace catalog {
+
+/**
+ * \brief Tiling of the sky used by the star index
+ *
+ * The sky is cut into declination zones of equal height, and each zone
+ * is divided into cells of equal right ascension width, the number of
+ * cells chosen such that the cells are roughly square. Tiles are numbered
+ * zone by zone, starting at the south pole. The tiling is completely
+ * determined by the zone height.
+ */
+class SkyTiling {
+	double	_zoneheight;
+	std::vector<uint32_t>	_firsttile;
+public:
+	double	zoneheight() const { return _zoneheight; }
+	SkyTiling(double zoneheight);
+	int	zones() const { return _firsttile.size() - 1; }
+	uint32_t	tiles() const { return _firsttile.back(); }
+	uint32_t	cells(int zone) const;
+	int	zone(double dec) const;
+	uint32_t	tile(double ra, double dec) const;
+	RaDec	center(uint32_t tile) const;
+	std::vector<uint32_t>	tiles(const SkyWindow& window) const;
+};
+
+/**
+ * \brief Header of a star index file
+ */
+struct StarIndexHeader {
+	char	magic[8];
+	uint32_t	version;
+	uint32_t	tiles;
+	double	zoneheight;	// radians
+	uint64_t	nstars;
+};
+
+/**
+ * \brief Star record of a star index file
+ */
+struct StarIndexRecord {
+	uint32_t	ra;		// milliarcseconds
+	int32_t		dec;		// milliarcseconds
+	float	pmra;			// radians per year
+	float	pmdec;			// radians per year
+	float	mag;
+	char	catalog;
+	char	reserved[3];
+	uint64_t	catalognumber;
+};
+
+/**
+ * \brief Catalog backend based on a star index file
+ *
+ * The index file contains a header, the offsets of the first star of
+ * each tile, and the star records, grouped by tile and sorted by
+ * magnitude within each tile. The file is mapped into memory, so a
+ * window query up to some limiting magnitude only touches the prefixes
+ * of the few tiles covering the window.
+ */
+class IndexBackend : public Catalog {
+	const char	*_data;
+	size_t	_length;
+	const StarIndexHeader	*_header;
+	const uint64_t	*_offsets;
+	const StarIndexRecord	*_stars;
+	SkyTiling	*_tiling;
+	void	add(StarTable& table, uint32_t tile, const SkyWindow& window,
+			const MagnitudeRange& magrange) const;
+public:
+	static const char	*magic;
+	IndexBackend(const std::string& indexfilename);
+	virtual ~IndexBackend();
+	virtual Star	find(const std::string& name);
+	virtual Catalog::starsetptr	find(const SkyWindow& window,
+						const MagnitudeRange& magrange);
+	virtual StarTablePtr	findTable(const SkyWindow& window,
+						const MagnitudeRange& magrange);
+	virtual unsigned long	numberOfStars();
+};
+
+/**
+ * \brief Class to create a star index file
+ *
+ * Stars added are appended to an unlinked scratch file together with
+ * their tile number, so the memory needed does not depend on the size
+ * of the catalog. The finalize method distributes the stars to their
+ * tiles in the index file and sorts each tile by magnitude.
+ */
+class IndexBackendCreator {
+	std::string	_filename;
+	SkyTiling	_tiling;
+	FILE	*_scratch;
+	std::vector<uint64_t>	_counts;
+	uint64_t	_nstars;
+	// prevent copying
+	IndexBackendCreator(const IndexBackendCreator& other);
+	IndexBackendCreator&	operator=(const IndexBackendCreator& other);
+public:
+	IndexBackendCreator(const std::string& filename, double zoneheight);
+	~IndexBackendCreator();
+	uint64_t	count() const { return _nstars; }
+	void	add(const Star& star);
+	void	finalize();
+};
+
+} // namespace catalog
+} // namespace astro
+
+#endif /* _StarIndex_h */
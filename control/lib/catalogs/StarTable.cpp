@@ -0,0 +1,165 @@
+/*
+ * StarTable.cpp -- columnar star query results
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroCatalog.h>
+#include <AstroFormat.h>
+#include <AstroDebug.h>
+
+namespace astro {
+namespace catalog {
+
+/**
+ * \brief Reserve space for n stars in all columns
+ */
+void	StarTable::reserve(size_t n) {
+	ra.reserve(n);
+	dec.reserve(n);
+	pmra.reserve(n);
+	pmdec.reserve(n);
+	mag.reserve(n);
+	catalog.reserve(n);
+	catalognumber.reserve(n);
+}
+
+/**
+ * \brief Remove all stars from the table
+ */
+void	StarTable::clear() {
+	ra.clear();
+	dec.clear();
+	pmra.clear();
+	pmdec.clear();
+	mag.clear();
+	catalog.clear();
+	catalognumber.clear();
+	_names.clear();
+}
+
+/**
+ * \brief Add a star given by its attributes
+ */
+void	StarTable::add(double _ra, double _dec, float _pmra, float _pmdec,
+		float _mag, char _catalog, uint64_t _catalognumber) {
+	ra.push_back(_ra);
+	dec.push_back(_dec);
+	pmra.push_back(_pmra);
+	pmdec.push_back(_pmdec);
+	mag.push_back(_mag);
+	catalog.push_back(_catalog);
+	catalognumber.push_back(_catalognumber);
+}
+
+/**
+ * \brief Add a star object
+ *
+ * The name of the star is only kept if it cannot be derived from the
+ * catalog number.
+ */
+void	StarTable::add(const Star& star) {
+	if (!hasname(star.catalog())) {
+		_names.insert(std::make_pair(size(), star.name()));
+	}
+	add(star.ra().radians(), star.dec().radians(),
+		star.pm().ra().radians(), star.pm().dec().radians(),
+		star.mag(), star.catalog(), star.catalognumber());
+}
+
+/**
+ * \brief Append all stars of another table
+ */
+void	StarTable::append(const StarTable& other) {
+	size_t	offset = size();
+	ra.insert(ra.end(), other.ra.begin(), other.ra.end());
+	dec.insert(dec.end(), other.dec.begin(), other.dec.end());
+	pmra.insert(pmra.end(), other.pmra.begin(), other.pmra.end());
+	pmdec.insert(pmdec.end(), other.pmdec.begin(), other.pmdec.end());
+	mag.insert(mag.end(), other.mag.begin(), other.mag.end());
+	catalog.insert(catalog.end(), other.catalog.begin(),
+		other.catalog.end());
+	catalognumber.insert(catalognumber.end(), other.catalognumber.begin(),
+		other.catalognumber.end());
+	std::map<size_t, std::string>::const_iterator	i;
+	for (i = other._names.begin(); i != other._names.end(); i++) {
+		_names.insert(std::make_pair(offset + i->first, i->second));
+	}
+}
+
+/**
+ * \brief Position of star i
+ */
+RaDec	StarTable::position(size_t i) const {
+	return RaDec(Angle(ra[i]), Angle(dec[i]));
+}
+
+/**
+ * \brief Whether the name of a star can be derived from its catalog number
+ */
+bool	StarTable::hasname(char catalog) {
+	switch (catalog) {
+	case 'B':
+	case 'H':
+	case 'T':
+	case 'U':
+		return true;
+	}
+	return false;
+}
+
+/**
+ * \brief Derive the name of a star from catalog and catalog number
+ *
+ * The names are the same as those the catalog backends assign to
+ * the stars they read.
+ */
+std::string	StarTable::name(char catalog, uint64_t catalognumber) {
+	switch (catalog) {
+	case 'B':
+		return stringprintf("BSC%04d", (int)catalognumber);
+	case 'H':
+		return stringprintf("HIP%06u", (unsigned int)catalognumber);
+	case 'T':
+		return stringprintf("T%04u %05u %u",
+			(unsigned int)(catalognumber / 1000000),
+			(unsigned int)((catalognumber / 10) % 100000),
+			(unsigned int)(catalognumber % 10));
+	case 'U':
+		return stringprintf("UCAC4-%03hu-%06u",
+			(unsigned short)(catalognumber / 1000000),
+			(unsigned int)(catalognumber % 1000000));
+	}
+	std::string	msg = stringprintf("cannot derive name for catalog '%c'",
+		catalog);
+	debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+	throw std::runtime_error(msg);
+}
+
+/**
+ * \brief Name of star i
+ */
+std::string	StarTable::name(size_t i) const {
+	std::map<size_t, std::string>::const_iterator	n = _names.find(i);
+	if (n != _names.end()) {
+		return n->second;
+	}
+	return name(catalog[i], catalognumber[i]);
+}
+
+/**
+ * \brief Convert a row of the table into a Star object
+ */
+Star	StarTable::star(size_t i) const {
+	Star	result(name(i));
+	result.ra() = Angle(ra[i]);
+	result.dec() = Angle(dec[i]);
+	result.pm().ra() = Angle(pmra[i]);
+	result.pm().dec() = Angle(pmdec[i]);
+	result.mag(mag[i]);
+	result.catalog(catalog[i]);
+	result.catalognumber(catalognumber[i]);
+	return result;
+}
+
+} // namespace catalog
+} // namespace astro
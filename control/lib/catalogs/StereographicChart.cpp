@@ -30,18 +30,12 @@ StereographicChart	StereographicChartFactory::chart(const RaDec& center,
 
 	// get all stars from the catalog (you better don't have the 
 	// limiting magnitude too large)
-	Catalog::starsetptr	stars = _catalog->find(SkyWindow::all,
+	StarTablePtr	stars = _catalog->findTable(SkyWindow::all,
 					MagnitudeRange(-30, limit_magnitude()));
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "got %u stars", stars->size());
 
 	// draw all the stars
-	draw(*(chart._image), projection, stars);
-
-	// apply point spread function
-	// XXX for the spread function we need the geometry, but we don't have
-	//     that in this case, so we must compute the geometry from
-	//     from the data we have first
-	//spread(*chart._image, 100, geometry)
+	draw(*(chart._image), projection, *stars);
 
 	// limit
 	limit(*chart._image, 1.);
@@ -71,6 +65,17 @@ void	StereographicChartFactory::draw(Image<double>& image,
 	}
 }
 
+void	StereographicChartFactory::draw(Image<double>& image,
+		const StereographicProjection& projection,
+		const StarTable& stars) const {
+	double	m = image.size().width() / 2;
+	Point	center = image.size().center();
+	for (size_t i = 0; i < stars.size(); i++) {
+		Point	p = projection(stars.position(i)) * m + center;
+		ChartFactoryBase::draw(image, p, stars.mag[i]);
+	}
+}
+
 void	StereographicChartFactory::draw(Image<double>& image,
 	const StereographicProjection& projection, const Star& star) const {
 	// where
@@ -133,35 +133,37 @@ bool	Ucac4::touches(uint16_t zone, const SkyWindow& window) {
  */
 Catalog::starsetptr	Ucac4::find(const SkyWindow& window,
 				const MagnitudeRange& magrange) {
-	// prepare the empty result set
-	Ucac4Zone::starsetptr	resultptr(new Ucac4Zone::starset());
-
-	// find minimum an maximum zone numbers
-	std::pair<uint16_t, uint16_t>	interval = zoneinterval(window);
-	uint16_t	minzone = interval.first;
-	uint16_t	maxzone = interval.second;
-
-	// iterate through zone numbers
-	uint32_t	counter = 0;
-	for (uint16_t zoneno = minzone; zoneno <= maxzone; zoneno++) {
-		Ucac4ZonePtr	z = zone(zoneno);
-		z->add(resultptr, window, magrange);
-	}
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u stars found, %u in set", counter,
-		resultptr->size());
-
-	// now copy everything into a set of normal stars
+	StarTablePtr	table = findTable(window, magrange);
 	Catalog::starsetptr	starresult
 		= Catalog::starsetptr(new Catalog::starset());
-	Ucac4Zone::starset::const_iterator	i;
-	for (i = resultptr->begin(); i != resultptr->end(); i++) {
-		starresult->insert(*i);
+	for (size_t i = 0; i < table->size(); i++) {
+		starresult->insert(table->star(i));
 	}
-
-	// thats it
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u stars found, %u in set",
+		table->size(), starresult->size());
 	return starresult;
 }
 
+/**
+ * \brief Retrieve all stars in a window as a columnar table
+ *
+ * The table is filled directly from the zone files, no star objects
+ * are created.
+ */
+StarTablePtr	Ucac4::findTable(const SkyWindow& window,
+				const MagnitudeRange& magrange) {
+	StarTablePtr	result(new StarTable());
+
+	// find minimum an maximum zone numbers
+	std::pair<uint16_t, uint16_t>	interval = zoneinterval(window);
+	for (uint16_t zoneno = interval.first; zoneno <= interval.second;
+		zoneno++) {
+		zone(zoneno)->add(*result, window, magrange);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u stars found", result->size());
+	return result;
+}
+
 CatalogIterator	Ucac4::findIter(const SkyWindow& window,
 	const MagnitudeRange& magrange) {
 	IteratorImplementationPtr	impl(
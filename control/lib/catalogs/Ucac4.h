@@ -81,6 +81,9 @@ public:
  */
 class Ucac4Zone : public MappedFile {
 	uint16_t	_zone;
+	double	ra(uint32_t number) const;
+	void	add(StarTable& table, uint32_t minnumber, uint32_t maxnumber,
+			const MagnitudeRange& magrange) const;
 public:
 	uint16_t	zone() const { return _zone; }
 	uint32_t	nstars() const { return nrecords(); }
@@ -97,6 +100,8 @@ public:
 				const MagnitudeRange& magrange);
 	starsetptr	add(starsetptr set, const SkyWindow& window,
 				const MagnitudeRange& magrange);
+	void	add(StarTable& table, const SkyWindow& window,
+				const MagnitudeRange& magrange) const;
 	unsigned long	numberOfStars();
 
 	CatalogIterator	begin();
@@ -160,6 +165,8 @@ public:
 					const MagnitudeRange& magrange);
 	virtual CatalogIterator	findIter(const SkyWindow& window,
 					const MagnitudeRange& magrange);
+	virtual StarTablePtr	findTable(const SkyWindow& window,
+					const MagnitudeRange& magrange);
 	virtual unsigned long	numberOfStars();
 	virtual CatalogIterator	begin();
 };
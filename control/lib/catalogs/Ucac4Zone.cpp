@@ -96,34 +96,38 @@ Ucac4Star	Ucac4Zone::get(uint32_t number) const {
 	return UCAC4_to_Ucac4Star(_zone, number, (UCAC4_STAR *)line.data());
 }
 
+/**
+ * \brief Get the right ascension of a star directly from the record
+ */
+double	Ucac4Zone::ra(uint32_t number) const {
+	const UCAC4_STAR	*star = (const UCAC4_STAR *)record(number - 1);
+	return MARCSEC_to_RADIANS * star->ra;
+}
+
 /**
  * \brief Get the first star number exceeding the ra
+ *
+ * The binary search only looks at the right ascension fields of the
+ * records, so no star objects are constructed.
  */
 uint32_t	Ucac4Zone::first(const Angle& ra) const {
 	// get the last star an make sure the 
-	Ucac4Star	laststar = get(nstars() - 1);
-	if (laststar.ra() < ra) {
+	double	r = ra.radians();
+	if (this->ra(nstars() - 1) < r) {
 		return nstars();
 	}
 
 	// search in the interval
 	uint32_t	l1 = 1, l2 = nstars();
-	Angle	ra1 = get(l1).ra();
-	Angle	ra2 = get(l2).ra();
 	while ((l2 - l1) > 1) {
 		uint32_t	l = (l1 + l2) / 2;
-		//debug(LOG_DEBUG, DEBUG_LOG, 0, "new subdivision: %lu", l);
-		Angle	ra0 = get(l).ra();
-		if (ra0 < ra) {
+		double	ra0 = this->ra(l);
+		if (ra0 < r) {
 			l1 = l;
-			ra1 = ra0;
 		}
-		if (ra <= ra0) {
+		if (r <= ra0) {
 			l2 = l;
-			ra2 = ra0;
 		}
-		//debug(LOG_DEBUG, DEBUG_LOG, 0, "%u,%u = %f < %f <= %f",
-		//	l1, l2, ra1.hours(), ra.hours(), ra2.hours());
 	}
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "first: %lu", l2);
 	return l2;
@@ -177,6 +181,50 @@ Ucac4Zone::starsetptr	Ucac4Zone::add(Ucac4Zone::starsetptr set,
 	return set;
 }
 
+/**
+ * \brief Add the stars with numbers in [minnumber, maxnumber) to a table
+ *
+ * The records are converted directly from the mapped file, only the
+ * fields needed in the table are evaluated.
+ */
+void	Ucac4Zone::add(StarTable& table, uint32_t minnumber, uint32_t maxnumber,
+		const MagnitudeRange& magrange) const {
+	for (uint32_t number = minnumber; number < maxnumber; number++) {
+		const UCAC4_STAR	*star
+			= (const UCAC4_STAR *)record(number - 1);
+		float	mag = star->mag1 * 0.001;
+		if (!magrange.contains(mag)) {
+			continue;
+		}
+		double	dec = MARCSEC_to_RADIANS * star->spd - M_PI / 2;
+		table.add(MARCSEC_to_RADIANS * star->ra, dec,
+			MARCSEC_to_RADIANS * star->pm_ra / cos(dec),
+			MARCSEC_to_RADIANS * star->pm_dec, mag, 'U',
+			Ucac4StarNumber(_zone, number).catalognumber());
+	}
+}
+
+/**
+ * \brief Add the stars of a window to a table
+ *
+ * This selects the same stars as the set based add method.
+ */
+void	Ucac4Zone::add(StarTable& table, const SkyWindow& window,
+		const MagnitudeRange& magrange) const {
+	size_t	before = table.size();
+	uint32_t	minindex = first(window.leftra());
+	uint32_t	maxindex = first(window.rightra());
+	if (minindex < maxindex) {
+		add(table, minindex, maxindex, magrange);
+	}
+	if (maxindex < minindex) {
+		add(table, 1, maxindex, magrange);
+		add(table, minindex, nstars(), magrange);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u stars from zone %hu",
+		table.size() - before, _zone);
+}
+
 unsigned long	Ucac4Zone::numberOfStars() {
 	return nrecords();
 }
@@ -0,0 +1,153 @@
+/*
+ * WCS.cpp -- world coordinate system of a solved image
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroSolver.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroIO.h>
+#include <cmath>
+
+using namespace astro::io;
+
+namespace astro {
+namespace catalog {
+
+WCS::WCS() {
+	_cd[0] = _cd[3] = 1;
+	_cd[1] = _cd[2] = 0;
+}
+
+WCS::WCS(const RaDec& crval, const Point& crpix, const double cd[4])
+	: _crval(crval), _crpix(crpix) {
+	for (int i = 0; i < 4; i++) {
+		_cd[i] = cd[i];
+	}
+}
+
+/**
+ * \brief Angular size of a pixel in radians
+ */
+double	WCS::scale() const {
+	return sqrt(fabs(_cd[0] * _cd[3] - _cd[1] * _cd[2]));
+}
+
+/**
+ * \brief Position angle of the image y axis, from north through east
+ */
+Angle	WCS::rotation() const {
+	return Angle(atan2(_cd[1], _cd[3]));
+}
+
+/**
+ * \brief Whether the image is mirrored
+ *
+ * An image with north up and east to the left, as seen through a
+ * telescope without a diagonal, has a negative determinant.
+ */
+bool	WCS::mirrored() const {
+	return (_cd[0] * _cd[3] - _cd[1] * _cd[2]) > 0;
+}
+
+/**
+ * \brief Standard coordinates of a position in the tangent plane at center
+ *
+ * \throws std::runtime_error	if the position is more than 90 degrees
+ *				away from the center
+ */
+Point	WCS::tangent(const RaDec& center, const RaDec& position) {
+	double	d0 = center.dec().radians();
+	double	d = position.dec().radians();
+	double	da = position.ra().radians() - center.ra().radians();
+	double	cosc = sin(d0) * sin(d) + cos(d0) * cos(d) * cos(da);
+	if (cosc <= 0) {
+		throw std::runtime_error("position not in tangent hemisphere");
+	}
+	return Point(cos(d) * sin(da) / cosc,
+		(cos(d0) * sin(d) - sin(d0) * cos(d) * cos(da)) / cosc);
+}
+
+/**
+ * \brief Position on the sky of standard coordinates in the tangent plane
+ */
+RaDec	WCS::untangent(const RaDec& center, const Point& standard) {
+	double	d0 = center.dec().radians();
+	double	rho = hypot(standard.x(), standard.y());
+	if (rho == 0) {
+		return center;
+	}
+	double	c = atan(rho);
+	double	d = asin(cos(c) * sin(d0)
+			+ standard.y() * sin(c) * cos(d0) / rho);
+	double	a = center.ra().radians() + atan2(standard.x() * sin(c),
+			rho * cos(d0) * cos(c) - standard.y() * sin(d0) * sin(c));
+	a = a - 2 * M_PI * floor(a / (2 * M_PI));
+	return RaDec(Angle(a), Angle(d));
+}
+
+/**
+ * \brief Sky position of a pixel
+ */
+RaDec	WCS::operator()(const Point& pixel) const {
+	double	x = pixel.x() - _crpix.x();
+	double	y = pixel.y() - _crpix.y();
+	return untangent(_crval, Point(_cd[0] * x + _cd[1] * y,
+					_cd[2] * x + _cd[3] * y));
+}
+
+/**
+ * \brief Pixel of a sky position
+ */
+Point	WCS::operator()(const RaDec& position) const {
+	Point	s = tangent(_crval, position);
+	double	det = _cd[0] * _cd[3] - _cd[1] * _cd[2];
+	double	x = ( _cd[3] * s.x() - _cd[1] * s.y()) / det;
+	double	y = (-_cd[2] * s.x() + _cd[0] * s.y()) / det;
+	return Point(x + _crpix.x(), y + _crpix.y());
+}
+
+/**
+ * \brief Add the FITS WCS keywords to an image
+ *
+ * FITS pixel coordinates start at 1, and angles are in degrees. If the
+ * reference pixel is the image center, the center keywords used by
+ * the ImageNormalizer are set as well.
+ */
+void	WCS::addMetadata(ImageBase& image) const {
+	image.setMetadata(FITSKeywords::meta(std::string("CTYPE1"),
+		std::string("RA---TAN")));
+	image.setMetadata(FITSKeywords::meta(std::string("CTYPE2"),
+		std::string("DEC--TAN")));
+	image.setMetadata(FITSKeywords::meta(std::string("CRVAL1"),
+		_crval.ra().degrees()));
+	image.setMetadata(FITSKeywords::meta(std::string("CRVAL2"),
+		_crval.dec().degrees()));
+	image.setMetadata(FITSKeywords::meta(std::string("CRPIX1"),
+		_crpix.x() + 1));
+	image.setMetadata(FITSKeywords::meta(std::string("CRPIX2"),
+		_crpix.y() + 1));
+	// CD elements are small, so they need more digits than meta gives
+	const char	*names[4] = { "CD1_1", "CD1_2", "CD2_1", "CD2_2" };
+	for (int i = 0; i < 4; i++) {
+		image.setMetadata(FITSKeywords::meta(std::string(names[i]),
+			stringprintf("%.12g", _cd[i] * 180 / M_PI)));
+	}
+	Point	center(image.size().width() / 2., image.size().height() / 2.);
+	if ((center - _crpix).abs() < 1) {
+		image.setMetadata(FITSKeywords::meta(std::string("RACENTR"),
+			_crval.ra().hours()));
+		image.setMetadata(FITSKeywords::meta(std::string("DECCENTR"),
+			_crval.dec().degrees()));
+	}
+}
+
+std::string	WCS::toString() const {
+	return stringprintf("center %s at %s, %.3f\"/pixel, angle %.2f deg%s",
+		_crval.toString().c_str(), _crpix.toString().c_str(),
+		scale() * 180 * 3600 / M_PI, rotation().degrees(),
+		(mirrored()) ? ", mirrored" : "");
+}
+
+} // namespace catalog
+} // namespace astro
@@ -28,7 +28,7 @@ void	usage(const char *progname) {
 	std::cout << "   " << path.basename() << " [ options ] type filepath";
 	std::cout << std::endl;
 	std::cout << "<type> is one of BSC, Hipparcos, Tycho2, Ucac4, Combined,"
-		" Database." << std::endl;
+		" Database, Index." << std::endl;
 	std::cout << "Depending on <type>, the catalog at path <filepath> is "
 		"openend and" << std::endl;
 	std::cout << "the contents shown." << std::endl;
@@ -58,6 +58,9 @@ CatalogFactory::BackendType	gettype(const std::string& type) {
 	if (type == "Database") {
 		return CatalogFactory::Database;
 	}
+	if (type == "Index") {
+		return CatalogFactory::Index;
+	}
 	std::string	msg = stringprintf("'%s' is not a known backend type",
 		type.c_str());
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", msg.c_str());
@@ -0,0 +1,164 @@
+/*
+ * IndexBackendTest.cpp -- tests for the tiled star index
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include "../StarIndex.h"
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <unistd.h>
+
+using namespace astro::catalog;
+
+namespace astro {
+namespace test {
+
+#define	MARCSEC_to_RADIANS	(M_PI / (180. * 60 * 60 * 1000))
+
+class IndexBackendTest : public CppUnit::TestFixture {
+private:
+	std::string	indexfilename;
+	std::vector<Star>	stars;
+	size_t	count(const SkyWindow& window, const MagnitudeRange& magrange);
+public:
+	void	setUp();
+	void	tearDown();
+	void	testTiling();
+	void	testWindow();
+	void	testWrap();
+	void	testAll();
+	void	testName();
+
+	CPPUNIT_TEST_SUITE(IndexBackendTest);
+	CPPUNIT_TEST(testTiling);
+	CPPUNIT_TEST(testWindow);
+	CPPUNIT_TEST(testWrap);
+	CPPUNIT_TEST(testAll);
+	CPPUNIT_TEST(testName);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IndexBackendTest);
+
+/**
+ * \brief Build an index from random stars
+ *
+ * The positions are whole milliarcseconds, so they survive the round trip
+ * through the index unchanged and can be compared with a brute force scan.
+ */
+void	IndexBackendTest::setUp() {
+	indexfilename = stringprintf("/tmp/indextest-%d.idx", getpid());
+	srandom(4711);
+	stars.clear();
+	IndexBackendCreator	creator(indexfilename, M_PI / 36);
+	for (int i = 0; i < 20000; i++) {
+		Star	star(StarTable::name('H', i + 1));
+		long	ra = random() % 1296000000l;
+		long	dec = (random() % 648000001l) - 324000000l;
+		star.ra() = Angle(ra * MARCSEC_to_RADIANS);
+		star.dec() = Angle(dec * MARCSEC_to_RADIANS);
+		star.mag(0.001 * (random() % 15000));
+		star.catalog('H');
+		star.catalognumber(i + 1);
+		creator.add(star);
+		stars.push_back(star);
+	}
+	creator.finalize();
+}
+
+void	IndexBackendTest::tearDown() {
+	unlink(indexfilename.c_str());
+}
+
+size_t	IndexBackendTest::count(const SkyWindow& window,
+		const MagnitudeRange& magrange) {
+	size_t	result = 0;
+	std::vector<Star>::const_iterator	s;
+	for (s = stars.begin(); s != stars.end(); s++) {
+		if (window.contains(*s) && magrange.contains(s->mag())) {
+			result++;
+		}
+	}
+	return result;
+}
+
+void	IndexBackendTest::testTiling() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testTiling() begin");
+	SkyTiling	tiling(M_PI / 36);
+	CPPUNIT_ASSERT(tiling.zones() == 36);
+	CPPUNIT_ASSERT(tiling.cells(0) < tiling.cells(18));
+	for (int i = 0; i < 1000; i++) {
+		double	ra = 2 * M_PI * (random() / (double)RAND_MAX);
+		double	dec = M_PI * (random() / (double)RAND_MAX - 0.5);
+		uint32_t	t = tiling.tile(ra, dec);
+		CPPUNIT_ASSERT(t < tiling.tiles());
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testTiling() end");
+}
+
+void	IndexBackendTest::testWindow() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testWindow() begin");
+	IndexBackend	index(indexfilename);
+	CPPUNIT_ASSERT(index.numberOfStars() == stars.size());
+	RaDec	center;
+	center.ra().hours(5.5);
+	center.dec().degrees(-20);
+	Angle	width; width.hours(2);
+	Angle	height; height.degrees(25);
+	SkyWindow	window(center, width, height);
+	MagnitudeRange	magrange(-30, 9);
+	StarTablePtr	table = index.findTable(window, magrange);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u stars found", table->size());
+	CPPUNIT_ASSERT(table->size() == count(window, magrange));
+	for (size_t i = 0; i < table->size(); i++) {
+		CPPUNIT_ASSERT(magrange.contains(table->mag[i]));
+	}
+	Catalog::starsetptr	starset = index.find(window, magrange);
+	CPPUNIT_ASSERT(starset->size() == table->size());
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testWindow() end");
+}
+
+void	IndexBackendTest::testWrap() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testWrap() begin");
+	IndexBackend	index(indexfilename);
+	RaDec	center;
+	center.ra().hours(23.5);
+	center.dec().degrees(70);
+	Angle	width; width.hours(3);
+	Angle	height; height.degrees(30);
+	SkyWindow	window(center, width, height);
+	MagnitudeRange	magrange(-30, 12);
+	StarTablePtr	table = index.findTable(window, magrange);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u stars found", table->size());
+	CPPUNIT_ASSERT(table->size() == count(window, magrange));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testWrap() end");
+}
+
+void	IndexBackendTest::testAll() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testAll() begin");
+	IndexBackend	index(indexfilename);
+	MagnitudeRange	magrange(-30, 6);
+	StarTablePtr	table = index.findTable(SkyWindow::all, magrange);
+	CPPUNIT_ASSERT(table->size() == count(SkyWindow::all, magrange));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testAll() end");
+}
+
+void	IndexBackendTest::testName() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testName() begin");
+	IndexBackend	index(indexfilename);
+	Star	star = index.find("HIP001234");
+	CPPUNIT_ASSERT(star.catalognumber() == 1234);
+	CPPUNIT_ASSERT(star.ra().radians() == stars[1233].ra().radians());
+	CPPUNIT_ASSERT(star.mag() == (float)stars[1233].mag());
+	CPPUNIT_ASSERT_THROW(index.find("HIP999999"), std::runtime_error);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testName() end");
+}
+
+} // namespace test
+} // namespace astro
@@ -0,0 +1,191 @@
+/*
+ * PlateSolverTest.cpp -- tests for the blind plate solver
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroSolver.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <unistd.h>
+
+using namespace astro::catalog;
+using namespace astro::image;
+
+namespace astro {
+namespace test {
+
+#define	ARCSEC	(M_PI / (180 * 3600))
+
+class PlateSolverTest : public CppUnit::TestFixture {
+private:
+	static StarTable	sky;
+	static SolverIndexPtr	index;
+	std::vector<transform::Star>	image(const WCS& wcs,
+						const ImageSize& size);
+	void	solve(bool mirrored);
+public:
+	void	setUp();
+	void	tearDown();
+	void	testWCS();
+	void	testCode();
+	void	testSolve();
+	void	testMirrored();
+	void	testPersistence();
+
+	CPPUNIT_TEST_SUITE(PlateSolverTest);
+	CPPUNIT_TEST(testWCS);
+	CPPUNIT_TEST(testCode);
+	CPPUNIT_TEST(testSolve);
+	CPPUNIT_TEST(testMirrored);
+	CPPUNIT_TEST(testPersistence);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PlateSolverTest);
+
+StarTable	PlateSolverTest::sky;
+SolverIndexPtr	PlateSolverTest::index;
+
+/**
+ * \brief Create a random sky and an index with 5 degree quads, only once
+ */
+void	PlateSolverTest::setUp() {
+	if (index) {
+		return;
+	}
+	srandom(1234);
+	for (int i = 0; i < 200000; i++) {
+		double	ra = 2 * M_PI * (random() / (double)RAND_MAX);
+		double	dec = asin(2 * (random() / (double)RAND_MAX) - 1);
+		float	mag = 4 + 10 * (random() / (double)RAND_MAX);
+		sky.add(ra, dec, 0, 0, mag, 'H', i + 1);
+	}
+	index = SolverIndexPtr(new SolverIndex(sky, 5 * M_PI / 180));
+}
+
+void	PlateSolverTest::tearDown() {
+}
+
+/**
+ * \brief Synthesize the stars an image with a given WCS would contain
+ */
+std::vector<transform::Star>	PlateSolverTest::image(const WCS& wcs,
+		const ImageSize& size) {
+	std::vector<transform::Star>	result;
+	for (size_t i = 0; i < sky.size(); i++) {
+		try {
+			Point	p = wcs(sky.position(i));
+			if ((p.x() < 0) || (p.x() >= size.width())
+				|| (p.y() < 0) || (p.y() >= size.height())) {
+				continue;
+			}
+			// a little noise on the positions
+			p = p + Point(0.3 * sin(i), 0.3 * cos(1.7 * i));
+			result.push_back(transform::Star(p,
+				pow(10, -0.4 * sky.mag[i])));
+		} catch (const std::exception&) {
+		}
+	}
+	return result;
+}
+
+void	PlateSolverTest::testWCS() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testWCS() begin");
+	RaDec	center(Angle(1.2), Angle(0.7));
+	double	s = 10 * ARCSEC;
+	double	cd[4] = { -s * cos(0.3), s * sin(0.3), s * sin(0.3),
+			s * cos(0.3) };
+	WCS	wcs(center, Point(500, 400), cd);
+	CPPUNIT_ASSERT(fabs(wcs.scale() - s) < 1e-12);
+	CPPUNIT_ASSERT(!wcs.mirrored());
+	RaDec	r = wcs(Point(500, 400));
+	CPPUNIT_ASSERT(fabs(r.ra().radians() - 1.2) < 1e-12);
+	CPPUNIT_ASSERT(fabs(r.dec().radians() - 0.7) < 1e-12);
+	Point	p = wcs(wcs(Point(17, 923)));
+	CPPUNIT_ASSERT((p - Point(17, 923)).abs() < 1e-6);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testWCS() end");
+}
+
+void	PlateSolverTest::testCode() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testCode() begin");
+	Point	p[4] = { Point(0, 0), Point(10, 1), Point(3, 4), Point(6, -2) };
+	float	code[4];
+	int	order[4];
+	CPPUNIT_ASSERT(SolverIndex::code(p, code, order));
+	// rotated, scaled, shifted and reordered quad has the same code
+	Point	q[4];
+	int	perm[4] = { 2, 0, 3, 1 };
+	for (int k = 0; k < 4; k++) {
+		const Point&	z = p[perm[k]];
+		q[k] = Point(3 * (z.x() * cos(1) - z.y() * sin(1)) + 100,
+			3 * (z.x() * sin(1) + z.y() * cos(1)) - 50);
+	}
+	float	code2[4];
+	int	order2[4];
+	CPPUNIT_ASSERT(SolverIndex::code(q, code2, order2));
+	for (int k = 0; k < 4; k++) {
+		CPPUNIT_ASSERT(fabs(code[k] - code2[k]) < 1e-5);
+		CPPUNIT_ASSERT(perm[order2[k]] == order[k]);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testCode() end");
+}
+
+void	PlateSolverTest::solve(bool mirrored) {
+	RaDec	center(Angle(4.1), Angle(-0.35));
+	double	s = 20 * ARCSEC;
+	double	a = 0.52;
+	double	m = (mirrored) ? -1 : 1;
+	double	cd[4] = { -m * s * cos(a), s * sin(a), m * s * sin(a),
+			s * cos(a) };
+	ImageSize	size(1800, 1400);
+	WCS	truth(center, Point(900, 700), cd);
+	std::vector<transform::Star>	stars = image(truth, size);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u stars in image", stars.size());
+	PlateSolver	solver(index);
+	WCS	wcs = solver(stars, size);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "solution: %s", wcs.toString().c_str());
+	UnitVector	u1(wcs.crval());
+	UnitVector	u2(center);
+	CPPUNIT_ASSERT(u1.angle(u2).radians() < 2 * ARCSEC);
+	CPPUNIT_ASSERT(fabs(wcs.scale() / s - 1) < 0.001);
+	CPPUNIT_ASSERT(wcs.mirrored() == mirrored);
+	CPPUNIT_ASSERT(fabs(wcs.rotation().radians() - a) < 0.001);
+}
+
+void	PlateSolverTest::testSolve() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSolve() begin");
+	solve(false);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSolve() end");
+}
+
+void	PlateSolverTest::testMirrored() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testMirrored() begin");
+	solve(true);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testMirrored() end");
+}
+
+void	PlateSolverTest::testPersistence() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPersistence() begin");
+	std::string	filename = stringprintf("/tmp/solvertest-%d.idx",
+				getpid());
+	index->save(filename);
+	SolverIndexPtr	loaded = SolverIndex::get(filename);
+	CPPUNIT_ASSERT(loaded == SolverIndex::get(filename));
+	CPPUNIT_ASSERT(loaded->numberOfStars() == index->numberOfStars());
+	CPPUNIT_ASSERT(loaded->numberOfQuads() == index->numberOfQuads());
+	CPPUNIT_ASSERT(loaded->quadsize() == index->quadsize());
+	const SolverIndex::Quad&	q = index->quad(17);
+	std::vector<uint32_t>	c = loaded->candidates(q.code, 1e-6);
+	CPPUNIT_ASSERT(std::find(c.begin(), c.end(), 17) != c.end());
+	unlink(filename.c_str());
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPersistence() end");
+}
+
+} // namespace test
+} // namespace astro
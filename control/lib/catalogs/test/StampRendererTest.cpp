@@ -0,0 +1,142 @@
+/*
+ * StampRendererTest.cpp -- tests for the PSF stamp renderer
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroChart.h>
+#include <AstroDebug.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cmath>
+#include <iostream>
+
+using namespace astro::catalog;
+using namespace astro::image;
+
+namespace astro {
+namespace test {
+
+class StampRendererTest : public CppUnit::TestFixture {
+private:
+public:
+	void	setUp();
+	void	tearDown();
+	void	testStamps();
+	void	testDirac();
+	void	testBands();
+	void	testOutside();
+
+	CPPUNIT_TEST_SUITE(StampRendererTest);
+	CPPUNIT_TEST(testStamps);
+	CPPUNIT_TEST(testDirac);
+	CPPUNIT_TEST(testBands);
+	CPPUNIT_TEST(testOutside);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StampRendererTest);
+
+void	StampRendererTest::setUp() {
+}
+
+void	StampRendererTest::tearDown() {
+}
+
+static double	total(const Image<double>& image) {
+	double	result = 0;
+	for (unsigned int i = 0; i < image.getSize().getPixels(); i++) {
+		result += image.pixels[i];
+	}
+	return result;
+}
+
+void	StampRendererTest::testStamps() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testStamps() begin");
+	// a gaussian with sigma = 1.5 pixels
+	TurbulencePointSpreadFunction	psf(1.5);
+	PointSpreadFunctionStamps	stamps(psf, 1., 100, 4);
+	CPPUNIT_ASSERT(stamps.radius() > 5);
+	CPPUNIT_ASSERT(stamps.radius() < 15);
+	// star at phase (1/4, 3/4) must match the psf evaluated directly
+	Image<double>	image(ImageSize(64, 48));
+	image.fill(0);
+	std::vector<double>	x(1, 20.25), y(1, 30.75), I(1, 2.);
+	StampRenderer	renderer(stamps);
+	renderer(image, x, y, I);
+	for (int dy = -3; dy <= 3; dy++) {
+		for (int dx = -3; dx <= 3; dx++) {
+			double	expected = 2 * psf(hypot(20 + dx - 20.25,
+						30 + dy - 30.75));
+			CPPUNIT_ASSERT(fabs(image.pixel(20 + dx, 30 + dy)
+				- expected) < 1e-12);
+		}
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testStamps() end");
+}
+
+void	StampRendererTest::testDirac() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testDirac() begin");
+	DiracPointSpreadFunction	psf;
+	PointSpreadFunctionStamps	stamps(psf, 1., 100, 4);
+	CPPUNIT_ASSERT(stamps.radius() == 1);
+	Image<double>	image(ImageSize(16, 16));
+	image.fill(0);
+	std::vector<double>	x(1, 5.25), y(1, 7.5), I(1, 1.);
+	StampRenderer	renderer(stamps);
+	renderer(image, x, y, I);
+	CPPUNIT_ASSERT(fabs(image.pixel(5, 7) - 0.375) < 1e-12);
+	CPPUNIT_ASSERT(fabs(image.pixel(6, 7) - 0.125) < 1e-12);
+	CPPUNIT_ASSERT(fabs(image.pixel(5, 8) - 0.375) < 1e-12);
+	CPPUNIT_ASSERT(fabs(image.pixel(6, 8) - 0.125) < 1e-12);
+	CPPUNIT_ASSERT(fabs(total(image) - 1) < 1e-12);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testDirac() end");
+}
+
+void	StampRendererTest::testBands() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testBands() begin");
+	TurbulencePointSpreadFunction	psf(2.);
+	PointSpreadFunctionStamps	stamps(psf, 1., 100, 4);
+	std::vector<double>	x, y, I;
+	for (int i = 0; i < 500; i++) {
+		x.push_back(fmod(i * 37.13, 200.) - 10);
+		y.push_back(fmod(i * 17.71, 150.) - 10);
+		I.push_back(1 + (i % 7));
+	}
+	// the result must not depend on the band height
+	Image<double>	single(ImageSize(180, 130));
+	single.fill(0);
+	StampRenderer	singlerenderer(stamps, 1000);
+	singlerenderer(single, x, y, I);
+	Image<double>	banded(ImageSize(180, 130));
+	banded.fill(0);
+	StampRenderer	bandedrenderer(stamps, 3);
+	bandedrenderer(banded, x, y, I);
+	for (unsigned int i = 0; i < single.getSize().getPixels(); i++) {
+		CPPUNIT_ASSERT(fabs(single.pixels[i] - banded.pixels[i])
+			< 1e-9);
+	}
+	CPPUNIT_ASSERT(total(single) > 0);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testBands() end");
+}
+
+void	StampRendererTest::testOutside() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testOutside() begin");
+	TurbulencePointSpreadFunction	psf(1.);
+	PointSpreadFunctionStamps	stamps(psf, 1., 100, 4);
+	Image<double>	image(ImageSize(32, 32));
+	image.fill(0);
+	std::vector<double>	x, y, I;
+	x.push_back(-1e9); y.push_back(10); I.push_back(1);
+	x.push_back(10); y.push_back(1e12); I.push_back(1);
+	x.push_back(NAN); y.push_back(10); I.push_back(1);
+	x.push_back(10); y.push_back(10); I.push_back(0);
+	x.push_back(-stamps.radius() - 2); y.push_back(10); I.push_back(1);
+	StampRenderer	renderer(stamps);
+	renderer(image, x, y, I);
+	CPPUNIT_ASSERT(total(image) == 0);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testOutside() end");
+}
+
+} // namespace test
+} // namespace astro
@@ -0,0 +1,95 @@
+/*
+ * StarTableTest.cpp -- tests for the columnar star table
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroCatalog.h>
+#include <AstroDebug.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <iostream>
+
+using namespace astro::catalog;
+
+namespace astro {
+namespace test {
+
+class StarTableTest : public CppUnit::TestFixture {
+private:
+public:
+	void	setUp();
+	void	tearDown();
+	void	testNames();
+	void	testStar();
+	void	testAppend();
+
+	CPPUNIT_TEST_SUITE(StarTableTest);
+	CPPUNIT_TEST(testNames);
+	CPPUNIT_TEST(testStar);
+	CPPUNIT_TEST(testAppend);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StarTableTest);
+
+void	StarTableTest::setUp() {
+}
+
+void	StarTableTest::tearDown() {
+}
+
+void	StarTableTest::testNames() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testNames() begin");
+	CPPUNIT_ASSERT(StarTable::name('B', 1234) == "BSC1234");
+	CPPUNIT_ASSERT(StarTable::name('H', 4711) == "HIP004711");
+	CPPUNIT_ASSERT(StarTable::name('T', 1000081) == "T0001 00008 1");
+	CPPUNIT_ASSERT(StarTable::name('U', 391012345) == "UCAC4-391-012345");
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testNames() end");
+}
+
+void	StarTableTest::testStar() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testStar() begin");
+	StarTable	table;
+	table.add(1.5, -0.25, 1e-8, -2e-8, 11.5, 'U', 391012345);
+	Star	other("M42-1");
+	other.ra() = Angle(1.46);
+	other.dec() = Angle(-0.09);
+	other.mag(4.0);
+	other.catalog('X');
+	other.catalognumber(1);
+	table.add(other);
+	CPPUNIT_ASSERT(table.size() == 2);
+	Star	star = table.star(0);
+	CPPUNIT_ASSERT(star.name() == "UCAC4-391-012345");
+	CPPUNIT_ASSERT(star.ra().radians() == 1.5);
+	CPPUNIT_ASSERT(star.dec().radians() == -0.25);
+	CPPUNIT_ASSERT(star.mag() == 11.5);
+	CPPUNIT_ASSERT(star.catalog() == 'U');
+	// names that cannot be derived are kept
+	CPPUNIT_ASSERT(table.name(1) == "M42-1");
+	CPPUNIT_ASSERT(table.star(1).mag() == 4.0);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testStar() end");
+}
+
+void	StarTableTest::testAppend() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testAppend() begin");
+	StarTable	a;
+	a.add(0.1, 0.2, 0, 0, 5, 'H', 1);
+	StarTable	b;
+	Star	s("special");
+	s.catalog('X');
+	b.add(s);
+	b.add(0.3, 0.4, 0, 0, 6, 'B', 2);
+	a.append(b);
+	CPPUNIT_ASSERT(a.size() == 3);
+	CPPUNIT_ASSERT(a.name(0) == "HIP000001");
+	CPPUNIT_ASSERT(a.name(1) == "special");
+	CPPUNIT_ASSERT(a.name(2) == "BSC0002");
+	a.clear();
+	CPPUNIT_ASSERT(a.empty());
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testAppend() end");
+}
+
+} // namespace test
+} // namespace astro
@@ -26,6 +26,7 @@ public:
 	void	testAccess();
 	void	testIterator();
 	void	testWindow();
+	void	testTable();
 
 	CPPUNIT_TEST_SUITE(Ucac4Test);
 	CPPUNIT_TEST(testConstructor);
@@ -33,6 +34,7 @@ public:
 	CPPUNIT_TEST(testAccess);
 	CPPUNIT_TEST(testIterator);
 	CPPUNIT_TEST(testWindow);
+	CPPUNIT_TEST(testTable);
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -121,5 +123,28 @@ void	Ucac4Test::testWindow() {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "testWindow() end");
 }
 
+void	Ucac4Test::testTable() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testTable() begin");
+	Ucac4	catalog("/usr/local/starcatalogs/u4");
+	RaDec   center(0, 0);
+	center.ra().hours(6.75247702777777777777);
+	center.dec().degrees(-16.71611583333333333333);
+	Angle	width; width.degrees(2);
+	Angle	height; height.degrees(2);
+	SkyWindow	window(center, width, height);
+	MagnitudeRange	magrange(-30., 14);
+	StarTablePtr	table = catalog.findTable(window, magrange);
+	Catalog::starsetptr	stars = catalog.find(window, magrange);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%u stars in table, %u in set",
+		table->size(), stars->size());
+	CPPUNIT_ASSERT(table->size() == stars->size());
+	for (size_t i = 0; i < table->size(); i++) {
+		Star	star = catalog.find(table->name(i));
+		CPPUNIT_ASSERT(fabs(star.mag() - table->mag[i]) < 0.001);
+		CPPUNIT_ASSERT(star.ra() == Angle(table->ra[i]));
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testTable() end");
+}
+
 } // namespace test
 } // namespace astro
@@ -6,6 +6,8 @@
 #include <AstroProject.h>
 #include <AstroDebug.h>
 #include <AstroIO.h>
+#include <ImageCache.h>
+#include <AstroMetrics.h>
 #include <includes.h>
 #include "ImageRepoTables.h"
 #include <numeric>
@@ -23,11 +25,13 @@ namespace project {
  */
 ImageRepo::ImageRepo(const std::string& name, Database database,
 	const std::string& directory, bool scan)
-	: _name(name), _database(database), _directory(directory) {
+	: _name(name), _database(database), _directory(directory),
+	  _compression("none") {
 	// make sure the database contains required tables
 	try {
 		ImageTable	images(_database);
 		MetadataTable	metadatatable(_database);
+		ImageFileTable	imagefiles(_database);
 	} catch (std::exception& x) {
 		std::string	msg = stringprintf("cannot open image "
 			"repository tables: %s", x.what());
@@ -42,161 +46,24 @@ ImageRepo::ImageRepo(const std::string& name, Database database,
 }
 
 /**
- * \brief get the id of an image identified by its filename
+ * \brief Set the compression used when saving images
+ *
+ * The compression specification is validated here, so that a bad
+ * configuration is detected before the first image is saved.
  */
-long	ImageRepo::id(const std::string& filename) {
-	ImageTable	images(_database);
-	return images.id(filename);
+void	ImageRepo::compression(const std::string& c) {
+	FITScompression	fitscompression(c);
+	_compression = fitscompression.toString();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "repo %s uses compression %s",
+		_name.c_str(), _compression.c_str());
 }
 
 /**
- * \brief process a single file during a scan
+ * \brief get the id of an image identified by its filename
  */
-void	ImageRepo::scan_file(const std::string& filename) {
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "scanning file '%s' (%d)",
-		filename.c_str(), filename.length());
-	// does the filename end in ".fits"?
-	if (filename.size() < 5) {
-		return;
-	}
-	std::string	extension = filename.substr(filename.length() - 5, 5);
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "substr: '%s'", extension.c_str());
-	if (extension != ".fits") {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "%s not a FITS file",
-			filename.c_str());
-		return;
-	}
-
-	// check whether this is a file
-	std::string	fullname = _directory + "/" + filename;
-	struct stat	sb;
-	if (stat(fullname.c_str(), &sb) < 0) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "cannot stat file %s: %s",
-			fullname.c_str(), strerror(errno));
-		return;
-	}
-
-	if (!S_ISREG(sb.st_mode)) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "%s: not a regular file",
-			fullname.c_str());
-		return;
-	}
-
-	// find out whether the database already contains this filename
+long	ImageRepo::id(const std::string& filename) {
 	ImageTable	images(_database);
-	try {
-		long	id = images.id(filename);
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "%s exists with id %ld", 
-			filename.c_str(), id);
-		// if we get to this point, the file already exists, so we
-		// skip it
-		return;
-	} catch (...) {
-		// file does not exist
-	}
-
-	// read the metadata
-        io::FITSinfileBase      infile(fullname);
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "size: %s",
-		infile.getSize().toString().c_str());
-
-	// create an information record
-	ImageRecord	imageinfo;
-	imageinfo.filename = filename;
-	imageinfo.project = "unknown";
-	imageinfo.created = sb.st_ctime;
-	try {
-		imageinfo.camera
-			= (std::string)infile.getMetadata("INSTRUME");
-	} catch(...) { }
-	imageinfo.width = infile.getSize().width();
-	imageinfo.height = infile.getSize().height();
-	imageinfo.xbin = 1;
-	try {
-		imageinfo.xbin
-			= (int)infile.getMetadata("XBINNING");
-	} catch(...) { }
-	imageinfo.ybin = 1;
-	try {
-		imageinfo.ybin
-			= (int)infile.getMetadata("YBINNING");
-	} catch(...) { }
-	imageinfo.depth = infile.getPlanes();
-	imageinfo.pixeltype = infile.getPixeltype();
-	imageinfo.exposuretime = 0;
-	try {
-		imageinfo.exposuretime
-			= (double)infile.getMetadata("EXPTIME");
-	} catch(...) { }
-	imageinfo.temperature = 0;
-	try {
-		imageinfo.temperature
-			= (double)infile.getMetadata("CCD-TEMP");
-	} catch(...) { }
-	imageinfo.purpose = "light";
-	imageinfo.bayer = "    ";
-	imageinfo.observation = "1970-01-01T00:00:00.000";
-	imageinfo.uuid = "";
-	try {
-		imageinfo.uuid = (std::string)(infile.getMetadata("UUID"));
-	} catch (...) { }
-
-	// add the entry to the table
-	long	imageid = images.add(imageinfo);
-
-	// in the part below we need the metatdata table
-	MetadataTable	metadatatable(_database);
-
-	// get all the metadata from the infile
-	int	seqno = 0;
-	ImageMetadata	md = infile.getAllMetadata();
-
-	// now add an entry for each meta data record
-	ImageMetadata::const_iterator	mi;
-	for (mi = md.begin(); mi != md.end(); mi++) {
-		MetadataRecord	m(-1, imageid);
-		m.seqno = seqno;
-		m.key = mi->first;
-		m.value = mi->second.getValue();
-		m.comment = mi->second.getComment();
-		metadatatable.add(m);
-		seqno++;
-	}
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "%d metadata records added", seqno);
-}
-
-/**
- * \brief Scan a directory for images
- */
-void	ImageRepo::scan_directory(bool recurse) {
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "scan directory %s", _directory.c_str());
-
-	if (recurse) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0,
-			"recursive scan not implemented");
-		throw std::runtime_error("not implemented");
-	}
-
-	// set up a counter so we can count the number of files we find
-	int	counter = 0;
-
-	// open the directory
-	DIR     *dir = opendir(_directory.c_str());
-	if (NULL == dir) {
-		throw std::runtime_error("cannot open directory");
-	}
-	struct dirent	*d;
-	while (NULL != (d = readdir(dir))) {
-		std::string     filename(d->d_name);
-		scan_file(filename);
-		counter++;
-	}
-
-	// close the directory
-	closedir(dir);
-
-	// report the number of files scanned
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "%d files scanned", counter);
+	return images.id(filename);
 }
 
 /**
@@ -252,11 +119,12 @@ long	ImageRepo::getId(const UUID& uuid) {
 
 /**
  * \brief Get an image
+ *
+ * The image comes from the image cache and is shared with other users
+ * of the same file, so it must not be modified.
  */
 ImagePtr	ImageRepo::getImage(long id) {
-	std::string	f = pathname(id);
-	FITSin	in(f);
-	return in.read();
+	return ImageCache::get().image(pathname(id));
 }
 
 ImagePtr	ImageRepo::getImage(const UUID& uuid) {
@@ -337,6 +205,16 @@ ImageEnvelope	ImageRepo::getEnvelope(const UUID& uuid) {
  * \brief Save an image in the repository
  */
 long	ImageRepo::save(ImagePtr image) {
+	static metrics::Histogram&	savetime
+		= metrics::Metrics::histogram("repository.save");
+	static metrics::Histogram&	writetime
+		= metrics::Metrics::histogram("repository.save.fits");
+	static metrics::Histogram&	inserttime
+		= metrics::Metrics::histogram("repository.save.db");
+	static metrics::Counter&	failures
+		= metrics::Metrics::counter("repository.save.failures");
+	metrics::ScopedTimer	savetimer(savetime);
+
 	// if the image does not have a UUID yet, add one
 	if (!image->hasMetadata("UUID")) {
 		UUID	uuid;
@@ -406,6 +284,7 @@ long	ImageRepo::save(ImagePtr image) {
 
 	// now try to save the image info record
 	try {
+		double	start = Timer::gettime();
 		// save the image info
 		ImageTable	images(_database);
 		imageid = images.add(imageinfo);
@@ -413,7 +292,9 @@ long	ImageRepo::save(ImagePtr image) {
 		// write the metadata to the metadata tabe
 		MetadataTable	metadata(_database);
 		
-		// now add an entry for each meta data record
+		// now add an entry for each meta data record, all records
+		// are inserted with the same prepared statement
+		std::vector<MetadataRecord>	records;
 		ImageMetadata::const_iterator	mi;
 		long	seqno = 0;
 		for (mi = image->begin(); mi != image->end(); mi++) {
@@ -422,11 +303,13 @@ long	ImageRepo::save(ImagePtr image) {
 			m.key = mi->first;
 			m.value = mi->second.getValue();
 			m.comment = mi->second.getComment();
-			metadata.add(m);
+			records.push_back(m);
 			seqno++;
 		}
+		metadata.add(records);
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "%d metadata records added",
 			seqno);
+		inserttime.record(Timer::gettime() - start);
 
 		// first we have to create a file name for the image
 		std::string	fullname
@@ -438,9 +321,12 @@ long	ImageRepo::save(ImagePtr image) {
 			fullname.c_str());
 
 		// write the image
+		ImageCache::get().invalidate(fullname);
 		unlink(fullname.c_str());
 		try {
+			metrics::ScopedTimer	writetimer(writetime);
 			FITSout	out(fullname);
+			out.setCompression(FITScompression(_compression));
 			out.write(image);
 			debug(LOG_DEBUG, DEBUG_LOG, 0, "image written to %s",
 				fullname.c_str());
@@ -455,6 +341,16 @@ long	ImageRepo::save(ImagePtr image) {
 		// when the ID became known from the add operation
 		update_filename(imageid, filename);
 
+		// remember the file state so that a directory scan does
+		// not have to read the headers of this file again
+		struct stat	sb;
+		if (0 == stat(fullname.c_str(), &sb)) {
+			ImageFileInfo	fileinfo;
+			fileinfo.filesize = sb.st_size;
+			fileinfo.mtime = sb.st_mtime;
+			ImageFileTable(_database).setstate(imageid, fileinfo);
+		}
+
 		// commit the transaction, only at this point do the database
 		// entries become persistent. This ensures that information
 		// about the image only becomes visible in the database when
@@ -469,6 +365,7 @@ long	ImageRepo::save(ImagePtr image) {
 		// the database will be clean again. In particular, if the
 		// disk write fails, nothing will show up in the database.
 		_database->rollback("saveimage");
+		failures.increment();
 		throw;
 	}
 
@@ -494,6 +391,7 @@ void	ImageRepo::remove(long id) {
 		images.remove(id);
 
 		// now remove the image file
+		ImageCache::get().invalidate(fullname);
 		if (unlink(fullname.c_str())) {
 			std::string	msg = stringprintf("cannot remove "
 				"image '%s': %s",
@@ -9,6 +9,7 @@
 #include <AstroFormat.h>
 #include <cstdlib>
 #include "ImageReposTable.h"
+#include <AstroIO.h>
 #include <includes.h>
 
 using namespace astro::persistence;
@@ -40,6 +41,9 @@ public:
 	virtual std::list<ImageRepoInfo>	listrepo(bool visible_only);
 	virtual bool	hidden(const std::string& name);
 	virtual void	setHidden(const std::string& name, bool hidden);
+	virtual std::string	compression(const std::string& name);
+	virtual void	setCompression(const std::string& name,
+				const std::string& compression);
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -72,7 +76,9 @@ bool	ImageRepoConfigurationBackend::exists(const std::string& name) {
  */
 ImageRepoPtr	ImageRepoConfigurationBackend::repo(const std::string& name) {
 	ImageRepoTable	repos(_config->database());
-	return ImageRepoPtr(new ImageRepo(repos.get(name)));
+	ImageRepoPtr	result(new ImageRepo(repos.get(name)));
+	result->compression(compression(name));
+	return result;
 }
 
 /**
@@ -257,5 +263,37 @@ void	ImageRepoConfigurationBackend::setHidden(const std::string& name,
 	repos.updaterow(info.id, updatespec);
 }
 
+/**
+ * \brief Get the FITS compression for images saved in a repository
+ *
+ * The compression is taken from the repository.<name>.compression
+ * configuration variable, and falls back to global.repository.compression.
+ * If neither is set, images are stored uncompressed.
+ */
+std::string	ImageRepoConfigurationBackend::compression(
+			const std::string& name) {
+	std::string	def = _config->get("global", "repository",
+				"compression", "none");
+	return _config->get("repository", name, "compression", def);
+}
+
+/**
+ * \brief Set the FITS compression for a repository
+ */
+void	ImageRepoConfigurationBackend::setCompression(const std::string& name,
+		const std::string& compression) {
+	if (!exists(name)) {
+		std::string	msg = stringprintf("image repository '%s' does "
+			"not exist", name.c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw NotFound(msg);
+	}
+	// make sure the compression specification can be parsed
+	std::string	spec = io::FITScompression(compression).toString();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "setting compression of %s to %s",
+		name.c_str(), spec.c_str());
+	_config->set("repository", name, "compression", spec);
+}
+
 } // namespace config
 } // namespace astro
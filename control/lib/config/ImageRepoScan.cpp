@@ -0,0 +1,478 @@
+/*
+ * ImageRepoScan.cpp -- incremental scan of an image repository directory
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroProject.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroUtils.h>
+#include <AstroIO.h>
+#include <includes.h>
+#include <ImageCache.h>
+#include "ImageRepoTables.h"
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace astro::persistence;
+using namespace astro::image;
+using namespace astro::io;
+
+namespace astro {
+namespace project {
+
+//////////////////////////////////////////////////////////////////////
+// Scan statistics
+//////////////////////////////////////////////////////////////////////
+ImageRepoScanStatistics::ImageRepoScanStatistics()
+	: files(0), unchanged(0), added(0), updated(0), failed(0),
+	  removed(0), duration(0) {
+}
+
+/**
+ * \brief Number of files processed per second
+ */
+double	ImageRepoScanStatistics::throughput() const {
+	if (duration <= 0) {
+		return 0;
+	}
+	return files / duration;
+}
+
+std::string	ImageRepoScanStatistics::toString() const {
+	return stringprintf("%d files (%d unchanged, %d added, %d updated, "
+		"%d failed, %d removed) in %.3fs, %.1f files/s", files,
+		unchanged, added, updated, failed, removed, duration,
+		throughput());
+}
+
+//////////////////////////////////////////////////////////////////////
+// Scan candidates
+//////////////////////////////////////////////////////////////////////
+/**
+ * \brief A file that has to be (re)indexed
+ *
+ * The candidate is filled in by a worker thread that only reads the
+ * headers of the file, all database work is done afterwards by the
+ * scanning thread.
+ */
+class ScanCandidate {
+public:
+	std::string	filename;
+	std::string	fullname;
+	long	imageid;	// -1 for files not yet in the database
+	ImageFileInfo	fileinfo;
+	time_t	created;
+	bool	ok;
+	ImageRecord	imageinfo;
+	ImageMetadata	metadata;
+	ScanCandidate() : imageid(-1), created(0), ok(false) { }
+	void	readheaders();
+};
+
+/**
+ * \brief Read the headers of a candidate file
+ *
+ * The FITSinfileBase constructor only reads the header units, the
+ * pixel data of the image is never touched.
+ */
+void	ScanCandidate::readheaders() {
+	try {
+		FITSinfileBase	infile(fullname);
+		imageinfo.filename = filename;
+		imageinfo.project = "unknown";
+		try {
+			imageinfo.project
+				= trim((std::string)infile.getMetadata("PROJECT"));
+		} catch(...) { }
+		imageinfo.created = created;
+		try {
+			imageinfo.camera
+				= trim((std::string)infile.getMetadata("INSTRUME"));
+		} catch(...) { }
+		imageinfo.width = infile.getSize().width();
+		imageinfo.height = infile.getSize().height();
+		imageinfo.xbin = 1;
+		try {
+			imageinfo.xbin
+				= (int)infile.getMetadata("XBINNING");
+		} catch(...) { }
+		imageinfo.ybin = 1;
+		try {
+			imageinfo.ybin
+				= (int)infile.getMetadata("YBINNING");
+		} catch(...) { }
+		imageinfo.depth = infile.getPlanes();
+		imageinfo.pixeltype = infile.getPixeltype();
+		imageinfo.exposuretime = 0;
+		try {
+			imageinfo.exposuretime
+				= (double)infile.getMetadata("EXPTIME");
+		} catch(...) { }
+		imageinfo.temperature = 0;
+		try {
+			imageinfo.temperature
+				= (double)infile.getMetadata("CCD-TEMP");
+		} catch(...) { }
+		// read the same keywords as ImageRepo::save, the update of
+		// a known file must not lose them
+		imageinfo.purpose = "light";
+		try {
+			imageinfo.purpose
+				= (std::string)infile.getMetadata("PURPOSE");
+		} catch(...) { }
+		try {
+			imageinfo.filter
+				= trim((std::string)infile.getMetadata("FILTER"));
+		} catch(...) { }
+		imageinfo.bayer = "    ";
+		try {
+			imageinfo.bayer
+				= trim((std::string)infile.getMetadata("BAYER"));
+		} catch(...) { }
+		imageinfo.observation = "1970-01-01T00:00:00.000";
+		try {
+			imageinfo.observation
+				= (std::string)infile.getMetadata("DATE-OBS");
+		} catch(...) { }
+		imageinfo.uuid = "";
+		try {
+			imageinfo.uuid
+				= trim((std::string)infile.getMetadata("UUID"));
+		} catch (...) { }
+		metadata = infile.getAllMetadata();
+		ok = true;
+	} catch (const std::exception& x) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "cannot read headers of %s: %s",
+			fullname.c_str(), x.what());
+		ok = false;
+	}
+}
+
+/**
+ * \brief Find out whether a directory entry is a FITS file worth scanning
+ */
+static bool	isfits(const std::string& filename) {
+	if (filename.size() < 5) {
+		return false;
+	}
+	return filename.substr(filename.length() - 5, 5) == ".fits";
+}
+
+/**
+ * \brief Retrieve the file state of all images known to the database
+ *
+ * This is a single join query, so that the scan does not have to query
+ * the database for each file in the directory.
+ */
+typedef std::map<std::string, std::pair<long, ImageFileInfo> >	filestatemap;
+
+static filestatemap	knownfiles(Database database) {
+	filestatemap	result;
+	Result	rows = database->query(
+		"select a.id, a.filename, b.filesize, b.mtime "
+		"from images a left outer join imagefiles b "
+		"on a.id = b.imageid");
+	for (auto r = rows.begin(); r != rows.end(); r++) {
+		ImageFileInfo	info;
+		if (!(*r)[2]->isnull()) {
+			info.filesize = (long)(*r)[2]->doubleValue();
+			info.mtime = (time_t)(*r)[3]->doubleValue();
+		}
+		result.insert(std::make_pair((*r)[1]->stringValue(),
+			std::make_pair((long)(*r)[0]->intValue(), info)));
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%lu files known in database",
+		(unsigned long)result.size());
+	return result;
+}
+
+/**
+ * \brief Write the results of a batch of candidates to the database
+ */
+static void	commitbatch(Database database,
+		std::vector<ScanCandidate>::iterator begin,
+		std::vector<ScanCandidate>::iterator end,
+		ImageRepoScanStatistics& statistics) {
+	database->begin("scanbatch");
+	try {
+		ImageTable	images(database);
+		MetadataTable	metadatatable(database);
+		ImageFileTable	imagefiles(database);
+		for (auto c = begin; c != end; c++) {
+			if (!c->ok) {
+				statistics.failed++;
+				continue;
+			}
+			long	imageid = c->imageid;
+			if (imageid < 0) {
+				imageid = images.add(c->imageinfo);
+				statistics.added++;
+			} else {
+				images.update(imageid, c->imageinfo);
+				metadatatable.remove(stringprintf(
+					"imageid = %ld", imageid));
+				statistics.updated++;
+			}
+			std::vector<MetadataRecord>	records;
+			records.reserve(c->metadata.size());
+			int	seqno = 0;
+			for (auto mi = c->metadata.begin();
+				mi != c->metadata.end(); mi++) {
+				MetadataRecord	m(-1, imageid);
+				m.seqno = seqno++;
+				m.key = mi->first;
+				m.value = mi->second.getValue();
+				m.comment = mi->second.getComment();
+				records.push_back(m);
+			}
+			metadatatable.add(records);
+			imagefiles.setstate(imageid, c->fileinfo);
+		}
+		database->commit("scanbatch");
+	} catch (...) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "scan batch failed, rolling back");
+		database->rollback("scanbatch");
+		database->commit("scanbatch");
+		throw;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// ImageRepo scanning methods
+//////////////////////////////////////////////////////////////////////
+/**
+ * \brief Incrementally scan the repository directory
+ *
+ * Files whose size and modification time match the state recorded in
+ * the database are skipped, images whose files no longer exist are
+ * removed from the database. The headers of all other FITS files are
+ * read by a pool of worker threads, while the scanning thread commits
+ * the results in batches, each batch in a single transaction.
+ *
+ * \param threads	number of header reading threads, 0 means one per
+ *			processor core
+ * \param batchsize	number of files to commit in one transaction
+ */
+ImageRepoScanStatistics	ImageRepo::scan(int threads, int batchsize) {
+	ImageRepoScanStatistics	statistics;
+	Timer	timer;
+	timer.start();
+	if (threads <= 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	if (batchsize <= 0) {
+		batchsize = 100;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "scan %s with %d threads, batch %d",
+		_directory.c_str(), threads, batchsize);
+
+	// make sure all tables exist before the join query
+	ImageTable	images(_database);
+	MetadataTable	metadatatable(_database);
+	ImageFileTable	imagefiles(_database);
+	filestatemap	known = knownfiles(_database);
+
+	// find the files that have to be read
+	DIR     *dir = opendir(_directory.c_str());
+	if (NULL == dir) {
+		std::string	msg = stringprintf("cannot open directory %s: %s",
+			_directory.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	std::vector<ScanCandidate>	candidates;
+	std::list<std::pair<long, ImageFileInfo> >	statesonly;
+	std::set<std::string>	present;
+	struct dirent	*d;
+	while (NULL != (d = readdir(dir))) {
+		std::string     filename(d->d_name);
+		if (!isfits(filename)) {
+			continue;
+		}
+		std::string	fullname = _directory + "/" + filename;
+		struct stat	sb;
+		if (stat(fullname.c_str(), &sb) < 0) {
+			debug(LOG_DEBUG, DEBUG_LOG, 0, "cannot stat file %s: %s",
+				fullname.c_str(), strerror(errno));
+			continue;
+		}
+		if (!S_ISREG(sb.st_mode)) {
+			continue;
+		}
+		statistics.files++;
+		present.insert(filename);
+		ImageFileInfo	fileinfo;
+		fileinfo.filesize = sb.st_size;
+		fileinfo.mtime = sb.st_mtime;
+
+		auto	k = known.find(filename);
+		if (k != known.end()) {
+			if (k->second.second == fileinfo) {
+				statistics.unchanged++;
+				continue;
+			}
+			// images indexed before file states were recorded
+			// are trusted, we only remember their state
+			if (k->second.second.mtime == 0) {
+				statesonly.push_back(std::make_pair(
+					k->second.first, fileinfo));
+				statistics.unchanged++;
+				continue;
+			}
+		}
+		ScanCandidate	candidate;
+		candidate.filename = filename;
+		candidate.fullname = fullname;
+		candidate.fileinfo = fileinfo;
+		candidate.created = sb.st_ctime;
+		if (k != known.end()) {
+			candidate.imageid = k->second.first;
+		}
+		candidates.push_back(candidate);
+	}
+	closedir(dir);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%lu of %d files need to be read",
+		(unsigned long)candidates.size(), statistics.files);
+
+	// record file states for files that don't need to be read
+	if (statesonly.size() > 0) {
+		_database->begin("scanstates");
+		try {
+			for (auto s = statesonly.begin(); s != statesonly.end();
+				s++) {
+				imagefiles.setstate(s->first, s->second);
+			}
+			_database->commit("scanstates");
+		} catch (...) {
+			_database->rollback("scanstates");
+			_database->commit("scanstates");
+			throw;
+		}
+	}
+
+	// remove the images whose files have disappeared, the foreign keys
+	// of the metadata and imagefiles tables cascade the delete
+	std::vector<std::pair<long, std::string> >	vanished;
+	for (auto k = known.begin(); k != known.end(); k++) {
+		if (present.find(k->first) == present.end()) {
+			vanished.push_back(std::make_pair(k->second.first,
+				k->first));
+		}
+	}
+	if (vanished.size() > 0) {
+		_database->begin("scanprune");
+		try {
+			for (auto v = vanished.begin(); v != vanished.end();
+				v++) {
+				debug(LOG_DEBUG, DEBUG_LOG, 0, "image %ld: file %s "
+					"has disappeared", v->first,
+					v->second.c_str());
+				images.remove(v->first);
+			}
+			_database->commit("scanprune");
+		} catch (...) {
+			_database->rollback("scanprune");
+			_database->commit("scanprune");
+			throw;
+		}
+		for (auto v = vanished.begin(); v != vanished.end(); v++) {
+			ImageCache::get().invalidate(_directory + "/" + v->second);
+		}
+		statistics.removed = vanished.size();
+	}
+
+	// The worker threads read headers ahead of the scanning thread,
+	// which commits each batch in a single transaction as soon as all
+	// its headers have been read. Readers never get more than two
+	// batches ahead of the last commit, which bounds the memory used
+	// for headers that have not been written yet.
+	std::mutex	mutex;
+	std::condition_variable	condition;
+	std::vector<char>	done(candidates.size(), 0);
+	size_t	committed = 0;
+	bool	aborted = false;
+	size_t	window = 2 * batchsize;
+	int	n = candidates.size();
+	std::thread	reader([&]() {
+#pragma omp parallel for num_threads(threads) schedule(dynamic)
+		for (int i = 0; i < n; i++) {
+			{
+				std::unique_lock<std::mutex>	lock(mutex);
+				condition.wait(lock, [&]() {
+					return aborted
+						|| ((size_t)i < committed + window);
+				});
+				if (aborted) {
+					continue;
+				}
+			}
+			candidates[i].readheaders();
+			{
+				std::unique_lock<std::mutex>	lock(mutex);
+				done[i] = 1;
+			}
+			condition.notify_all();
+		}
+	});
+	try {
+		for (size_t first = 0; first < candidates.size();
+			first += batchsize) {
+			size_t	last = std::min(candidates.size(),
+					first + batchsize);
+			{
+				std::unique_lock<std::mutex>	lock(mutex);
+				condition.wait(lock, [&]() {
+					for (size_t i = first; i < last; i++) {
+						if (!done[i]) {
+							return false;
+						}
+					}
+					return true;
+				});
+			}
+			commitbatch(_database, candidates.begin() + first,
+				candidates.begin() + last, statistics);
+			{
+				std::unique_lock<std::mutex>	lock(mutex);
+				committed = last;
+			}
+			condition.notify_all();
+		}
+	} catch (...) {
+		{
+			std::unique_lock<std::mutex>	lock(mutex);
+			aborted = true;
+		}
+		condition.notify_all();
+		reader.join();
+		throw;
+	}
+	reader.join();
+
+	timer.end();
+	statistics.duration = timer.elapsed();
+	debug(LOG_INFO, DEBUG_LOG, 0, "scan of %s: %s", _directory.c_str(),
+		statistics.toString().c_str());
+	return statistics;
+}
+
+/**
+ * \brief Scan a directory for images
+ */
+void	ImageRepo::scan_directory(bool recurse) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "scan directory %s", _directory.c_str());
+
+	if (recurse) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0,
+			"recursive scan not implemented");
+		throw std::runtime_error("not implemented");
+	}
+	scan();
+}
+
+} // namespace project
+} // namespace astro
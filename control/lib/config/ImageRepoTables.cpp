@@ -196,5 +196,68 @@ UpdateSpec	MetadataTableAdapter::object_to_updatespec(const MetadataRecord&metar
 	return spec;
 }
 
+//////////////////////////////////////////////////////////////////////
+// ImageFileInfo implementation
+//////////////////////////////////////////////////////////////////////
+bool	ImageFileInfo::operator==(const ImageFileInfo& other) const {
+	if (filesize != other.filesize) { return false; }
+	if (mtime != other.mtime) { return false; }
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Image file table adapter
+//////////////////////////////////////////////////////////////////////
+std::string	ImageFileTableAdapter::tablename() {
+	return std::string("imagefiles");
+}
+
+std::string	ImageFileTableAdapter::createstatement() {
+	return std::string(
+		"create table imagefiles (\n"
+		"    id integer not null,\n"
+		"    imageid integer not null references images(id) "
+			"on delete cascade on update cascade,\n"
+		"    filesize integer not null,\n"
+		"    mtime integer not null,\n"
+		"    primary key(id)\n"
+		");\n"
+		"create unique index imagefiles_x1 on imagefiles(imageid);\n"
+	);
+}
+
+ImageFileRecord	ImageFileTableAdapter::row_to_object(int objectid,
+			const Row& row) {
+	int	ref = row["imageid"]->intValue();
+	ImageFileRecord	record(objectid, ref);
+	record.filesize = (long)row["filesize"]->doubleValue();
+	record.mtime = (time_t)row["mtime"]->doubleValue();
+	return record;
+}
+
+UpdateSpec	ImageFileTableAdapter::object_to_updatespec(
+			const ImageFileRecord& filerec) {
+	UpdateSpec	spec;
+	FieldValueFactory	factory;
+	spec.insert(Field("imageid", factory.get(filerec.ref())));
+	spec.insert(Field("filesize", factory.get((double)filerec.filesize)));
+	spec.insert(Field("mtime", factory.get((double)filerec.mtime)));
+	return spec;
+}
+
+//////////////////////////////////////////////////////////////////////
+// ImageFileTable implementation
+//////////////////////////////////////////////////////////////////////
+/**
+ * \brief Record the file state for an image, replacing any previous state
+ */
+void	ImageFileTable::setstate(long imageid, const ImageFileInfo& info) {
+	remove(stringprintf("imageid = %ld", imageid));
+	ImageFileRecord	record(-1, imageid);
+	record.filesize = info.filesize;
+	record.mtime = info.mtime;
+	add(record);
+}
+
 } // namespace project
 } // namespace astro
@@ -117,6 +117,52 @@ public:
 		: Table<MetadataRecord, MetadataTableAdapter>(database) { }
 };
 
+/**
+ * \brief File state of an image at the time it was last indexed
+ *
+ * The directory scan uses size and modification time of a file to decide
+ * whether the headers have to be read again.
+ */
+class ImageFileInfo {
+public:
+	long	filesize;
+	time_t	mtime;
+	ImageFileInfo() : filesize(0), mtime(0) { }
+	bool	operator==(const ImageFileInfo& other) const;
+};
+
+/**
+ * \brief Wrapper for the image file information
+ */
+class ImageFileRecord : public PersistentRef<ImageFileInfo> {
+public:
+	ImageFileRecord(int id, int ref)
+		: PersistentRef<ImageFileInfo>(id, ref) { }
+};
+
+/**
+ * \brief Adapter for the imagefiles table
+ */
+class ImageFileTableAdapter {
+public:
+static std::string      tablename();
+static std::string      createstatement();
+static ImageFileRecord
+        row_to_object(int objectid, const astro::persistence::Row& row);
+static astro::persistence::UpdateSpec
+        object_to_updatespec(const ImageFileRecord& imagefile);
+};
+
+/**
+ * \brief Image file table
+ */
+class ImageFileTable : public Table<ImageFileRecord, ImageFileTableAdapter> {
+public:
+	ImageFileTable(Database& database)
+		: Table<ImageFileRecord, ImageFileTableAdapter>(database) { }
+	void	setstate(long imageid, const ImageFileInfo& info);
+};
+
 } // namespace project
 } // namespace astro
 
@@ -31,6 +31,7 @@ public:
 	void	testImage();
 	void	testSelect();
 	void	testRemove();
+	void	testIncrementalScan();
 	//void	testXXX();
 
 	CPPUNIT_TEST_SUITE(ImageRepoTest);
@@ -38,6 +39,7 @@ public:
 	CPPUNIT_TEST(testImage);
 	CPPUNIT_TEST(testSelect);
 	CPPUNIT_TEST(testRemove);
+	CPPUNIT_TEST(testIncrementalScan);
 	//CPPUNIT_TEST(testXXX);
 	CPPUNIT_TEST_SUITE_END();
 };
@@ -145,6 +147,74 @@ void	ImageRepoTest::testRemove() {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "testRemove() end");
 }
 
+static void	writeimage(const std::string& filename, int width) {
+	ImagePtr	image(new Image<unsigned short>(width, 20));
+	image->setMetadata(FITSKeywords::meta("PURPOSE", "dark"));
+	image->setMetadata(FITSKeywords::meta("PROJECT", "scanproject"));
+	image->setMetadata(FITSKeywords::meta("FILTER", "R"));
+	image->setMetadata(FITSKeywords::meta("EXPTIME", 1.));
+	FITSout	out(filename);
+	if (out.exists()) {
+		out.unlink();
+	}
+	out.write(image);
+}
+
+void	ImageRepoTest::testIncrementalScan() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testIncrementalScan() begin");
+	char	scandir[] = "/tmp/scantestXXXXXX";
+	CPPUNIT_ASSERT(NULL != mkdtemp(scandir));
+	std::string	dir(scandir);
+	unlink("scantest.db");
+	Database	scandb = DatabaseFactory::get("scantest.db");
+	ImageRepo	repo("scantest", scandb, dir, false);
+
+	// new files are added
+	writeimage(dir + "/a.fits", 20);
+	writeimage(dir + "/b.fits", 20);
+	writeimage(dir + "/c.fits", 20);
+	ImageRepoScanStatistics	statistics = repo.scan(2, 2);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", statistics.toString().c_str());
+	CPPUNIT_ASSERT(statistics.files == 3);
+	CPPUNIT_ASSERT(statistics.added == 3);
+	CPPUNIT_ASSERT(repo.count() == 3);
+
+	// a second scan does not read any headers
+	statistics = repo.scan(2, 2);
+	CPPUNIT_ASSERT(statistics.unchanged == 3);
+	CPPUNIT_ASSERT(statistics.added == 0);
+	CPPUNIT_ASSERT(statistics.updated == 0);
+
+	// a file with a different size is read again, a deleted file
+	// is removed from the database
+	writeimage(dir + "/b.fits", 40);
+	unlink((dir + "/c.fits").c_str());
+	statistics = repo.scan(2, 2);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", statistics.toString().c_str());
+	CPPUNIT_ASSERT(statistics.files == 2);
+	CPPUNIT_ASSERT(statistics.unchanged == 1);
+	CPPUNIT_ASSERT(statistics.updated == 1);
+	CPPUNIT_ASSERT(statistics.removed == 1);
+	CPPUNIT_ASSERT(repo.count() == 2);
+	CPPUNIT_ASSERT(0 == scandb->query(
+		"select * from metadata where imageid not in "
+		"(select id from images)").size());
+
+	// the updated record keeps the values from the headers
+	Result	rows = scandb->query("select project, purpose, filter "
+		"from images where filename = 'b.fits'");
+	CPPUNIT_ASSERT(rows.size() == 1);
+	CPPUNIT_ASSERT(rows.front()["project"]->stringValue()
+		== "scanproject");
+	CPPUNIT_ASSERT(rows.front()["purpose"]->stringValue() == "dark");
+	CPPUNIT_ASSERT(rows.front()["filter"]->stringValue() == "R");
+
+	unlink((dir + "/a.fits").c_str());
+	unlink((dir + "/b.fits").c_str());
+	rmdir(scandir);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testIncrementalScan() end");
+}
+
 #if 0
 void	ImageRepoTest::testXXX() {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "testXXX() begin");
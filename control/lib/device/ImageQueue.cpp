@@ -5,10 +5,24 @@
  */
 #include <AstroCamera.h>
 #include <AstroDebug.h>
+#include <AstroMetrics.h>
 
 namespace astro {
 namespace camera {
 
+/**
+ * \brief Metrics shared by all image queues of the process
+ *
+ * The length gauge is the total number of images waiting in all queues,
+ * each queue only adds and removes its own entries.
+ */
+static metrics::Counter&	queueadded
+	= metrics::Metrics::counter("imagequeue.added");
+static metrics::Counter&	queuedropped
+	= metrics::Metrics::counter("imagequeue.dropped");
+static metrics::Gauge&	queuelength
+	= metrics::Metrics::gauge("imagequeue.length");
+
 /**
  * \brief Constructor for an ImageQueue object
  *
@@ -24,6 +38,16 @@ ImageQueue::ImageQueue(unsigned long maxqueuelength)
 	_sequence = 0;
 }
 
+/**
+ * \brief Destroy the queue
+ *
+ * Images still in the queue no longer count in the length gauge.
+ */
+ImageQueue::~ImageQueue() {
+	std::unique_lock<std::mutex>	lock(mutex);
+	queuelength.add(-(int64_t)queue.size());
+}
+
 /**
  * \brief Check whether there are images in the queue
  */
@@ -44,6 +68,7 @@ ImageQueueEntry	ImageQueue::getEntry(bool block) {
 		if (queue.size() > 0) {
 			ImageQueueEntry	result = queue.front();
 			queue.pop_front();
+			queuelength.add(-1);
 			return result;
 		}
 		if (!block) {
@@ -79,6 +104,8 @@ void	ImageQueue::add(ImageQueueEntry& entry) {
 	if (queue.size() < _maxqueuelength) {
 		entry.sequence = _sequence++;
 		queue.push_back(entry);
+		queueadded.increment();
+		queuelength.add(1);
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "add image, queue length now %d",
 			queue.size());
 	} else {
@@ -86,6 +113,7 @@ void	ImageQueue::add(ImageQueueEntry& entry) {
 			entry.image->size().toString().c_str(),
 			queue.size(), _maxqueuelength);
 		_dropped++;
+		queuedropped.increment();
 		throw ImageDropped();
 	}
 	condition.notify_all();
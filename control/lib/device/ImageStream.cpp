@@ -6,6 +6,7 @@
 #include <AstroCamera.h>
 #include <AstroDebug.h>
 #include <AstroUtils.h>
+#include <AstroMetrics.h>
 #include "ImageStreamThread.h"
 
 namespace astro {
@@ -15,7 +16,7 @@ namespace camera {
  * \brief Construct a stream
  */
 ImageStream::ImageStream(unsigned long _maxqueuelength)
-	: ImageQueue(_maxqueuelength) {
+	: ImageQueue(_maxqueuelength), _imagesink(NULL) {
 	private_data = NULL;
 }
 
@@ -66,6 +67,7 @@ void	ImageStream::startStream(const Exposure& exposure) {
 	// start the thread with the information we have gathered
 	ImageStreamThread	*t = new ImageStreamThread(*this, ccd);
 	private_data = t;
+	t->start();
 }
 
 /**
@@ -91,6 +93,24 @@ const Exposure&	ImageStream::streamExposure() {
 	return _streamexposure;
 }
 
+/**
+ * \brief Get the format images are converted to
+ */
+astro::image::StreamFormat	ImageStream::streamFormat() {
+	std::unique_lock<std::mutex>	lock(_streamformatmutex);
+	return _streamformat;
+}
+
+/**
+ * \brief Change the format, also while the stream is running
+ */
+void	ImageStream::streamFormat(const astro::image::StreamFormat& f) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "stream format %s",
+		f.toString().c_str());
+	std::unique_lock<std::mutex>	lock(_streamformatmutex);
+	_streamformat = f;
+}
+
 /**
  * \brief Find out whether stream is still streaming
  */
@@ -105,8 +125,9 @@ bool	ImageStream::streaming() {
 /**
  * \brief Process an image entry
  *
- * This method sends the entry to the queue if no sink is defined, but
- * if there is a sink, the image is sent there.
+ * This method converts the image to the stream format and then sends the
+ * entry to the queue if no sink is defined, but if there is a sink, the
+ * image is sent there.
  */
 void	ImageStream::operator()(const ImageQueueEntry& entry) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "new queue entry received");
@@ -117,11 +138,19 @@ void	ImageStream::operator()(const ImageQueueEntry& entry) {
 			entry.exposure.toString().c_str());
 		return;
 	}
+	ImageQueueEntry	newentry(entry);
+	astro::image::StreamFormat	format = streamFormat();
+	if ((format.getFormat() != astro::image::StreamFormat::native)
+		&& (newentry.image)) {
+		static metrics::Histogram&	conversiontime
+			= metrics::Metrics::histogram("stream.convert");
+		metrics::ScopedTimer	timer(conversiontime);
+		newentry.image = format.convert(newentry.image);
+	}
 	if (_imagesink) {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "sending entry to sink");
-		(*_imagesink)(entry);
+		(*_imagesink)(newentry);
 	} else {
-		ImageQueueEntry	newentry(entry);
 		try {
 			ImageQueue::add(newentry);
 			debug(LOG_DEBUG, DEBUG_LOG, 0, "new queue entry %ld",
@@ -30,10 +30,20 @@ static void	imagestreammain(ImageStreamThread *ist) {
 
 /**
  * \brief Construct a new thread
+ *
+ * The thread is only launched by start(), because it immediately asks
+ * the stream whether it is streaming, which it only knows after it has
+ * stored this object.
  */
 ImageStreamThread::ImageStreamThread(ImageStream& stream, Ccd *ccd)
-	: _stream(stream), _ccd(ccd), _running(true),
-	  _thread(imagestreammain, this) {
+	: _stream(stream), _ccd(ccd), _running(true) {
+}
+
+/**
+ * \brief Launch the thread
+ */
+void	ImageStreamThread::start() {
+	_thread = std::thread(imagestreammain, this);
 }
 
 /**
@@ -41,7 +51,9 @@ ImageStreamThread::ImageStreamThread(ImageStream& stream, Ccd *ccd)
  */
 ImageStreamThread::~ImageStreamThread() {
 	stop();
-	_thread.join();
+	if (_thread.joinable()) {
+		_thread.join();
+	}
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "stream thread destroyed");
 }
 
@@ -29,6 +29,7 @@ private:
 public:
 	ImageStreamThread(ImageStream& stream, Ccd *ccd);
 	~ImageStreamThread();
+	void	start();
 	void	run();
 	void	stop();
 };
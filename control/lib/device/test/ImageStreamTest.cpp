@@ -0,0 +1,83 @@
+/*
+ * ImageStreamTest.cpp -- test conversion of streamed images
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroCamera.h>
+#include <AstroDebug.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+using namespace astro::camera;
+using namespace astro::image;
+
+namespace astro {
+namespace test {
+
+/**
+ * \brief CCD that immediately delivers 16 bit images of a 12 bit sensor
+ */
+class StreamTestCcd : public Ccd {
+public:
+	StreamTestCcd() : Ccd(CcdInfo("ccd:streamtest/camera/0",
+		ImageSize(64, 48))) { }
+	virtual void	startExposure(const Exposure& exposure) {
+		Ccd::startExposure(exposure);
+		state(CcdState::exposed);
+	}
+	virtual void	cancelExposure() { }
+private:
+	virtual ImagePtr	getRawImage() {
+		Image<unsigned short>	*image
+			= new Image<unsigned short>(exposure.size());
+		image->fill(4095);
+		return ImagePtr(image);
+	}
+};
+
+class ImageStreamTest : public CppUnit::TestFixture {
+public:
+	void	setUp() { }
+	void	tearDown() { }
+	void	testNative();
+	void	testMono8();
+
+	CPPUNIT_TEST_SUITE(ImageStreamTest);
+	CPPUNIT_TEST(testNative);
+	CPPUNIT_TEST(testMono8);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ImageStreamTest);
+
+void	ImageStreamTest::testNative() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testNative() begin");
+	StreamTestCcd	ccd;
+	CPPUNIT_ASSERT(ccd.streamFormat().getFormat() == StreamFormat::native);
+	ccd.startStream(Exposure());
+	ImageQueueEntry	entry = ccd.getEntry(true);
+	ccd.stopStream();
+	CPPUNIT_ASSERT(NULL != dynamic_cast<Image<unsigned short> *>(
+		&*entry.image));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testNative() end");
+}
+
+void	ImageStreamTest::testMono8() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testMono8() begin");
+	StreamTestCcd	ccd;
+	ccd.streamFormat(StreamFormat(StreamFormat::mono8, 0, 4095));
+	ccd.startStream(Exposure());
+	ImageQueueEntry	entry = ccd.getEntry(true);
+	ccd.stopStream();
+	Image<unsigned char>	*image
+		= dynamic_cast<Image<unsigned char> *>(&*entry.image);
+	CPPUNIT_ASSERT(NULL != image);
+	CPPUNIT_ASSERT(image->size() == ImageSize(64, 48));
+	// the white point of the sensor becomes white
+	CPPUNIT_ASSERT(image->pixel(10, 10) == 255);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testMono8() end");
+}
+
+} // namespace test
+} // namespace astro
@@ -28,13 +28,35 @@ void	EventHandler::active(bool a) {
 }
 
 void	EventHandler::callback(CallbackPtr c) {
-	handler._callback = c;
+	handler._journal.callback(c);
 }
 
 EventHandler&	EventHandler::get() {
 	return handler;
 }
 
+EventJournal&	EventHandler::journal() {
+	return handler._journal;
+}
+
+/**
+ * \brief Limit the rate of events a subsystem may write
+ *
+ * A rate of 0 removes the limit.
+ */
+void	EventHandler::ratelimit(Event::Subsystem subsystem, double rate,
+		double burst) {
+	Event	e;
+	handler._journal.ratelimit(e.subsystem2string(subsystem), rate, burst);
+}
+
+/**
+ * \brief Wait until all events raised so far have been written
+ */
+bool	EventHandler::flush(double timeout) {
+	return handler._journal.wait(timeout);
+}
+
 void	EventHandler::consume(const std::string& file, int line,
 		const std::string& classname, eventlevel_t level,
 		const Event::Subsystem subsystem,
@@ -42,6 +64,35 @@ void	EventHandler::consume(const std::string& file, int line,
 	return handler.process(file, line, classname, level, subsystem, message);
 }
 
+/**
+ * \brief Read the rate limits from the configuration
+ *
+ * The global.events.<subsystem> entries contain the maximum number of
+ * events per second a subsystem may write.
+ */
+static void	configure(EventJournal& journal, ConfigurationPtr config) {
+	Event	e;
+	for (int s = Event::DEBUG; s <= Event::UTILITIES; s++) {
+		std::string	name = e.subsystem2string((Event::Subsystem)s);
+		if (!config->has("global", "events", name)) {
+			continue;
+		}
+		std::string	value = config->get("global", "events", name);
+		double	rate;
+		try {
+			rate = std::stod(value);
+		} catch (const std::exception& x) {
+			// std::invalid_argument or std::out_of_range, keep
+			// the default and don't let the event path throw
+			debug(LOG_ERR, DEBUG_LOG, 0,
+				"bad rate '%s' for events.%s ignored: %s",
+				value.c_str(), name.c_str(), x.what());
+			continue;
+		}
+		journal.ratelimit(name, rate, std::max(1., rate));
+	}
+}
+
 /**
  * \brief Main event processing method
  */
@@ -53,7 +104,12 @@ void	EventHandler::process(const std::string& file, int line,
 		return;
 	}
 	if (!database) {
-		database = Configuration::get()->database();
+		ConfigurationPtr	config = Configuration::get();
+		database = config->database();
+		if (database) {
+			_journal.database(database);
+			configure(_journal, config);
+		}
 	}
 	if (!database) {
 		// still no database, give up
@@ -105,18 +161,9 @@ void	EventHandler::process(const std::string& file, int line,
 	record.file = file;
 	record.line = line;
 
-	// save the record in the database table
-	EventTable	table(database);
-	int	id = table.add(record);
-	record.id(id);
-
-	// if a callback is installed, send the event to the callback
-	if (!_callback) {
-		return;
-	}
-	EventCallbackData	*ecd = new EventCallbackData(record);
-	CallbackDataPtr	cd = CallbackDataPtr(ecd);
-	_callback->operator()(cd);
+	// hand the record to the journal, which writes it to the database
+	// and sends it to the callback
+	_journal.add(record);
 }
 
 } // namespace events
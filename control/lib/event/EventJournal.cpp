@@ -0,0 +1,416 @@
+/*
+ * EventJournal.cpp -- asynchronous, batched event persistence
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroEvent.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroUtils.h>
+#include <chrono>
+
+using namespace astro::persistence;
+using namespace astro::callback;
+
+namespace astro {
+namespace events {
+
+/**
+ * \brief How far back the queue is searched for an identical event
+ */
+#define	COALESCE_DEPTH	16
+
+EventJournalStatistics::EventJournalStatistics() : written(0), batches(0),
+	dropped(0), coalesced(0), suppressed(0), failed(0), queued(0),
+	maxqueued(0) {
+}
+
+std::string	EventJournalStatistics::toString() const {
+	return stringprintf("written=%lu in %lu batches, dropped=%lu, "
+		"coalesced=%lu, suppressed=%lu, failed=%lu, queued=%lu "
+		"(max %lu)", written, batches, dropped, coalesced, suppressed,
+		failed, (unsigned long)queued, (unsigned long)maxqueued);
+}
+
+EventRateLimit::EventRateLimit(double rate, double burst)
+	: _rate(rate), _burst(burst), _tokens(burst), _last(0) {
+}
+
+/**
+ * \brief Find out whether an event at time now may pass
+ */
+bool	EventRateLimit::admit(double now) {
+	if (_rate <= 0) {
+		return true;
+	}
+	if (_last > 0) {
+		_tokens = std::min(_burst, _tokens + (now - _last) * _rate);
+	}
+	_last = now;
+	if (_tokens < 1) {
+		return false;
+	}
+	_tokens -= 1;
+	return true;
+}
+
+static double	eventtime(const EventRecord& record) {
+	return record.eventtime.tv_sec + record.eventtime.tv_usec / 1000000.;
+}
+
+/**
+ * \brief Find out whether two events only differ in time
+ */
+static bool	same(const EventRecord& a, const EventRecord& b) {
+	return (a.level == b.level) && (a.line == b.line)
+		&& (a.message == b.message) && (a.file == b.file)
+		&& (a.classname == b.classname);
+}
+
+/**
+ * \brief Construct an event journal
+ *
+ * \param capacity	the maximum number of events waiting to be written
+ * \param batchsize	the maximum number of events written in a transaction
+ * \param historysize	the number of written events kept in memory
+ */
+EventJournal::EventJournal(size_t capacity, size_t batchsize,
+	size_t historysize)
+	: _capacity(capacity), _batchsize(batchsize), _writing(0),
+	  _dropped(0), _historysize(historysize), _historybase(-1),
+	  _terminate(false) {
+	if ((capacity < 2) || (batchsize == 0)) {
+		std::string	msg = stringprintf("bad event journal capacity "
+			"%lu or batch size %lu", (unsigned long)capacity,
+			(unsigned long)batchsize);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	_historystart = Timer::gettime();
+}
+
+/**
+ * \brief Destroy the journal, writing all events still waiting
+ */
+EventJournal::~EventJournal() {
+	stop();
+}
+
+void	EventJournal::database(Database database) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	_database = database;
+}
+
+void	EventJournal::callback(CallbackPtr callback) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	_callback = callback;
+}
+
+/**
+ * \brief Set the rate limit for a subsystem, a rate of 0 removes it
+ */
+void	EventJournal::ratelimit(const std::string& subsystem, double rate,
+		double burst) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	if (rate <= 0) {
+		_limits.erase(subsystem);
+		return;
+	}
+	_limits[subsystem] = EventRateLimit(rate, std::max(burst, 1.));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s events limited to %.1f/s",
+		subsystem.c_str(), rate);
+}
+
+/**
+ * \brief Append a record to the queue, the lock must be held
+ */
+void	EventJournal::enqueue(const EventRecord& record) {
+	_queue.push_back(entry(record));
+	_statistics.queued = _queue.size();
+	if (_statistics.queued > _statistics.maxqueued) {
+		_statistics.maxqueued = _statistics.queued;
+	}
+}
+
+/**
+ * \brief Add an event to the journal
+ *
+ * This method never waits for the database. It returns false if the
+ * event was suppressed by a rate limit or dropped because the queue
+ * is full.
+ */
+bool	EventJournal::add(const EventRecord& record) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	if (_terminate) {
+		return false;
+	}
+
+	// apply the rate limit of the subsystem
+	std::map<std::string, EventRateLimit>::iterator	l
+		= _limits.find(record.subsystem);
+	if ((l != _limits.end()) && (!l->second.admit(Timer::gettime()))) {
+		_suppressed[record.subsystem]++;
+		_statistics.suppressed++;
+		return false;
+	}
+
+	// merge with the last queued event of the same subsystem
+	std::deque<entry>::reverse_iterator	i = _queue.rbegin();
+	for (int n = 0; (i != _queue.rend()) && (n < COALESCE_DEPTH);
+		i++, n++) {
+		if (i->record.subsystem != record.subsystem) {
+			continue;
+		}
+		if (same(i->record, record)) {
+			i->repeats++;
+			_statistics.coalesced++;
+			return true;
+		}
+		break;
+	}
+
+	// report events that were lost since the last event got through
+	if (_queue.size() + 2 < _capacity) {
+		if (_dropped > 0) {
+			EventRecord	notice(record);
+			notice.level = WARNING;
+			notice.message = stringprintf("%lu events dropped, "
+				"event queue full", _dropped);
+			enqueue(notice);
+			_dropped = 0;
+		}
+		unsigned long&	suppressed = _suppressed[record.subsystem];
+		if (suppressed > 0) {
+			EventRecord	notice(record);
+			notice.level = NOTICE;
+			notice.message = stringprintf("%lu %s events suppressed "
+				"by rate limit", suppressed,
+				record.subsystem.c_str());
+			enqueue(notice);
+			suppressed = 0;
+		}
+	}
+
+	// a full queue drops the new event
+	if (_queue.size() >= _capacity) {
+		_dropped++;
+		_statistics.dropped++;
+		return false;
+	}
+	enqueue(record);
+
+	// the writer thread is only started when it is needed
+	if (!_thread.joinable()) {
+		_thread = std::thread(main, this);
+	}
+	_condition.notify_all();
+	return true;
+}
+
+/**
+ * \brief Wait until the queue is empty and no batch is being written
+ */
+bool	EventJournal::wait(double timeout) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	std::chrono::duration<double>	d(timeout);
+	return _condition.wait_for(lock, d, [this]() {
+		return _queue.empty() && (_writing == 0);
+	});
+}
+
+/**
+ * \brief Stop the writer thread
+ *
+ * Events already in the queue are written before the thread terminates,
+ * events added after this method was called are ignored.
+ */
+void	EventJournal::stop() {
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		_terminate = true;
+		_condition.notify_all();
+	}
+	if (_thread.joinable()) {
+		_thread.join();
+	}
+}
+
+void	EventJournal::main(EventJournal *journal) {
+	try {
+		journal->run();
+	} catch (const std::exception& x) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "event journal terminated: %s",
+			x.what());
+	} catch (...) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "event journal terminated");
+	}
+}
+
+/**
+ * \brief Main function of the writer thread
+ *
+ * The thread takes all events waiting in the queue, up to the batch
+ * size, and writes them in a single transaction. While a batch is being
+ * written, new events accumulate for the next batch.
+ */
+void	EventJournal::run() {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	while (true) {
+		while (_queue.empty() && !_terminate) {
+			_condition.wait(lock);
+		}
+		if (_queue.empty()) {
+			return;
+		}
+
+		// take a batch from the queue
+		std::vector<EventRecord>	batch;
+		while ((!_queue.empty()) && (batch.size() < _batchsize)) {
+			entry&	e = _queue.front();
+			if (e.repeats > 0) {
+				e.record.message.append(stringprintf(
+					" (%d times)", e.repeats + 1));
+			}
+			batch.push_back(e.record);
+			_queue.pop_front();
+		}
+		_writing = batch.size();
+		_statistics.queued = _queue.size();
+		Database	database = _database;
+		CallbackPtr	callback = _callback;
+		lock.unlock();
+
+		// write the batch in a single transaction
+		bool	written = false;
+		try {
+			if (!database) {
+				throw std::runtime_error("no database");
+			}
+			EventTable	table(database);
+			std::vector<long>	ids = table.add(batch);
+			for (size_t i = 0; i < batch.size(); i++) {
+				batch[i].id(ids[i]);
+			}
+			written = true;
+		} catch (const std::exception& x) {
+			debug(LOG_ERR, DEBUG_LOG, 0, "cannot write %lu events: %s",
+				(unsigned long)batch.size(), x.what());
+		}
+
+		// send the written events to the callback
+		if (written && callback) {
+			std::vector<EventRecord>::const_iterator	r;
+			for (r = batch.begin(); r != batch.end(); r++) {
+				try {
+					CallbackDataPtr	cd(
+						new EventCallbackData(*r));
+					callback->operator()(cd);
+				} catch (const std::exception& x) {
+					debug(LOG_ERR, DEBUG_LOG, 0,
+						"event callback failed: %s",
+						x.what());
+				}
+			}
+		}
+
+		// remember the written events
+		lock.lock();
+		if (written) {
+			_statistics.written += batch.size();
+			_statistics.batches++;
+			// nothing before the first event written is known
+			if (_historybase < 0) {
+				_historybase = batch.front().id() - 1;
+				_historystart = eventtime(batch.front());
+			}
+			_history.insert(_history.end(), batch.begin(),
+				batch.end());
+			// event times have microsecond resolution
+			while (_history.size() > _historysize) {
+				_historystart = eventtime(_history.front())
+						+ 0.000001;
+				_historybase = _history.front().id();
+				_history.pop_front();
+			}
+		} else {
+			_statistics.failed += batch.size();
+		}
+		_writing = 0;
+		_condition.notify_all();
+	}
+}
+
+/**
+ * \brief Get the events between from and to from memory
+ *
+ * Only events written by this process are kept in memory. Since ids
+ * are assigned in increasing order, events written by other processes
+ * to the same database leave gaps in the ids of the events in memory,
+ * or have ids beyond the last one written by this process, which costs
+ * a single primary key lookup to find out. The method returns false in
+ * that case, or if older events have already been evicted from memory,
+ * and the caller has to query the database.
+ */
+bool	EventJournal::recent(double from, double to,
+		std::list<EventRecord>& events) const {
+	std::list<EventRecord>	result;
+	long	lastid;
+	Database	database;
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		if (_history.empty() || (from < _historystart)) {
+			return false;
+		}
+		lastid = _historybase;
+		std::deque<EventRecord>::const_iterator	i;
+		for (i = _history.begin(); i != _history.end(); i++) {
+			if (i->id() != lastid + 1) {
+				return false;
+			}
+			lastid = i->id();
+			double	t = eventtime(*i);
+			if ((from <= t) && (t <= to)) {
+				result.push_back(*i);
+			}
+		}
+		database = _database;
+	}
+	if (!database) {
+		return false;
+	}
+	try {
+		EventTable	table(database);
+		if (table.lastid() != lastid) {
+			return false;
+		}
+	} catch (const std::exception& x) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "cannot check last event id: %s",
+			x.what());
+		return false;
+	}
+	events.splice(events.end(), result);
+	return true;
+}
+
+/**
+ * \brief Find a recently written event by its id
+ */
+bool	EventJournal::find(int id, EventRecord& record) const {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	std::deque<EventRecord>::const_reverse_iterator	i;
+	for (i = _history.rbegin(); i != _history.rend(); i++) {
+		if (i->id() == id) {
+			record = *i;
+			return true;
+		}
+	}
+	return false;
+}
+
+EventJournalStatistics	EventJournal::statistics() const {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	return _statistics;
+}
+
+} // namespace events
+} // namespace astro
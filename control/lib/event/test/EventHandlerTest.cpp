@@ -11,8 +11,9 @@
 #include <AstroDebug.h>
 #include <AstroConfig.h>
 #include <AstroEvent.h>
+#include <AstroFormat.h>
 
-using namespace astro::event;
+using namespace astro::events;
 using namespace astro::persistence;
 using namespace astro::config;
 
@@ -25,9 +26,13 @@ public:
 	void	setUp();
 	void	tearDown();
 	void	testEventHandler();
+	void	testJournal();
+	void	testRateLimit();
 
 	CPPUNIT_TEST_SUITE(EventHandlerTest);
 	CPPUNIT_TEST(testEventHandler);
+	CPPUNIT_TEST(testJournal);
+	CPPUNIT_TEST(testRateLimit);
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -47,12 +52,99 @@ void	EventHandlerTest::testEventHandler() {
 	EventTable	table(database);
 	table.remove("0 = 0");
 	EventHandler::active(true);
-	::event(EVENT_LOG, Event::DEBUG, "handler test");
+	astro::event(EVENT_GLOBAL, DEBUG, Event::DEBUG, "handler test");
+	// events are written asynchronously
+	CPPUNIT_ASSERT(EventHandler::flush());
 	EventRecord	record = table.byid(1);
 	CPPUNIT_ASSERT(record.pid == getpid());
 	CPPUNIT_ASSERT(record.subsystem == "debug");
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "testEventHandler() end");
 }
 
+static EventRecord	testrecord(const std::string& subsystem,
+				const std::string& message) {
+	EventRecord	record(-1);
+	record.level = INFO;
+	record.pid = getpid();
+	record.service = "test";
+	gettimeofday(&record.eventtime, NULL);
+	record.subsystem = subsystem;
+	record.message = message;
+	record.file = __FILE__;
+	record.line = __LINE__;
+	return record;
+}
+
+void	EventHandlerTest::testJournal() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testJournal() begin");
+	EventTable	table(database);
+	table.remove("0 = 0");
+	double	start = Timer::gettime();
+	EventJournal	journal(16, 4, 4);
+	journal.database(database);
+	for (int i = 0; i < 10; i++) {
+		CPPUNIT_ASSERT(journal.add(testrecord("guide", "repeated")));
+	}
+	for (int i = 0; i < 6; i++) {
+		journal.add(testrecord("device",
+			stringprintf("message %d", i)));
+	}
+	CPPUNIT_ASSERT(journal.wait(10));
+	EventJournalStatistics	statistics = journal.statistics();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", statistics.toString().c_str());
+	CPPUNIT_ASSERT(statistics.written + statistics.coalesced == 16);
+	CPPUNIT_ASSERT(table.count() == (long)statistics.written);
+
+	// the history only keeps the last 4 written events
+	std::list<EventRecord>	events;
+	CPPUNIT_ASSERT(!journal.recent(start, Timer::gettime(), events));
+	EventRecord	last(-1);
+	CPPUNIT_ASSERT(journal.find(table.lastid(), last));
+	CPPUNIT_ASSERT(last.message == "message 5");
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testJournal() end");
+}
+
+void	EventHandlerTest::testRateLimit() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testRateLimit() begin");
+	EventTable	table(database);
+	table.remove("0 = 0");
+	EventJournal	journal(64, 16, 64);
+	journal.database(database);
+	double	start = Timer::gettime();
+	journal.ratelimit("focus", 1, 3);
+	int	admitted = 0;
+	for (int i = 0; i < 10; i++) {
+		if (journal.add(testrecord("focus",
+			stringprintf("focus %d", i)))) {
+			admitted++;
+		}
+	}
+	CPPUNIT_ASSERT(admitted == 3);
+	CPPUNIT_ASSERT(journal.wait(10));
+	CPPUNIT_ASSERT(journal.statistics().suppressed == 7);
+
+	// the next event that passes reports the suppressed events
+	journal.ratelimit("focus", 0);
+	journal.add(testrecord("focus", "after"));
+	CPPUNIT_ASSERT(journal.wait(10));
+	// nothing is known before the first event the journal has written
+	std::list<EventRecord>	events;
+	CPPUNIT_ASSERT(!journal.recent(start, Timer::gettime() + 1, events));
+	EventRecord	first(-1);
+	CPPUNIT_ASSERT(journal.find(table.lastid() - 4, first));
+	double	from = first.eventtime.tv_sec
+			+ first.eventtime.tv_usec / 1000000.;
+	CPPUNIT_ASSERT(journal.recent(from, Timer::gettime() + 1, events));
+	CPPUNIT_ASSERT(events.size() == 5);
+	CPPUNIT_ASSERT(events.back().message == "after");
+
+	// events written by another process are not in memory
+	table.add(testrecord("focus", "other process"));
+	events.clear();
+	CPPUNIT_ASSERT(!journal.recent(from, Timer::gettime() + 1, events));
+	CPPUNIT_ASSERT(events.size() == 0);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testRateLimit() end");
+}
+
 } // namespace test
 } // namespace astro
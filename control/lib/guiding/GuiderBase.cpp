@@ -45,7 +45,9 @@ ImagePtr	GuiderBase::getImage() {
  */
 GuiderBase::GuiderBase(const GuiderName& guidername, camera::CcdPtr ccd,
 	persistence::Database database)
-	: GuiderName(guidername), _imager(ccd), _database(database)  {
+	: GuiderName(guidername), _imager(ccd), _database(database),
+	  _imagepool(4, callback::ImageCallbackData(ImagePtr())),
+	  _trackingpool(16, TrackingPoint()) {
 }
 
 void	GuiderBase::addImageCallback(callback::CallbackPtr callback) {
@@ -109,6 +111,18 @@ void	GuiderBase::removeBacklashCallback(callback::CallbackPtr callback) {
 	_backlashcallback.erase(callback);
 }
 
+/**
+ * \brief Delivery statistics of the asynchronous image and tracking callbacks
+ */
+std::vector<callback::CallbackStatistics>	GuiderBase::callbackStatistics() const {
+	std::vector<callback::CallbackStatistics>	result
+		= _imagecallback.statistics();
+	std::vector<callback::CallbackStatistics>	tracking
+		= _trackingcallback.statistics();
+	result.insert(result.end(), tracking.begin(), tracking.end());
+	return result;
+}
+
 /**
  * \brief Callback for images
  */
@@ -116,9 +130,8 @@ void	GuiderBase::callback(image::ImagePtr image) {
 	if (!image) {
 		return;
 	}
-	callback::ImageCallbackData	*argp
-		= new callback::ImageCallbackData(image);
-        callback::CallbackDataPtr arg(argp);
+	callback::CallbackDataPtr	arg
+		= _imagepool.get(callback::ImageCallbackData(image));
 	_imagecallback(arg);
 }
 
@@ -126,8 +139,7 @@ void	GuiderBase::callback(image::ImagePtr image) {
  * \brief Callback for tracking points
  */
 void	GuiderBase::callback(const TrackingPoint& point) {
-	callback::CallbackDataPtr       trackinginfo(
-		new TrackingPoint(point));
+	callback::CallbackDataPtr	trackinginfo = _trackingpool.get(point);
 	_trackingcallback(trackinginfo);
 }
 
@@ -4,6 +4,7 @@
  * (c) 2014 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
 #include "TrackingPersistence.h"
+#include <mutex>
 
 using namespace astro::persistence;
 
@@ -120,5 +121,31 @@ UpdateSpec	TrackingTableAdapter::object_to_updatespec(const TrackingPointRecord&
 	return spec;
 }
 
+/**
+ * \brief Databases on which the tracking index is known to exist
+ */
+static std::mutex	indexed_mutex;
+static std::vector<std::weak_ptr<DatabaseBackend> >	indexed;
+
+TrackingTable::TrackingTable(Database database)
+	: Table<TrackingPointRecord, TrackingTableAdapter>(database) {
+	std::unique_lock<std::mutex>	lock(indexed_mutex);
+	auto	i = indexed.begin();
+	while (i != indexed.end()) {
+		Database	d = i->lock();
+		if (!d) {
+			i = indexed.erase(i);
+			continue;
+		}
+		if (d == database) {
+			return;
+		}
+		i++;
+	}
+	database->query("create index if not exists tracking_x1 "
+		"on tracking(track, trackingtime)");
+	indexed.push_back(database);
+}
+
 } // namespace guiding
 } // namespace astro
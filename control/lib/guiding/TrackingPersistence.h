@@ -48,7 +48,20 @@ static TrackingPointRecord	row_to_object(int objectid, const astro::persistence:
 static astro::persistence::UpdateSpec	object_to_updatespec(const TrackingPointRecord& tracking);
 };
 
-typedef astro::persistence::Table<TrackingPointRecord, TrackingTableAdapter>	TrackingTable;
+/**
+ * \brief Tracking table
+ *
+ * History queries always select by track and time, the constructor makes
+ * sure there is an index for this, also in databases created before the
+ * index was introduced. Tracking tables are constructed for every
+ * tracking point, so the index is only checked the first time a table
+ * is opened on a database.
+ */
+class TrackingTable : public astro::persistence::Table<TrackingPointRecord,
+					TrackingTableAdapter> {
+public:
+	TrackingTable(astro::persistence::Database database);
+};
 
 } // namespace guiding
 } // namespace astro
@@ -6,6 +6,7 @@
 #include <AstroGuiding.h>
 #include "TrackingProcess.h"
 #include "TrackingPersistence.h"
+#include <AstroMetrics.h>
 
 using namespace astro::callback;
 using namespace astro::thread;
@@ -215,6 +216,15 @@ cleanup:
 void	TrackingProcess::step(thread::Thread<TrackingProcess>& thread,
 		double imageInterval,
 		double& guideportTime) {
+	static metrics::Histogram&	steptime
+		= metrics::Metrics::histogram("guiding.tracking.step");
+	static metrics::Histogram&	imagetime
+		= metrics::Metrics::histogram("guiding.tracking.image");
+	static metrics::Counter&	aocorrections
+		= metrics::Metrics::counter("guiding.tracking.aocorrections");
+	static metrics::Counter&	gpcorrections
+		= metrics::Metrics::counter("guiding.tracking.gpcorrections");
+
 	// we measure the time it takes to get an exposure. This
 	// may be larger than the interval, so we need the time
 	// to protect from overcorrecting
@@ -229,6 +239,7 @@ void	TrackingProcess::step(thread::Thread<TrackingProcess>& thread,
 	double	imageTime = Timer::gettime();
 	ImagePtr	image = guider()->getImage();
 	timer.end();
+	imagetime.record(timer.elapsed());
 	debug(LOG_DEBUG, DEBUG_LOG, 0,
 		"TRACK %d: new image received, elapsed = %f", _id,
 		timer.elapsed());
@@ -266,6 +277,7 @@ void	TrackingProcess::step(thread::Thread<TrackingProcess>& thread,
 		// do the correction using the adaptive optics device
 		remainder = _adaptiveOpticsDevice->correct(offset,
 			_adaptiveopticsInterval, _stepping);
+		aocorrections.increment();
 		debug(LOG_DEBUG, DEBUG_LOG, 0,
 			"TRACK %d: offset remaining after AO: %s", _id,
 			remainder.toString().c_str());
@@ -288,6 +300,7 @@ void	TrackingProcess::step(thread::Thread<TrackingProcess>& thread,
 			Point	d = _guidePortDevice->correct(remainder,
 				_guideportInterval, _stepping);
 			guideportTime = Timer::gettime();
+			gpcorrections.increment();
 			debug(LOG_DEBUG, DEBUG_LOG, 0,
 				"TRACK %d: guideport leaves offset %s",
 				_id, d.toString().c_str());
@@ -297,6 +310,9 @@ void	TrackingProcess::step(thread::Thread<TrackingProcess>& thread,
 			"TRACK %d: no usable guider port", _id);
 	}
 
+	// time spent in this step, not counting the sleep below
+	steptime.record(Timer::gettime() - imageTime);
+
 	// time we want to sleep until the next AO action is waranted
 	double	dt = imageTime + imageInterval - Timer::gettime();
 	if (dt > 0) {
@@ -7,6 +7,7 @@
 #include <AstroDebug.h>
 #include <TrackingPersistence.h>
 #include <sstream>
+#include <limits>
 
 using namespace astro::persistence;
 
@@ -110,6 +111,83 @@ TrackingHistory	TrackingStore::get(long id,
 	return history;
 }
 
+/**
+ * \brief Get a column oriented tracking history
+ *
+ * \param id		the track id
+ * \param type		the control device for which to retrieve points
+ * \param fromtime	start of the time range in seconds since the start
+ *			of the track
+ * \param totime	end of the time range in seconds since the start
+ *			of the track, 0 means until the end of the track
+ * \param binwidth	if positive, the points are averaged over bins of
+ *			this width in seconds, so the amount of data
+ *			transferred is bounded by the time range
+ */
+TrackingSeries	TrackingStore::getSeries(long id, ControlDeviceType type,
+		double fromtime, double totime, double binwidth) {
+	TrackTable	table(_database);
+	TrackRecord	track = table.byid(id);
+	TrackingTable	trackingtable(_database);	// ensures the index
+
+	TrackingSeries	series;
+	series.trackid = id;
+	series.whenstarted = track.whenstarted;
+	series.type = type;
+	series.binwidth = (binwidth > 0) ? binwidth : 0;
+	double	start = series.whenstarted + fromtime;
+	double	end = (totime > 0) ? (series.whenstarted + totime)
+			: std::numeric_limits<double>::max();
+	int	controltype = (type == AO) ? 1 : 0;
+
+	std::ostringstream	qstr;
+	if (series.binwidth > 0) {
+		qstr << "select avg(trackingtime), avg(xoffset), avg(yoffset), ";
+		qstr << "avg(racorrection), avg(deccorrection), count(*) ";
+	} else {
+		qstr << "select trackingtime, xoffset, yoffset, ";
+		qstr << "racorrection, deccorrection, 1 ";
+	}
+	qstr << "from tracking ";
+	qstr << "where track = ? and trackingtime >= ? and trackingtime < ? ";
+	qstr << "and controltype = ? ";
+	if (series.binwidth > 0) {
+		qstr << "group by cast((trackingtime - ?) / ? as integer) ";
+		qstr << "order by 1";
+	} else {
+		qstr << "order by trackingtime";
+	}
+	persistence::StatementPtr	statement
+		= _database->statement(qstr.str());
+	statement->bind(0, (int)id);
+	statement->bind(1, start);
+	statement->bind(2, end);
+	statement->bind(3, controltype);
+	if (series.binwidth > 0) {
+		statement->bind(4, start);
+		statement->bind(5, series.binwidth);
+	}
+	Result	result = statement->result();
+
+	series.time.reserve(result.size());
+	series.xoffset.reserve(result.size());
+	series.yoffset.reserve(result.size());
+	series.racorrection.reserve(result.size());
+	series.deccorrection.reserve(result.size());
+	for (auto row = result.begin(); row != result.end(); row++) {
+		series.time.push_back((*row)[0]->doubleValue()
+			- series.whenstarted);
+		series.xoffset.push_back((*row)[1]->doubleValue());
+		series.yoffset.push_back((*row)[2]->doubleValue());
+		series.racorrection.push_back((*row)[3]->doubleValue());
+		series.deccorrection.push_back((*row)[4]->doubleValue());
+		series.count += (*row)[5]->intValue();
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "track %ld: %d values from %ld points",
+		id, series.size(), series.count);
+	return series;
+}
+
 /**
  * \brief Delete the tracking history
  */
@@ -0,0 +1,96 @@
+/*
+ * TrackingStoreTest.cpp -- test column oriented tracking history retrieval
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroGuiding.h>
+#include <AstroDebug.h>
+#include "../TrackingPersistence.h"
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cmath>
+#include <includes.h>
+
+using namespace astro::guiding;
+using namespace astro::persistence;
+
+namespace astro {
+namespace test {
+
+class TrackingStoreTest : public CppUnit::TestFixture {
+	Database	database;
+	long	trackid;
+public:
+	void	setUp();
+	void	tearDown();
+	void	testSeries();
+	void	testBinnedSeries();
+
+	CPPUNIT_TEST_SUITE(TrackingStoreTest);
+	CPPUNIT_TEST(testSeries);
+	CPPUNIT_TEST(testBinnedSeries);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+/**
+ * \brief Create a track with 100 GP points, one per second
+ */
+void	TrackingStoreTest::setUp() {
+	unlink("trackingstoretest.db");
+	database = DatabaseFactory::get("trackingstoretest.db");
+	TrackRecord	track(-1);
+	track.name = "test";
+	track.instrument = "INSTRUMENT";
+	track.ccd = "ccd:simulator/camera/ccd";
+	track.guideport = "guideport:simulator/guideport";
+	track.whenstarted = 1000000000;
+	track.guideportcalid = -1;
+	track.adaptiveopticscalid = -1;
+	TrackTable	tracktable(database);
+	trackid = tracktable.add(track);
+	TrackingTable	trackingtable(database);
+	std::vector<TrackingPointRecord>	points;
+	for (int i = 0; i < 100; i++) {
+		TrackingPoint	p(track.whenstarted + i + 0.5, Point(i, -i),
+			Point(0.1, 0.2));
+		p.type = GP;
+		points.push_back(TrackingPointRecord(-1, trackid, p));
+	}
+	trackingtable.add(points);
+}
+
+void	TrackingStoreTest::tearDown() {
+	database.reset();
+	unlink("trackingstoretest.db");
+}
+
+void	TrackingStoreTest::testSeries() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSeries() begin");
+	TrackingStore	store(database);
+	TrackingSeries	series = store.getSeries(trackid, GP, 10, 20);
+	CPPUNIT_ASSERT(series.size() == 10);
+	CPPUNIT_ASSERT(series.count == 10);
+	CPPUNIT_ASSERT(fabs(series.time[0] - 10.5) < 1e-6);
+	CPPUNIT_ASSERT(series.xoffset[0] == 10);
+	CPPUNIT_ASSERT(series.yoffset[9] == -19);
+	CPPUNIT_ASSERT(store.getSeries(trackid, AO).size() == 0);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSeries() end");
+}
+
+void	TrackingStoreTest::testBinnedSeries() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testBinnedSeries() begin");
+	TrackingStore	store(database);
+	TrackingSeries	series = store.getSeries(trackid, GP, 0, 0, 10);
+	CPPUNIT_ASSERT(series.size() == 10);
+	CPPUNIT_ASSERT(series.count == 100);
+	CPPUNIT_ASSERT(fabs(series.time[0] - 5) < 1e-6);
+	CPPUNIT_ASSERT(fabs(series.xoffset[0] - 4.5) < 1e-6);
+	CPPUNIT_ASSERT(fabs(series.racorrection[9] - 0.1) < 1e-6);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testBinnedSeries() end");
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TrackingStoreTest);
+
+} // namespace test
+} // namespace astro
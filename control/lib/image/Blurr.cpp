@@ -4,7 +4,7 @@
  * (c) 2013 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
 #include <Blurr.h>
-#include <fftw3.h>
+#include <AstroConvolve.h>
 #include <math.h>
 #include <AstroDebug.h>
 
@@ -69,85 +69,27 @@ double	Blurr::aperture(double r) const {
  * \brief Compute the blurr
  *
  * This method takes as point spread function of the telescope the
- * diffraction pattern of the 
+ * (possibly obstructed) aperture disk. The kernel only extends over
+ * the radius, so the ConvolutionEngine can convolve it in the spatial
+ * domain for small radii, and switches to Fourier transforms for large
+ * ones. As before, the image is treated as periodic.
  */
 Image<double>	Blurr::operator()(const Image<double>& image) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "computing the convolution for blurr");
-	// how large is the pixel array that we should use for the
-	// computation
-	//size_t	n = image.size().getPixels();
-	int	n0 = image.size().height();
-	int	n1 = image.size().width();
-	size_t	nc = n0 * (1 + (n1 / 2));
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "nc = %d", nc);
-
-	// compute the blurring function
-	Image<double>	blurr(ImageSize(n1, n0));
-
-	// allocate memory for the transform
-	fftw_complex	*af = (fftw_complex *)fftw_malloc(
-					sizeof(fftw_complex) * nc);
-	fftw_complex	*bf = (fftw_complex *)fftw_malloc(
-					sizeof(fftw_complex) * nc);
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "transform memory allocated");
-
-	// plan the fourier transform for the forward transform
-	fftw_plan	p = fftw_plan_dft_r2c_2d(n0, n1, 
-				image.pixels, af, FFTW_ESTIMATE);
-	fftw_plan	q = fftw_plan_dft_r2c_2d(n0, n1, 
-				blurr.pixels, bf, FFTW_ESTIMATE);
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "transforms planned");
-
-	// compute the values of the blurring function
-	double	value = 1. / (n0 * n1);
-	debug(LOG_DEBUG, DEBUG_LOG, 0,
-		"radius = %.1f, innerradius = %.1f, value = %f",
-		_radius, _innerradius, value);
-	for (int x = 0; x < n1; x++) {
-		for (int y = 0; y < n0; y++) {
-			int	xx = (x > (n0 / 2)) ? (n1 - x) : x;
-			int	yy = (y > (n1 / 2)) ? (n0 - y) : y;
-			double	r = hypot(xx, yy);
-			blurr.pixel(x, y) = value * aperture(r);
+	int	r = floor(_radius);
+	Image<double>	kernel(ImageSize(2 * r + 1, 2 * r + 1));
+	for (int x = -r; x <= r; x++) {
+		for (int y = -r; y <= r; y++) {
+			kernel.pixel(x + r, y + r) = aperture(hypot(x, y));
 		}
 	}
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "blurr kernel computed");
-
-	// compute the fourier transforms
-	fftw_execute(p);
-	fftw_execute(q);
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "transform computed");
-
-	// compute the product
-	for (unsigned int i = 0; i < nc; i++) {
-		fftw_complex	product;
-		product[0] = af[i][0] * bf[i][0] - af[i][1] * bf[i][1];
-		product[1] = af[i][1] * bf[i][0] + af[i][0] * bf[i][1];
-		af[i][0] = product[0];
-		af[i][1] = product[1];
-	}
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "product computed");
-
-	// prepare a pixel which will contain the blurred pixels
-	Image<double>	blurred(n1, n0);
-
-	// compute the inverse fourier transform
-	fftw_plan	r = fftw_plan_dft_c2r_2d(n0, n1,
-				af, blurred.pixels, FFTW_ESTIMATE);
-	fftw_execute(r);
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "inverse transform computed");
-
-	// clean up the memory allocated
-	fftw_destroy_plan(r);
-	fftw_destroy_plan(q);
-	fftw_destroy_plan(p);
-	fftw_free(af);
-	fftw_free(bf);
-	fftw_cleanup();
+	debug(LOG_DEBUG, DEBUG_LOG, 0,
+		"radius = %.1f, innerradius = %.1f, kernel %s",
+		_radius, _innerradius, kernel.size().toString().c_str());
+	ConvolutionEngine	engine(adapter::ConvolutionKernel(kernel), true);
+	ImagePtr	blurred = engine(image);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "blurr computation complete");
-
-	// return the blurred image
-	return blurred;
+	return *dynamic_cast<Image<double> *>(&*blurred);
 }
 
 } // namespace image
@@ -0,0 +1,269 @@
+/*
+ * Conversion.cpp -- fast conversion kernels for streaming cameras
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroConversion.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+
+namespace astro {
+namespace image {
+
+/*
+ * Fixed point formulae, they are the same as those of the unsigned char
+ * specializations of convertPixelPairTyped in Pixel.cpp. Integer min/max
+ * instead of branches keeps the loops vectorizable.
+ */
+static inline uint8_t	clamp8(int x) {
+	return (x < 0) ? 0 : ((x > 255) ? 255 : x);
+}
+
+static inline void	yuv2rgb(int y, int d, int e, uint8_t *R, uint8_t *G,
+				uint8_t *B) {
+	int	c = 298 * (y - 16) + 128;
+	*R = clamp8((c           + 409 * e) >> 8);
+	*G = clamp8((c - 100 * d - 208 * e) >> 8);
+	*B = clamp8((c + 516 * d          ) >> 8);
+}
+
+/*
+ * The luminance of an RGB pixel uses the weights of RGB<P>::luminance()
+ * scaled by 2^16, they add up to 65536
+ */
+static inline uint8_t	rgbluminance(int R, int G, int B) {
+	return (13933 * R + 46871 * G + 4732 * B) >> 16;
+}
+
+/**
+ * \brief Scaling parameters for the 16 to 8 bit conversion
+ *
+ * Values are first clipped to [black, white] so that the product with
+ * the 16.16 fixed point factor cannot overflow 32 bits.
+ */
+class scale16 {
+public:
+	uint32_t	black;
+	uint32_t	range;
+	uint32_t	factor;
+	scale16(uint16_t _black, uint16_t white) : black(_black) {
+		if (white <= _black) {
+			std::string	msg = stringprintf("bad scaling range "
+				"[%hu,%hu]", _black, white);
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+			throw std::range_error(msg);
+		}
+		range = white - _black;
+		factor = ((255U << 16) + range / 2) / range;
+	}
+	uint8_t	operator()(uint32_t v) const {
+		uint32_t	d = (v > black) ? (v - black) : 0;
+		d = (d > range) ? range : d;
+		return (d * factor + 32768) >> 16;
+	}
+};
+
+namespace kernels {
+
+/**
+ * \brief Convert packed YUYV to packed RGB
+ */
+void	yuyv2rgb(const uint8_t *yuyv, uint8_t *rgb, size_t pixels) {
+	size_t	pairs = pixels / 2;
+#	pragma omp simd
+	for (size_t i = 0; i < pairs; i++) {
+		const uint8_t	*s = yuyv + 4 * i;
+		uint8_t	*t = rgb + 6 * i;
+		int	d = s[1] - 128;
+		int	e = s[3] - 128;
+		yuv2rgb(s[0], d, e, t + 0, t + 1, t + 2);
+		yuv2rgb(s[2], d, e, t + 3, t + 4, t + 5);
+	}
+}
+
+/**
+ * \brief Extract the Y channel of packed YUYV
+ */
+void	yuyv2luminance(const uint8_t *yuyv, uint8_t *luminance,
+		size_t pixels) {
+#	pragma omp simd
+	for (size_t i = 0; i < pixels; i++) {
+		luminance[i] = yuyv[2 * i];
+	}
+}
+
+/**
+ * \brief Convert packed RGB to luminance
+ */
+void	rgb2mono(const uint8_t *rgb, uint8_t *mono, size_t pixels) {
+#	pragma omp simd
+	for (size_t i = 0; i < pixels; i++) {
+		const uint8_t	*s = rgb + 3 * i;
+		mono[i] = rgbluminance(s[0], s[1], s[2]);
+	}
+}
+
+/**
+ * \brief Scale 16 bit values in [black, white] to the full 8 bit range
+ *
+ * With the default range this is the same as dropping the low byte,
+ * like the generic pixel value conversion.
+ */
+void	scale16to8(const uint16_t *src, uint8_t *dest, size_t pixels,
+		uint16_t black, uint16_t white) {
+	if ((black == 0) && (white == 0xffff)) {
+#		pragma omp simd
+		for (size_t i = 0; i < pixels; i++) {
+			dest[i] = src[i] >> 8;
+		}
+		return;
+	}
+	scale16	s(black, white);
+#	pragma omp simd
+	for (size_t i = 0; i < pixels; i++) {
+		dest[i] = s(src[i]);
+	}
+}
+
+} // namespace kernels
+
+/*
+ * The pixel classes have a virtual table, so image pixel arrays are not
+ * packed and the image versions cannot simply call the buffer kernels.
+ * They use the same inline formulae and distribute rows over threads.
+ */
+template<typename P, typename Q>
+static Image<P>	*newimage(const Image<Q>& image) {
+	Image<P>	*result = new Image<P>(image.size());
+	result->setOrigin(image.origin());
+	result->metadata(image.metadata());
+	return result;
+}
+
+Image<RGB<unsigned char> >	*yuyv2rgb(
+					const Image<YUYV<unsigned char> >& image) {
+	Image<RGB<unsigned char> >	*result
+		= newimage<RGB<unsigned char> >(image);
+	int	w = image.size().width();
+	int	h = image.size().height();
+	const YUYV<unsigned char>	*src = image.pixels;
+	RGB<unsigned char>	*dest = result->pixels;
+#	pragma omp parallel for
+	for (int y = 0; y < h; y++) {
+		const YUYV<unsigned char>	*s = src + y * w;
+		RGB<unsigned char>	*t = dest + y * w;
+		for (int x = 0; x + 1 < w; x += 2) {
+			int	d = s[x].uv - 128;
+			int	e = s[x + 1].uv - 128;
+			yuv2rgb(s[x].y, d, e, &t[x].R, &t[x].G, &t[x].B);
+			yuv2rgb(s[x + 1].y, d, e,
+				&t[x + 1].R, &t[x + 1].G, &t[x + 1].B);
+		}
+	}
+	return result;
+}
+
+Image<unsigned char>	*yuyv2luminance(
+				const Image<YUYV<unsigned char> >& image) {
+	Image<unsigned char>	*result = newimage<unsigned char>(image);
+	size_t	n = image.size().getPixels();
+	const YUYV<unsigned char>	*src = image.pixels;
+	unsigned char	*dest = result->pixels;
+	for (size_t i = 0; i < n; i++) {
+		dest[i] = src[i].y;
+	}
+	return result;
+}
+
+Image<unsigned char>	*rgb2mono(const Image<RGB<unsigned char> >& image) {
+	Image<unsigned char>	*result = newimage<unsigned char>(image);
+	int	n = image.size().getPixels();
+	const RGB<unsigned char>	*src = image.pixels;
+	unsigned char	*dest = result->pixels;
+#	pragma omp parallel for
+	for (int i = 0; i < n; i++) {
+		dest[i] = rgbluminance(src[i].R, src[i].G, src[i].B);
+	}
+	return result;
+}
+
+Image<unsigned char>	*scale16to8(const Image<unsigned short>& image,
+				unsigned short black, unsigned short white) {
+	Image<unsigned char>	*result = newimage<unsigned char>(image);
+	result->setMosaicType(image.getMosaicType());
+	kernels::scale16to8(image.pixels, result->pixels,
+		image.size().getPixels(), black, white);
+	return result;
+}
+
+//////////////////////////////////////////////////////////////////////
+// stream format conversion
+//////////////////////////////////////////////////////////////////////
+std::string	StreamFormat::format2string(format f) {
+	switch (f) {
+	case native:	return std::string("native");
+	case rgb8:	return std::string("rgb8");
+	case mono8:	return std::string("mono8");
+	}
+	throw std::runtime_error("unknown stream format");
+}
+
+StreamFormat::format	StreamFormat::string2format(const std::string& s) {
+	if (s == "native") { return native; }
+	if (s == "rgb8") { return rgb8; }
+	if (s == "mono8") { return mono8; }
+	std::string	msg = stringprintf("unknown stream format '%s'",
+		s.c_str());
+	debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+	throw std::runtime_error(msg);
+}
+
+StreamFormat::StreamFormat(format f, unsigned short black,
+	unsigned short white) : _format(f), _black(black), _white(white) {
+	if (white <= black) {
+		std::string	msg = stringprintf("bad stream range [%hu,%hu]",
+			black, white);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+}
+
+std::string	StreamFormat::toString() const {
+	return stringprintf("%s [%hu,%hu]", format2string(_format).c_str(),
+		_black, _white);
+}
+
+/**
+ * \brief Convert an image of a stream to the requested format
+ */
+ImagePtr	StreamFormat::convert(ImagePtr image) const {
+	format	f = _format;
+	if (f == native) {
+		return image;
+	}
+	Image<YUYV<unsigned char> >	*yuyv
+		= dynamic_cast<Image<YUYV<unsigned char> > *>(&*image);
+	if (NULL != yuyv) {
+		if (f == rgb8) {
+			return ImagePtr(yuyv2rgb(*yuyv));
+		}
+		return ImagePtr(yuyv2luminance(*yuyv));
+	}
+	Image<RGB<unsigned char> >	*rgb
+		= dynamic_cast<Image<RGB<unsigned char> > *>(&*image);
+	if (NULL != rgb) {
+		if (f == mono8) {
+			return ImagePtr(rgb2mono(*rgb));
+		}
+		return image;
+	}
+	Image<unsigned short>	*shortimage
+		= dynamic_cast<Image<unsigned short> *>(&*image);
+	if ((NULL != shortimage) && (f == mono8)) {
+		return ImagePtr(scale16to8(*shortimage, _black, _white));
+	}
+	return image;
+}
+
+} // namespace image
+} // namespace astro
@@ -0,0 +1,165 @@
+/*
+ * ConvolutionEngine.cpp -- convolution in the spatial or Fourier domain
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroConvolve.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <cmath>
+#include <fftw3.h>
+
+using namespace astro::adapter;
+
+namespace astro {
+namespace image {
+
+ConvolutionEngine::ConvolutionEngine(const ConvolutionKernel& kernel,
+	bool periodic) : _kernel(kernel), _periodic(periodic),
+	_method(automatic) {
+}
+
+/**
+ * \brief Find the method used to convolve an image of a given size
+ *
+ * The spatial method needs one multiplication per kernel weight and
+ * pixel, or per row and column weight if the kernel is separable.
+ * The Fourier method needs three transforms of the padded image,
+ * which costs a small multiple of log2 of its size per pixel.
+ */
+ConvolutionEngine::method_type	ConvolutionEngine::method(
+		const ImageSize& size) const {
+	if (_method != automatic) {
+		return _method;
+	}
+	if (_kernel.separable()) {
+		return spatial;
+	}
+	double	padded = size.getPixels();
+	if (!_periodic) {
+		padded = (size.width() + _kernel.size().width() - 1)
+			* (double)(size.height() + _kernel.size().height() - 1);
+	}
+	double	spatialcost = _kernel.size().getPixels();
+	double	fouriercost = 8 * log2(padded) * padded / size.getPixels();
+	return (spatialcost > fouriercost) ? fourier : spatial;
+}
+
+/**
+ * \brief Convolve row by row, rows are computed in parallel
+ */
+Image<double>	*ConvolutionEngine::spatialconvolve(
+		const ConstImageAdapter<double>& image) const {
+	int	w = image.getSize().width();
+	int	h = image.getSize().height();
+	Image<double>	*result = new Image<double>(image.getSize());
+#pragma omp parallel for
+	for (int y = 0; y < h; y++) {
+		_kernel.fillRow(image, _periodic, y, 0, w, result->pixels + y * w);
+	}
+	return result;
+}
+
+/**
+ * \brief Convolve by multiplying Fourier transforms
+ *
+ * With zero border, the image is padded by the kernel size minus one,
+ * so the cyclic convolution computed by the transforms does not wrap
+ * around. The kernel is stored mirrored at the origin, because the
+ * kernel pixel (i,j) multiplies the image pixel at offset
+ * (i - center.x, j - center.y).
+ */
+Image<double>	*ConvolutionEngine::fourierconvolve(
+		const ConstImageAdapter<double>& image) const {
+	int	w = image.getSize().width();
+	int	h = image.getSize().height();
+	int	kw = _kernel.size().width();
+	int	kh = _kernel.size().height();
+	int	pw = (_periodic) ? w : (w + kw - 1);
+	int	ph = (_periodic) ? h : (h + kh - 1);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "fourier convolution on %dx%d array",
+		pw, ph);
+
+	// padded image and kernel arrays
+	int	n = pw * ph;
+	int	nc = ph * (pw / 2 + 1);
+	double	*a = (double *)fftw_malloc(sizeof(double) * n);
+	double	*b = (double *)fftw_malloc(sizeof(double) * n);
+	fftw_complex	*af = (fftw_complex *)fftw_malloc(
+					sizeof(fftw_complex) * nc);
+	fftw_complex	*bf = (fftw_complex *)fftw_malloc(
+					sizeof(fftw_complex) * nc);
+	fftw_plan	p, q, r;
+	{
+		std::unique_lock<std::mutex>	lock(fftw_planner_mutex);
+		p = fftw_plan_dft_r2c_2d(ph, pw, a, af, FFTW_ESTIMATE);
+		q = fftw_plan_dft_r2c_2d(ph, pw, b, bf, FFTW_ESTIMATE);
+		r = fftw_plan_dft_c2r_2d(ph, pw, af, a, FFTW_ESTIMATE);
+	}
+
+	std::fill(a, a + n, 0.);
+	std::fill(b, b + n, 0.);
+#pragma omp parallel for
+	for (int y = 0; y < h; y++) {
+		image.fillRow(y, 0, w, a + y * pw);
+	}
+	for (int j = 0; j < kh; j++) {
+		for (int i = 0; i < kw; i++) {
+			int	x = (((_kernel.center().x() - i) % pw) + pw) % pw;
+			int	y = (((_kernel.center().y() - j) % ph) + ph) % ph;
+			b[x + pw * y] += _kernel.weight(i, j);
+		}
+	}
+	fftw_execute(p);
+	fftw_execute(q);
+
+	// multiply the transforms, including the normalization
+	double	normalize = 1. / n;
+#pragma omp parallel for
+	for (int i = 0; i < nc; i++) {
+		double	re = af[i][0] * bf[i][0] - af[i][1] * bf[i][1];
+		double	im = af[i][1] * bf[i][0] + af[i][0] * bf[i][1];
+		af[i][0] = re * normalize;
+		af[i][1] = im * normalize;
+	}
+	fftw_execute(r);
+
+	Image<double>	*result = new Image<double>(image.getSize());
+	for (int y = 0; y < h; y++) {
+		std::copy(a + y * pw, a + y * pw + w, result->pixels + y * w);
+	}
+
+	{
+		std::unique_lock<std::mutex>	lock(fftw_planner_mutex);
+		fftw_destroy_plan(r);
+		fftw_destroy_plan(q);
+		fftw_destroy_plan(p);
+	}
+	fftw_free(bf);
+	fftw_free(af);
+	fftw_free(b);
+	fftw_free(a);
+	return result;
+}
+
+/**
+ * \brief Convolve an image with the kernel
+ */
+ImagePtr	ConvolutionEngine::operator()(
+		const ConstImageAdapter<double>& image) const {
+	ImageSize	size = image.getSize();
+	if (method(size) == fourier) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0,
+			"convolve %s with %s kernel in Fourier domain",
+			size.toString().c_str(),
+			_kernel.size().toString().c_str());
+		return ImagePtr(fourierconvolve(image));
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "convolve %s with %s%s kernel",
+		size.toString().c_str(), _kernel.size().toString().c_str(),
+		(_kernel.separable()) ? " separable" : "");
+	return ImagePtr(spatialconvolve(image));
+}
+
+} // namespace image
+} // namespace astro
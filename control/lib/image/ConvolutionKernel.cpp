@@ -0,0 +1,147 @@
+/*
+ * ConvolutionKernel.cpp -- precomputed convolution kernels
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroAdapter.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <cmath>
+
+namespace astro {
+namespace adapter {
+
+/**
+ * \brief Construct a kernel from a point spread function
+ *
+ * The center of the kernel is the center pixel of the psf.
+ */
+ConvolutionKernel::ConvolutionKernel(const ConstImageAdapter<double>& psf)
+	: _size(psf.getSize()),
+	  _center(psf.getSize().width() / 2, psf.getSize().height() / 2) {
+	int	w = _size.width();
+	int	h = _size.height();
+	if ((w <= 0) || (h <= 0)) {
+		std::string	msg("empty convolution kernel");
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+	_weights.resize(w * h);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			_weights[x + w * y] = psf.pixel(x, y);
+		}
+	}
+	analyze();
+}
+
+/**
+ * \brief Construct a separable kernel from its one dimensional factors
+ */
+ConvolutionKernel::ConvolutionKernel(const std::vector<double>& horizontal,
+	const std::vector<double>& vertical)
+	: _size((int)horizontal.size(), (int)vertical.size()),
+	  _center((int)horizontal.size() / 2, (int)vertical.size() / 2),
+	  _separable(true), _horizontal(horizontal), _vertical(vertical) {
+	if ((horizontal.size() == 0) || (vertical.size() == 0)) {
+		std::string	msg("empty convolution kernel");
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+	int	w = _size.width();
+	_weights.resize(w * _size.height());
+	for (int y = 0; y < _size.height(); y++) {
+		for (int x = 0; x < w; x++) {
+			_weights[x + w * y] = horizontal[x] * vertical[y];
+		}
+	}
+}
+
+/**
+ * \brief Find out whether the kernel is separable
+ *
+ * A kernel is separable if it has rank 1. The row and column through
+ * the largest weight are candidate factors, the kernel is separable if
+ * their product reproduces all weights.
+ */
+void	ConvolutionKernel::analyze() {
+	int	w = _size.width();
+	int	h = _size.height();
+	int	pivot = 0;
+	for (int i = 1; i < w * h; i++) {
+		if (fabs(_weights[i]) > fabs(_weights[pivot])) {
+			pivot = i;
+		}
+	}
+	double	maximum = fabs(_weights[pivot]);
+	_separable = false;
+	if (maximum == 0) {
+		return;
+	}
+	int	px = pivot % w;
+	int	py = pivot / w;
+	_horizontal.resize(w);
+	_vertical.resize(h);
+	for (int x = 0; x < w; x++) {
+		_horizontal[x] = _weights[x + w * py] / _weights[pivot];
+	}
+	for (int y = 0; y < h; y++) {
+		_vertical[y] = _weights[px + w * y];
+	}
+	double	tolerance = 1e-12 * maximum;
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			double	d = _horizontal[x] * _vertical[y]
+					- _weights[x + w * y];
+			if (fabs(d) > tolerance) {
+				_horizontal.clear();
+				_vertical.clear();
+				return;
+			}
+		}
+	}
+	_separable = true;
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s kernel is separable",
+		_size.toString().c_str());
+}
+
+/**
+ * \brief Normalized gaussian kernel
+ *
+ * The kernel extends to cutoff * sigma from the center.
+ */
+ConvolutionKernel	ConvolutionKernel::gauss(double sigma, double cutoff) {
+	if (sigma <= 0) {
+		std::string	msg = stringprintf("bad gauss sigma %f", sigma);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+	int	r = ceil(cutoff * sigma);
+	std::vector<double>	g(2 * r + 1);
+	double	sum = 0;
+	for (int i = -r; i <= r; i++) {
+		g[i + r] = exp(-(i * i) / (2 * sigma * sigma));
+		sum += g[i + r];
+	}
+	for (int i = 0; i <= 2 * r; i++) {
+		g[i] /= sum;
+	}
+	return ConvolutionKernel(g, g);
+}
+
+/**
+ * \brief Normalized box kernel
+ */
+ConvolutionKernel	ConvolutionKernel::box(int width, int height) {
+	if ((width <= 0) || (height <= 0)) {
+		std::string	msg = stringprintf("bad box size %dx%d",
+			width, height);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+	return ConvolutionKernel(std::vector<double>(width, 1. / width),
+		std::vector<double>(height, 1. / height));
+}
+
+} // namespace adapter
+} // namespace astro
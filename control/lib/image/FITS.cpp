@@ -134,7 +134,9 @@ FITSinfileBase::FITSinfileBase(const std::string& filename)
 	int	status = 0;
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "open FITS file '%s'",
 		filename.c_str());
-	if (fits_open_file(&fptr, filename.c_str(), READONLY, &status)) {
+	// fits_open_image moves to the first HDU containing image data,
+	// which for tile compressed files is the first extension
+	if (fits_open_image(&fptr, filename.c_str(), READONLY, &status)) {
 		throw FITSexception(errormsg(status), filename);
 	}
 
@@ -239,6 +241,24 @@ const char	*ignored_keywords[IGNORED_KEYWORDS_N] = {
 	"XTENSION", "END", "BSCALE", "BZERO",
 };
 
+/**
+ * \brief Keywords describing the binary table of a tile compressed image
+ *
+ * These keywords are only ignored in compressed HDUs, where they are
+ * managed by the FITS library.
+ */
+#define	COMPRESSION_KEYWORDS_N	13
+const char	*compression_keywords[COMPRESSION_KEYWORDS_N] = {
+	"TFIELDS", "THEAP", "EXTNAME", "ZIMAGE", "ZSIMPLE", "ZEXTEND",
+	"ZBITPIX", "ZCMPTYPE", "ZQUANTIZ", "ZDITHER0", "ZBLOCKED",
+	"ZPCOUNT", "ZGCOUNT",
+};
+
+#define	COMPRESSION_PREFIXES_N	7
+const char	*compression_prefixes[COMPRESSION_PREFIXES_N] = {
+	"TTYPE", "TFORM", "ZNAXIS", "ZTILE", "ZNAME", "ZVAL", "ZHECKSUM",
+};
+
 /**
  * \brief Find out whether a key should be ignored
  *
@@ -246,10 +266,12 @@ const char	*ignored_keywords[IGNORED_KEYWORDS_N] = {
  * only process headers that are not explicitely handled by the FITS library.
  * Otherwise it would be impossible to keep the headers consistent.
  * This function tells whether a header is ignored, based on the name.
- * It uses the list of ignored_keywords defined above.
+ * It uses the list of ignored_keywords defined above, and for compressed
+ * images also the compression keywords.
  * \param keyname	header key name 
+ * \param compressed	whether the HDU is a tile compressed image
  */
-static bool	ignored(const std::string& keyname) {
+static bool	ignored(const std::string& keyname, bool compressed) {
 	if (keyname.substr(0, 5) == "NAXIS") {
 		return true;
 	}
@@ -258,6 +280,20 @@ static bool	ignored(const std::string& keyname) {
 			return true;
 		}
 	}
+	if (!compressed) {
+		return false;
+	}
+	for (int i = 0; i < COMPRESSION_KEYWORDS_N; i++) {
+		if (keyname == compression_keywords[i]) {
+			return true;
+		}
+	}
+	for (int i = 0; i < COMPRESSION_PREFIXES_N; i++) {
+		std::string	prefix(compression_prefixes[i]);
+		if (keyname.substr(0, prefix.size()) == prefix) {
+			return true;
+		}
+	}
 	return false;
 }
 
@@ -295,6 +331,11 @@ void	FITSinfileBase::readkeys() {
 	char	keyname[100];
 	char	value[100];
 	char	comment[100];
+	bool	compressed = fits_is_compressed_image(fptr, &status);
+	if (compressed) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "%s is tile compressed",
+			filename.c_str());
+	}
 	while (1) {
 		if (fits_read_keyn(fptr, keynum, keyname, value, comment,
 			&status)) {
@@ -309,7 +350,7 @@ void	FITSinfileBase::readkeys() {
 			// list of attributes, so we stop at this point
 			break;
 		}
-		if (ignored(name)) {
+		if (ignored(name, compressed)) {
 			debug(LOG_DEBUG, DEBUG_LOG, 0, "header '%s' ignored",
 				name.c_str());
 		} else {
@@ -410,6 +451,9 @@ void	FITSoutfileBase::write(const ImageBase& image) {
 		throw FITSexception(errormsg(status));
 	}
 
+	// compression has to be set up before the image HDU is created
+	setupCompression();
+
 	// find the dimensions
 	long	naxis = 3;
 	long	naxes[3] = {
@@ -562,6 +606,44 @@ void	FITSoutfileBase::write(const ImageBase& image) {
 	}
 }
 
+/**
+ * \brief Configure tile compression for the image HDU
+ *
+ * Tiles are single rows of a single plane, which is what CFITSIO uses
+ * by default for RICE, GZIP and PLIO. HCOMPRESS needs two dimensional
+ * tiles, so we leave the tile size to the library in that case.
+ */
+void	FITSoutfileBase::setupCompression() {
+	if (!_compression.enabled()) {
+		return;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "compress %s with %s",
+		filename.c_str(), _compression.toString().c_str());
+	bool	floatingpoint = (imgtype == FLOAT_IMG)
+				|| (imgtype == DOUBLE_IMG);
+
+	// floating point data is only quantized if a quantization level
+	// is requested, otherwise it is compressed losslessly, which
+	// CFITSIO only supports with GZIP
+	int	fitstype = _compression.fitstype();
+	if (floatingpoint && (_compression.quantize() == 0)
+		&& (fitstype != GZIP_1)) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "lossless floating point "
+			"compression of %s uses gzip", filename.c_str());
+		fitstype = GZIP_1;
+	}
+	int	status = 0;
+	if (fits_set_compression_type(fptr, fitstype, &status)) {
+		throw FITSexception(errormsg(status), filename);
+	}
+	if (floatingpoint) {
+		if (fits_set_quantize_level(fptr, _compression.quantize(),
+			&status)) {
+			throw FITSexception(errormsg(status), filename);
+		}
+	}
+}
+
 /**
  * \brief Fix permissions on precious files
  */
@@ -20,7 +20,7 @@ typedef struct {
 	bool	unique;
 } FITSKeyword;
 
-#define	Nkeywors	83
+#define	Nkeywors	87
 FITSKeyword	keywors[Nkeywors] = {
 // standard keywords
 { // 0
@@ -522,6 +522,30 @@ FITSKeyword	keywors[Nkeywors] = {
 	std::type_index(typeid(double)),
 	true
 },
+{ // 83
+	std::string("CD1_1"),
+	std::string("coordinate transformation matrix element"),
+	std::type_index(typeid(double)),
+	true
+},
+{ // 84
+	std::string("CD1_2"),
+	std::string("coordinate transformation matrix element"),
+	std::type_index(typeid(double)),
+	true
+},
+{ // 85
+	std::string("CD2_1"),
+	std::string("coordinate transformation matrix element"),
+	std::type_index(typeid(double)),
+	true
+},
+{ // 86
+	std::string("CD2_2"),
+	std::string("coordinate transformation matrix element"),
+	std::type_index(typeid(double)),
+	true
+},
 };
 
 int	FITSKeywords::type(std::type_index idx) {
@@ -0,0 +1,118 @@
+/*
+ * FITScompression.cpp -- tile compression settings for FITS files
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroIO.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroUtils.h>
+#include <fitsio.h>
+#include <cmath>
+
+namespace astro {
+namespace io {
+
+std::string	FITScompression::method2string(method_t method) {
+	switch (method) {
+	case NONE:
+		return std::string("none");
+	case RICE:
+		return std::string("rice");
+	case GZIP:
+		return std::string("gzip");
+	case HCOMPRESS:
+		return std::string("hcompress");
+	case PLIO:
+		return std::string("plio");
+	}
+	std::string	msg = stringprintf("unknown compression method %d",
+		method);
+	throw std::runtime_error(msg);
+}
+
+FITScompression::method_t	FITScompression::string2method(
+					const std::string& method) {
+	if ((method == "none") || (method.size() == 0)) {
+		return NONE;
+	}
+	if (method == "rice") {
+		return RICE;
+	}
+	if (method == "gzip") {
+		return GZIP;
+	}
+	if (method == "hcompress") {
+		return HCOMPRESS;
+	}
+	if (method == "plio") {
+		return PLIO;
+	}
+	std::string	msg = stringprintf("unknown compression method %s",
+		method.c_str());
+	throw std::runtime_error(msg);
+}
+
+FITScompression::FITScompression(method_t method, float quantize)
+	: _method(method), _quantize(0) {
+	this->quantize(quantize);
+}
+
+/**
+ * \brief Construct compression settings from a string
+ *
+ * The string has the form method[:quantize], where method is one of
+ * none, rice, gzip, hcompress or plio.
+ */
+FITScompression::FITScompression(const std::string& spec)
+	: _method(NONE), _quantize(0) {
+	size_t	colon = spec.find(':');
+	_method = string2method(trim(spec.substr(0, colon)));
+	if (colon != std::string::npos) {
+		quantize(std::stof(spec.substr(colon + 1)));
+	}
+}
+
+void	FITScompression::quantize(float q) {
+	if ((q < 0) || (!std::isfinite(q))) {
+		std::string	msg = stringprintf("bad quantization level %f",
+			q);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+	_quantize = q;
+}
+
+/**
+ * \brief Get the CFITSIO compression type constant
+ */
+int	FITScompression::fitstype() const {
+	switch (_method) {
+	case NONE:
+		return 0;
+	case RICE:
+		return RICE_1;
+	case GZIP:
+		return GZIP_1;
+	case HCOMPRESS:
+		return HCOMPRESS_1;
+	case PLIO:
+		return PLIO_1;
+	}
+	throw std::runtime_error("unknown compression method");
+}
+
+std::string	FITScompression::toString() const {
+	if ((_method == NONE) || (_quantize == 0)) {
+		return method2string(_method);
+	}
+	return stringprintf("%s:%g", method2string(_method).c_str(),
+		_quantize);
+}
+
+bool	FITScompression::operator==(const FITScompression& other) const {
+	return (_method == other._method) && (_quantize == other._quantize);
+}
+
+} // namespace io
+} // namespace astro
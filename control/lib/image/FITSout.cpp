@@ -42,13 +42,15 @@ void	FITSout::unlink() {
  */
 template<typename P>
 static bool	do_write(const std::string& filename, const ImagePtr image,
-			const bool precious = true) {
+			const bool precious = true,
+			const FITScompression& compression = FITScompression()) {
 	Image<P>	*im = dynamic_cast<Image<P> *>(&*image);
 	if (NULL == im) {
 		return false;
 	}
 	FITSoutfile<P>	outfile(filename);
 	outfile.setPrecious(precious);
+	outfile.setCompression(compression);
 	outfile.write(*im);
 	return true;
 }
@@ -61,7 +63,8 @@ static bool	do_write(const std::string& filename, const ImagePtr image,
 void	FITSout::write(const ImagePtr image) {
 	// test the various types, and call the do_write template 
 #define	do_write_typed(type)						\
-	if (do_write<type >(filename, image, precious())) {		\
+	if (do_write<type >(filename, image, precious(),		\
+		compression())) {					\
 		return;							\
 	}
 	do_write_typed(unsigned char)
@@ -86,7 +89,8 @@ void	FITSout::write(const ImagePtr image) {
 	do_write_typed(YUYV<double>)
 
 #define	do_write_multi(type, n)						\
-	if (do_write<Multiplane<type, n> >(filename, image, precious())) {\
+	if (do_write<Multiplane<type, n> >(filename, image, precious(),\
+		compression())) {					\
 		return;							\
 	}
 	do_write_multi(unsigned char,  1)
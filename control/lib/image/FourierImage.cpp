@@ -13,6 +13,8 @@
 namespace astro {
 namespace image {
 
+std::mutex	fftw_planner_mutex;
+
 /**
  * \brief Compute size of the complex fourier transform image
  *
@@ -69,11 +71,17 @@ void	FourierImage::fourier(const Image<double>& image) {
 		n0, n1);
 
 	// compute the fourier transform
-	fftw_plan	p = fftw_plan_dft_r2c_2d(n0, n1, image.pixels,
+	fftw_plan	p;
+	{
+		std::unique_lock<std::mutex>	lock(fftw_planner_mutex);
+		p = fftw_plan_dft_r2c_2d(n0, n1, image.pixels,
 				(fftw_complex *)pixels, FFTW_ESTIMATE);
+	}
 	fftw_execute(p);
-	fftw_destroy_plan(p);
-	fftw_cleanup();
+	{
+		std::unique_lock<std::mutex>	lock(fftw_planner_mutex);
+		fftw_destroy_plan(p);
+	}
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "fourier transform completed");
 }
 
@@ -141,11 +149,17 @@ ImagePtr	FourierImage::inverse() const {
 	int	n1 = _orig.width();
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "inverse transform, (%d,%d)", n0, n1);
 	// compute the fourier transform
-	fftw_plan	p = fftw_plan_dft_c2r_2d(n0, n1, (fftw_complex *)pixels,
+	fftw_plan	p;
+	{
+		std::unique_lock<std::mutex>	lock(fftw_planner_mutex);
+		p = fftw_plan_dft_c2r_2d(n0, n1, (fftw_complex *)pixels,
 				image->pixels, FFTW_ESTIMATE);
+	}
 	fftw_execute(p);
-	fftw_destroy_plan(p);
-	fftw_cleanup();
+	{
+		std::unique_lock<std::mutex>	lock(fftw_planner_mutex);
+		fftw_destroy_plan(p);
+	}
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "inverse fourier transform complete");
 
 	// normalize to the dimensions of the domain
@@ -0,0 +1,137 @@
+/*
+ * HotPixels.cpp -- cosmetic correction of hot and cold pixels
+ *
+ * (c) 2017 Prof Dr Andreas Müller, Hochschule Rapperswil
+ */
+#include <AstroAdapter.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <cmath>
+#include <limits>
+
+namespace astro {
+namespace adapter {
+
+/**
+ * \brief Correct a monochrome image that is not a mosaic
+ */
+template<typename T>
+static size_t	hotpixels_plane(Image<T>& image, int radius,
+			double threshold) {
+	// a zero border would make all pixels near the border look hot
+	SlidingMedian<T>	median(radius, true);
+	Image<T>	*medianimage = median(image);
+	ImagePtr	medianptr(medianimage);
+	int	n = image.size().getPixels();
+
+	// estimate the noise from the median absolute deviation
+	std::vector<float>	deviation(n);
+#pragma omp parallel for
+	for (int i = 0; i < n; i++) {
+		deviation[i] = fabs((double)image.pixels[i]
+				- (double)medianimage->pixels[i]);
+	}
+	std::vector<float>	sorted(deviation);
+	std::nth_element(sorted.begin(), sorted.begin() + n / 2, sorted.end());
+	double	noise = 1.4826 * sorted[n / 2];
+	if (noise <= 0) {
+		// more than half of the pixels equal their local median,
+		// as in flat or heavily quantized images, so use the mean
+		// absolute deviation instead
+		double	sum = 0;
+#pragma omp parallel for reduction(+:sum)
+		for (int i = 0; i < n; i++) {
+			sum += deviation[i];
+		}
+		noise = 1.2533 * sum / n;
+	}
+	// a deviation by a single count is never a hot pixel
+	if (std::numeric_limits<T>::is_integer) {
+		noise = std::max(noise, 1.);
+	}
+	double	limit = threshold * noise;
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "noise %f, correcting deviations > %f",
+		noise, limit);
+
+	size_t	corrected = 0;
+#pragma omp parallel for reduction(+:corrected)
+	for (int i = 0; i < n; i++) {
+		if (deviation[i] > limit) {
+			image.pixels[i] = medianimage->pixels[i];
+			corrected++;
+		}
+	}
+	return corrected;
+}
+
+template<typename T>
+Image<T>	*hotpixels(const Image<T>& image, int radius, double threshold,
+			size_t *corrected) {
+	Image<T>	*result = new Image<T>(image);
+	size_t	count = 0;
+	if (!image.getMosaicType().isMosaic()) {
+		count = hotpixels_plane(*result, radius, threshold);
+	} else {
+		// neighbouring pixels of a mosaic have different colors
+		for (int x = 0; x < 2; x++) {
+			for (int y = 0; y < 2; y++) {
+				Subgrid	grid(ImagePoint(x, y), ImageSize(2, 2));
+				SubgridAdapter<T>	sub(*result, grid);
+				Image<T>	plane(sub);
+				count += hotpixels_plane(plane, radius,
+					threshold);
+				for (int yy = 0; yy < sub.getSize().height();
+					yy++) {
+					for (int xx = 0;
+						xx < sub.getSize().width(); xx++) {
+						sub.writablepixel(xx, yy)
+							= plane.pixel(xx, yy);
+					}
+				}
+			}
+		}
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%lu pixels corrected",
+		(unsigned long)count);
+	if (corrected) {
+		*corrected = count;
+	}
+	return result;
+}
+
+#define	hotpixels_instance(Pixel)					\
+template Image<Pixel>	*hotpixels<Pixel>(const Image<Pixel>& image,	\
+	int radius, double threshold, size_t *corrected);
+
+hotpixels_instance(unsigned char)
+hotpixels_instance(unsigned short)
+hotpixels_instance(unsigned int)
+hotpixels_instance(unsigned long)
+hotpixels_instance(float)
+hotpixels_instance(double)
+
+#define hotpixels_mono(Pixel, imageptr)					\
+{									\
+	Image<Pixel>	*image						\
+		= dynamic_cast<Image<Pixel>*>(&*imageptr);		\
+	if (NULL != image) {						\
+		return ImagePtr(hotpixels<Pixel>(*image, radius,	\
+			threshold));					\
+	}								\
+}
+
+ImagePtr	hotpixelsptr(ImagePtr imageptr, int radius, double threshold) {
+	hotpixels_mono(unsigned char, imageptr)
+	hotpixels_mono(unsigned short, imageptr)
+	hotpixels_mono(unsigned int, imageptr)
+	hotpixels_mono(unsigned long, imageptr)
+	hotpixels_mono(float, imageptr)
+	hotpixels_mono(double, imageptr)
+	std::string	msg = stringprintf("cannot correct hot pixels in %s "
+		"images", demangle(imageptr->pixel_type().name()).c_str());
+	debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+	throw std::runtime_error(msg);
+}
+
+} // namespace adapter
+} // namespace astro
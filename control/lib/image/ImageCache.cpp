@@ -0,0 +1,297 @@
+/*
+ * ImageCache.cpp -- in process cache of decoded images and FITS headers
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <ImageCache.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroIO.h>
+#include <AstroMetrics.h>
+#include <cerrno>
+#include <cstring>
+
+namespace astro {
+namespace image {
+
+/**
+ * \brief Approximate memory used by a header
+ */
+static size_t	headerbytes(const ImageHeader& header) {
+	return sizeof(ImageHeader) + 128 * header.metadata.size();
+}
+
+/**
+ * \brief Memory used by the pixels of an image
+ */
+static size_t	imagebytes(const ImagePtr& image) {
+	return image->size().getPixels() * image->bytesPerPixel();
+}
+
+/**
+ * \brief Metrics shared by all image caches of the process
+ *
+ * The gauges are the totals over all caches, each cache only adds and
+ * removes its own entries.
+ */
+static metrics::Counter&	cachehits
+	= metrics::Metrics::counter("imagecache.hits");
+static metrics::Counter&	cachemisses
+	= metrics::Metrics::counter("imagecache.misses");
+static metrics::Counter&	cacheheaderhits
+	= metrics::Metrics::counter("imagecache.headerhits");
+static metrics::Counter&	cacheheadermisses
+	= metrics::Metrics::counter("imagecache.headermisses");
+static metrics::Counter&	cacheevictions
+	= metrics::Metrics::counter("imagecache.evictions");
+static metrics::Counter&	cacheinvalidations
+	= metrics::Metrics::counter("imagecache.invalidations");
+static metrics::Gauge&	cachebytes
+	= metrics::Metrics::gauge("imagecache.bytes");
+static metrics::Gauge&	cacheentries
+	= metrics::Metrics::gauge("imagecache.entries");
+
+ImageCacheStatistics::ImageCacheStatistics() : hits(0), misses(0),
+	headerhits(0), headermisses(0), evictions(0), invalidations(0),
+	bytes(0), budget(0), entries(0) {
+}
+
+std::string	ImageCacheStatistics::toString() const {
+	return stringprintf("images %lu hits/%lu misses, headers %lu hits/"
+		"%lu misses, %lu evicted, %lu invalidated, %lu entries, "
+		"%lu of %lu bytes", hits, misses, headerhits, headermisses,
+		evictions, invalidations, (unsigned long)entries,
+		(unsigned long)bytes, (unsigned long)budget);
+}
+
+ImageCache::ImageCache(size_t budget) {
+	_statistics.budget = budget;
+}
+
+ImageCache::~ImageCache() {
+	cachebytes.add(-(int64_t)_statistics.bytes);
+	cacheentries.add(-(int64_t)_statistics.entries);
+}
+
+/**
+ * \brief The cache shared by all servants of a process
+ */
+ImageCache&	ImageCache::get() {
+	static ImageCache	cache;
+	return cache;
+}
+
+size_t	ImageCache::budget() const {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	return _statistics.budget;
+}
+
+/**
+ * \brief Change the memory budget, a budget of 0 disables the cache
+ */
+void	ImageCache::budget(size_t b) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "image cache budget %lu bytes",
+		(unsigned long)b);
+	_statistics.budget = b;
+	shrink();
+}
+
+/**
+ * \brief Remove an entry, the lock must be held
+ */
+void	ImageCache::erase(entrymap::iterator i) {
+	_statistics.bytes -= i->second.bytes;
+	cachebytes.add(-(int64_t)i->second.bytes);
+	_lru.erase(i->second.lru);
+	_entries.erase(i);
+	_statistics.entries = _entries.size();
+	cacheentries.add(-1);
+}
+
+/**
+ * \brief Evict least recently used entries until the budget is met
+ */
+void	ImageCache::shrink() {
+	while ((_statistics.bytes > _statistics.budget) && (!_lru.empty())) {
+		entrymap::iterator	i = _entries.find(_lru.back());
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "evict %s from image cache",
+			i->first.c_str());
+		erase(i);
+		_statistics.evictions++;
+		cacheevictions.increment();
+	}
+}
+
+/**
+ * \brief Find a valid entry for a file and mark it as recently used
+ *
+ * An entry for a file that has changed since it was cached is removed.
+ */
+ImageCache::entry	*ImageCache::lookup(const std::string& filename,
+				const struct stat& sb) {
+	entrymap::iterator	i = _entries.find(filename);
+	if (i == _entries.end()) {
+		return NULL;
+	}
+	entry&	e = i->second;
+	if ((e.mtime != sb.st_mtime) || (e.filesize != sb.st_size)
+		|| (e.inode != sb.st_ino)) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "%s has changed",
+			filename.c_str());
+		erase(i);
+		_statistics.invalidations++;
+		cacheinvalidations.increment();
+		return NULL;
+	}
+	_lru.splice(_lru.begin(), _lru, e.lru);
+	return &e;
+}
+
+/**
+ * \brief Find or create the entry for a file
+ */
+ImageCache::entry&	ImageCache::insert(const std::string& filename,
+				const struct stat& sb) {
+	entry	*e = lookup(filename, sb);
+	if (NULL != e) {
+		return *e;
+	}
+	entry	n;
+	n.mtime = sb.st_mtime;
+	n.filesize = sb.st_size;
+	n.inode = sb.st_ino;
+	n.hasheader = false;
+	n.bytes = 0;
+	_lru.push_front(filename);
+	n.lru = _lru.begin();
+	entry&	result = _entries.insert(std::make_pair(filename, n))
+				.first->second;
+	_statistics.entries = _entries.size();
+	cacheentries.add(1);
+	return result;
+}
+
+static void	filestat(const std::string& filename, struct stat& sb) {
+	if (stat(filename.c_str(), &sb) < 0) {
+		std::string	msg = stringprintf("cannot stat %s: %s",
+			filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+}
+
+/**
+ * \brief Get the decoded image of a file
+ *
+ * The file is decoded outside the lock, so a slow read does not block
+ * other users of the cache.
+ */
+ImagePtr	ImageCache::image(const std::string& filename) {
+	struct stat	sb;
+	filestat(filename, sb);
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		entry	*e = lookup(filename, sb);
+		if ((NULL != e) && (e->image)) {
+			_statistics.hits++;
+			cachehits.increment();
+			return e->image;
+		}
+		_statistics.misses++;
+		cachemisses.increment();
+	}
+
+	io::FITSin	in(filename);
+	ImagePtr	image = in.read();
+
+	std::unique_lock<std::mutex>	lock(_mutex);
+	size_t	bytes = imagebytes(image);
+	if (bytes > _statistics.budget) {
+		return image;
+	}
+	entry&	e = insert(filename, sb);
+	if (!e.image) {
+		e.image = image;
+		e.bytes += bytes;
+		_statistics.bytes += bytes;
+		cachebytes.add(bytes);
+		shrink();
+	}
+	return image;
+}
+
+/**
+ * \brief Get the header of a file without decoding the pixels
+ */
+ImageHeader	ImageCache::header(const std::string& filename) {
+	struct stat	sb;
+	filestat(filename, sb);
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		entry	*e = lookup(filename, sb);
+		if ((NULL != e) && (e->hasheader)) {
+			_statistics.headerhits++;
+			cacheheaderhits.increment();
+			return e->header;
+		}
+		_statistics.headermisses++;
+		cacheheadermisses.increment();
+	}
+
+	ImageHeader	header;
+	{
+		io::FITSinfileBase	infile(filename);
+		header.imgtype = infile.getImgtype();
+		header.planes = infile.getPlanes();
+		header.size = infile.getSize();
+		header.metadata = infile.getAllMetadata();
+	}
+
+	std::unique_lock<std::mutex>	lock(_mutex);
+	size_t	bytes = headerbytes(header);
+	if (bytes > _statistics.budget) {
+		return header;
+	}
+	entry&	e = insert(filename, sb);
+	if (!e.hasheader) {
+		e.header = header;
+		e.hasheader = true;
+		e.bytes += bytes;
+		_statistics.bytes += bytes;
+		cachebytes.add(bytes);
+		shrink();
+	}
+	return header;
+}
+
+/**
+ * \brief Forget a file, e.g. because it is about to be changed or removed
+ */
+void	ImageCache::invalidate(const std::string& filename) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	entrymap::iterator	i = _entries.find(filename);
+	if (i != _entries.end()) {
+		erase(i);
+		_statistics.invalidations++;
+		cacheinvalidations.increment();
+	}
+}
+
+void	ImageCache::clear() {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	cachebytes.add(-(int64_t)_statistics.bytes);
+	cacheentries.add(-(int64_t)_statistics.entries);
+	_entries.clear();
+	_lru.clear();
+	_statistics.bytes = 0;
+	_statistics.entries = 0;
+}
+
+ImageCacheStatistics	ImageCache::statistics() const {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	return _statistics;
+}
+
+} // namespace image
+} // namespace astro
@@ -4,6 +4,7 @@
  * (c) 2013 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
 #include <ImageDirectory.h>
+#include <ImageCache.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <AstroDebug.h>
@@ -87,32 +88,30 @@ long	ImageDirectory::fileAge(const std::string& name) const {
  * the header information.
  */
 int	ImageDirectory::bytesPerPixel(const std::string& filename) const {
-	std::string	f = fullname(filename);
-	io::FITSinfileBase	infile(f);
+	ImageHeader	header = ImageCache::get().header(fullname(filename));
 
-	switch (infile.getImgtype()) {
+	switch (header.imgtype) {
 	case BYTE_IMG:
 	case SBYTE_IMG:
-		return sizeof(unsigned char) * infile.getPlanes();
+		return sizeof(unsigned char) * header.planes;
 	case USHORT_IMG:
 	case SHORT_IMG:
-		return sizeof(unsigned short) * infile.getPlanes();
+		return sizeof(unsigned short) * header.planes;
 	case ULONG_IMG:
 	case LONG_IMG:
-		return sizeof(unsigned long) * infile.getPlanes();
+		return sizeof(unsigned long) * header.planes;
 	case FLOAT_IMG:
-		return sizeof(float) * infile.getPlanes();
+		return sizeof(float) * header.planes;
 	case DOUBLE_IMG:
-		return sizeof(double) * infile.getPlanes();
+		return sizeof(double) * header.planes;
 	}
 	return 2;
 }
 
 int	ImageDirectory::bytesPerPlane(const std::string& filename) const {
-	std::string	f = fullname(filename);
-	io::FITSinfileBase	infile(f);
+	ImageHeader	header = ImageCache::get().header(fullname(filename));
 
-	switch (infile.getImgtype()) {
+	switch (header.imgtype) {
 	case BYTE_IMG:
 	case SBYTE_IMG:
 		return sizeof(unsigned char);
@@ -131,10 +130,9 @@ int	ImageDirectory::bytesPerPlane(const std::string& filename) const {
 }
 
 std::type_index	ImageDirectory::pixelType(const std::string& filename) const {
-	std::string	f = fullname(filename);
-	io::FITSinfileBase	infile(f);
+	ImageHeader	header = ImageCache::get().header(fullname(filename));
 
-	switch (infile.getImgtype()) {
+	switch (header.imgtype) {
 	case BYTE_IMG:
 	case SBYTE_IMG:
 		return typeid(unsigned char);
@@ -228,6 +226,7 @@ std::string	ImageDirectory::save(astro::image::ImagePtr image) {
 void	ImageDirectory::write(astro::image::ImagePtr image,
 		const std::string& filename) {
 	std::string	f = fullname(filename);
+	ImageCache::get().invalidate(f);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "write image to file %s, fullname = %s",
 		filename.c_str(), f.c_str());
 
@@ -253,6 +252,7 @@ void	ImageDirectory::remove(const std::string& filename) {
 	if (!isFile(filename)) {
 		throw std::runtime_error("file not found");
 	}
+	ImageCache::get().invalidate(fullname(filename));
 	if (unlink(fullname(filename).c_str()) < 0) {
 		debug(LOG_ERR, DEBUG_LOG, 0, "cannot remove %s: %s",
 			filename.c_str(), strerror(errno));
@@ -264,10 +264,12 @@ void	ImageDirectory::remove(const std::string& filename) {
 
 /**
  * \brief retrieve an image from the image directory
+ *
+ * The image comes from the image cache and is shared with other users
+ * of the same file, so it must not be modified.
  */
 ImagePtr	ImageDirectory::getImagePtr(const std::string& filename) {
-	astro::io::FITSin	in(fullname(filename));
-	return in.read();
+	return ImageCache::get().image(fullname(filename));
 }
 
 /**
@@ -275,15 +277,20 @@ ImagePtr	ImageDirectory::getImagePtr(const std::string& filename) {
  */
 Metavalue	ImageDirectory::getMetadata(const std::string& filename,
 			const std::string& keyword) {
-	return getImagePtr(filename)->getMetadata(keyword);
+	ImageHeader	header = ImageCache::get().header(fullname(filename));
+	return header.metadata.getMetadata(keyword);
 }
 
 /**
  * \brief Set the meta data in an image
+ *
+ * The image is read bypassing the cache, because the cached copy must
+ * not be modified.
  */
 void	ImageDirectory::setMetadata(const std::string& filename,
 		const ImageMetadata& metadata) {
-	ImagePtr	image = getImagePtr(filename);
+	astro::io::FITSin	in(fullname(filename));
+	ImagePtr	image = in.read();
 	for (auto ptr = metadata.begin(); ptr != metadata.end(); ptr++) {
 		image->setMetadata(ptr->second);
 	}
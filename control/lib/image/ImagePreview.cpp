@@ -0,0 +1,313 @@
+/*
+ * ImagePreview.cpp -- downsampled and stretched renderings of images
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroDisplay.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace astro {
+namespace image {
+
+/**
+ * \brief Number of values per pixel in the preview
+ */
+template<typename Pixel>
+struct PreviewPlanes {
+	enum { value = 1 };
+};
+
+template<typename P>
+struct PreviewPlanes<RGB<P> > {
+	enum { value = 3 };
+};
+
+/**
+ * \brief Add the values of a pixel to the block sums
+ */
+template<typename Pixel>
+static inline void	accumulate(const Pixel& p, double *sum) {
+	sum[0] += p;
+}
+
+template<typename P>
+static inline void	accumulate(const RGB<P>& p, double *sum) {
+	sum[0] += p.R;
+	sum[1] += p.G;
+	sum[2] += p.B;
+}
+
+template<typename P>
+static inline void	accumulate(const YUYV<P>& p, double *sum) {
+	sum[0] += p.y;
+}
+
+/**
+ * \brief Average binning x binning blocks of a rectangle of an image
+ *
+ * The source rows are traversed in memory order, each row adds its
+ * pixels to the sums of the preview row it belongs to.
+ */
+template<typename Pixel>
+static bool	previewbin(const ImagePtr image, const ImageRectangle& source,
+		int binning, const ImageSize& size, int& planes,
+		std::vector<float>& values) {
+	const Image<Pixel>	*imagep
+		= dynamic_cast<const Image<Pixel> *>(&*image);
+	if (NULL == imagep) {
+		return false;
+	}
+	planes = PreviewPlanes<Pixel>::value;
+	int	w = size.width();
+	int	h = size.height();
+	values.resize(size.getPixels() * planes);
+	int	x0 = source.origin().x();
+	int	xmax = x0 + source.size().width();
+	int	y0 = source.origin().y();
+	int	ymax = y0 + source.size().height();
+	int	iw = image->size().width();
+#pragma omp parallel for
+	for (int y = 0; y < h; y++) {
+		std::vector<double>	sum(w * planes, 0.);
+		int	ystart = y0 + y * binning;
+		int	yend = std::min(ystart + binning, ymax);
+		for (int yy = ystart; yy < yend; yy++) {
+			const Pixel	*row = imagep->pixels + yy * iw;
+			for (int xx = x0; xx < xmax; xx++) {
+				accumulate(row[xx],
+					&sum[((xx - x0) / binning) * planes]);
+			}
+		}
+		for (int x = 0; x < w; x++) {
+			int	xstart = x0 + x * binning;
+			int	xend = std::min(xstart + binning, xmax);
+			double	n = (xend - xstart) * (yend - ystart);
+			for (int p = 0; p < planes; p++) {
+				values[(y * w + x) * planes + p]
+					= sum[x * planes + p] / n;
+			}
+		}
+	}
+	return true;
+}
+
+#define	previewbin_typed(Pixel)						\
+	if (!binned) {							\
+		binned = previewbin<Pixel>(image, _source, _binning,	\
+			_size, _planes, _values);			\
+	}
+
+/**
+ * \brief Construct a preview of a rectangle of an image
+ *
+ * \param image		the image to preview
+ * \param source	the rectangle to preview, an empty rectangle means
+ *			the complete image
+ * \param binning	the number of image pixels in each direction
+ *			that make up a preview pixel
+ */
+ImagePreview::ImagePreview(const ImagePtr image, const ImageRectangle& source,
+	int binning) : _source(source), _binning(binning) {
+	if (_source.isEmpty()) {
+		_source = ImageRectangle(image->size());
+	}
+	build(image);
+}
+
+/**
+ * \brief Construct a preview of a complete image
+ *
+ * The binning is chosen such that the preview is no larger than maxsize
+ * pixels in either direction.
+ */
+ImagePreview::ImagePreview(const ImagePtr image, int maxsize)
+	: _source(image->size()),
+	  _binning(binningFor(image->size(), maxsize)) {
+	build(image);
+}
+
+/**
+ * \brief Compute the preview values
+ */
+void	ImagePreview::build(const ImagePtr image) {
+	if (_binning < 1) {
+		std::string	msg = stringprintf("bad preview binning %d",
+			_binning);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+	if (!image->size().bounds(_source)) {
+		std::string	msg = stringprintf("rectangle %s not contained "
+			"in image of size %s", _source.toString().c_str(),
+			image->size().toString().c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+	_size = ImageSize(
+		(_source.size().width() + _binning - 1) / _binning,
+		(_source.size().height() + _binning - 1) / _binning);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "preview %s of %s, binning %d",
+		_size.toString().c_str(), _source.toString().c_str(),
+		_binning);
+
+	bool	binned = false;
+	previewbin_typed(unsigned char);
+	previewbin_typed(unsigned short);
+	previewbin_typed(unsigned int);
+	previewbin_typed(unsigned long);
+	previewbin_typed(float);
+	previewbin_typed(double);
+	previewbin_typed(RGB<unsigned char>);
+	previewbin_typed(RGB<unsigned short>);
+	previewbin_typed(RGB<unsigned int>);
+	previewbin_typed(RGB<unsigned long>);
+	previewbin_typed(RGB<float>);
+	previewbin_typed(RGB<double>);
+	previewbin_typed(YUYV<unsigned char>);
+	previewbin_typed(YUYV<unsigned short>);
+	previewbin_typed(YUYV<unsigned int>);
+	previewbin_typed(YUYV<unsigned long>);
+	previewbin_typed(YUYV<float>);
+	previewbin_typed(YUYV<double>);
+	if (!binned) {
+		std::string	msg = stringprintf("cannot preview %s pixels",
+			demangle(image->pixel_type().name()).c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+
+	_minimum = std::numeric_limits<float>::max();
+	_maximum = -std::numeric_limits<float>::max();
+	std::vector<float>::const_iterator	i;
+	for (i = _values.begin(); i != _values.end(); i++) {
+		if (*i < _minimum) { _minimum = *i; }
+		if (*i > _maximum) { _maximum = *i; }
+	}
+	if (_minimum > _maximum) {
+		_minimum = _maximum = 0;
+	}
+}
+
+/**
+ * \brief Find the binning needed to reduce an image to maxsize pixels
+ */
+int	ImagePreview::binningFor(const ImageSize& size, int maxsize) {
+	if (maxsize <= 0) {
+		std::string	msg = stringprintf("bad preview size %d",
+			maxsize);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+	int	longside = std::max(size.width(), size.height());
+	return std::max(1, (longside + maxsize - 1) / maxsize);
+}
+
+/**
+ * \brief Find stretching limits from the distribution of the values
+ *
+ * The limits are the values below which the fractions lowfraction and
+ * highfraction of the preview values lie. At most about 100000 values
+ * are sampled, and all color channels are treated together.
+ */
+void	ImagePreview::limits(double lowfraction, double highfraction,
+		float& low, float& high) const {
+	std::vector<float>	sample;
+	size_t	step = 1 + _values.size() / 100000;
+	for (size_t i = 0; i < _values.size(); i += step) {
+		if (_values[i] == _values[i]) {
+			sample.push_back(_values[i]);
+		}
+	}
+	if (sample.size() == 0) {
+		low = high = 0;
+		return;
+	}
+	size_t	l = std::min(sample.size() - 1,
+			(size_t)(lowfraction * sample.size()));
+	size_t	h = std::min(sample.size() - 1,
+			(size_t)(highfraction * sample.size()));
+	std::nth_element(sample.begin(), sample.begin() + l, sample.end());
+	low = sample[l];
+	std::nth_element(sample.begin(), sample.begin() + h, sample.end());
+	high = sample[h];
+}
+
+/**
+ * \brief Convert the preview to 8 bit values
+ *
+ * Values up to low become 0, values from high become 255, values in
+ * between are mapped with a gamma curve. NaN values become 0.
+ */
+std::vector<unsigned char>	ImagePreview::stretch(float low, float high,
+					float gamma) const {
+	if ((high <= low) || (gamma <= 0)) {
+		std::string	msg = stringprintf("bad stretch %f - %f, "
+			"gamma %f", low, high, gamma);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+	std::vector<unsigned char>	result(_values.size());
+	double	scale = 1. / (high - low);
+	double	exponent = 1. / gamma;
+	int	n = _values.size();
+#pragma omp parallel for
+	for (int i = 0; i < n; i++) {
+		double	v = (_values[i] - low) * scale;
+		if (!(v > 0)) {
+			result[i] = 0;
+			continue;
+		}
+		if (v >= 1) {
+			result[i] = 255;
+			continue;
+		}
+		if (exponent != 1) {
+			v = pow(v, exponent);
+		}
+		result[i] = (unsigned char)(255 * v + 0.5);
+	}
+	return result;
+}
+
+/**
+ * \brief Build an image from the preview values
+ */
+ImagePtr	ImagePreview::image() const {
+	if (_planes == 3) {
+		Image<RGB<float> >	*imagep = new Image<RGB<float> >(_size);
+		for (unsigned int i = 0; i < _size.getPixels(); i++) {
+			imagep->pixels[i] = RGB<float>(_values[3 * i],
+				_values[3 * i + 1], _values[3 * i + 2]);
+		}
+		return ImagePtr(imagep);
+	}
+	Image<float>	*imagep = new Image<float>(_size);
+	std::copy(_values.begin(), _values.end(), imagep->pixels);
+	return ImagePtr(imagep);
+}
+
+/**
+ * \brief Build an 8 bit image from the stretched preview values
+ */
+ImagePtr	ImagePreview::image(float low, float high, float gamma) const {
+	std::vector<unsigned char>	bytes = stretch(low, high, gamma);
+	if (_planes == 3) {
+		Image<RGB<unsigned char> >	*imagep
+			= new Image<RGB<unsigned char> >(_size);
+		for (unsigned int i = 0; i < _size.getPixels(); i++) {
+			imagep->pixels[i] = RGB<unsigned char>(bytes[3 * i],
+				bytes[3 * i + 1], bytes[3 * i + 2]);
+		}
+		return ImagePtr(imagep);
+	}
+	Image<unsigned char>	*imagep = new Image<unsigned char>(_size);
+	std::copy(bytes.begin(), bytes.end(), imagep->pixels);
+	return ImagePtr(imagep);
+}
+
+} // namespace image
+} // namespace astro
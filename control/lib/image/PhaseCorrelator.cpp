@@ -9,7 +9,7 @@
 #include <AstroAdapter.h>
 #include <AstroFilter.h>
 #include <AstroIO.h>
-#include <fftw3.h>
+#include <AstroConvolve.h>
 #include <includes.h>
 
 using namespace astro::adapter;
@@ -170,15 +170,18 @@ std::pair<Point, double> PhaseCorrelator::operator()(
 	fftw_complex	*bf = (fftw_complex *)fftw_malloc(
 					sizeof(fftw_complex) * nc);
 
-	// create a plan for the fourier transform
-	fftw_plan	p = fftw_plan_dft_r2c_2d(size.height(), size.width(),
-				a, af, 0);
-	fftw_plan	q = fftw_plan_dft_r2c_2d(size.height(), size.width(),
-				b, bf, 0);
-
-	// we also already need a back transform
-	fftw_plan	r = fftw_plan_dft_c2r_2d(size.height(), size.width(),
-				af, a, 0);
+	// create a plan for the fourier transform, and we also already
+	// need a back transform. Planning is not thread safe.
+	fftw_plan	p, q, r;
+	{
+		std::unique_lock<std::mutex>	lock(fftw_planner_mutex);
+		p = fftw_plan_dft_r2c_2d(size.height(), size.width(),
+			a, af, FFTW_ESTIMATE);
+		q = fftw_plan_dft_r2c_2d(size.height(), size.width(),
+			b, bf, FFTW_ESTIMATE);
+		r = fftw_plan_dft_c2r_2d(size.height(), size.width(),
+			af, a, FFTW_ESTIMATE);
+	}
 
 	// compute the values for the hanning windows
 	const ConstImageAdapter<double>	*windowedfrom = NULL;
@@ -272,12 +275,14 @@ std::pair<Point, double> PhaseCorrelator::operator()(
 	}
 	
 	// clean up the memory allocated
-	fftw_destroy_plan(r);
-	fftw_destroy_plan(q);
-	fftw_destroy_plan(p);
+	{
+		std::unique_lock<std::mutex>	lock(fftw_planner_mutex);
+		fftw_destroy_plan(r);
+		fftw_destroy_plan(q);
+		fftw_destroy_plan(p);
+	}
 	fftw_free(af);
 	fftw_free(bf);
-	fftw_cleanup();
 
 	// we should now remove the window adapters
 	if (windowedfrom) { delete windowedfrom; windowedfrom = NULL; }
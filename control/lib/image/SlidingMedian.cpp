@@ -0,0 +1,360 @@
+/*
+ * SlidingMedian.cpp -- median filter with a sliding histogram
+ *
+ * (c) 2017 Prof Dr Andreas Müller, Hochschule Rapperswil
+ */
+#include <AstroAdapter.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <cstdint>
+
+namespace astro {
+namespace adapter {
+
+std::vector<int>	diskHalfwidths(int r) {
+	std::vector<int>	result(2 * r + 1);
+	for (int y = -r; y <= r; y++) {
+		int	x = 0;
+		while ((x + 1) * (x + 1) + y * y <= r * r) {
+			x++;
+		}
+		result[y + r] = x;
+	}
+	return result;
+}
+
+template<typename T>
+SlidingMedian<T>::SlidingMedian(int r, bool clamp) : _r(r), _clamp(clamp) {
+	if (r < 0) {
+		std::string	msg = stringprintf("bad median radius %d", r);
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::range_error(msg);
+	}
+	_halfwidth = diskHalfwidths(r);
+}
+
+/**
+ * \brief Histogram of the pixels in the disk
+ *
+ * The histogram keeps track of the number of values below the current
+ * median bin, and moves the median bin after the disk has been moved.
+ */
+class DiskHistogram {
+	enum { coarsebits = 6 };
+	std::vector<int>	_fine;
+	std::vector<int>	_coarse;
+	int	_k;
+	int	_median;
+	int	_below;
+public:
+	DiskHistogram(int levels, int k)
+		: _fine(levels, 0), _coarse((levels >> coarsebits) + 1, 0),
+		  _k(k), _median(0), _below(0) {
+	}
+	void	add(uint32_t level) {
+		_fine[level]++;
+		_coarse[level >> coarsebits]++;
+		if ((int)level < _median) {
+			_below++;
+		}
+	}
+	void	remove(uint32_t level) {
+		_fine[level]--;
+		_coarse[level >> coarsebits]--;
+		if ((int)level < _median) {
+			_below--;
+		}
+	}
+	int	median();
+};
+
+/**
+ * \brief Move the median bin until it contains the value of rank k
+ */
+int	DiskHistogram::median() {
+	const int	step = 1 << coarsebits;
+	while (_below > _k) {
+		int	c = (_median >> coarsebits) - 1;
+		if ((0 == (_median & (step - 1))) && (c >= 0)
+			&& (_below - _coarse[c] > _k)) {
+			_below -= _coarse[c];
+			_median -= step;
+		} else {
+			_median--;
+			_below -= _fine[_median];
+		}
+	}
+	while (_below + _fine[_median] <= _k) {
+		int	c = _median >> coarsebits;
+		if ((0 == (_median & (step - 1)))
+			&& (_below + _coarse[c] <= _k)) {
+			_below += _coarse[c];
+			_median += step;
+		} else {
+			_below += _fine[_median];
+			_median++;
+		}
+	}
+	return _median;
+}
+
+/**
+ * \brief Maximum number of histogram bins for the whole image
+ *
+ * This covers all 8 and 16 bit images. Floating point and 32 bit images
+ * often have almost as many distinct values as pixels, a histogram over
+ * all values of the image would then be as large as the image for every
+ * thread. Such images are processed in bands of rows instead, see
+ * bandmedian() below.
+ */
+static const size_t	maxlevels = 1 << 16;
+
+/**
+ * \brief Number of rows in a band of an image with many distinct values
+ */
+#define	BAND_ROWS	64
+
+/**
+ * \brief Median by partial sorting of the disk around each pixel
+ *
+ * This is what the MedianRadiusAdapter does, but with border clamping
+ * and with rows distributed over threads. It is only used as a reference
+ * for the histogram based median.
+ */
+template<typename T>
+static Image<T>	*selectmedian(const Image<T>& source,
+			const std::vector<int>& halfwidth, bool clamp) {
+	int	w = source.size().width();
+	int	h = source.size().height();
+	int	r = (halfwidth.size() - 1) / 2;
+	size_t	count = 0;
+	for (int j = 0; j <= 2 * r; j++) {
+		count += 2 * halfwidth[j] + 1;
+	}
+	size_t	k = (count - 1) / 2;
+	Image<T>	*result = new Image<T>(source.size());
+#pragma omp parallel
+	{
+	std::vector<T>	values;
+	values.reserve(count);
+#pragma omp for schedule(dynamic, 16)
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			values.clear();
+			for (int j = 0; j <= 2 * r; j++) {
+				int	yy = y + j - r;
+				int	hw = halfwidth[j];
+				for (int xx = x - hw; xx <= x + hw; xx++) {
+					if (clamp) {
+						values.push_back(source.pixels[
+						std::min(std::max(xx, 0), w - 1)
+						+ w * std::min(std::max(yy, 0),
+							h - 1)]);
+					} else if ((xx < 0) || (xx >= w)
+						|| (yy < 0) || (yy >= h)) {
+						values.push_back(0);
+					} else {
+						values.push_back(
+							source.pixels[xx + w * yy]);
+					}
+				}
+			}
+			std::nth_element(values.begin(), values.begin() + k,
+				values.end());
+			result->pixels[x + w * y] = values[k];
+		}
+	}
+	}
+	return result;
+}
+
+/**
+ * \brief Compute the median of one row by sliding the disk to the right
+ *
+ * The histogram must be empty on entry and is empty again on return.
+ * The level functor gives the histogram bin of any pixel the disk
+ * touches, including pixels outside the image.
+ */
+template<typename T, typename L>
+static void	slide(DiskHistogram& histogram, const std::vector<int>& halfwidth,
+		int w, int y, const L& level, const std::vector<T>& levels,
+		T *out) {
+	int	r = (halfwidth.size() - 1) / 2;
+	// fill the histogram with the disk around (0, y)
+	for (int j = 0; j <= 2 * r; j++) {
+		int	hw = halfwidth[j];
+		for (int x = -hw; x <= hw; x++) {
+			histogram.add(level(x, y + j - r));
+		}
+	}
+	out[0] = levels[histogram.median()];
+
+	// slide the disk to the right
+	for (int x = 1; x < w; x++) {
+		for (int j = 0; j <= 2 * r; j++) {
+			int	yy = y + j - r;
+			int	hw = halfwidth[j];
+			histogram.remove(level(x - 1 - hw, yy));
+			histogram.add(level(x + hw, yy));
+		}
+		out[x] = levels[histogram.median()];
+	}
+
+	// empty the histogram again for the next row
+	for (int j = 0; j <= 2 * r; j++) {
+		int	hw = halfwidth[j];
+		for (int x = w - 1 - hw; x <= w - 1 + hw; x++) {
+			histogram.remove(level(x, y + j - r));
+		}
+	}
+}
+
+/**
+ * \brief Find the distinct values in a range of pixels, including 0
+ */
+template<typename T>
+static std::vector<T>	distinct(const T *begin, const T *end) {
+	std::vector<T>	levels(begin, end);
+	levels.push_back(0);
+	std::sort(levels.begin(), levels.end());
+	levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+	return levels;
+}
+
+/**
+ * \brief Histogram median for images with many distinct values
+ *
+ * The image is divided into bands of BAND_ROWS rows. The histogram bins
+ * of a band are the distinct values of the rows the disks of the band
+ * touch, so the median is still exact, but a histogram never has more
+ * bins than a band and its border rows have pixels.
+ */
+template<typename T>
+static Image<T>	*bandmedian(const Image<T>& source,
+			const std::vector<int>& halfwidth, bool clamp) {
+	int	w = source.size().width();
+	int	h = source.size().height();
+	int	r = (halfwidth.size() - 1) / 2;
+	int	count = 0;
+	for (int j = 0; j <= 2 * r; j++) {
+		count += 2 * halfwidth[j] + 1;
+	}
+	int	nbands = (h + BAND_ROWS - 1) / BAND_ROWS;
+	Image<T>	*result = new Image<T>(source.size());
+#pragma omp parallel for schedule(dynamic)
+	for (int b = 0; b < nbands; b++) {
+		int	y0 = b * BAND_ROWS;
+		int	y1 = std::min(h, y0 + BAND_ROWS);
+		int	ya = std::max(0, y0 - r);
+		int	yb = std::min(h, y1 + r);
+		const T	*first = source.pixels + w * ya;
+		const T	*last = source.pixels + w * yb;
+		std::vector<T>	levels = distinct(first, last);
+		std::vector<uint32_t>	index(last - first);
+		for (size_t i = 0; i < index.size(); i++) {
+			index[i] = std::lower_bound(levels.begin(),
+					levels.end(), first[i]) - levels.begin();
+		}
+		uint32_t	zero = std::lower_bound(levels.begin(),
+				levels.end(), T(0)) - levels.begin();
+		auto	level = [&](int x, int y) -> uint32_t {
+			if (clamp) {
+				x = std::min(std::max(x, 0), w - 1);
+				y = std::min(std::max(y, 0), h - 1);
+			} else if ((x < 0) || (x >= w) || (y < 0) || (y >= h)) {
+				return zero;
+			}
+			return index[x + w * (y - ya)];
+		};
+		DiskHistogram	histogram(levels.size(), (count - 1) / 2);
+		for (int y = y0; y < y1; y++) {
+			slide(histogram, halfwidth, w, y, level, levels,
+				result->pixels + w * y);
+		}
+	}
+	return result;
+}
+
+/**
+ * \brief Compute the median filtered image
+ *
+ * Pixels outside the image count as zero, like in the MedianRadiusAdapter,
+ * or are replaced by the nearest pixel of the image if clamp is set.
+ */
+template<typename T>
+Image<T>	*SlidingMedian<T>::operator()(
+			const ConstImageAdapter<T>& image) const {
+	int	w = image.getSize().width();
+	int	h = image.getSize().height();
+	int	n = w * h;
+
+	// find the distinct values, they become the histogram bins
+	Image<T>	source(image);
+	std::vector<T>	levels = distinct(source.pixels, source.pixels + n);
+	if (levels.size() > maxlevels) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "%d levels on %dx%d image, "
+			"using bands", (int)levels.size(), w, h);
+		return bandmedian(source, _halfwidth, _clamp);
+	}
+	std::vector<uint32_t>	index(n);
+#pragma omp parallel for
+	for (int i = 0; i < n; i++) {
+		index[i] = std::lower_bound(levels.begin(), levels.end(),
+				source.pixels[i]) - levels.begin();
+	}
+	uint32_t	zero = std::lower_bound(levels.begin(), levels.end(), T(0))
+				- levels.begin();
+	int	count = 0;
+	for (int j = 0; j <= 2 * _r; j++) {
+		count += 2 * _halfwidth[j] + 1;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "median radius %d (%d pixels) "
+		"on %dx%d image with %d levels", _r, count, w, h,
+		(int)levels.size());
+
+	// level of a pixel, taking care of the border
+	auto	level = [&](int x, int y) -> uint32_t {
+		if (_clamp) {
+			x = std::min(std::max(x, 0), w - 1);
+			y = std::min(std::max(y, 0), h - 1);
+		} else if ((x < 0) || (x >= w) || (y < 0) || (y >= h)) {
+			return zero;
+		}
+		return index[x + w * y];
+	};
+
+	Image<T>	*result = new Image<T>(image.getSize());
+#pragma omp parallel
+	{
+	DiskHistogram	histogram(levels.size(), (count - 1) / 2);
+#pragma omp for schedule(dynamic, 16)
+	for (int y = 0; y < h; y++) {
+		slide(histogram, _halfwidth, w, y, level, levels,
+			result->pixels + w * y);
+	}
+	}
+	return result;
+}
+
+/**
+ * \brief Compute the median by partial sorting of each disk
+ *
+ * This is much slower than the histogram median, it is the reference
+ * the histogram median is tested against.
+ */
+template<typename T>
+Image<T>	*SlidingMedian<T>::select(
+			const ConstImageAdapter<T>& image) const {
+	Image<T>	source(image);
+	return selectmedian(source, _halfwidth, _clamp);
+}
+
+template class SlidingMedian<unsigned char>;
+template class SlidingMedian<unsigned short>;
+template class SlidingMedian<unsigned int>;
+template class SlidingMedian<unsigned long>;
+template class SlidingMedian<float>;
+template class SlidingMedian<double>;
+
+} // namespace adapter
+} // namespace astro
@@ -10,6 +10,8 @@
 #include <AstroFilter.h>
 #include <cmath>
 #include "ReductionAdapter.h"
+#include "StackingCube.h"
+#include <memory>
 
 using namespace astro::image;
 using namespace astro::image::transform;
@@ -184,10 +186,14 @@ Transform	Stacker::findtransform(const ConstImageAdapter<double>& base,
  */
 template<typename AccumulatorPixel, typename Pixel>
 class MonochromeStacker : public Stacker {
-	const ConstImageAdapter<Pixel>	*baseimage() {
+	const ConstImageAdapter<Pixel>	*baseimage() const {
 		return dynamic_cast<Image<Pixel>*>(&*_baseimage);
 	}
+	const ConstImageAdapter<Pixel>&	typed(ImagePtr imageptr) const;
 	Accumulator<AccumulatorPixel, Pixel>	_accumulator;
+	std::unique_ptr<StackingCube>	_cube;
+	void	addtocube(const ConstImageAdapter<Pixel>& image,
+			const Transform& transform);
 public:
 	MonochromeStacker(ImagePtr baseimage_ptr)
 		: Stacker(baseimage_ptr), _accumulator(baseimage()) {
@@ -195,22 +201,74 @@ public:
 			throw std::logic_error("base image type mismatch");
 		}
 	}
+	Transform	registration(const ConstImageAdapter<Pixel>& image) const;
+	Transform	registration(ImagePtr imageptr) const;
+	void	add(const ConstImageAdapter<Pixel>& image,
+			const Transform& transform);
 	void	add(const ConstImageAdapter<Pixel>& image);
+	void	add(ImagePtr imageptr, const Transform& transform);
 	void	add(ImagePtr imageptr);
-	ImagePtr	image() {
+	ImagePtr	image();
+};
+
+template<typename AccumulatorPixel, typename Pixel>
+const ConstImageAdapter<Pixel>&	MonochromeStacker<AccumulatorPixel, Pixel>::typed(
+		ImagePtr imageptr) const {
+	Image<Pixel>	*imagep = dynamic_cast<Image<Pixel>*>(&*imageptr);
+	if (NULL == imagep) {
+		throw std::logic_error("new image has wrong type");
+	}
+	return *imagep;
+}
+
+/**
+ * \brief Write a registered image to the scratch cube
+ *
+ * The cube is created when the first image is added, and the base image
+ * becomes its first frame, just as the accumulator starts with the base
+ * image.
+ */
+template<typename AccumulatorPixel, typename Pixel>
+void	MonochromeStacker<AccumulatorPixel, Pixel>::addtocube(
+		const ConstImageAdapter<Pixel>& image,
+		const Transform& transform) {
+	std::vector<const ConstImageAdapter<double>*>	planes(1);
+	if (!_cube) {
+		_cube = std::unique_ptr<StackingCube>(new StackingCube(
+			baseimage()->getSize(), 1, scratchdirectory()));
+		TypeConversionAdapter<Pixel>	base(*baseimage());
+		planes[0] = &base;
+		_cube->add(planes, planes, Transform());
+	}
+	TypeConversionAdapter<Pixel>	converted(image);
+	TransformAdapter<double>	transformed(converted,
+						transform.inverse());
+	planes[0] = &transformed;
+	std::vector<const ConstImageAdapter<double>*>	originals(1, &converted);
+	_cube->add(planes, originals, transform);
+}
+
+template<typename AccumulatorPixel, typename Pixel>
+ImagePtr	MonochromeStacker<AccumulatorPixel, Pixel>::image() {
+	if (!_cube) {
 		return _accumulator.image();
 	}
-};
+	std::unique_ptr<Image<float> >	combined(_cube->combine(*this, 0));
+	ConvertingAdapter<AccumulatorPixel, float>	result(*combined);
+	return ImagePtr(new Image<AccumulatorPixel>(result));
+}
 
+/**
+ * \brief Find the transform that makes an image congruent to the base image
+ *
+ * This method does not change the stacker, so it can be called for
+ * several images concurrently.
+ */
 template<typename AccumulatorPixel, typename Pixel>
-void	MonochromeStacker<AccumulatorPixel, Pixel>::add(
-		const ConstImageAdapter<Pixel>& image) {
-	// first handle the case where there is no transform
+Transform	MonochromeStacker<AccumulatorPixel, Pixel>::registration(
+		const ConstImageAdapter<Pixel>& image) const {
 	if (notransform()) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "accumulate with no transform");
-		ConvertingAdapter<AccumulatorPixel, Pixel>	accumulatorimage(image);
-		_accumulator.accumulate(accumulatorimage);
-		return;
+		return Transform();
 	}
 
 	// create a transform analyizer on the base image
@@ -223,11 +281,38 @@ void	MonochromeStacker<AccumulatorPixel, Pixel>::add(
 					targetimageadapter);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "add transform: %s",
 		transform.toString().c_str());
+	return transform;
+}
+
+template<typename AccumulatorPixel, typename Pixel>
+Transform	MonochromeStacker<AccumulatorPixel, Pixel>::registration(
+		ImagePtr imageptr) const {
+	return registration(typed(imageptr));
+}
+
+/**
+ * \brief Add an image with a known transform
+ */
+template<typename AccumulatorPixel, typename Pixel>
+void	MonochromeStacker<AccumulatorPixel, Pixel>::add(
+		const ConstImageAdapter<Pixel>& image,
+		const Transform& transform) {
+	if (rejection() != none) {
+		addtocube(image, transform);
+		return;
+	}
 
 	// create an adapter that converts the pixels of the original image
 	// into pixels that are compatible with the accumulator
 	ConvertingAdapter<AccumulatorPixel, Pixel>	accumulatorimage(image);
 
+	// first handle the case where there is no transform
+	if (transform.isIdentity()) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "accumulate with no transform");
+		_accumulator.accumulate(accumulatorimage);
+		return;
+	}
+
 	// create an adapter that applies the transform to the image
 	TransformAdapter<AccumulatorPixel>	transformadapter(
 		accumulatorimage, transform.inverse());
@@ -235,13 +320,21 @@ void	MonochromeStacker<AccumulatorPixel, Pixel>::add(
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "image added");
 }
 
+template<typename AccumulatorPixel, typename Pixel>
+void	MonochromeStacker<AccumulatorPixel, Pixel>::add(
+		const ConstImageAdapter<Pixel>& image) {
+	add(image, registration(image));
+}
+
+template<typename AccumulatorPixel, typename Pixel>
+void	MonochromeStacker<AccumulatorPixel, Pixel>::add(ImagePtr imageptr,
+		const Transform& transform) {
+	add(typed(imageptr), transform);
+}
+
 template<typename AccumulatorPixel, typename Pixel>
 void	MonochromeStacker<AccumulatorPixel, Pixel>::add(ImagePtr imageptr) {
-	Image<Pixel>	*imagep = dynamic_cast<Image<Pixel>*>(&*imageptr);
-	if (NULL == imagep) {
-		throw std::logic_error("new image has wrong type");
-	}
-	add(*imagep);
+	add(typed(imageptr));
 }
 
 /**
@@ -250,10 +343,17 @@ void	MonochromeStacker<AccumulatorPixel, Pixel>::add(ImagePtr imageptr) {
 template<typename AccumulatorPixel, typename Pixel>
 class RGBStacker : public Stacker {
 	ImagePtr	_baseimageptr;
-	const ConstImageAdapter<RGB<Pixel> >	*baseimage() {
+	const ConstImageAdapter<RGB<Pixel> >	*baseimage() const {
 		return dynamic_cast<Image<RGB<Pixel> >*>(&*_baseimageptr);
 	}
+	const ConstImageAdapter<RGB<Pixel> >&	typed(ImagePtr imageptr) const;
 	Accumulator<RGB<AccumulatorPixel>, RGB<Pixel> >	_accumulator;
+	std::unique_ptr<StackingCube>	_cube;
+	void	addtocube(const ConstImageAdapter<RGB<Pixel> >& image,
+			const Transform& transform);
+	void	addplanes(const ConstImageAdapter<RGB<double> >& image,
+			const ConstImageAdapter<RGB<double> >& original,
+			const Transform& transform);
 public:
 	RGBStacker(ImagePtr baseimageptr) : Stacker(baseimageptr),
 		_baseimageptr(baseimageptr), _accumulator(baseimage()) {
@@ -264,30 +364,108 @@ public:
 		}
 	}
 
+	Transform	registration(
+			const ConstImageAdapter<RGB<Pixel> >& image) const;
+	Transform	registration(ImagePtr imageptr) const;
+
+	void	add(const ConstImageAdapter<RGB<Pixel> >& image,
+			const Transform& transform);
 	void	add(const ConstImageAdapter<RGB<Pixel> >& image);
 
+	void	add(ImagePtr imageptr, const Transform& transform);
 	void	add(ImagePtr imageptr);
 	
-	ImagePtr	image() {
-		return _accumulator.image();
-	}
+	ImagePtr	image();
 };
 
+template<typename AccumulatorPixel, typename Pixel>
+const ConstImageAdapter<RGB<Pixel> >&	RGBStacker<AccumulatorPixel, Pixel>::typed(
+		ImagePtr newimage) const {
+	// convert the image to a strongly typed image
+	Image<RGB<Pixel> >	*imagep
+		= dynamic_cast<Image<RGB<Pixel> >*>(&*newimage);
+	if (NULL == imagep) {
+		throw std::runtime_error("new image has wrong type");
+	}
+	return *imagep;
+}
+
 /**
- * \brief Add an image to the stack
+ * \brief Write the color planes of a registered image to the cube
+ */
+template<typename AccumulatorPixel, typename Pixel>
+void	RGBStacker<AccumulatorPixel, Pixel>::addplanes(
+		const ConstImageAdapter<RGB<double> >& image,
+		const ConstImageAdapter<RGB<double> >& original,
+		const Transform& transform) {
+	ColorRedAdapter<double>	red(image);
+	ColorGreenAdapter<double>	green(image);
+	ColorBlueAdapter<double>	blue(image);
+	std::vector<const ConstImageAdapter<double>*>	planes;
+	planes.push_back(&red);
+	planes.push_back(&green);
+	planes.push_back(&blue);
+	ColorRedAdapter<double>	originalred(original);
+	ColorGreenAdapter<double>	originalgreen(original);
+	ColorBlueAdapter<double>	originalblue(original);
+	std::vector<const ConstImageAdapter<double>*>	originals;
+	originals.push_back(&originalred);
+	originals.push_back(&originalgreen);
+	originals.push_back(&originalblue);
+	_cube->add(planes, originals, transform);
+}
+
+/**
+ * \brief Write a registered image to the scratch cube
  *
- * This method computes a translation between two images
+ * As for monochrome images, the base image is the first frame of the cube.
  */
 template<typename AccumulatorPixel, typename Pixel>
-void	RGBStacker<AccumulatorPixel, Pixel>::add(
-		const ConstImageAdapter<RGB<Pixel> >& image) {
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "stacking new image");
+void	RGBStacker<AccumulatorPixel, Pixel>::addtocube(
+		const ConstImageAdapter<RGB<Pixel> >& image,
+		const Transform& transform) {
+	if (!_cube) {
+		_cube = std::unique_ptr<StackingCube>(new StackingCube(
+			baseimage()->getSize(), 3, scratchdirectory()));
+		RGBAdapter<double, Pixel>	base(*baseimage());
+		addplanes(base, base, Transform());
+	}
+	RGBAdapter<double, Pixel>	converted(image);
+	TransformAdapter<RGB<double> >	transformed(converted,
+						transform.inverse());
+	addplanes(transformed, converted, transform);
+}
 
-	// first handle the case where there is no transform
+template<typename AccumulatorPixel, typename Pixel>
+ImagePtr	RGBStacker<AccumulatorPixel, Pixel>::image() {
+	if (!_cube) {
+		return _accumulator.image();
+	}
+	std::unique_ptr<Image<float> >	red(_cube->combine(*this, 0));
+	std::unique_ptr<Image<float> >	green(_cube->combine(*this, 1));
+	std::unique_ptr<Image<float> >	blue(_cube->combine(*this, 2));
+	Image<RGB<AccumulatorPixel> >	*result
+		= new Image<RGB<AccumulatorPixel> >(_cube->size());
+	ImagePtr	resultptr(result);
+	size_t	n = _cube->size().getPixels();
+	for (size_t i = 0; i < n; i++) {
+		result->pixels[i] = RGB<AccumulatorPixel>(red->pixels[i],
+			green->pixels[i], blue->pixels[i]);
+	}
+	return resultptr;
+}
+
+/**
+ * \brief Find the transform of a color image
+ *
+ * Only the luminance is used to find the transform. Like the monochrome
+ * version, this method can be called concurrently.
+ */
+template<typename AccumulatorPixel, typename Pixel>
+Transform	RGBStacker<AccumulatorPixel, Pixel>::registration(
+		const ConstImageAdapter<RGB<Pixel> >& image) const {
 	if (notransform()) {
-		RGBAdapter<AccumulatorPixel, Pixel>	accumulatorimage(image);
-		_accumulator.accumulate(accumulatorimage);
-		return;
+		return Transform();
 	}
 
 	// create a luminance adapter on the base image, because we only want
@@ -296,12 +474,38 @@ void	RGBStacker<AccumulatorPixel, Pixel>::add(
 
 	// find the transform to the new image
 	LuminanceAdapter<RGB<Pixel>, double>	luminanceimage(image);
-	Transform	transform = findtransform(luminancebase, luminanceimage);
+	return findtransform(luminancebase, luminanceimage);
+}
+
+template<typename AccumulatorPixel, typename Pixel>
+Transform	RGBStacker<AccumulatorPixel, Pixel>::registration(
+		ImagePtr imageptr) const {
+	return registration(typed(imageptr));
+}
+
+/**
+ * \brief Add an image with a known transform to the stack
+ */
+template<typename AccumulatorPixel, typename Pixel>
+void	RGBStacker<AccumulatorPixel, Pixel>::add(
+		const ConstImageAdapter<RGB<Pixel> >& image,
+		const Transform& transform) {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "stacking new image");
+	if (rejection() != none) {
+		addtocube(image, transform);
+		return;
+	}
 
 	// create an adapter that converts the pixels of the original image
 	// into pixels that are compatible with the accumulator
 	RGBAdapter<AccumulatorPixel, Pixel>	accumulatorimage(image);
 
+	// first handle the case where there is no transform
+	if (transform.isIdentity()) {
+		_accumulator.accumulate(accumulatorimage);
+		return;
+	}
+
 	// create an adapter that applies the transform to the image
 	TransformAdapter<RGB<AccumulatorPixel> >	transformadapter(
 		accumulatorimage, transform.inverse());
@@ -309,17 +513,26 @@ void	RGBStacker<AccumulatorPixel, Pixel>::add(
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "image added");
 }
 
+/**
+ * \brief Add an image to the stack
+ *
+ * This method computes a translation between two images
+ */
 template<typename AccumulatorPixel, typename Pixel>
-void	RGBStacker<AccumulatorPixel, Pixel>::add(ImagePtr newimage) {
-	// convert the image to a strongly typed image
-	Image<RGB<Pixel> >	*imagep
-		= dynamic_cast<Image<RGB<Pixel> >*>(&*newimage);
-	if (NULL == imagep) {
-		throw std::runtime_error("new image has wrong type");
-	}
+void	RGBStacker<AccumulatorPixel, Pixel>::add(
+		const ConstImageAdapter<RGB<Pixel> >& image) {
+	add(image, registration(image));
+}
+
+template<typename AccumulatorPixel, typename Pixel>
+void	RGBStacker<AccumulatorPixel, Pixel>::add(ImagePtr newimage,
+		const Transform& transform) {
+	add(typed(newimage), transform);
+}
 
-	// now add the image
-	add(*imagep);
+template<typename AccumulatorPixel, typename Pixel>
+void	RGBStacker<AccumulatorPixel, Pixel>::add(ImagePtr newimage) {
+	add(typed(newimage));
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -0,0 +1,529 @@
+/*
+ * StackingCube.cpp -- out-of-core rejection stacking
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include "StackingCube.h"
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <includes.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace astro::image::transform;
+
+namespace astro {
+namespace image {
+namespace stacking {
+
+#define	BAND_HEIGHT		16
+#define	NOISE_ROW_SPACING	8
+#define	NOISE_MAX_SAMPLES	100000
+
+//////////////////////////////////////////////////////////////////////
+// Rejection method names
+//////////////////////////////////////////////////////////////////////
+std::string	Stacker::rejection2string(rejection_method r) {
+	switch (r) {
+	case none:		return std::string("none");
+	case sigmaclip:		return std::string("sigmaclip");
+	case winsorized:	return std::string("winsorized");
+	case percentile:	return std::string("percentile");
+	}
+	throw std::runtime_error("unknown rejection method");
+}
+
+Stacker::rejection_method	Stacker::string2rejection(const std::string& r) {
+	if (r == "none") { return none; }
+	if (r == "sigmaclip") { return sigmaclip; }
+	if (r == "winsorized") { return winsorized; }
+	if (r == "percentile") { return percentile; }
+	std::string	msg = stringprintf("unknown rejection method '%s'",
+		r.c_str());
+	debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+	throw std::runtime_error(msg);
+}
+
+//////////////////////////////////////////////////////////////////////
+// StackingCube implementation
+//////////////////////////////////////////////////////////////////////
+/**
+ * \brief Create a scratch cube in a directory
+ *
+ * The file is unlinked immediately after creation, so it disappears
+ * when the cube is destroyed, even if the process crashes.
+ */
+StackingCube::StackingCube(const ImageSize& size, int planes,
+	const std::string& directory)
+	: _size(size), _planes(planes), _fd(-1), _data(NULL),
+	  _mappedlength(0) {
+	std::string	dir = directory;
+	if (dir.size() == 0) {
+		const char	*tmpdir = getenv("TMPDIR");
+		dir = (NULL != tmpdir) ? std::string(tmpdir)
+					: std::string("/tmp");
+	}
+	char	buffer[1024];
+	snprintf(buffer, sizeof(buffer), "%s/stackXXXXXX", dir.c_str());
+	_fd = mkstemp(buffer);
+	if (_fd < 0) {
+		std::string	msg = stringprintf("cannot create scratch cube "
+			"in %s: %s", dir.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	unlink(buffer);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "scratch cube %s for %s x %d planes",
+		buffer, _size.toString().c_str(), _planes);
+}
+
+StackingCube::~StackingCube() {
+	unmap();
+	if (_fd >= 0) {
+		close(_fd);
+	}
+}
+
+/**
+ * \brief Offset in floats of a row in the scratch file
+ */
+size_t	StackingCube::offset(int frame, int plane, int y) const {
+	return (((size_t)frame * _planes + plane) * _size.height() + y)
+		* _size.width();
+}
+
+/**
+ * \brief Estimate the noise from absolute differences of neighbour pixels
+ *
+ * Differences of neighbouring pixels are insensitive to gradients, and
+ * the median makes the estimate insensitive to stars. The estimate has
+ * to be computed on the frame as it was taken, because interpolation
+ * during registration smoothes the noise by an amount that depends on
+ * the subpixel offset. Rows are sampled with a fixed spacing, chosen so
+ * that at most NOISE_MAX_SAMPLES differences are used, so the estimate
+ * does not depend on the number of threads.
+ */
+double	StackingCube::noise(const ConstImageAdapter<double>& image) const {
+	int	width = image.getSize().width();
+	int	height = image.getSize().height();
+	if ((width < 2) || (height < 1)) {
+		return 0;
+	}
+	size_t	perrow = width - 1;
+	int	spacing = std::max((size_t)NOISE_ROW_SPACING,
+		(height * perrow + NOISE_MAX_SAMPLES - 1) / NOISE_MAX_SAMPLES);
+	std::vector<float>	d;
+	d.reserve(((height + spacing - 1) / spacing) * perrow);
+	for (int y = 0; y < height; y += spacing) {
+		double	previous = image.pixel(0, y);
+		for (int x = 1; x < width; x++) {
+			double	v = image.pixel(x, y);
+			d.push_back(fabs(v - previous));
+			previous = v;
+		}
+	}
+	std::nth_element(d.begin(), d.begin() + d.size() / 2, d.end());
+	return 1.4826 * d[d.size() / 2] / sqrt(2.);
+}
+
+/**
+ * \brief Add a registered frame to the cube
+ *
+ * \param planes	adapters for the registered planes of the frame
+ * \param originals	adapters for the planes of the frame before
+ *			registration, used to estimate the noise of the frame
+ * \param transform	transform from stack coordinates to the coordinates
+ *			of the original frame, used to find out which pixels
+ *			are covered by the frame
+ */
+void	StackingCube::add(
+		const std::vector<const ConstImageAdapter<double>*>& planes,
+		const std::vector<const ConstImageAdapter<double>*>& originals,
+		const Transform& transform) {
+	if (((int)planes.size() != _planes)
+		|| ((int)originals.size() != _planes)) {
+		throw std::logic_error("plane count does not match cube");
+	}
+	unmap();
+	int	frame = frames();
+	int	width = _size.width();
+	int	height = _size.height();
+	std::vector<double>	variances(_planes);
+	for (int p = 0; p < _planes; p++) {
+		const ConstImageAdapter<double>&	image = *planes[p];
+		int	error = 0;
+#pragma omp parallel for schedule(dynamic)
+		for (int y = 0; y < height; y++) {
+			std::vector<float>	row(width);
+			for (int x = 0; x < width; x++) {
+				Point	s = transform(Point(x, y));
+				if ((s.x() < 0) || (s.x() > width - 1)
+					|| (s.y() < 0) || (s.y() > height - 1)) {
+					row[x] = std::numeric_limits<float>::quiet_NaN();
+					continue;
+				}
+				row[x] = image.pixel(x, y);
+			}
+			const char	*buffer = (const char *)&row[0];
+			size_t	remaining = width * sizeof(float);
+			off_t	position = offset(frame, p, y) * sizeof(float);
+			while (remaining > 0) {
+				ssize_t	bytes = pwrite(_fd, buffer, remaining,
+							position);
+				if (bytes <= 0) {
+					// a short write of 0 bytes does not set errno
+					int	e = (bytes < 0) ? errno : EIO;
+#pragma omp critical
+					error = e;
+					break;
+				}
+				buffer += bytes;
+				position += bytes;
+				remaining -= bytes;
+			}
+		}
+		if (error) {
+			std::string	msg = stringprintf("cannot write frame %d "
+				"to scratch cube: %s", frame, strerror(error));
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+			throw std::runtime_error(msg);
+		}
+		double	sigma = noise(*originals[p]);
+		variances[p] = sigma * sigma;
+	}
+
+	// the weight of the frame is the inverse of the mean noise variance
+	double	variance = 0;
+	for (int p = 0; p < _planes; p++) {
+		variance += variances[p] / _planes;
+	}
+	double	weight = (variance > 0) ? 1. / variance : 1.;
+	_weights.push_back(weight);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "frame %d added to cube, noise = %f, "
+		"weight = %g", frame, sqrt(variance), weight);
+}
+
+/**
+ * \brief Map the scratch file into the address space
+ */
+void	StackingCube::map() {
+	if (NULL != _data) {
+		return;
+	}
+	_mappedlength = offset(frames(), 0, 0) * sizeof(float);
+	if (_mappedlength == 0) {
+		return;
+	}
+	void	*data = mmap(NULL, _mappedlength, PROT_READ, MAP_SHARED,
+			_fd, 0);
+	if (MAP_FAILED == data) {
+		std::string	msg = stringprintf("cannot map scratch cube: %s",
+			strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	_data = (const float *)data;
+}
+
+/**
+ * \brief Remove the mapping of the scratch file
+ */
+void	StackingCube::unmap() {
+	if (NULL == _data) {
+		return;
+	}
+	munmap((void *)_data, _mappedlength);
+	_data = NULL;
+	_mappedlength = 0;
+}
+
+/**
+ * \brief Release the pages that contain a range of floats
+ *
+ * The range is shrunk to whole pages, so pages shared with other bands
+ * are left alone.
+ */
+static void	release(const float *data, size_t from, size_t to) {
+	static const size_t	pagesize = sysconf(_SC_PAGESIZE);
+	size_t	start = ((from * sizeof(float) + pagesize - 1) / pagesize)
+				* pagesize;
+	size_t	end = ((to * sizeof(float)) / pagesize) * pagesize;
+	if (end > start) {
+		madvise((char *)data + start, end - start, MADV_DONTNEED);
+	}
+}
+
+/**
+ * \brief A sample of a pixel stack
+ */
+typedef struct sample_s {
+	float	value;
+	float	weight;
+} sample_t;
+
+static bool	sample_less(const sample_t& a, const sample_t& b) {
+	return a.value < b.value;
+}
+
+/**
+ * \brief Median of the values of a set of samples
+ */
+static double	median(std::vector<float>& values, int n) {
+	std::nth_element(values.begin(), values.begin() + n / 2,
+		values.begin() + n);
+	double	m = values[n / 2];
+	if (0 == n % 2) {
+		m = (m + *std::max_element(values.begin(),
+			values.begin() + n / 2)) / 2;
+	}
+	return m;
+}
+
+/**
+ * \brief Rejection engine working on one pixel stack at a time
+ *
+ * Each thread uses its own engine, so the buffers are only allocated
+ * once per band.
+ */
+class PixelRejector {
+	const Stacker&	_stacker;
+	std::vector<float>	_values;
+	std::vector<float>	_winsorized;
+	int	keepwithin(std::vector<sample_t>& samples, int n,
+			double low, double high);
+	double	robustsigma(int n, double& m);
+	int	sigmaclip(std::vector<sample_t>& samples, int n, bool winsorize);
+	int	percentile(std::vector<sample_t>& samples, int n);
+public:
+	unsigned long	rejectedlow;
+	unsigned long	rejectedhigh;
+	PixelRejector(const Stacker& stacker, int frames)
+		: _stacker(stacker), _values(frames), _winsorized(frames),
+		  rejectedlow(0), rejectedhigh(0) { }
+	float	operator()(std::vector<sample_t>& samples, int n);
+};
+
+/**
+ * \brief Move the samples inside [low, high] to the front
+ *
+ * \return the number of samples that were kept
+ */
+int	PixelRejector::keepwithin(std::vector<sample_t>& samples, int n,
+		double low, double high) {
+	int	kept = 0;
+	for (int i = 0; i < n; i++) {
+		if (samples[i].value < low) {
+			rejectedlow++;
+		} else if (samples[i].value > high) {
+			rejectedhigh++;
+		} else {
+			samples[kept++] = samples[i];
+		}
+	}
+	return kept;
+}
+
+/**
+ * \brief Winsorized estimate of the standard deviation of _values
+ *
+ * The values are clipped at 1.5 sigma around the median until the
+ * estimate converges, the factor 1.134 corrects for the clipping
+ * of a normal distribution.
+ */
+double	PixelRejector::robustsigma(int n, double& m) {
+	std::copy(_values.begin(), _values.begin() + n, _winsorized.begin());
+	double	sigma = 0;
+	for (int iteration = 0; iteration < 10; iteration++) {
+		m = median(_winsorized, n);
+		double	s = 0, s2 = 0;
+		for (int i = 0; i < n; i++) {
+			s += _winsorized[i];
+			s2 += _winsorized[i] * _winsorized[i];
+		}
+		double	mean = s / n;
+		double	newsigma = 1.134
+			* sqrt(std::max(0., (s2 - n * mean * mean) / (n - 1)));
+		if ((newsigma == 0)
+			|| (fabs(newsigma - sigma) < 0.0005 * newsigma)) {
+			return newsigma;
+		}
+		sigma = newsigma;
+		double	low = m - 1.5 * sigma;
+		double	high = m + 1.5 * sigma;
+		for (int i = 0; i < n; i++) {
+			if (_winsorized[i] < low) {
+				_winsorized[i] = low;
+			} else if (_winsorized[i] > high) {
+				_winsorized[i] = high;
+			}
+		}
+	}
+	return sigma;
+}
+
+/**
+ * \brief Iterative (winsorized) sigma clipping around the median
+ */
+int	PixelRejector::sigmaclip(std::vector<sample_t>& samples, int n,
+		bool winsorize) {
+	for (int iteration = 0; iteration < _stacker.iterations();
+		iteration++) {
+		if (n < 3) {
+			break;
+		}
+		for (int i = 0; i < n; i++) {
+			_values[i] = samples[i].value;
+		}
+		double	m = 0;
+		double	sigma = 0;
+		if (winsorize) {
+			sigma = robustsigma(n, m);
+		} else {
+			m = median(_values, n);
+			double	s2 = 0;
+			for (int i = 0; i < n; i++) {
+				double	d = samples[i].value - m;
+				s2 += d * d;
+			}
+			sigma = sqrt(s2 / (n - 1));
+		}
+		if (sigma <= 0) {
+			break;
+		}
+		int	kept = keepwithin(samples, n,
+				m - _stacker.klow() * sigma,
+				m + _stacker.khigh() * sigma);
+		if (kept == n) {
+			break;
+		}
+		n = kept;
+	}
+	return n;
+}
+
+/**
+ * \brief Reject a fixed fraction of the lowest and highest samples
+ */
+int	PixelRejector::percentile(std::vector<sample_t>& samples, int n) {
+	int	drop = floor(n * _stacker.clipfraction());
+	if (n - 2 * drop < 1) {
+		drop = (n - 1) / 2;
+	}
+	if (drop == 0) {
+		return n;
+	}
+	std::sort(samples.begin(), samples.begin() + n, sample_less);
+	std::copy(samples.begin() + drop, samples.begin() + n - drop,
+		samples.begin());
+	rejectedlow += drop;
+	rejectedhigh += drop;
+	return n - 2 * drop;
+}
+
+/**
+ * \brief Combine the first n samples of a pixel stack
+ */
+float	PixelRejector::operator()(std::vector<sample_t>& samples, int n) {
+	if (n == 0) {
+		return 0;
+	}
+	switch (_stacker.rejection()) {
+	case Stacker::none:
+		break;
+	case Stacker::sigmaclip:
+		n = sigmaclip(samples, n, false);
+		break;
+	case Stacker::winsorized:
+		n = sigmaclip(samples, n, true);
+		break;
+	case Stacker::percentile:
+		n = percentile(samples, n);
+		break;
+	}
+	double	s = 0, w = 0;
+	for (int i = 0; i < n; i++) {
+		s += samples[i].weight * samples[i].value;
+		w += samples[i].weight;
+	}
+	return (w > 0) ? (s / w) : 0;
+}
+
+/**
+ * \brief Combine one plane of the cube into an image
+ *
+ * The rows of the image are processed in bands in parallel. Memory
+ * needed beyond the result image is one pixel stack per thread, the
+ * frame data itself is only accessed through the mapping.
+ */
+Image<float>	*StackingCube::combine(const Stacker& stacker, int plane) {
+	if ((plane < 0) || (plane >= _planes)) {
+		throw std::range_error("plane out of range");
+	}
+	map();
+	int	width = _size.width();
+	int	height = _size.height();
+	int	n = frames();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "combine plane %d of %d frames, "
+		"rejection %s", plane, n,
+		Stacker::rejection2string(stacker.rejection()).c_str());
+
+	// normalize the weights so that the largest weight is 1
+	std::vector<float>	weights(n, 1.);
+	if (stacker.weighted()) {
+		double	maxweight = *std::max_element(_weights.begin(),
+					_weights.end());
+		for (int f = 0; f < n; f++) {
+			weights[f] = _weights[f] / maxweight;
+		}
+	}
+
+	Image<float>	*result = new Image<float>(_size);
+	unsigned long	rejectedlow = 0;
+	unsigned long	rejectedhigh = 0;
+	int	nbands = (height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+#pragma omp parallel for schedule(dynamic)
+	for (int b = 0; b < nbands; b++) {
+		PixelRejector	rejector(stacker, n);
+		std::vector<sample_t>	samples(n);
+		std::vector<const float *>	rows(n);
+		int	y0 = b * BAND_HEIGHT;
+		int	y1 = std::min(height, y0 + BAND_HEIGHT);
+		for (int y = y0; y < y1; y++) {
+			for (int f = 0; f < n; f++) {
+				rows[f] = _data + offset(f, plane, y);
+			}
+			for (int x = 0; x < width; x++) {
+				int	m = 0;
+				for (int f = 0; f < n; f++) {
+					float	v = rows[f][x];
+					if (v == v) {
+						samples[m].value = v;
+						samples[m].weight = weights[f];
+						m++;
+					}
+				}
+				result->pixel(x, y) = rejector(samples, m);
+			}
+		}
+		for (int f = 0; f < n; f++) {
+			release(_data, offset(f, plane, y0),
+				offset(f, plane, y0) + (y1 - y0) * width);
+		}
+#pragma omp critical
+		{
+			rejectedlow += rejector.rejectedlow;
+			rejectedhigh += rejector.rejectedhigh;
+		}
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "plane %d: %lu low and %lu high "
+		"samples rejected (%.2f%%)", plane, rejectedlow, rejectedhigh,
+		100. * (rejectedlow + rejectedhigh)
+			/ ((double)n * _size.getPixels()));
+	return result;
+}
+
+} // namespace stacking
+} // namespace image
+} // namespace astro
@@ -0,0 +1,58 @@
+/*
+ * StackingCube.h -- scratch cube of registered frames for rejection stacking
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _StackingCube_h
+#define _StackingCube_h
+
+#include <AstroStacking.h>
+#include <vector>
+
+namespace astro {
+namespace image {
+namespace stacking {
+
+/**
+ * \brief Scratch cube of registered frames
+ *
+ * The registered frames are written as float planes to an unlinked
+ * temporary file, so the memory needed does not depend on the number
+ * of frames. Pixels that are not covered by a frame are stored as NaN.
+ * For combining, the file is mapped into the address space, and the
+ * rows of the output image are processed in bands, each band by
+ * a separate thread. Pages of a band are released as soon as the band
+ * is done.
+ */
+class StackingCube {
+	ImageSize	_size;
+	int	_planes;
+	int	_fd;
+	std::vector<double>	_weights;
+	const float	*_data;
+	size_t	_mappedlength;
+	void	map();
+	void	unmap();
+	size_t	offset(int frame, int plane, int y) const;
+	double	noise(const ConstImageAdapter<double>& image) const;
+	// prevent copying
+	StackingCube(const StackingCube& other);
+	StackingCube&	operator=(const StackingCube& other);
+public:
+	const ImageSize&	size() const { return _size; }
+	int	planes() const { return _planes; }
+	int	frames() const { return _weights.size(); }
+	StackingCube(const ImageSize& size, int planes,
+		const std::string& directory);
+	~StackingCube();
+	void	add(const std::vector<const ConstImageAdapter<double>*>& planes,
+			const std::vector<const ConstImageAdapter<double>*>& originals,
+			const transform::Transform& transform);
+	Image<float>	*combine(const Stacker& stacker, int plane);
+};
+
+} // namespace stacking
+} // namespace image
+} // namespace astro
+
+#endif /* _StackingCube_h */
@@ -0,0 +1,199 @@
+/*
+ * StackingPipeline.cpp -- read, register and stack images concurrently
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroStacking.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroUtils.h>
+#include <AstroIO.h>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using namespace astro::image::transform;
+using namespace astro::io;
+
+namespace astro {
+namespace image {
+namespace stacking {
+
+/**
+ * \brief Shared state of the stages of the pipeline
+ *
+ * All fields are protected by the mutex, every change is signaled with
+ * the condition variable to all waiting stages.
+ */
+class PipelineState {
+public:
+	std::mutex	mutex;
+	std::condition_variable	condition;
+	// images read but not yet registered
+	std::deque<std::pair<int, ImagePtr> >	toregister;
+	// registered images waiting to be added in order
+	std::map<int, std::pair<ImagePtr, Transform> >	registered;
+	int	accumulated;
+	bool	readerdone;
+	std::exception_ptr	error;
+	PipelineState() : accumulated(0), readerdone(false) { }
+	void	fail(std::exception_ptr e) {
+		std::unique_lock<std::mutex>	lock(mutex);
+		if (!error) {
+			error = e;
+		}
+		condition.notify_all();
+	}
+};
+
+/**
+ * \brief Read stage: read images, at most readahead ahead of the stacker
+ */
+static void	reader(PipelineState *state,
+		const std::vector<std::string> *filenames, int readahead) {
+	int	n = filenames->size();
+	for (int i = 0; i < n; i++) {
+		{
+			std::unique_lock<std::mutex>	lock(state->mutex);
+			while (!state->error
+				&& (i - state->accumulated >= readahead)) {
+				state->condition.wait(lock);
+			}
+			if (state->error) {
+				return;
+			}
+		}
+		ImagePtr	image;
+		try {
+			FITSin	in((*filenames)[i]);
+			image = in.read();
+		} catch (...) {
+			debug(LOG_ERR, DEBUG_LOG, 0, "cannot read %s",
+				(*filenames)[i].c_str());
+			state->fail(std::current_exception());
+			return;
+		}
+		std::unique_lock<std::mutex>	lock(state->mutex);
+		state->toregister.push_back(std::make_pair(i, image));
+		state->condition.notify_all();
+	}
+	std::unique_lock<std::mutex>	lock(state->mutex);
+	state->readerdone = true;
+	state->condition.notify_all();
+}
+
+/**
+ * \brief Registration stage: compute transforms for images read
+ */
+static void	registrar(PipelineState *state, const Stacker *stacker) {
+	while (true) {
+		std::pair<int, ImagePtr>	item;
+		{
+			std::unique_lock<std::mutex>	lock(state->mutex);
+			while (!state->error && state->toregister.empty()
+				&& !state->readerdone) {
+				state->condition.wait(lock);
+			}
+			if (state->error || state->toregister.empty()) {
+				return;
+			}
+			item = state->toregister.front();
+			state->toregister.pop_front();
+		}
+		try {
+			Transform	transform
+				= stacker->registration(item.second);
+			std::unique_lock<std::mutex>	lock(state->mutex);
+			state->registered.insert(std::make_pair(item.first,
+				std::make_pair(item.second, transform)));
+			state->condition.notify_all();
+		} catch (...) {
+			debug(LOG_ERR, DEBUG_LOG, 0, "cannot register image %d",
+				item.first);
+			state->fail(std::current_exception());
+			return;
+		}
+	}
+}
+
+StackingPipeline::StackingPipeline(StackerPtr stacker)
+	: _stacker(stacker), _threads(0), _readahead(0) {
+}
+
+/**
+ * \brief Stack a list of images
+ *
+ * The images are added to the stacker in the order of the list, so the
+ * result does not depend on the number of threads.
+ */
+void	StackingPipeline::operator()(const std::vector<std::string>& filenames) {
+	int	threads = _threads;
+	if (threads <= 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	int	readahead = (_readahead > 0) ? _readahead : 2 * threads;
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "stacking %d images with %d threads, "
+		"readahead %d", filenames.size(), threads, readahead);
+	Timer	timer;
+	timer.start();
+
+	PipelineState	state;
+	std::thread	readerthread(reader, &state, &filenames, readahead);
+	std::vector<std::thread>	workers;
+	for (int t = 0; t < threads; t++) {
+		workers.push_back(std::thread(registrar, &state,
+			&*_stacker));
+	}
+
+	// add the images in order as soon as they are registered
+	double	addtime = 0;
+	int	n = filenames.size();
+	for (int i = 0; i < n; i++) {
+		std::pair<ImagePtr, Transform>	frame;
+		{
+			std::unique_lock<std::mutex>	lock(state.mutex);
+			while (!state.error && (state.registered.find(i)
+				== state.registered.end())) {
+				state.condition.wait(lock);
+			}
+			if (state.error) {
+				break;
+			}
+			auto	r = state.registered.find(i);
+			frame = r->second;
+			state.registered.erase(r);
+		}
+		try {
+			Timer	addtimer;
+			addtimer.start();
+			_stacker->add(frame.first, frame.second);
+			addtimer.end();
+			addtime += addtimer.elapsed();
+		} catch (...) {
+			state.fail(std::current_exception());
+			break;
+		}
+		std::unique_lock<std::mutex>	lock(state.mutex);
+		state.accumulated++;
+		state.condition.notify_all();
+	}
+
+	// wait for all stages to terminate
+	readerthread.join();
+	for (auto w = workers.begin(); w != workers.end(); w++) {
+		w->join();
+	}
+	if (state.error) {
+		std::rethrow_exception(state.error);
+	}
+	timer.end();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%d images stacked in %.3fs, "
+		"%.3fs adding", n, timer.elapsed(), addtime);
+}
+
+} // namespace stacking
+} // namespace image
+} // namespace astro
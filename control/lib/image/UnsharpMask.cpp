@@ -4,6 +4,7 @@
  * (c) 2016 Prof Dr Andreas Müller, Hochschule Rapperswil
  */
 #include <AstroAdapter.h>
+#include <AstroConvolve.h>
 
 namespace astro {
 namespace adapter {
@@ -21,27 +22,57 @@ void	UnsharpMaskBase::radius(double r) {
 	_radius = r;
 	_top = ceil(r);
 	_weight = 0;
-	int	counter = 0;
+	int	n = 2 * _top + 1;
+	_weights.resize(n * n);
 	for (int x = -_top; x <= _top; x++) {
 		for (int y = -_top; y <= _top; y++) {
 			double	s = w(x, y);
 			if (s > 0) {
 				_weight += s;
-				counter++;
+			} else {
+				s = 0;
 			}
+			_weights[(x + _top) + n * (y + _top)] = s;
 		}
 	}
 	_weight = 1./_weight;
+	for (int i = 0; i < n * n; i++) {
+		_weights[i] *= _weight;
+	}
+}
+
+/**
+ * \brief The normalized mask weights as a convolution kernel
+ */
+ConvolutionKernel	UnsharpMaskBase::kernel() const {
+	int	n = 2 * _top + 1;
+	Image<double>	k(n, n);
+	std::copy(_weights.begin(), _weights.end(), k.pixels);
+	return ConvolutionKernel(k);
 }
 
+/**
+ * \brief Unsharp mask an image
+ *
+ * The mask is computed by the ConvolutionEngine with precomputed weights,
+ * treating the image as periodic like the TilingAdapter did before.
+ */
 template<typename T>
-ImagePtr	unsharp(const ConstImageAdapter<T>& image,
-			double radius, double amount) {
-	TilingAdapter<T>	tiling(image);
-	UnsharpMaskingAdapter<T>	masking(tiling);
-	masking.radius(radius);
-	masking.amount(amount);
-	return ImagePtr(new Image<T>(masking));
+ImagePtr	unsharp(const Image<T>& image, double radius, double amount) {
+	UnsharpMaskBase	mask;
+	mask.radius(radius);
+	ConvolutionEngine	engine(mask.kernel(), true);
+	ImagePtr	maskptr = engine(ConvertingAdapter<double, T>(image));
+	const Image<double>	*maskimage
+		= dynamic_cast<const Image<double> *>(&*maskptr);
+	Image<T>	*result = new Image<T>(image.size());
+	int	n = image.size().getPixels();
+#pragma omp parallel for
+	for (int i = 0; i < n; i++) {
+		double	v = image.pixels[i] - amount * maskimage->pixels[i];
+		result->pixels[i] = (v < 0) ? 0 : v;
+	}
+	return ImagePtr(result);
 }
 
 #define	do_unsharp(image, Pixel)					\
@@ -0,0 +1,260 @@
+/*
+ * Benchmark.cpp -- harness for throughput measurements of the image library
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Benchmark.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroUtils.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+#include <thread>
+
+/*
+ * Allocation counting: the benchmark program replaces the global
+ * operator new, so every allocation done by the library while a
+ * benchmark runs is counted.
+ */
+static std::atomic<unsigned long>	allocations(0);
+static std::atomic<unsigned long>	allocatedbytes(0);
+
+void	*operator new(size_t size) {
+	allocations++;
+	allocatedbytes += size;
+	void	*p = malloc((size) ? size : 1);
+	if (NULL == p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void	*operator new[](size_t size) {
+	return operator new(size);
+}
+
+void	operator delete(void *p) noexcept {
+	free(p);
+}
+
+void	operator delete[](void *p) noexcept {
+	free(p);
+}
+
+void	operator delete(void *p, size_t) noexcept {
+	free(p);
+}
+
+void	operator delete[](void *p, size_t) noexcept {
+	free(p);
+}
+
+namespace astro {
+namespace test {
+
+BenchmarkResult::BenchmarkResult() : pixels(0), iterations(0), best(0),
+	mean(0), median(0), pixelspersecond(0), allocations(0),
+	allocatedbytes(0) {
+}
+
+std::string	BenchmarkResult::toJSON() const {
+	return stringprintf("{ \"name\": \"%s\", \"pixels\": %lu, "
+		"\"iterations\": %d, \"best\": %.6f, \"mean\": %.6f, "
+		"\"median\": %.6f, \"pixelspersecond\": %.0f, "
+		"\"allocations\": %.1f, \"allocatedbytes\": %.0f }",
+		name.c_str(), pixels, iterations, best, mean, median,
+		pixelspersecond, allocations, allocatedbytes);
+}
+
+BenchmarkRunner::BenchmarkRunner(int iterations, double mintime)
+	: _iterations(iterations), _mintime(mintime) {
+}
+
+/**
+ * \brief Find out whether a benchmark matches the name filter
+ */
+bool	BenchmarkRunner::selected(const std::string& name) const {
+	if (_filter.size() == 0) {
+		return true;
+	}
+	return name.find(_filter) != std::string::npos;
+}
+
+/**
+ * \brief Run a benchmark
+ */
+void	BenchmarkRunner::run(const std::string& name, unsigned long pixels,
+		std::function<void()> operation) {
+	if (!selected(name)) {
+		return;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "benchmark %s", name.c_str());
+
+	// warm up
+	operation();
+
+	// measure
+	std::vector<double>	times;
+	unsigned long	a = allocations;
+	unsigned long	b = allocatedbytes;
+	double	total = 0;
+	while ((times.size() < (size_t)_iterations) || (total < _mintime)) {
+		double	start = Timer::gettime();
+		operation();
+		double	t = Timer::gettime() - start;
+		times.push_back(t);
+		total += t;
+	}
+	a = allocations - a;
+	b = allocatedbytes - b;
+
+	BenchmarkResult	result;
+	result.name = name;
+	result.pixels = pixels;
+	result.iterations = times.size();
+	result.mean = total / times.size();
+	std::sort(times.begin(), times.end());
+	result.best = times.front();
+	result.median = times[times.size() / 2];
+	result.pixelspersecond = (result.median > 0)
+				? (pixels / result.median) : 0;
+	result.allocations = a / (double)times.size();
+	result.allocatedbytes = b / (double)times.size();
+	debug(LOG_INFO, DEBUG_LOG, 0, "%s: %d iterations, median %.6fs, "
+		"%.1f Mpixels/s", name.c_str(), result.iterations,
+		result.median, result.pixelspersecond / 1000000.);
+	_results.push_back(result);
+}
+
+/**
+ * \brief Write the results as a JSON document
+ */
+void	BenchmarkRunner::json(std::ostream& out,
+		const image::ImageSize& size) const {
+	time_t	now = time(NULL);
+	char	timestamp[32];
+	strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S",
+		localtime(&now));
+	out << "{" << std::endl;
+	out << "  \"timestamp\": \"" << timestamp << "\"," << std::endl;
+	out << "  \"threads\": " << std::thread::hardware_concurrency()
+		<< "," << std::endl;
+	out << "  \"width\": " << size.width() << "," << std::endl;
+	out << "  \"height\": " << size.height() << "," << std::endl;
+	out << "  \"benchmarks\": [" << std::endl;
+	for (auto ptr = _results.begin(); ptr != _results.end(); ptr++) {
+		out << "    " << ptr->toJSON();
+		if (ptr + 1 != _results.end()) {
+			out << ",";
+		}
+		out << std::endl;
+	}
+	out << "  ]" << std::endl;
+	out << "}" << std::endl;
+}
+
+/**
+ * \brief Linear congruential generator for reproducible inputs
+ */
+class lcg {
+	uint64_t	_state;
+public:
+	lcg(uint64_t seed) : _state(seed) { }
+	double	uniform() {
+		_state = 6364136223846793005ULL * _state
+			+ 1442695040888963407ULL;
+		return (_state >> 11) / 9007199254740992.;
+	}
+	double	normal() {
+		// sum of twelve uniform variables is good enough for noise
+		double	s = -6;
+		for (int i = 0; i < 12; i++) {
+			s += uniform();
+		}
+		return s;
+	}
+};
+
+StarFieldGenerator::StarFieldGenerator(const image::ImageSize& size,
+	int stars, unsigned long seed)
+	: _size(size), _stars(stars), _seed(seed) {
+}
+
+/**
+ * \brief Create a star field image
+ *
+ * The image has a sky background with a linear gradient, gaussian
+ * star profiles and gaussian noise. Values are in the range of a
+ * 16 bit camera.
+ */
+image::Image<double>	*StarFieldGenerator::operator()(const Point& offset,
+				unsigned long noiseseed) const {
+	int	w = _size.width();
+	int	h = _size.height();
+	image::Image<double>	*image = new image::Image<double>(_size);
+
+	// background gradient
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			image->pixel(x, y) = 1000 + 0.5 * x + 0.25 * y;
+		}
+	}
+
+	// stars
+	lcg	stars(_seed);
+	for (int i = 0; i < _stars; i++) {
+		double	sx = stars.uniform() * w + offset.x();
+		double	sy = stars.uniform() * h + offset.y();
+		double	brightness = 500 + 30000 * pow(stars.uniform(), 4);
+		double	sigma = 1.2 + stars.uniform();
+		int	r = ceil(4 * sigma);
+		for (int y = floor(sy) - r; y <= ceil(sy) + r; y++) {
+			if ((y < 0) || (y >= h)) { continue; }
+			for (int x = floor(sx) - r; x <= ceil(sx) + r; x++) {
+				if ((x < 0) || (x >= w)) { continue; }
+				double	dx = x - sx;
+				double	dy = y - sy;
+				double	d2 = dx * dx + dy * dy;
+				image->pixel(x, y) += brightness
+					* exp(-d2 / (2 * sigma * sigma));
+			}
+		}
+	}
+
+	// noise
+	lcg	noise(noiseseed);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			image->pixel(x, y) += 20 * noise.normal();
+		}
+	}
+	return image;
+}
+
+image::Image<unsigned short>	*toUnsignedShort(
+					const image::Image<double>& image) {
+	image::Image<unsigned short>	*result
+		= new image::Image<unsigned short>(image.size());
+	int	w = image.size().width();
+	int	h = image.size().height();
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			double	v = image.pixel(x, y);
+			result->pixel(x, y) = (v < 0) ? 0
+				: ((v > 65535) ? 65535 : (unsigned short)v);
+		}
+	}
+	return result;
+}
+
+image::Image<float>	*toFloat(const image::Image<double>& image) {
+	return new image::Image<float>(image);
+}
+
+} // namespace test
+} // namespace astro
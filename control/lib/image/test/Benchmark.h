@@ -0,0 +1,93 @@
+/*
+ * Benchmark.h -- harness for throughput measurements of the image library
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#ifndef _Benchmark_h
+#define _Benchmark_h
+
+#include <AstroImage.h>
+#include <AstroTypes.h>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace astro {
+namespace test {
+
+/**
+ * \brief Result of a single benchmark
+ *
+ * Times are wall clock times of a single iteration in seconds,
+ * allocations and allocated bytes are per iteration as well.
+ */
+class BenchmarkResult {
+public:
+	std::string	name;
+	unsigned long	pixels;
+	int	iterations;
+	double	best;
+	double	mean;
+	double	median;
+	double	pixelspersecond;
+	double	allocations;
+	double	allocatedbytes;
+	BenchmarkResult();
+	std::string	toJSON() const;
+};
+
+/**
+ * \brief Run benchmarks and collect the results
+ *
+ * Each benchmark is an operation processing a known number of pixels.
+ * The operation is first run once to warm up caches, and then repeated
+ * until both the minimum number of iterations and the minimum total
+ * time are reached. Allocations are counted by the global operator new
+ * of the benchmark program.
+ */
+class BenchmarkRunner {
+	int	_iterations;
+	double	_mintime;
+	std::string	_filter;
+	std::vector<BenchmarkResult>	_results;
+public:
+	BenchmarkRunner(int iterations = 3, double mintime = 1.0);
+	void	filter(const std::string& f) { _filter = f; }
+	bool	selected(const std::string& name) const;
+	void	run(const std::string& name, unsigned long pixels,
+			std::function<void()> operation);
+	const std::vector<BenchmarkResult>&	results() const {
+		return _results;
+	}
+	void	json(std::ostream& out, const image::ImageSize& size) const;
+};
+
+/**
+ * \brief Deterministic synthetic star field
+ *
+ * The star positions, brightnesses and the noise are derived from a
+ * private linear congruential generator, so the same seed always
+ * produces the same image. The offset shifts all stars,
+ * which allows to create frames for registration benchmarks.
+ */
+class StarFieldGenerator {
+	image::ImageSize	_size;
+	int	_stars;
+	unsigned long	_seed;
+public:
+	StarFieldGenerator(const image::ImageSize& size, int stars = 300,
+		unsigned long seed = 4711);
+	image::Image<double>	*operator()(const Point& offset = Point(),
+					unsigned long noiseseed = 1) const;
+};
+
+// conversions of the star field to other pixel types
+image::Image<unsigned short>	*toUnsignedShort(
+					const image::Image<double>& image);
+image::Image<float>	*toFloat(const image::Image<double>& image);
+
+} // namespace test
+} // namespace astro
+
+#endif /* _Benchmark_h */
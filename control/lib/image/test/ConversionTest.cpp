@@ -0,0 +1,201 @@
+/*
+ * ConversionTest.cpp -- tests for the fast conversion kernels
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroConversion.h>
+#include <AstroDebug.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cstdlib>
+#include <vector>
+
+using namespace astro::image;
+
+namespace astro {
+namespace test {
+
+class ConversionTest : public CppUnit::TestFixture {
+private:
+	Image<YUYV<unsigned char> >	*yuyvimage;
+	Image<RGB<unsigned char> >	*rgbimage;
+public:
+	void	setUp();
+	void	tearDown();
+	void	testYuyv2rgb();
+	void	testYuyv2luminance();
+	void	testRgb2mono();
+	void	testScale16to8();
+	void	testStreamFormat();
+
+	CPPUNIT_TEST_SUITE(ConversionTest);
+	CPPUNIT_TEST(testYuyv2rgb);
+	CPPUNIT_TEST(testYuyv2luminance);
+	CPPUNIT_TEST(testRgb2mono);
+	CPPUNIT_TEST(testScale16to8);
+	CPPUNIT_TEST(testStreamFormat);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ConversionTest);
+
+void	ConversionTest::setUp() {
+	yuyvimage = new Image<YUYV<unsigned char> >(64, 48);
+	rgbimage = new Image<RGB<unsigned char> >(64, 48);
+	srandom(4711);
+	for (unsigned int i = 0; i < yuyvimage->size().getPixels(); i++) {
+		yuyvimage->pixels[i].y = random() & 0xff;
+		yuyvimage->pixels[i].uv = random() & 0xff;
+		rgbimage->pixels[i].R = random() & 0xff;
+		rgbimage->pixels[i].G = random() & 0xff;
+		rgbimage->pixels[i].B = random() & 0xff;
+	}
+}
+
+void	ConversionTest::tearDown() {
+	delete yuyvimage;
+	delete rgbimage;
+}
+
+void	ConversionTest::testYuyv2rgb() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testYuyv2rgb() begin");
+	// the image kernel must agree with the generic conversion
+	Image<RGB<unsigned char> >	generic(*yuyvimage);
+	std::unique_ptr<Image<RGB<unsigned char> > >	fast(yuyv2rgb(*yuyvimage));
+	unsigned int	n = yuyvimage->size().getPixels();
+	for (unsigned int i = 0; i < n; i++) {
+		CPPUNIT_ASSERT(generic.pixels[i] == fast->pixels[i]);
+	}
+	// the buffer kernel must agree with the image kernel
+	std::vector<uint8_t>	packed(2 * n);
+	for (unsigned int i = 0; i < n; i++) {
+		packed[2 * i] = yuyvimage->pixels[i].y;
+		packed[2 * i + 1] = yuyvimage->pixels[i].uv;
+	}
+	std::vector<uint8_t>	rgb(3 * n);
+	kernels::yuyv2rgb(packed.data(), rgb.data(), n);
+	for (unsigned int i = 0; i < n; i++) {
+		CPPUNIT_ASSERT(rgb[3 * i] == fast->pixels[i].R);
+		CPPUNIT_ASSERT(rgb[3 * i + 1] == fast->pixels[i].G);
+		CPPUNIT_ASSERT(rgb[3 * i + 2] == fast->pixels[i].B);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testYuyv2rgb() end");
+}
+
+void	ConversionTest::testYuyv2luminance() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testYuyv2luminance() begin");
+	std::unique_ptr<Image<unsigned char> >	fast(
+		yuyv2luminance(*yuyvimage));
+	unsigned int	n = yuyvimage->size().getPixels();
+	std::vector<uint8_t>	packed(2 * n);
+	for (unsigned int i = 0; i < n; i++) {
+		CPPUNIT_ASSERT(fast->pixels[i] == yuyvimage->pixels[i].y);
+		packed[2 * i] = yuyvimage->pixels[i].y;
+		packed[2 * i + 1] = yuyvimage->pixels[i].uv;
+	}
+	std::vector<uint8_t>	mono(n);
+	kernels::yuyv2luminance(packed.data(), mono.data(), n);
+	for (unsigned int i = 0; i < n; i++) {
+		CPPUNIT_ASSERT(mono[i] == fast->pixels[i]);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testYuyv2luminance() end");
+}
+
+void	ConversionTest::testRgb2mono() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testRgb2mono() begin");
+	std::unique_ptr<Image<unsigned char> >	fast(rgb2mono(*rgbimage));
+	unsigned int	n = rgbimage->size().getPixels();
+	std::vector<uint8_t>	packed(3 * n);
+	for (unsigned int i = 0; i < n; i++) {
+		// fixed point and truncation may be off by one
+		int	l = rgbimage->pixels[i].luminance();
+		CPPUNIT_ASSERT(abs(l - fast->pixels[i]) <= 1);
+		packed[3 * i] = rgbimage->pixels[i].R;
+		packed[3 * i + 1] = rgbimage->pixels[i].G;
+		packed[3 * i + 2] = rgbimage->pixels[i].B;
+	}
+	std::vector<uint8_t>	mono(n);
+	kernels::rgb2mono(packed.data(), mono.data(), n);
+	for (unsigned int i = 0; i < n; i++) {
+		CPPUNIT_ASSERT(mono[i] == fast->pixels[i]);
+	}
+	// white must remain white
+	uint8_t	white[3] = { 255, 255, 255 };
+	uint8_t	w = 0;
+	kernels::rgb2mono(white, &w, 1);
+	CPPUNIT_ASSERT(w == 255);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testRgb2mono() end");
+}
+
+void	ConversionTest::testScale16to8() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testScale16to8() begin");
+	Image<unsigned short>	image(256, 256);
+	unsigned int	n = image.size().getPixels();
+	for (unsigned int i = 0; i < n; i++) {
+		image.pixels[i] = i;
+	}
+	image.setMosaicType(MosaicType::BAYER_GRBG);
+	// default range is the same as the generic conversion
+	std::unique_ptr<Image<unsigned char> >	fast(scale16to8(image));
+	CPPUNIT_ASSERT(fast->getMosaicType() == image.getMosaicType());
+	for (unsigned int i = 0; i < n; i++) {
+		CPPUNIT_ASSERT(fast->pixels[i] == (image.pixels[i] >> 8));
+	}
+	// values are clipped to the range and stretched
+	std::unique_ptr<Image<unsigned char> >	stretched(
+		scale16to8(image, 1000, 2000));
+	for (unsigned int i = 0; i < n; i++) {
+		unsigned short	v = image.pixels[i];
+		unsigned char	s = stretched->pixels[i];
+		if (v <= 1000) {
+			CPPUNIT_ASSERT(s == 0);
+		} else if (v >= 2000) {
+			CPPUNIT_ASSERT(s == 255);
+		} else {
+			int	expected = (255 * (v - 1000) + 500) / 1000;
+			CPPUNIT_ASSERT(abs(expected - s) <= 1);
+		}
+	}
+	CPPUNIT_ASSERT_THROW(scale16to8(image, 2000, 1000), std::range_error);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testScale16to8() end");
+}
+
+void	ConversionTest::testStreamFormat() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testStreamFormat() begin");
+	CPPUNIT_ASSERT(StreamFormat::string2format("mono8")
+		== StreamFormat::mono8);
+	CPPUNIT_ASSERT(StreamFormat::format2string(StreamFormat::rgb8)
+		== std::string("rgb8"));
+	CPPUNIT_ASSERT_THROW(StreamFormat::string2format("jpeg"),
+		std::runtime_error);
+	CPPUNIT_ASSERT_THROW(StreamFormat(StreamFormat::mono8, 100, 100),
+		std::range_error);
+	ImagePtr	yuyv(new Image<YUYV<unsigned char> >(*yuyvimage));
+	ImagePtr	image = StreamFormat().convert(yuyv);
+	CPPUNIT_ASSERT(image.get() == yuyv.get());
+	image = StreamFormat(StreamFormat::rgb8).convert(yuyv);
+	CPPUNIT_ASSERT(NULL != dynamic_cast<Image<RGB<unsigned char> > *>(
+		&*image));
+	StreamFormat	mono(StreamFormat::mono8);
+	image = mono.convert(image);
+	CPPUNIT_ASSERT(NULL != dynamic_cast<Image<unsigned char> *>(&*image));
+	CPPUNIT_ASSERT(image->size() == yuyvimage->size());
+	// images without a fast conversion are left alone
+	ImagePtr	doubleimage(new Image<double>(16, 16));
+	image = mono.convert(doubleimage);
+	CPPUNIT_ASSERT(image.get() == doubleimage.get());
+	// the white point of a 12 bit sensor becomes white
+	Image<unsigned short>	*shortimage = new Image<unsigned short>(16, 16);
+	ImagePtr	shortptr(shortimage);
+	shortimage->fill(4095);
+	image = StreamFormat(StreamFormat::mono8, 0, 4095).convert(shortptr);
+	Image<unsigned char>	*byteimage
+		= dynamic_cast<Image<unsigned char> *>(&*image);
+	CPPUNIT_ASSERT(NULL != byteimage);
+	CPPUNIT_ASSERT(byteimage->pixel(3, 3) == 255);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testStreamFormat() end");
+}
+
+} // namespace test
+} // namespace astro
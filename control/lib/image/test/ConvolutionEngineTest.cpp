@@ -0,0 +1,186 @@
+/*
+ * ConvolutionEngineTest.cpp -- test the convolution engine
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <AstroDebug.h>
+#include <AstroConvolve.h>
+#include <AstroAdapter.h>
+#include <cmath>
+
+using namespace astro::image;
+using namespace astro::adapter;
+
+namespace astro {
+namespace test {
+
+class ConvolutionEngineTest: public CppUnit::TestFixture {
+	Image<double>	*image;
+	Image<double>	*disk;
+	double	maxdifference(const Image<double>& a,
+			const ConstImageAdapter<double>& b);
+public:
+	void	setUp();
+	void	tearDown();
+	void	testSeparable();
+	void	testAdapter();
+	void	testFourier();
+	void	testPeriodic();
+	void	testColor();
+
+	CPPUNIT_TEST_SUITE(ConvolutionEngineTest);
+	CPPUNIT_TEST(testSeparable);
+	CPPUNIT_TEST(testAdapter);
+	CPPUNIT_TEST(testFourier);
+	CPPUNIT_TEST(testPeriodic);
+	CPPUNIT_TEST(testColor);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ConvolutionEngineTest);
+
+void	ConvolutionEngineTest::setUp() {
+	image = new Image<double>(23, 17);
+	for (int x = 0; x < 23; x++) {
+		for (int y = 0; y < 17; y++) {
+			image->pixel(x, y) = (x * 5 + y * 11) % 13 + 0.25 * x;
+		}
+	}
+	disk = new Image<double>(5, 5);
+	for (int x = 0; x < 5; x++) {
+		for (int y = 0; y < 5; y++) {
+			disk->pixel(x, y) = (hypot(x - 2, y - 2) <= 2) ? x + 1 : 0;
+		}
+	}
+}
+
+void	ConvolutionEngineTest::tearDown() {
+	delete image;
+	delete disk;
+}
+
+double	ConvolutionEngineTest::maxdifference(const Image<double>& a,
+		const ConstImageAdapter<double>& b) {
+	double	result = 0;
+	for (int x = 0; x < a.size().width(); x++) {
+		for (int y = 0; y < a.size().height(); y++) {
+			result = std::max(result,
+				fabs(a.pixel(x, y) - b.pixel(x, y)));
+		}
+	}
+	return result;
+}
+
+void	ConvolutionEngineTest::testSeparable() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSeparable() begin");
+	ConvolutionKernel	gauss = ConvolutionKernel::gauss(1.5);
+	CPPUNIT_ASSERT(gauss.separable());
+	CPPUNIT_ASSERT(gauss.size() == ImageSize(11, 11));
+	double	sum = 0;
+	for (int x = 0; x < 11; x++) {
+		for (int y = 0; y < 11; y++) {
+			sum += gauss.weight(x, y);
+		}
+	}
+	CPPUNIT_ASSERT(fabs(sum - 1) < 1e-10);
+
+	// a product kernel given as an image must be recognized
+	Image<double>	product(4, 3);
+	for (int x = 0; x < 4; x++) {
+		for (int y = 0; y < 3; y++) {
+			product.pixel(x, y) = (x + 1) * (2 - y);
+		}
+	}
+	CPPUNIT_ASSERT(ConvolutionKernel(product).separable());
+	CPPUNIT_ASSERT(!ConvolutionKernel(*disk).separable());
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSeparable() end");
+}
+
+void	ConvolutionEngineTest::testAdapter() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testAdapter() begin");
+	// rows computed with the separable method agree with single pixels
+	ConvolutionAdapter<double>	separable(*image,
+		ConvolutionKernel::box(3, 5));
+	Image<double>	a(separable);
+	CPPUNIT_ASSERT(maxdifference(a, separable) < 1e-10);
+	CPPUNIT_ASSERT(fabs(a.pixel(0, 0) - (image->pixel(0, 0)
+		+ image->pixel(1, 0) + image->pixel(0, 1) + image->pixel(1, 1)
+		+ image->pixel(0, 2) + image->pixel(1, 2)) / 15) < 1e-10);
+
+	// same for the direct method
+	ConvolutionAdapter<double>	direct(*image, *disk);
+	Image<double>	b(direct);
+	CPPUNIT_ASSERT(maxdifference(b, direct) < 1e-10);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testAdapter() end");
+}
+
+void	ConvolutionEngineTest::testFourier() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testFourier() begin");
+	ConvolutionKernel	kernel(*disk);
+	ConvolutionEngine	engine(kernel);
+	engine.method(ConvolutionEngine::spatial);
+	ImagePtr	spatial = engine(*image);
+	engine.method(ConvolutionEngine::fourier);
+	ImagePtr	fourier = engine(*image);
+	ConvolutionAdapter<double>	adapter(*image, *disk);
+	Image<double>	*s = dynamic_cast<Image<double> *>(&*spatial);
+	Image<double>	*f = dynamic_cast<Image<double> *>(&*fourier);
+	CPPUNIT_ASSERT(maxdifference(*s, adapter) < 1e-9);
+	CPPUNIT_ASSERT(maxdifference(*f, adapter) < 1e-9);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testFourier() end");
+}
+
+void	ConvolutionEngineTest::testPeriodic() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPeriodic() begin");
+	ConvolutionKernel	kernel(*disk);
+	ConvolutionEngine	engine(kernel, true);
+	engine.method(ConvolutionEngine::spatial);
+	ImagePtr	spatial = engine(*image);
+	engine.method(ConvolutionEngine::fourier);
+	ImagePtr	fourier = engine(*image);
+	TilingAdapter<double>	tiling(*image);
+	Image<double>	*s = dynamic_cast<Image<double> *>(&*spatial);
+	Image<double>	*f = dynamic_cast<Image<double> *>(&*fourier);
+	for (int x = 0; x < 23; x++) {
+		for (int y = 0; y < 17; y++) {
+			double	v = 0;
+			for (int i = 0; i < 5; i++) {
+				for (int j = 0; j < 5; j++) {
+					v += disk->pixel(i, j) * tiling.pixel(
+						x + i - 2, y + j - 2);
+				}
+			}
+			CPPUNIT_ASSERT(fabs(s->pixel(x, y) - v) < 1e-9);
+			CPPUNIT_ASSERT(fabs(f->pixel(x, y) - v) < 1e-9);
+		}
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPeriodic() end");
+}
+
+void	ConvolutionEngineTest::testColor() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testColor() begin");
+	Image<RGB<float> >	color(9, 7);
+	for (int x = 0; x < 9; x++) {
+		for (int y = 0; y < 7; y++) {
+			color.pixel(x, y) = RGB<float>((float)x, (float)y,
+				(float)(x + y));
+		}
+	}
+	ConvolutionAdapter<RGB<float> >	adapter(color,
+		ConvolutionKernel::gauss(1));
+	Image<RGB<float> >	result(adapter);
+	for (int x = 0; x < 9; x++) {
+		for (int y = 0; y < 7; y++) {
+			RGB<float>	p = adapter.pixel(x, y);
+			CPPUNIT_ASSERT(fabs(result.pixel(x, y).R - p.R) < 1e-4);
+			CPPUNIT_ASSERT(fabs(result.pixel(x, y).B - p.B) < 1e-4);
+		}
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testColor() end");
+}
+
+} // namespace test
+} // namespace astro
@@ -0,0 +1,140 @@
+/*
+ * FITScompressionTest.cpp -- write and read tile compressed FITS files
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+
+#include <AstroIO.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <config.h>
+#include <iostream>
+#include <AstroDebug.h>
+#include <cmath>
+
+using namespace astro::io;
+using namespace astro::image;
+
+namespace astro {
+namespace test {
+
+class FITScompressionTest : public CppUnit::TestFixture {
+public:
+	void	setUp() { }
+	void	tearDown() { }
+	void	testSpec();
+	void	testRiceUShort();
+	void	testQuantizedFloat();
+	void	testLosslessFloat();
+
+	CPPUNIT_TEST_SUITE(FITScompressionTest);
+	CPPUNIT_TEST(testSpec);
+	CPPUNIT_TEST(testRiceUShort);
+	CPPUNIT_TEST(testQuantizedFloat);
+	CPPUNIT_TEST(testLosslessFloat);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+void	FITScompressionTest::testSpec() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSpec() begin");
+	FITScompression	c1("rice");
+	CPPUNIT_ASSERT(c1.method() == FITScompression::RICE);
+	CPPUNIT_ASSERT(c1.quantize() == 0);
+	FITScompression	c2("hcompress:16");
+	CPPUNIT_ASSERT(c2.method() == FITScompression::HCOMPRESS);
+	CPPUNIT_ASSERT(c2.quantize() == 16);
+	CPPUNIT_ASSERT(FITScompression(c2.toString()) == c2);
+	CPPUNIT_ASSERT(!FITScompression("none").enabled());
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSpec() end");
+}
+
+void	FITScompressionTest::testRiceUShort() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testRiceUShort() begin");
+	std::string	filename("tmp/rice_test.fits");
+	Image<unsigned short>	image(256, 256);
+	for (int x = 0; x < image.size().width(); x++) {
+		for (int y = 0; y < image.size().height(); y++) {
+			image.pixel(x, y) = (x * y) % 65536;
+		}
+	}
+	image.setMetadata(FITSKeywords::meta(std::string("EXPTIME"), 1.5));
+	FITSoutfile<unsigned short>	outfile(filename);
+	outfile.setPrecious(false);
+	outfile.setCompression(FITScompression(FITScompression::RICE));
+	outfile.write(image);
+
+	// reading must be transparent, and rice is lossless
+	FITSinfile<unsigned short>	infile(filename);
+	CPPUNIT_ASSERT(infile.getSize() == image.size());
+	CPPUNIT_ASSERT(infile.hasMetadata("EXPTIME"));
+	CPPUNIT_ASSERT(!infile.hasMetadata("ZCMPTYPE"));
+	Image<unsigned short>	*readback = infile.read();
+	for (int x = 0; x < image.size().width(); x++) {
+		for (int y = 0; y < image.size().height(); y++) {
+			CPPUNIT_ASSERT(readback->pixel(x, y)
+				== image.pixel(x, y));
+		}
+	}
+	delete readback;
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testRiceUShort() end");
+}
+
+void	FITScompressionTest::testQuantizedFloat() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testQuantizedFloat() begin");
+	std::string	filename("tmp/quantized_test.fits");
+	Image<float>	image(256, 256);
+	for (int x = 0; x < image.size().width(); x++) {
+		for (int y = 0; y < image.size().height(); y++) {
+			image.pixel(x, y) = 1000 + 100 * sin(x * 0.1)
+				+ (((x * 7 + y * 13) % 17) - 8);
+		}
+	}
+	FITSoutfile<float>	outfile(filename);
+	outfile.setPrecious(false);
+	outfile.setCompression(FITScompression(FITScompression::RICE, 16));
+	outfile.write(image);
+
+	FITSinfile<float>	infile(filename);
+	Image<float>	*readback = infile.read();
+	for (int x = 0; x < image.size().width(); x++) {
+		for (int y = 0; y < image.size().height(); y++) {
+			CPPUNIT_ASSERT(fabs(readback->pixel(x, y)
+				- image.pixel(x, y)) < 1);
+		}
+	}
+	delete readback;
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testQuantizedFloat() end");
+}
+
+void	FITScompressionTest::testLosslessFloat() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testLosslessFloat() begin");
+	std::string	filename("tmp/lossless_test.fits");
+	Image<float>	image(256, 256);
+	for (int x = 0; x < image.size().width(); x++) {
+		for (int y = 0; y < image.size().height(); y++) {
+			image.pixel(x, y) = 1000 + 100 * sin(x * 0.1) + y / 3.;
+		}
+	}
+	// a repository configured as "rice" must be able to save darks
+	FITSoutfile<float>	outfile(filename);
+	outfile.setPrecious(false);
+	outfile.setCompression(FITScompression("rice"));
+	outfile.write(image);
+
+	FITSinfile<float>	infile(filename);
+	Image<float>	*readback = infile.read();
+	for (int x = 0; x < image.size().width(); x++) {
+		for (int y = 0; y < image.size().height(); y++) {
+			CPPUNIT_ASSERT(readback->pixel(x, y)
+				== image.pixel(x, y));
+		}
+	}
+	delete readback;
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testLosslessFloat() end");
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FITScompressionTest);
+
+} // namespace test
+} // namespace astro
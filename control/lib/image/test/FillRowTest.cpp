@@ -0,0 +1,180 @@
+/*
+ * FillRowTest.cpp -- test row evaluation of adapters
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroAdapter.h>
+#include <AstroTonemapping.h>
+#include <AstroTransform.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <AstroDebug.h>
+#include <cmath>
+#include <vector>
+
+using namespace astro::image;
+using namespace astro::adapter;
+using namespace astro::image::transform;
+
+namespace astro {
+namespace test {
+
+/**
+ * \brief Compare the rows returned by fillRow with the pixel values
+ */
+template<typename Pixel>
+static bool	rowsagree(const ConstImageAdapter<Pixel>& adapter,
+			double tolerance = 0) {
+	int	w = adapter.getSize().width();
+	int	h = adapter.getSize().height();
+	std::vector<Pixel>	row(w);
+	for (int y = 0; y < h; y++) {
+		for (int x0 = 0; x0 < w; x0 += 5) {
+			int	n = std::min(7, w - x0);
+			adapter.fillRow(y, x0, n, row.data());
+			for (int i = 0; i < n; i++) {
+				double	d = row[i] - adapter.pixel(x0 + i, y);
+				if (fabs(d) > tolerance) {
+					debug(LOG_ERR, DEBUG_LOG, 0,
+						"mismatch at (%d,%d)",
+						x0 + i, y);
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+class FillRowTest : public CppUnit::TestFixture {
+	Image<double>	*image;
+public:
+	void	setUp();
+	void	tearDown();
+	void	testImage();
+	void	testWindow();
+	void	testSubgrid();
+	void	testArithmetic();
+	void	testConverting();
+	void	testTonemapping();
+	void	testTransform();
+	void	testConstruct();
+
+	CPPUNIT_TEST_SUITE(FillRowTest);
+	CPPUNIT_TEST(testImage);
+	CPPUNIT_TEST(testWindow);
+	CPPUNIT_TEST(testSubgrid);
+	CPPUNIT_TEST(testArithmetic);
+	CPPUNIT_TEST(testConverting);
+	CPPUNIT_TEST(testTonemapping);
+	CPPUNIT_TEST(testTransform);
+	CPPUNIT_TEST(testConstruct);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FillRowTest);
+
+void	FillRowTest::setUp() {
+	image = new Image<double>(40, 30);
+	for (int x = 0; x < 40; x++) {
+		for (int y = 0; y < 30; y++) {
+			image->pixel(x, y) = (x * 7 + y * 13) % 17 - 3;
+		}
+	}
+}
+
+void	FillRowTest::tearDown() {
+	delete image;
+}
+
+void	FillRowTest::testImage() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testImage() begin");
+	CPPUNIT_ASSERT(rowsagree<double>(*image));
+	double	row[10];
+	CPPUNIT_ASSERT_THROW(image->fillRow(0, 35, 10, row), std::range_error);
+	CPPUNIT_ASSERT_THROW(image->fillRow(30, 0, 10, row), std::range_error);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testImage() end");
+}
+
+void	FillRowTest::testWindow() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testWindow() begin");
+	WindowAdapter<double>	window(*image,
+		ImageRectangle(ImagePoint(3, 5), ImageSize(20, 10)));
+	CPPUNIT_ASSERT(rowsagree<double>(window));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testWindow() end");
+}
+
+void	FillRowTest::testSubgrid() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSubgrid() begin");
+	ConstSubgridAdapter<double>	subgrid(*image,
+		Subgrid(ImagePoint(1, 0), ImageSize(3, 2)));
+	CPPUNIT_ASSERT(rowsagree<double>(subgrid));
+	SubgridAdapter<double>	writable(*image,
+		Subgrid(ImagePoint(0, 1), ImageSize(1, 2)));
+	CPPUNIT_ASSERT(rowsagree<double>(writable));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSubgrid() end");
+}
+
+void	FillRowTest::testArithmetic() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testArithmetic() begin");
+	AddAdapter<double>	sum(*image, *image);
+	CPPUNIT_ASSERT(rowsagree<double>(sum));
+	MultiplyAdapter<double>	product(*image, *image);
+	CPPUNIT_ASSERT(rowsagree<double>(product));
+	AddConstantAdapter<double, double>	shifted(*image, 2.5);
+	CPPUNIT_ASSERT(rowsagree<double>(shifted));
+	RescalingAdapter<double>	rescaled(*image, -3, 0.5);
+	CPPUNIT_ASSERT(rowsagree<double>(rescaled));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testArithmetic() end");
+}
+
+void	FillRowTest::testConverting() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testConverting() begin");
+	ConvertingAdapter<float, double>	converted(*image);
+	CPPUNIT_ASSERT(rowsagree<float>(converted));
+	Image<RGB<double> >	color(10, 10);
+	for (int x = 0; x < 10; x++) {
+		for (int y = 0; y < 10; y++) {
+			color.pixel(x, y) = RGB<double>((double)x, (double)y, (double)(x + y));
+		}
+	}
+	LuminanceAdapter<RGB<double>, double>	luminance(color);
+	CPPUNIT_ASSERT(rowsagree<double>(luminance, 1e-10));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testConverting() end");
+}
+
+void	FillRowTest::testTonemapping() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testTonemapping() begin");
+	GammaAdapter<double>	gamma(*image, 0.5);
+	CPPUNIT_ASSERT(rowsagree<double>(gamma));
+	LuminanceScalingAdapter<double>	scaled(*image, 3);
+	CPPUNIT_ASSERT(rowsagree<double>(scaled));
+	RangeAdapter<double>	range(*image, -3, 13);
+	CPPUNIT_ASSERT(rowsagree<double>(range, 1e-6));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testTonemapping() end");
+}
+
+void	FillRowTest::testTransform() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testTransform() begin");
+	Transform	transform(0.1, Point(1.5, -0.7), 1.2);
+	TransformAdapter<double>	transformed(*image, transform);
+	CPPUNIT_ASSERT(rowsagree<double>(transformed, 1e-6));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testTransform() end");
+}
+
+void	FillRowTest::testConstruct() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testConstruct() begin");
+	AddConstantAdapter<double, double>	shifted(*image, 1);
+	Image<double>	result(shifted);
+	for (int x = 0; x < 40; x++) {
+		for (int y = 0; y < 30; y++) {
+			CPPUNIT_ASSERT(result.pixel(x, y)
+				== image->pixel(x, y) + 1);
+		}
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testConstruct() end");
+}
+
+} // namespace test
+} // namespace astro
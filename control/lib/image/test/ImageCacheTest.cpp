@@ -0,0 +1,141 @@
+/*
+ * ImageCacheTest.cpp -- test the image cache
+ *
+ * (c) 2017 Prof Dr Andreas Müller, Hochschule Rapperswil
+ */
+#include <ImageCache.h>
+#include <AstroIO.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <AstroDebug.h>
+#include <AstroMetrics.h>
+#include <unistd.h>
+
+using namespace astro::image;
+using namespace astro::io;
+
+namespace astro {
+namespace test {
+
+class ImageCacheTest : public CppUnit::TestFixture {
+	void	write(const std::string& filename, int size,
+			unsigned short value);
+public:
+	void	setUp();
+	void	tearDown();
+
+	void	testHit();
+	void	testHeader();
+	void	testEviction();
+	void	testChanged();
+
+	CPPUNIT_TEST_SUITE(ImageCacheTest);
+	CPPUNIT_TEST(testHit);
+	CPPUNIT_TEST(testHeader);
+	CPPUNIT_TEST(testEviction);
+	CPPUNIT_TEST(testChanged);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ImageCacheTest);
+
+void	ImageCacheTest::write(const std::string& filename, int size,
+		unsigned short value) {
+	Image<unsigned short>	*image = new Image<unsigned short>(size, size);
+	ImagePtr	imageptr(image);
+	image->fill(value);
+	image->setMetadata(FITSKeywords::meta("EXPTIME", 1.5));
+	unlink(filename.c_str());
+	FITSout	out(filename);
+	out.setPrecious(false);
+	out.write(imageptr);
+}
+
+void	ImageCacheTest::setUp() {
+	write("tmp/cache1.fits", 100, 1);
+	write("tmp/cache2.fits", 100, 2);
+	write("tmp/cache3.fits", 100, 3);
+}
+
+void	ImageCacheTest::tearDown() {
+	unlink("tmp/cache1.fits");
+	unlink("tmp/cache2.fits");
+	unlink("tmp/cache3.fits");
+}
+
+void	ImageCacheTest::testHit() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testHit() begin");
+	metrics::Counter&	hits = metrics::Metrics::counter("imagecache.hits");
+	metrics::Gauge&	entries = metrics::Metrics::gauge("imagecache.entries");
+	uint64_t	hitsbefore = hits.value();
+	int64_t	entriesbefore = entries.value();
+	{
+		ImageCache	cache;
+		ImagePtr	first = cache.image("tmp/cache1.fits");
+		ImagePtr	second = cache.image("tmp/cache1.fits");
+		CPPUNIT_ASSERT(first == second);
+		ImageCacheStatistics	s = cache.statistics();
+		CPPUNIT_ASSERT(s.misses == 1);
+		CPPUNIT_ASSERT(s.hits == 1);
+		CPPUNIT_ASSERT(s.entries == 1);
+		CPPUNIT_ASSERT(s.bytes >= 100 * 100 * sizeof(unsigned short));
+		// the statistics are also published as metrics
+		CPPUNIT_ASSERT(hits.value() == hitsbefore + 1);
+		CPPUNIT_ASSERT(entries.value() == entriesbefore + 1);
+	}
+	CPPUNIT_ASSERT(entries.value() == entriesbefore);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testHit() end");
+}
+
+void	ImageCacheTest::testHeader() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testHeader() begin");
+	ImageCache	cache;
+	ImageHeader	header = cache.header("tmp/cache2.fits");
+	CPPUNIT_ASSERT(header.size == ImageSize(100, 100));
+	CPPUNIT_ASSERT(header.planes == 1);
+	CPPUNIT_ASSERT(header.metadata.hasMetadata("EXPTIME"));
+	cache.header("tmp/cache2.fits");
+	ImageCacheStatistics	s = cache.statistics();
+	CPPUNIT_ASSERT(s.headermisses == 1);
+	CPPUNIT_ASSERT(s.headerhits == 1);
+	CPPUNIT_ASSERT(s.misses == 0);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testHeader() end");
+}
+
+void	ImageCacheTest::testEviction() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testEviction() begin");
+	// room for two images only
+	ImageCache	cache(2 * 100 * 100 * sizeof(unsigned short));
+	cache.image("tmp/cache1.fits");
+	cache.image("tmp/cache2.fits");
+	cache.image("tmp/cache1.fits");
+	cache.image("tmp/cache3.fits");
+	ImageCacheStatistics	s = cache.statistics();
+	CPPUNIT_ASSERT(s.evictions == 1);
+	CPPUNIT_ASSERT(s.entries == 2);
+	// cache2.fits was least recently used
+	cache.image("tmp/cache1.fits");
+	cache.image("tmp/cache3.fits");
+	s = cache.statistics();
+	CPPUNIT_ASSERT(s.hits == 3);
+	cache.image("tmp/cache2.fits");
+	s = cache.statistics();
+	CPPUNIT_ASSERT(s.misses == 4);
+	CPPUNIT_ASSERT(s.bytes <= s.budget);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testEviction() end");
+}
+
+void	ImageCacheTest::testChanged() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testChanged() begin");
+	ImageCache	cache;
+	ImagePtr	first = cache.image("tmp/cache1.fits");
+	write("tmp/cache1.fits", 50, 7);
+	ImagePtr	second = cache.image("tmp/cache1.fits");
+	CPPUNIT_ASSERT(second->size() == ImageSize(50, 50));
+	CPPUNIT_ASSERT(cache.statistics().misses == 2);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testChanged() end");
+}
+
+} // namespace test
+} // namespace astro
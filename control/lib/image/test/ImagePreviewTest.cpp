@@ -0,0 +1,139 @@
+/*
+ * ImagePreviewTest.cpp -- test downsampled image previews
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroDisplay.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <AstroDebug.h>
+#include <cmath>
+
+using namespace astro::image;
+
+namespace astro {
+namespace test {
+
+class ImagePreviewTest : public CppUnit::TestFixture {
+public:
+	void	setUp();
+	void	tearDown();
+
+	void	testBinning();
+	void	testRectangle();
+	void	testColor();
+	void	testStretch();
+	void	testOutside();
+
+	CPPUNIT_TEST_SUITE(ImagePreviewTest);
+	CPPUNIT_TEST(testBinning);
+	CPPUNIT_TEST(testRectangle);
+	CPPUNIT_TEST(testColor);
+	CPPUNIT_TEST(testStretch);
+	CPPUNIT_TEST(testOutside);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ImagePreviewTest);
+
+void	ImagePreviewTest::setUp() {
+}
+
+void	ImagePreviewTest::tearDown() {
+}
+
+static ImagePtr	ramp(int width, int height) {
+	Image<unsigned short>	*image
+		= new Image<unsigned short>(ImageSize(width, height));
+	for (int x = 0; x < width; x++) {
+		for (int y = 0; y < height; y++) {
+			image->pixel(x, y) = x + 100 * y;
+		}
+	}
+	return ImagePtr(image);
+}
+
+void	ImagePreviewTest::testBinning() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testBinning() begin");
+	ImagePtr	image = ramp(100, 50);
+	ImagePreview	preview(image, 30);
+	CPPUNIT_ASSERT(preview.binning() == 4);
+	CPPUNIT_ASSERT(preview.size() == ImageSize(25, 13));
+	CPPUNIT_ASSERT(preview.planes() == 1);
+	CPPUNIT_ASSERT(preview.values().size() == 25 * 13);
+	// block (1,2) covers x = 4..7, y = 8..11
+	CPPUNIT_ASSERT(fabs(preview.values()[2 * 25 + 1] - (5.5 + 950))
+		< 1e-3);
+	// the last row only covers y = 48, 49
+	CPPUNIT_ASSERT(fabs(preview.values()[12 * 25] - (1.5 + 4850))
+		< 1e-3);
+	CPPUNIT_ASSERT(preview.minimum() == 1.5 + 150);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testBinning() end");
+}
+
+void	ImagePreviewTest::testRectangle() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testRectangle() begin");
+	ImagePtr	image = ramp(100, 50);
+	ImagePreview	preview(image,
+		ImageRectangle(ImagePoint(10, 20), ImageSize(5, 3)), 1);
+	CPPUNIT_ASSERT(preview.size() == ImageSize(5, 3));
+	CPPUNIT_ASSERT(preview.values()[0] == 2010);
+	CPPUNIT_ASSERT(preview.values()[14] == 2214);
+	ImagePtr	result = preview.image();
+	CPPUNIT_ASSERT(result->size() == ImageSize(5, 3));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testRectangle() end");
+}
+
+void	ImagePreviewTest::testColor() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testColor() begin");
+	Image<RGB<unsigned char> >	*imagep
+		= new Image<RGB<unsigned char> >(ImageSize(4, 4));
+	for (unsigned int i = 0; i < 16; i++) {
+		imagep->pixels[i] = RGB<unsigned char>(i, 2 * i, 100);
+	}
+	ImagePtr	image(imagep);
+	ImagePreview	preview(image, ImageRectangle(), 2);
+	CPPUNIT_ASSERT(preview.planes() == 3);
+	CPPUNIT_ASSERT(preview.size() == ImageSize(2, 2));
+	// block (0,0) contains pixels 0, 1, 4, 5
+	CPPUNIT_ASSERT(preview.values()[0] == 2.5);
+	CPPUNIT_ASSERT(preview.values()[1] == 5);
+	CPPUNIT_ASSERT(preview.values()[2] == 100);
+	ImagePtr	rendered = preview.image(0, 100);
+	CPPUNIT_ASSERT(NULL != dynamic_cast<Image<RGB<unsigned char> > *>(
+		&*rendered));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testColor() end");
+}
+
+void	ImagePreviewTest::testStretch() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testStretch() begin");
+	ImagePtr	image = ramp(100, 100);
+	ImagePreview	preview(image, ImageRectangle(), 1);
+	float	low, high;
+	preview.limits(0.1, 0.9, low, high);
+	CPPUNIT_ASSERT((low > 900) && (low < 1100));
+	CPPUNIT_ASSERT((high > 8900) && (high < 9100));
+	std::vector<unsigned char>	bytes = preview.stretch(low, high);
+	CPPUNIT_ASSERT(bytes.size() == 10000);
+	CPPUNIT_ASSERT(bytes[0] == 0);
+	CPPUNIT_ASSERT(bytes[9999] == 255);
+	// gamma brightens the mid tones
+	std::vector<unsigned char>	g = preview.stretch(0, 10000, 2);
+	CPPUNIT_ASSERT(g[5000] > 170);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testStretch() end");
+}
+
+void	ImagePreviewTest::testOutside() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testOutside() begin");
+	ImagePtr	image = ramp(10, 10);
+	CPPUNIT_ASSERT_THROW(ImagePreview(image,
+		ImageRectangle(ImagePoint(5, 5), ImageSize(6, 2)), 1),
+		std::range_error);
+	CPPUNIT_ASSERT_THROW(ImagePreview(image, ImageRectangle(), 0),
+		std::range_error);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testOutside() end");
+}
+
+} // namespace test
+} // namespace astro
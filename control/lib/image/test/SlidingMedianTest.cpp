@@ -0,0 +1,220 @@
+/*
+ * SlidingMedianTest.cpp -- test the sliding window median filter
+ *
+ * (c) 2017 Prof Dr Andreas Müller, Hochschule Rapperswil
+ */
+#include <AstroAdapter.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <AstroDebug.h>
+#include <AstroUtils.h>
+#include <cstdlib>
+
+using namespace astro::image;
+using namespace astro::adapter;
+
+namespace astro {
+namespace test {
+
+class SlidingMedianTest : public CppUnit::TestFixture {
+	template<typename T>
+	void	compare(const Image<T>& image, int radius);
+public:
+	void	setUp();
+	void	tearDown();
+
+	void	testDisk();
+	void	testByte();
+	void	testFloat();
+	void	testLargeFloat();
+	void	testFloatSelect();
+	void	testHotPixels();
+	void	testFlat();
+	void	testMosaic();
+
+	CPPUNIT_TEST_SUITE(SlidingMedianTest);
+	CPPUNIT_TEST(testDisk);
+	CPPUNIT_TEST(testByte);
+	CPPUNIT_TEST(testFloat);
+	CPPUNIT_TEST(testLargeFloat);
+	CPPUNIT_TEST(testFloatSelect);
+	CPPUNIT_TEST(testHotPixels);
+	CPPUNIT_TEST(testFlat);
+	CPPUNIT_TEST(testMosaic);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SlidingMedianTest);
+
+void	SlidingMedianTest::setUp() {
+}
+
+void	SlidingMedianTest::tearDown() {
+}
+
+/**
+ * \brief Compare the sliding median with the median radius adapter
+ */
+template<typename T>
+void	SlidingMedianTest::compare(const Image<T>& image, int radius) {
+	SlidingMedian<T>	median(radius);
+	Image<T>	*filtered = median(image);
+	ImagePtr	filteredptr(filtered);
+	MedianRadiusAdapter<T>	mra(image, radius);
+	for (int x = 0; x < image.size().width(); x++) {
+		for (int y = 0; y < image.size().height(); y++) {
+			CPPUNIT_ASSERT(filtered->pixel(x, y) == mra.pixel(x, y));
+		}
+	}
+}
+
+void	SlidingMedianTest::testDisk() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testDisk() begin");
+	std::vector<int>	hw = diskHalfwidths(2);
+	CPPUNIT_ASSERT(hw.size() == 5);
+	CPPUNIT_ASSERT(hw[0] == 0);
+	CPPUNIT_ASSERT(hw[1] == 1);
+	CPPUNIT_ASSERT(hw[2] == 2);
+	CPPUNIT_ASSERT(hw[3] == 1);
+	CPPUNIT_ASSERT(hw[4] == 0);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testDisk() end");
+}
+
+void	SlidingMedianTest::testByte() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testByte() begin");
+	srandom(1);
+	Image<unsigned char>	image(37, 23);
+	for (int i = 0; i < 37 * 23; i++) {
+		image.pixels[i] = random() % 256;
+	}
+	compare(image, 0);
+	compare(image, 1);
+	compare(image, 4);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testByte() end");
+}
+
+void	SlidingMedianTest::testFloat() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testFloat() begin");
+	// more distinct values than the coarse histogram bin size
+	srandom(2);
+	Image<float>	image(50, 40);
+	for (int i = 0; i < 50 * 40; i++) {
+		image.pixels[i] = (random() % 100000) / 100. - 100;
+	}
+	compare(image, 3);
+	compare(image, 10);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testFloat() end");
+}
+
+void	SlidingMedianTest::testLargeFloat() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testLargeFloat() begin");
+	// a frame of camera size where almost every pixel has its own value,
+	// too many for the histogram
+	srandom(4);
+	Image<float>	image(1024, 768);
+	for (int i = 0; i < 1024 * 768; i++) {
+		image.pixels[i] = 1000 + (random() % 1000000) / 1000.;
+	}
+	compare(image, 2);
+	image.pixel(500, 400) = 60000;
+	size_t	corrected = 0;
+	Image<float>	*result = hotpixels(image, 2, 8, &corrected);
+	ImagePtr	resultptr(result);
+	CPPUNIT_ASSERT(corrected == 1);
+	CPPUNIT_ASSERT(result->pixel(500, 400) < 2000);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testLargeFloat() end");
+}
+
+void	SlidingMedianTest::testFloatSelect() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testFloatSelect() begin");
+	// every pixel has its own value, so the image is processed in bands
+	srandom(5);
+	Image<float>	image(1024, 768);
+	for (int i = 0; i < 1024 * 768; i++) {
+		image.pixels[i] = 1000 + random() / 1000.;
+	}
+	for (int clamp = 0; clamp <= 1; clamp++) {
+		SlidingMedian<float>	median(8, clamp);
+		Timer	timer;
+		timer.start();
+		Image<float>	*sliding = median(image);
+		ImagePtr	slidingptr(sliding);
+		timer.end();
+		double	slidingtime = timer.elapsed();
+		timer.start();
+		Image<float>	*selected = median.select(image);
+		ImagePtr	selectedptr(selected);
+		timer.end();
+		double	selecttime = timer.elapsed();
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "clamp=%d: histogram %.3fs, "
+			"selection %.3fs", clamp, slidingtime, selecttime);
+		for (int i = 0; i < 1024 * 768; i++) {
+			CPPUNIT_ASSERT(sliding->pixels[i] == selected->pixels[i]);
+		}
+		CPPUNIT_ASSERT(slidingtime < selecttime);
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testFloatSelect() end");
+}
+
+void	SlidingMedianTest::testHotPixels() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testHotPixels() begin");
+	srandom(3);
+	Image<unsigned short>	image(40, 30);
+	for (int i = 0; i < 40 * 30; i++) {
+		image.pixels[i] = 1000 + random() % 20;
+	}
+	image.pixel(10, 10) = 60000;
+	image.pixel(20, 15) = 50000;
+	image.pixel(30, 5) = 0;
+	size_t	corrected = 0;
+	Image<unsigned short>	*result = hotpixels(image, 2, 8, &corrected);
+	ImagePtr	resultptr(result);
+	CPPUNIT_ASSERT(corrected == 3);
+	CPPUNIT_ASSERT(result->pixel(10, 10) < 1020);
+	CPPUNIT_ASSERT(result->pixel(20, 15) < 1020);
+	CPPUNIT_ASSERT(result->pixel(30, 5) >= 1000);
+	CPPUNIT_ASSERT(result->pixel(11, 10) == image.pixel(11, 10));
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testHotPixels() end");
+}
+
+void	SlidingMedianTest::testFlat() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testFlat() begin");
+	// the median absolute deviation of a flat image is zero, pixels
+	// off by one count must not be corrected
+	Image<unsigned short>	image(40, 30);
+	for (int i = 0; i < 40 * 30; i++) {
+		image.pixels[i] = (i % 7) ? 1000 : 1001;
+	}
+	image.pixel(10, 10) = 60000;
+	size_t	corrected = 0;
+	Image<unsigned short>	*result = hotpixels(image, 2, 8, &corrected);
+	ImagePtr	resultptr(result);
+	CPPUNIT_ASSERT(corrected == 1);
+	CPPUNIT_ASSERT(result->pixel(10, 10) == 1000);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testFlat() end");
+}
+
+void	SlidingMedianTest::testMosaic() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testMosaic() begin");
+	// a mosaic where the colors differ a lot must not be flattened
+	Image<float>	image(40, 30);
+	image.setMosaicType(MosaicType::BAYER_RGGB);
+	for (int x = 0; x < 40; x++) {
+		for (int y = 0; y < 30; y++) {
+			image.pixel(x, y) = 100 * (1 + (x % 2) + 2 * (y % 2))
+				+ ((x * 7 + y * 3) % 5);
+		}
+	}
+	image.pixel(12, 12) = 5000;
+	size_t	corrected = 0;
+	Image<float>	*result = hotpixels(image, 2, 8, &corrected);
+	ImagePtr	resultptr(result);
+	CPPUNIT_ASSERT(corrected == 1);
+	CPPUNIT_ASSERT(result->pixel(12, 12) < 105);
+	CPPUNIT_ASSERT(result->getMosaicType().isMosaic());
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testMosaic() end");
+}
+
+} // namespace test
+} // namespace astro
@@ -0,0 +1,222 @@
+/*
+ * StackerTest.cpp -- test rejection stacking
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+
+#include <AstroStacking.h>
+#include <AstroIO.h>
+#include <AstroFormat.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <AstroDebug.h>
+#include <cmath>
+#include <unistd.h>
+
+using namespace astro::image;
+using namespace astro::image::stacking;
+using namespace astro::io;
+
+namespace astro {
+namespace test {
+
+class StackerTest : public CppUnit::TestFixture {
+	ImagePtr	frame(int i);
+	ImagePtr	starframe(int dx, int dy);
+	void	stack(Stacker::rejection_method method);
+public:
+	void	setUp() { }
+	void	tearDown() { }
+	void	testSigmaclip();
+	void	testWinsorized();
+	void	testPercentile();
+	void	testPipeline();
+	void	testRegisteredPipeline();
+
+	CPPUNIT_TEST_SUITE(StackerTest);
+	CPPUNIT_TEST(testSigmaclip);
+	CPPUNIT_TEST(testWinsorized);
+	CPPUNIT_TEST(testPercentile);
+	CPPUNIT_TEST(testPipeline);
+	CPPUNIT_TEST(testRegisteredPipeline);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+/**
+ * \brief Create a noisy frame, frame 4 has a satellite trail in row 50
+ */
+ImagePtr	StackerTest::frame(int i) {
+	Image<float>	*image = new Image<float>(300, 200);
+	for (int x = 0; x < 300; x++) {
+		for (int y = 0; y < 200; y++) {
+			image->pixel(x, y) = 100
+				+ ((x * 7 + y * 3 + i * 11) % 5) - 2;
+			if ((i == 4) && (y == 50)) {
+				image->pixel(x, y) += 10000;
+			}
+		}
+	}
+	return ImagePtr(image);
+}
+
+#define	STARS	60
+
+/**
+ * \brief Create a star field shifted by (dx, dy) pixels
+ *
+ * Every frame contains the same stars, only their position changes.
+ */
+ImagePtr	StackerTest::starframe(int dx, int dy) {
+	Image<float>	*image = new Image<float>(512, 512);
+	image->fill(100);
+	srandom(4711);
+	for (int s = 0; s < STARS; s++) {
+		int	sx = 40 + random() % 432 + dx;
+		int	sy = 40 + random() % 432 + dy;
+		double	brightness = 1000 + random() % 4000;
+		for (int x = sx - 8; x <= sx + 8; x++) {
+			for (int y = sy - 8; y <= sy + 8; y++) {
+				double	r2 = (x - sx) * (x - sx)
+						+ (y - sy) * (y - sy);
+				image->pixel(x, y) += brightness
+					* exp(-r2 / (2 * 1.5 * 1.5));
+			}
+		}
+	}
+	return ImagePtr(image);
+}
+
+void	StackerTest::stack(Stacker::rejection_method method) {
+	StackerPtr	stacker = Stacker::get(frame(0));
+	stacker->notransform(true);
+	stacker->rejection(method);
+	for (int i = 1; i < 20; i++) {
+		stacker->add(frame(i));
+	}
+	ImagePtr	result = stacker->image();
+	Image<float>	*image = dynamic_cast<Image<float>*>(&*result);
+	CPPUNIT_ASSERT(NULL != image);
+	for (int x = 0; x < 300; x += 7) {
+		CPPUNIT_ASSERT(fabs(image->pixel(x, 50) - 100) < 1);
+		CPPUNIT_ASSERT(fabs(image->pixel(x, 51) - 100) < 1);
+	}
+}
+
+void	StackerTest::testSigmaclip() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSigmaclip() begin");
+	stack(Stacker::sigmaclip);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSigmaclip() end");
+}
+
+void	StackerTest::testWinsorized() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testWinsorized() begin");
+	stack(Stacker::winsorized);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testWinsorized() end");
+}
+
+void	StackerTest::testPercentile() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPercentile() begin");
+	stack(Stacker::percentile);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPercentile() end");
+}
+
+void	StackerTest::testPipeline() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPipeline() begin");
+	std::vector<std::string>	filenames;
+	for (int i = 1; i < 20; i++) {
+		std::string	filename = stringprintf("tmp/stack-%d.fits", i);
+		FITSout	out(filename);
+		out.setPrecious(false);
+		out.write(frame(i));
+		filenames.push_back(filename);
+	}
+	StackerPtr	stacker = Stacker::get(frame(0));
+	stacker->notransform(true);
+	stacker->rejection(Stacker::sigmaclip);
+	StackingPipeline	pipeline(stacker);
+	pipeline.threads(4);
+	pipeline.readahead(3);
+	pipeline(filenames);
+	ImagePtr	result = stacker->image();
+	Image<float>	*image = dynamic_cast<Image<float>*>(&*result);
+	CPPUNIT_ASSERT(NULL != image);
+	for (int x = 0; x < 300; x += 7) {
+		CPPUNIT_ASSERT(fabs(image->pixel(x, 50) - 100) < 1);
+	}
+	for (auto f = filenames.begin(); f != filenames.end(); f++) {
+		unlink(f->c_str());
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPipeline() end");
+}
+
+/**
+ * \brief Stack shifted frames, registering them in several threads
+ *
+ * The result must be the same as when the frames are registered and
+ * added one after the other, and the stars must stay where they are
+ * in the base image.
+ */
+void	StackerTest::testRegisteredPipeline() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testRegisteredPipeline() begin");
+	ImagePtr	base = starframe(0, 0);
+	std::vector<std::string>	filenames;
+	std::vector<ImagePtr>	frames;
+	for (int i = 1; i < 9; i++) {
+		std::string	filename = stringprintf("tmp/shifted-%d.fits", i);
+		ImagePtr	shifted = starframe((i % 3) - 1, (i % 5) - 2);
+		FITSout	out(filename);
+		out.setPrecious(false);
+		out.write(shifted);
+		filenames.push_back(filename);
+		frames.push_back(shifted);
+	}
+
+	StackerPtr	stacker = Stacker::get(base);
+	stacker->notransform(false);
+	stacker->patchsize(128);
+	stacker->rejection(Stacker::sigmaclip);
+	StackingPipeline	pipeline(stacker);
+	pipeline.threads(4);
+	pipeline.readahead(4);
+	pipeline(filenames);
+	ImagePtr	result = stacker->image();
+	Image<float>	*image = dynamic_cast<Image<float>*>(&*result);
+	CPPUNIT_ASSERT(NULL != image);
+
+	StackerPtr	serial = Stacker::get(base);
+	serial->notransform(false);
+	serial->patchsize(128);
+	serial->rejection(Stacker::sigmaclip);
+	for (auto f = frames.begin(); f != frames.end(); f++) {
+		serial->add(*f);
+	}
+	ImagePtr	serialresult = serial->image();
+	Image<float>	*serialimage
+		= dynamic_cast<Image<float>*>(&*serialresult);
+	CPPUNIT_ASSERT(NULL != serialimage);
+
+	Image<float>	*baseimage = dynamic_cast<Image<float>*>(&*base);
+	// background far from the stars and from the shifted borders
+	double	ratio = image->pixel(10, 256) / baseimage->pixel(10, 256);
+	srandom(4711);
+	for (int s = 0; s < STARS; s++) {
+		int	sx = 40 + random() % 432;
+		int	sy = 40 + random() % 432;
+		random();
+		CPPUNIT_ASSERT(fabs(image->pixel(sx, sy)
+			- serialimage->pixel(sx, sy)) < 0.01);
+		CPPUNIT_ASSERT(fabs(image->pixel(sx, sy)
+			- ratio * baseimage->pixel(sx, sy))
+			< 0.05 * ratio * baseimage->pixel(sx, sy));
+	}
+	for (auto f = filenames.begin(); f != filenames.end(); f++) {
+		unlink(f->c_str());
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testRegisteredPipeline() end");
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StackerTest);
+
+} // namespace test
+} // namespace astro
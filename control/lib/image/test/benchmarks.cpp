@@ -0,0 +1,269 @@
+/*
+ * benchmarks.cpp -- throughput benchmarks for the image library hot paths
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <Benchmark.h>
+#include <includes.h>
+#include <AstroDebug.h>
+#include <AstroUtils.h>
+#include <AstroIO.h>
+#include <AstroStacking.h>
+#include <AstroTransform.h>
+#include <AstroDemosaic.h>
+#include <AstroFilter.h>
+#include <AstroBackground.h>
+#include <AstroViewer.h>
+#include <AstroConversion.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+using namespace astro::image;
+using namespace astro::image::stacking;
+using namespace astro::image::transform;
+using namespace astro::image::filter;
+using namespace astro::adapter;
+using namespace astro::io;
+
+namespace astro {
+namespace test {
+
+static void	usage(const char *progname) {
+	std::cout << "usage: " << progname << " [ options ]" << std::endl;
+	std::cout << "options:" << std::endl;
+	std::cout << "  -d           increase debug level" << std::endl;
+	std::cout << "  -f <name>    only run benchmarks whose name contains "
+		"<name>" << std::endl;
+	std::cout << "  -i <n>       run each benchmark at least <n> times"
+		<< std::endl;
+	std::cout << "  -o <file>    write the JSON results to <file> instead "
+		"of stdout" << std::endl;
+	std::cout << "  -s <size>    use images of <size> x <size> pixels"
+		<< std::endl;
+	std::cout << "  -t <time>    run each benchmark at least <time> seconds"
+		<< std::endl;
+	std::cout << "  -h           display this help message and exit"
+		<< std::endl;
+}
+
+static const char	*fitsfilename = "tmp/benchmark.fits";
+static const int	stackframes = 8;
+
+static void	writefits(ImagePtr image) {
+	FITSout	out(fitsfilename);
+	out.setPrecious(false);
+	if (out.exists()) {
+		out.unlink();
+	}
+	out.write(image);
+}
+
+static void	stack(const std::vector<ImagePtr>& frames,
+			Stacker::rejection_method method) {
+	StackerPtr	stacker = Stacker::get(frames[0]);
+	stacker->notransform(true);
+	stacker->rejection(method);
+	for (size_t i = 1; i < frames.size(); i++) {
+		stacker->add(frames[i]);
+	}
+	ImagePtr	result = stacker->image();
+}
+
+int	main(int argc, char *argv[]) {
+	debugtimeprecision = 3;
+	debugthreads = 1;
+	int	size = 1024;
+	int	iterations = 3;
+	double	mintime = 1.0;
+	std::string	filter;
+	std::string	outfilename;
+	int	c;
+	while (EOF != (c = getopt(argc, argv, "df:hi:o:s:t:")))
+		switch (c) {
+		case 'd':
+			debuglevel = LOG_DEBUG;
+			break;
+		case 'f':
+			filter = std::string(optarg);
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		case 'i':
+			iterations = std::stoi(optarg);
+			break;
+		case 'o':
+			outfilename = std::string(optarg);
+			break;
+		case 's':
+			size = std::stoi(optarg);
+			break;
+		case 't':
+			mintime = std::stod(optarg);
+			break;
+		default:
+			throw std::runtime_error("unknown option");
+		}
+	if (debuglevel < LOG_INFO) {
+		debuglevel = LOG_INFO;
+	}
+
+	// synthetic inputs
+	ImageSize	imagesize(size, size);
+	unsigned long	pixels = imagesize.getPixels();
+	StarFieldGenerator	generator(imagesize);
+	std::shared_ptr<Image<double> >	field(generator());
+	Image<unsigned short>	*shortimage = toUnsignedShort(*field);
+	ImagePtr	shortptr(shortimage);
+	std::shared_ptr<Image<float> >	floatimage(toFloat(*field));
+	Image<unsigned short>	*mosaicimage = toUnsignedShort(*field);
+	ImagePtr	mosaicptr(mosaicimage);
+	mosaicimage->setMosaicType(MosaicType::BAYER_RGGB);
+	std::shared_ptr<Image<double> >	shifted(generator(Point(3.3, -2.7),
+						2));
+	std::vector<ImagePtr>	frames;
+	for (int i = 0; i < stackframes; i++) {
+		std::shared_ptr<Image<double> >	frame(generator(Point(), i + 1));
+		frames.push_back(ImagePtr(toUnsignedShort(*frame)));
+	}
+	writefits(shortptr);
+
+	// webcam style color frames, the packed buffers are what a camera
+	// delivers, the images are what the stream converts
+	Image<YUYV<unsigned char> >	yuyvimage(imagesize);
+	Image<RGB<unsigned char> >	rgbimage(imagesize);
+	std::vector<uint8_t>	yuyvbuffer(2 * pixels);
+	std::vector<uint8_t>	rgbbuffer(3 * pixels);
+	std::vector<uint8_t>	monobuffer(pixels);
+	for (unsigned long i = 0; i < pixels; i++) {
+		unsigned char	v = shortimage->pixels[i] >> 8;
+		yuyvimage.pixels[i] = YUYV<unsigned char>(v,
+			(unsigned char)(128 + (i & 0x1f)));
+		rgbimage.pixels[i] = RGB<unsigned char>(v, v ^ 0x55, 255 - v);
+		yuyvbuffer[2 * i] = yuyvimage.pixels[i].y;
+		yuyvbuffer[2 * i + 1] = yuyvimage.pixels[i].uv;
+		rgbbuffer[3 * i] = rgbimage.pixels[i].R;
+		rgbbuffer[3 * i + 1] = rgbimage.pixels[i].G;
+		rgbbuffer[3 * i + 2] = rgbimage.pixels[i].B;
+	}
+
+	BenchmarkRunner	runner(iterations, mintime);
+	runner.filter(filter);
+
+	// FITS I/O
+	runner.run("fits/write", pixels, [&]() { writefits(shortptr); });
+	runner.run("fits/read", pixels, [&]() {
+		FITSin	in(fitsfilename);
+		ImagePtr	image = in.read();
+	});
+
+	// stacking
+	runner.run("stacker/none", stackframes * pixels, [&]() {
+		stack(frames, Stacker::none);
+	});
+	runner.run("stacker/sigmaclip", stackframes * pixels, [&]() {
+		stack(frames, Stacker::sigmaclip);
+	});
+
+	// registration
+	runner.run("phasecorrelator", pixels, [&]() {
+		PhaseCorrelator	correlator(true);
+		correlator(*field, *shifted);
+	});
+
+	// demosaicing
+	runner.run("demosaic/bilinear", pixels, [&]() {
+		DemosaicBilinear<unsigned short>	demosaicer;
+		ImagePtr	result(demosaicer(*mosaicimage));
+	});
+
+	// filters
+	runner.run("filter/mean", pixels, [&]() {
+		Mean<unsigned short, double>	mean;
+		mean.filter(*shortimage);
+	});
+	runner.run("filter/median", pixels, [&]() {
+		astro::image::filter::Median<unsigned short, double>	median;
+		median.filter(*shortimage);
+	});
+
+	// background extraction
+	runner.run("background/quadratic", pixels, [&]() {
+		BackgroundExtractor	extractor(100);
+		extractor(floatimage->center(), true,
+			BackgroundExtractor::QUADRATIC, *floatimage);
+	});
+
+	// geometric transformation
+	runner.run("transformadapter", pixels, [&]() {
+		TransformAdapter<double>	adapter(*field,
+			Transform(0.01, Point(3.5, -2.25)));
+		Image<double>	result(adapter);
+	});
+
+	// conversions of stream images, the generic variants are the
+	// converting constructors the fast kernels replace
+	runner.run("conversion/yuyv2rgb/generic", pixels, [&]() {
+		Image<RGB<unsigned char> >	result(yuyvimage);
+	});
+	runner.run("conversion/yuyv2rgb/image", pixels, [&]() {
+		std::unique_ptr<Image<RGB<unsigned char> > >	result(
+			yuyv2rgb(yuyvimage));
+	});
+	runner.run("conversion/yuyv2rgb/buffer", pixels, [&]() {
+		kernels::yuyv2rgb(yuyvbuffer.data(), rgbbuffer.data(), pixels);
+	});
+	runner.run("conversion/yuyv2luminance/image", pixels, [&]() {
+		std::unique_ptr<Image<unsigned char> >	result(
+			yuyv2luminance(yuyvimage));
+	});
+	runner.run("conversion/yuyv2luminance/buffer", pixels, [&]() {
+		kernels::yuyv2luminance(yuyvbuffer.data(), monobuffer.data(),
+			pixels);
+	});
+	runner.run("conversion/rgb2mono/generic", pixels, [&]() {
+		Image<unsigned char>	result(rgbimage);
+	});
+	runner.run("conversion/rgb2mono/image", pixels, [&]() {
+		std::unique_ptr<Image<unsigned char> >	result(
+			rgb2mono(rgbimage));
+	});
+	runner.run("conversion/rgb2mono/buffer", pixels, [&]() {
+		kernels::rgb2mono(rgbbuffer.data(), monobuffer.data(), pixels);
+	});
+	runner.run("conversion/scale16to8/generic", pixels, [&]() {
+		Image<unsigned char>	result(*shortimage);
+	});
+	runner.run("conversion/scale16to8/image", pixels, [&]() {
+		std::unique_ptr<Image<unsigned char> >	result(
+			scale16to8(*shortimage));
+	});
+	runner.run("conversion/scale16to8/stretch", pixels, [&]() {
+		kernels::scale16to8(shortimage->pixels, monobuffer.data(),
+			pixels, 1000, 40000);
+	});
+
+	// viewer pipeline, reads the FITS file and renders the image
+	runner.run("viewer", pixels, [&]() {
+		Viewer	viewer(fitsfilename);
+		viewer.update();
+	});
+
+	// write the results
+	if (outfilename.size() > 0) {
+		std::ofstream	out(outfilename.c_str());
+		runner.json(out, imagesize);
+	} else {
+		runner.json(std::cout, imagesize);
+	}
+	unlink(fitsfilename);
+	return EXIT_SUCCESS;
+}
+
+} // namespace test
+} // namespace astro
+
+int	main(int argc, char *argv[]) {
+	return astro::main_function<astro::test::main>(argc, argv);
+}
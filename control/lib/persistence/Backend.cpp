@@ -5,11 +5,14 @@
  */
 #include <AstroPersistence.h>
 #include <AstroFormat.h>
+#include <AstroUtils.h>
 #include <sqlite3.h>
 #include <stdexcept>
 #include <AstroDebug.h>
 #include <includes.h>
 #include <mutex>
+#include <thread>
+#include <atomic>
 
 namespace astro {
 namespace persistence {
@@ -19,22 +22,51 @@ class Sqlite3Backend;
  * \brief Exception handling in Sqlite3 database
  */
 class Sqlite3Exception : public std::runtime_error {
-	std::string	cause(Sqlite3Backend& database,
-				const std::string& info);
+	static std::string	cause(sqlite3 *database,
+					const std::string& info);
 public:
-	Sqlite3Exception(Sqlite3Backend& backend, const std::string& info) 
-		: std::runtime_error(cause(backend, info)) {
+	Sqlite3Exception(sqlite3 *database, const std::string& info)
+		: std::runtime_error(cause(database, info)) {
 	}
 };
 
+/**
+ * \brief A single connection to an Sqlite3 database
+ *
+ * Each connection keeps a cache of prepared statements that are currently
+ * not in use. A statement is taken out of the cache while a Statement
+ * object uses it, and returned to the cache when the Statement object is
+ * destroyed. If the cache grows beyond its capacity, the least recently
+ * used statements are finalized.
+ */
+class Sqlite3Connection {
+	Sqlite3Backend&	_backend;
+	sqlite3	*_database;
+	typedef std::pair<std::string, sqlite3_stmt *>	cacheentry;
+	std::list<cacheentry>	_cache;	// most recently used first
+	size_t	_cachesize;
+	std::mutex	_cachemutex;
+public:
+	sqlite3	*database() { return _database; }
+	Sqlite3Backend&	backend() { return _backend; }
+	Sqlite3Connection(Sqlite3Backend& backend, const std::string& filename,
+		bool readonly, size_t cachesize = 32);
+	~Sqlite3Connection();
+	sqlite3_stmt	*acquire(const std::string& query);
+	void	release(const std::string& query, sqlite3_stmt *stmt);
+	Result	query(const std::string& query);
+	void	pragma(const std::string& pragma);
+};
+
 /**
  * \brief Statement abstraction for Sqlite3 database
  */
 class Sqlite3Statement : public Statement {
-	Sqlite3Backend&	_backend;
+	Sqlite3Connection&	_connection;
 	sqlite3_stmt	*stmt;
 public:
-	Sqlite3Statement(Sqlite3Backend& backend, const std::string& query);
+	Sqlite3Statement(Sqlite3Connection& connection,
+		const std::string& query);
 	~Sqlite3Statement();
 	// bind parameters
         virtual void	bindInteger(int colno, int value);
@@ -42,6 +74,7 @@ public:
         virtual void	bindString(int colno, const std::string& value);
 	// executen
         virtual void	execute();
+	virtual void	reset();
 protected:
 	virtual Field	field(int colno);
         virtual Row	row();
@@ -55,15 +88,36 @@ public:
 
 /**
  * \brief Sqlite3 backend abstraction
+ *
+ * The backend uses one connection for all writes. If the database can be
+ * put into WAL mode, select queries from threads that do not currently
+ * own a transaction are handed to a small pool of read only connections,
+ * so that readers do not block writers and vice versa.
  */
 class Sqlite3Backend : public DatabaseBackend {
 	std::string	_filename;
-	sqlite3	*_database;
+	int	_nreaders;
+	std::unique_ptr<Sqlite3Connection>	_writer;
+	std::vector<std::unique_ptr<Sqlite3Connection> >	_readers;
+	std::mutex	_readermutex;
+	std::atomic<unsigned int>	_nextreader;
+	std::thread::id	_transactionowner;
+	std::mutex	_transactionmutex;
+	void	begintransaction();
+	Sqlite3Connection&	reader();
+	Sqlite3Connection&	connection(const std::string& query);
 public:
-	sqlite3	*database() { return _database; }
-
+	// performance counters, updated by the connections
+	std::atomic<unsigned long>	cachehits;
+	std::atomic<unsigned long>	cachemisses;
+	std::atomic<unsigned long long>	prepareusec;
+	std::atomic<unsigned long>	lockwaits;
+	std::atomic<unsigned long long>	lockwaitusec;
+	std::atomic<unsigned long>	connectionwaits;
+	std::atomic<unsigned long long>	connectionwaitusec;
+	std::atomic<unsigned long>	readerqueries;
 public:
-	Sqlite3Backend(const std::string& filename);
+	Sqlite3Backend(const std::string& filename, int readers);
 	~Sqlite3Backend();
 	virtual std::string	escape(const std::string& value);
 	virtual Result	query(const std::string& query);
@@ -77,51 +131,97 @@ public:
 	virtual void	rollback(const std::string& savepoint);
 	virtual StatementPtr	statement(const std::string& query);
 	virtual bool	hastable(const std::string& tablename);
+	virtual DatabaseStatistics	statistics();
 };
 
 //////////////////////////////////////////////////////////////////////
-// Sqlite 3 statement implementation
+// Wait accounting
 //////////////////////////////////////////////////////////////////////
 /**
- * \brief Create an SQL statement
+ * \brief Lock wait accounting for the current thread
+ *
+ * Waiting for a database lock may take several invocations of the busy
+ * handler and the retries in Sqlite3Statement::execute(), but it must
+ * only be counted as one wait. While a LockWaitScope exists, only the
+ * first wait of the thread is counted. Outside of a scope, each sequence
+ * of busy handler calls counts as one wait.
  */
-Sqlite3Statement::Sqlite3Statement(Sqlite3Backend& backend,
-		const std::string& query) 
-	: Statement(query), _backend(backend) {
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "preparing statement with SQL: '%s'",
-		query.c_str());
-	stmt = NULL;
-	int	rc;
-	const char	*tail;
-	if (SQLITE_OK == (rc = sqlite3_prepare_v2(_backend.database(),
-		query.c_str(), query.size(), &stmt, &tail))) {
-		if (NULL == stmt) {
-			std::string	cause
-				= stringprintf("not an sql query: '%s'",
-					query.c_str());
-			debug(LOG_ERR, DEBUG_LOG, 0, "%s", cause.c_str());
-			throw BadQuery(cause);
+class LockWaitScope {
+	static thread_local bool	_inscope;
+	static thread_local bool	_counted;
+public:
+	LockWaitScope() { _inscope = true; _counted = false; }
+	~LockWaitScope() { _inscope = false; }
+	static void	count(Sqlite3Backend& backend);
+};
+
+thread_local bool	LockWaitScope::_inscope = false;
+thread_local bool	LockWaitScope::_counted = false;
+
+void	LockWaitScope::count(Sqlite3Backend& backend) {
+	if (_inscope && _counted) {
+		return;
+	}
+	backend.lockwaits++;
+	_counted = true;
+}
+
+/**
+ * \brief Hold the sqlite3 mutex of a connection
+ *
+ * In serialized mode, sqlite3 lets only one thread at a time use a
+ * connection. Taking the connection mutex explicitly before a statement
+ * runs makes the time threads wait for each other visible in the
+ * statistics. The mutex is recursive, so sqlite3 can still take it
+ * again internally.
+ */
+class ConnectionLock {
+	sqlite3_mutex	*_mutex;
+	ConnectionLock(const ConnectionLock& other);
+	ConnectionLock&	operator=(const ConnectionLock& other);
+public:
+	ConnectionLock(Sqlite3Connection& connection);
+	~ConnectionLock() {
+		if (NULL != _mutex) {
+			sqlite3_mutex_leave(_mutex);
 		}
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "statement prepared");
+	}
+};
+
+ConnectionLock::ConnectionLock(Sqlite3Connection& connection)
+	: _mutex(sqlite3_db_mutex(connection.database())) {
+	if ((NULL == _mutex) || (SQLITE_OK == sqlite3_mutex_try(_mutex))) {
 		return;
 	}
-	debug(LOG_ERR, DEBUG_LOG, 0, "prepare failed (%d): remaining query: %s",
-		rc, tail);
-	throw Sqlite3Exception(_backend,
-		stringprintf("remaining query: %s", tail));
+	double	start = Timer::gettime();
+	sqlite3_mutex_enter(_mutex);
+	connection.backend().connectionwaits++;
+	connection.backend().connectionwaitusec
+		+= 1000000 * (Timer::gettime() - start);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Sqlite 3 statement implementation
+//////////////////////////////////////////////////////////////////////
+/**
+ * \brief Create an SQL statement
+ */
+Sqlite3Statement::Sqlite3Statement(Sqlite3Connection& connection,
+		const std::string& query)
+	: Statement(query), _connection(connection) {
+	stmt = _connection.acquire(query);
 }
 
 /**
  * \brief Destroy the statement
+ *
+ * The prepared statement is not finalized but returned to the cache
+ * of the connection.
  */
 Sqlite3Statement::~Sqlite3Statement() {
 //	debug(LOG_DEBUG, DEBUG_LOG, 0, "destroy statement '%s'",
 //		query().c_str());
-	int	rc = sqlite3_finalize(stmt);
-	if (rc != SQLITE_OK) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "error in finalize: %s",
-			sqlite3_errmsg(_backend.database()));
-	}
+	_connection.release(query(), stmt);
 }
 
 void	Sqlite3Statement::bindInteger(int colno, int value) {
@@ -129,7 +229,7 @@ void	Sqlite3Statement::bindInteger(int colno, int value) {
 	if (SQLITE_OK == (rc = sqlite3_bind_int(stmt, colno + 1, value))) {
 		return;
 	}
-	throw Sqlite3Exception(_backend, "bindInteger");
+	throw Sqlite3Exception(_connection.database(), "bindInteger");
 }
 
 void	Sqlite3Statement::bindDouble(int colno, double value) {
@@ -137,7 +237,7 @@ void	Sqlite3Statement::bindDouble(int colno, double value) {
 	if (SQLITE_OK == (rc = sqlite3_bind_double(stmt, colno + 1, value))) {
 		return;
 	}
-	throw Sqlite3Exception(_backend, "bindDouble");
+	throw Sqlite3Exception(_connection.database(), "bindDouble");
 }
 
 void	Sqlite3Statement::bindString(int colno, const std::string& value) {
@@ -146,7 +246,7 @@ void	Sqlite3Statement::bindString(int colno, const std::string& value) {
 			value.size(), SQLITE_TRANSIENT))) {
 		return;
 	}
-	throw Sqlite3Exception(_backend, "bindString");
+	throw Sqlite3Exception(_connection.database(), "bindString");
 }
 
 /**
@@ -172,8 +272,14 @@ std::string	Sqlite3Statement::stringColumn(int colno) {
 
 /**
  * \brief Execute a statement
+ *
+ * If the database stays locked even after the busy handler gives up,
+ * the step is retried a few times. The retries belong to the same lock
+ * wait as the busy handler calls.
  */
 void	Sqlite3Statement::execute() {
+	ConnectionLock	lock(_connection);
+	LockWaitScope	scope;
 	int	retry = 0;
 	int	rc;
 	while (retry < 10) {
@@ -184,16 +290,31 @@ void	Sqlite3Statement::execute() {
 			return;
 		case SQLITE_BUSY:
 			retry++;
+			LockWaitScope::count(_connection.backend());
+			_connection.backend().lockwaitusec += 10000;
 			usleep(10000);
 			break;
 		default:
 			debug(LOG_DEBUG, DEBUG_LOG, 0,
 				"sqlite3_step return code: %d", rc);
-			throw Sqlite3Exception(_backend, "execute query");
+			throw Sqlite3Exception(_connection.database(),
+				"execute query");
 		}
 	}
 	// step failed after 10 retries
-	throw Sqlite3Exception(_backend, "execute query: after 10 retries");
+	throw Sqlite3Exception(_connection.database(),
+		"execute query: after 10 retries");
+}
+
+/**
+ * \brief Reset a statement so that it can be executed again
+ *
+ * This also clears all bindings, so a reused statement never silently
+ * inherits values from the previous execution.
+ */
+void	Sqlite3Statement::reset() {
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
 }
 
 Field	Sqlite3Statement::field(int colno) {
@@ -235,6 +356,8 @@ Row	Sqlite3Statement::row() {
 
 Result	Sqlite3Statement::result() {
 //	debug(LOG_DEBUG, DEBUG_LOG, 0, "retrieveing query result");
+	ConnectionLock	lock(_connection);
+	LockWaitScope	scope;
 	Result	result;
 	while (SQLITE_ROW == sqlite3_step(stmt)) {
 //		debug(LOG_DEBUG, DEBUG_LOG, 0, "retrieveing row");
@@ -247,7 +370,7 @@ Result	Sqlite3Statement::result() {
 }
 
 //////////////////////////////////////////////////////////////////////
-// Sqlite3 Backend implementation
+// Sqlite3 connection implementation
 //////////////////////////////////////////////////////////////////////
 
 // The initialization of the sqlite3 library must ensure that it runs
@@ -271,60 +394,145 @@ static void	sqlite3_initialize_once() {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "sqlite3 initialized");
 }
 
-Sqlite3Backend::Sqlite3Backend(const std::string& filename)
-	: _filename(filename) {
-	std::call_once(sqlite3_once_flag, sqlite3_initialize_once);
-	// check whether this version of sqlite is compiled with mutexes
-	if (sqlite3_threadsafe()) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "backend is thread safe");
-	} else {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "backend is NOT thread safe");
+/**
+ * \brief Busy handler that counts lock waits
+ *
+ * This replaces sqlite3_busy_timeout(), it also gives up after about
+ * 10 seconds.
+ */
+static int	busy_handler(void *data, int count) {
+	Sqlite3Backend	*backend = (Sqlite3Backend *)data;
+	if (count == 0) {
+		LockWaitScope::count(*backend);
 	}
+	if (count >= 1000) {
+		return 0;
+	}
+	int	usec = (count < 10) ? 1000 * (count + 1) : 10000;
+	usleep(usec);
+	backend->lockwaitusec += usec;
+	return 1;
+}
+
+Sqlite3Connection::Sqlite3Connection(Sqlite3Backend& backend,
+	const std::string& filename, bool readonly, size_t cachesize)
+	: _backend(backend), _cachesize(cachesize) {
 	// open the database
 	_database = NULL;
-	if (sqlite3_open(_filename.c_str(), &_database)) {
+	int	flags = (readonly) ? SQLITE_OPEN_READONLY
+			: (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+	if (sqlite3_open_v2(filename.c_str(), &_database, flags, NULL)) {
 		std::string	cause
 			= stringprintf("cannot open/create db on file '%s': %s",
 				filename.c_str(), sqlite3_errmsg(_database));
 		debug(LOG_ERR, DEBUG_LOG, 0, "%s", cause.c_str());
+		sqlite3_close(_database);
 		throw BadDatabase(cause);
 	}
 
 	// wait 10 seconds on locked databases
-	sqlite3_busy_timeout(_database, 10000);
+	sqlite3_busy_handler(_database, busy_handler, &_backend);
 
 	// some pragmas
-	char	*errmesg = NULL;
-	if (sqlite3_exec(_database, "PRAGMA temp_store = MEMORY;", NULL, NULL,
-		&errmesg)) {
-		std::string	msg = stringprintf("'PRAGMA temp_store = "
-			"MEMORY' failed: %s", errmesg);
-		sqlite3_free(errmesg);
-		throw BadDatabase(msg);
+	try {
+		pragma("temp_store = MEMORY");
+		pragma("foreign_keys = ON");
+		pragma("locking_mode = NORMAL");
+	} catch (...) {
+		sqlite3_close(_database);
+		throw;
 	}
-	if (sqlite3_exec(_database, "PRAGMA foreign_keys = ON;", NULL, NULL,
-		&errmesg)) {
-		std::string	msg = stringprintf("'PRAGMA foreign_keys = "
-			"ON' failed: %s", errmesg);
-		sqlite3_free(errmesg);
-		throw BadDatabase(msg);
+}
+
+/**
+ * \brief Finalize all cached statements and close the connection
+ */
+Sqlite3Connection::~Sqlite3Connection() {
+	std::list<cacheentry>::iterator	i;
+	for (i = _cache.begin(); i != _cache.end(); i++) {
+		sqlite3_finalize(i->second);
 	}
-	if (sqlite3_exec(_database, "PRAGMA locking_mode = NORMAL;", NULL, NULL,
-		&errmesg)) {
-		std::string	msg = stringprintf("'PRAGMA locking_mode = "
-			"NORMAL' failed: %s", errmesg);
+	_cache.clear();
+	sqlite3_close(_database);
+	_database = NULL;
+}
+
+/**
+ * \brief Execute a pragma on this connection
+ */
+void	Sqlite3Connection::pragma(const std::string& pragma) {
+	char	*errmesg = NULL;
+	std::string	query = "PRAGMA " + pragma + ";";
+	if (sqlite3_exec(_database, query.c_str(), NULL, NULL, &errmesg)) {
+		std::string	msg = stringprintf("'PRAGMA %s' failed: %s",
+			pragma.c_str(), errmesg);
 		sqlite3_free(errmesg);
 		throw BadDatabase(msg);
 	}
 }
 
-Sqlite3Backend::~Sqlite3Backend() {
-	sqlite3_close(_database);
-	_database = NULL;
+/**
+ * \brief Get a prepared statement for a query
+ *
+ * If an idle statement for the same query is in the cache, it is taken
+ * out of the cache and returned, otherwise the query is prepared.
+ */
+sqlite3_stmt	*Sqlite3Connection::acquire(const std::string& query) {
+	{
+		std::unique_lock<std::mutex>	lock(_cachemutex);
+		std::list<cacheentry>::iterator	i;
+		for (i = _cache.begin(); i != _cache.end(); i++) {
+			if (i->first == query) {
+				sqlite3_stmt	*stmt = i->second;
+				_cache.erase(i);
+				_backend.cachehits++;
+				return stmt;
+			}
+		}
+	}
+	_backend.cachemisses++;
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "preparing statement with SQL: '%s'",
+		query.c_str());
+	sqlite3_stmt	*stmt = NULL;
+	int	rc;
+	const char	*tail;
+	double	start = Timer::gettime();
+	rc = sqlite3_prepare_v2(_database, query.c_str(), query.size(),
+		&stmt, &tail);
+	_backend.prepareusec += 1000000 * (Timer::gettime() - start);
+	if (SQLITE_OK == rc) {
+		if (NULL == stmt) {
+			std::string	cause
+				= stringprintf("not an sql query: '%s'",
+					query.c_str());
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s", cause.c_str());
+			throw BadQuery(cause);
+		}
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "statement prepared");
+		return stmt;
+	}
+	debug(LOG_ERR, DEBUG_LOG, 0, "prepare failed (%d): remaining query: %s",
+		rc, tail);
+	throw Sqlite3Exception(_database,
+		stringprintf("remaining query: %s", tail));
 }
 
-std::string	Sqlite3Backend::escape(const std::string& value) {
-	return value;
+/**
+ * \brief Return a statement to the cache
+ *
+ * The statement is reset, which also releases any read lock it may still
+ * hold, and its bindings are cleared.
+ */
+void	Sqlite3Connection::release(const std::string& query,
+		sqlite3_stmt *stmt) {
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+	std::unique_lock<std::mutex>	lock(_cachemutex);
+	_cache.push_front(std::make_pair(query, stmt));
+	while (_cache.size() > _cachesize) {
+		sqlite3_finalize(_cache.back().second);
+		_cache.pop_back();
+	}
 }
 
 /**
@@ -332,7 +540,7 @@ std::string	Sqlite3Backend::escape(const std::string& value) {
  */
 class ResultCollector {
 	FieldValueFactory	factory;
-public:	
+public:
 	Result	result;
 	int	operator()(int columns, char **values, char **colnames);
 };
@@ -365,8 +573,10 @@ static int	collector_callback(void *coll, int columns, char **values,
 /**
  * \brief Perform an arbitrary query
  */
-Result	Sqlite3Backend::query(const std::string& query) {
+Result	Sqlite3Connection::query(const std::string& query) {
 //	debug(LOG_DEBUG, DEBUG_LOG, 0, "query: %s", query.c_str());
+	ConnectionLock	lock(*this);
+	LockWaitScope	scope;
 	ResultCollector	collector;
 	char	*errmsg = NULL;
 	int	rc = sqlite3_exec(_database, query.c_str(),
@@ -376,7 +586,122 @@ Result	Sqlite3Backend::query(const std::string& query) {
 	}
 	debug(LOG_ERR, DEBUG_LOG, 0, "query '%s' fails: %s",
 		query.c_str(), errmsg);
-	throw Sqlite3Exception(*this, std::string(errmsg));
+	std::string	msg(errmsg);
+	sqlite3_free(errmsg);
+	throw Sqlite3Exception(_database, msg);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Sqlite3 Backend implementation
+//////////////////////////////////////////////////////////////////////
+Sqlite3Backend::Sqlite3Backend(const std::string& filename, int readers)
+	: _filename(filename), _nreaders(readers), _nextreader(0),
+	  cachehits(0), cachemisses(0), prepareusec(0), lockwaits(0),
+	  lockwaitusec(0), connectionwaits(0), connectionwaitusec(0),
+	  readerqueries(0) {
+	std::call_once(sqlite3_once_flag, sqlite3_initialize_once);
+	// check whether this version of sqlite is compiled with mutexes
+	if (sqlite3_threadsafe()) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "backend is thread safe");
+	} else {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "backend is NOT thread safe");
+	}
+	_writer = std::unique_ptr<Sqlite3Connection>(
+		new Sqlite3Connection(*this, _filename, false));
+
+	// reader connections only make sense in WAL mode, in all other
+	// journal modes a reader would block the writer anyway. Memory
+	// databases cannot be shared between connections at all. The
+	// conversion to WAL mode is permanent, see DatabaseFactory.
+	if (_nreaders > 0) {
+		std::string	mode;
+		try {
+			Result	r = _writer->query("PRAGMA journal_mode;");
+			if ((r.size() > 0)
+				&& (r.front()[0]->stringValue() != "wal")) {
+				debug(LOG_INFO, DEBUG_LOG, 0, "converting %s "
+					"to WAL journal mode", _filename.c_str());
+			}
+			r = _writer->query("PRAGMA journal_mode = WAL;");
+			if (r.size() > 0) {
+				mode = r.front()[0]->stringValue();
+			}
+		} catch (const std::exception& x) {
+			debug(LOG_DEBUG, DEBUG_LOG, 0, "cannot set WAL mode: %s",
+				x.what());
+		}
+		if (mode != "wal") {
+			debug(LOG_DEBUG, DEBUG_LOG, 0, "journal mode '%s', "
+				"not using reader connections", mode.c_str());
+			_nreaders = 0;
+		}
+	}
+}
+
+Sqlite3Backend::~Sqlite3Backend() {
+	_readers.clear();
+	_writer.reset();
+}
+
+std::string	Sqlite3Backend::escape(const std::string& value) {
+	return value;
+}
+
+/**
+ * \brief Get one of the reader connections
+ *
+ * The reader connections are created on first use, and then used in
+ * round robin fashion.
+ */
+Sqlite3Connection&	Sqlite3Backend::reader() {
+	{
+		std::unique_lock<std::mutex>	lock(_readermutex);
+		if (_readers.size() == 0) {
+			debug(LOG_DEBUG, DEBUG_LOG, 0,
+				"opening %d reader connections on %s",
+				_nreaders, _filename.c_str());
+			for (int i = 0; i < _nreaders; i++) {
+				_readers.push_back(
+					std::unique_ptr<Sqlite3Connection>(
+					new Sqlite3Connection(*this, _filename,
+						true)));
+			}
+		}
+	}
+	readerqueries++;
+	return *_readers[_nextreader++ % _readers.size()];
+}
+
+/**
+ * \brief Find the connection a query should be sent to
+ *
+ * Only select queries are candidates for a reader connection. A thread
+ * that has a transaction open on the writer connection must see its own
+ * uncommitted changes, so its queries always use the writer.
+ */
+Sqlite3Connection&	Sqlite3Backend::connection(const std::string& query) {
+	if (_nreaders <= 0) {
+		return *_writer;
+	}
+	size_t	start = query.find_first_not_of(" \t\n");
+	if ((start == std::string::npos)
+		|| (0 != strncasecmp(query.c_str() + start, "select", 6))) {
+		return *_writer;
+	}
+	if (!sqlite3_get_autocommit(_writer->database())) {
+		std::unique_lock<std::mutex>	lock(_transactionmutex);
+		if (_transactionowner == std::this_thread::get_id()) {
+			return *_writer;
+		}
+	}
+	return reader();
+}
+
+/**
+ * \brief Perform an arbitrary query
+ */
+Result	Sqlite3Backend::query(const std::string& query) {
+	return connection(query).query(query);
 }
 
 /**
@@ -398,14 +723,26 @@ std::vector<std::string>	Sqlite3Backend::fieldnames(
 	return result;
 }
 
+/**
+ * \brief Remember the thread that opens a transaction on the writer
+ */
+void	Sqlite3Backend::begintransaction() {
+	if (sqlite3_get_autocommit(_writer->database())) {
+		std::unique_lock<std::mutex>	lock(_transactionmutex);
+		_transactionowner = std::this_thread::get_id();
+	}
+}
+
 /**
  * \brief Start a transaction
  */
 void	Sqlite3Backend::begin() {
+	begintransaction();
 	query("BEGIN TRANSACTION;");
 }
 
 void	Sqlite3Backend::begin(const std::string& savepoint) {
+	begintransaction();
 	query("SAVEPOINT " + savepoint + ";");
 }
 
@@ -435,7 +772,7 @@ void	Sqlite3Backend::rollback(const std::string& savepoint) {
  * \brief Create a statement from a query
  */
 StatementPtr	Sqlite3Backend::statement(const std::string& query) {
-	return StatementPtr(new Sqlite3Statement(*this, query));
+	return StatementPtr(new Sqlite3Statement(connection(query), query));
 }
 
 /**
@@ -452,23 +789,53 @@ bool	Sqlite3Backend::hastable(const std::string& tablename) {
 	} catch (std::exception& x) {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "cannot create table %s",
 			x.what());
-			
+
 	}
 	return false;
 }
 
+/**
+ * \brief Get a snapshot of the performance counters
+ */
+DatabaseStatistics	Sqlite3Backend::statistics() {
+	DatabaseStatistics	result;
+	result.cachehits = cachehits;
+	result.cachemisses = cachemisses;
+	result.preparetime = prepareusec / 1000000.;
+	result.lockwaits = lockwaits;
+	result.lockwaittime = lockwaitusec / 1000000.;
+	result.connectionwaits = connectionwaits;
+	result.connectionwaittime = connectionwaitusec / 1000000.;
+	result.readerqueries = readerqueries;
+	return result;
+}
+
 //////////////////////////////////////////////////////////////////////
 // Sqlite3Exception
 //////////////////////////////////////////////////////////////////////
-// this method can only be defined here because only now we know that the
-// backend really is
 /**
  * \brief Create an Sqlite3 error message
  */
-std::string	Sqlite3Exception::cause(Sqlite3Backend& database,
+std::string	Sqlite3Exception::cause(sqlite3 *database,
 			const std::string& info) {
-	return stringprintf("%s: %s", info.c_str(),
-		sqlite3_errmsg(database.database()));
+	return stringprintf("%s: %s", info.c_str(), sqlite3_errmsg(database));
+}
+
+//////////////////////////////////////////////////////////////////////
+// DatabaseStatistics
+//////////////////////////////////////////////////////////////////////
+DatabaseStatistics::DatabaseStatistics()
+	: cachehits(0), cachemisses(0), preparetime(0), lockwaits(0),
+	  lockwaittime(0), connectionwaits(0), connectionwaittime(0),
+	  readerqueries(0) {
+}
+
+std::string	DatabaseStatistics::toString() const {
+	return stringprintf("statement cache %lu hits, %lu misses, "
+		"prepare %.3fs, %lu lock waits %.3fs, %lu connection waits "
+		"%.3fs, %lu reader queries", cachehits, cachemisses,
+		preparetime, lockwaits, lockwaittime, connectionwaits,
+		connectionwaittime, readerqueries);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -476,11 +843,17 @@ std::string	Sqlite3Exception::cause(Sqlite3Backend& database,
 //////////////////////////////////////////////////////////////////////
 /**
  * \brief Backend factory implementation
+ *
+ * By default, the backend uses two additional reader connections.
  */
 Database	DatabaseFactory::get(const std::string& filename) {
+	return get(filename, 2);
+}
+
+Database	DatabaseFactory::get(const std::string& filename, int readers) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "create backend on file '%s'",
 		filename.c_str());
-	return Database(new Sqlite3Backend(filename));
+	return Database(new Sqlite3Backend(filename, readers));
 }
 
 } // namespace persistence
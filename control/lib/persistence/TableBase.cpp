@@ -58,11 +58,13 @@ std::string	TableBase::selectquery() const {
 /**
  * \brief Find the id for the next row to be inserted
  *
- * This method generates the id 1 if there are now rows in the table
+ * This method generates the id 1 if there are now rows in the table.
+ * Since id is the primary key, max(id) is a single index lookup, in
+ * contrast to count(*) which has to scan the whole table.
  */
 long	TableBase::nextid() {
 	std::ostringstream	out;
-	out << "select case when count(*) = 0 then 1 else max(id + 1) end as 'nextid' from " << _tablename;
+	out << "select coalesce(max(id), 0) + 1 as 'nextid' from " << _tablename;
 	Result	result = _database->query(out.str());
 	if (result.size() != 1) {
 		return 0;
@@ -128,6 +130,48 @@ long	TableBase::addrow(const UpdateSpec& updatespec) {
 	return objectid;
 }
 
+/**
+ * \brief Add a set of rows in a single transaction, return the ids
+ *
+ * The next id is only computed once, and the insert statement for rows
+ * with the same set of columns comes from the statement cache of the
+ * backend, so it is only prepared once. The rows are
+ * added inside a savepoint, so this also works when the caller already
+ * has a transaction open. Either all rows are added or none.
+ */
+std::vector<long>	TableBase::addrows(
+				const std::vector<UpdateSpec>& updatespecs) {
+	std::vector<long>	objectids;
+	if (updatespecs.size() == 0) {
+		return objectids;
+	}
+	objectids.reserve(updatespecs.size());
+	_database->begin("addrows");
+	try {
+		long	objectid = nextid();
+		std::vector<UpdateSpec>::const_iterator	i;
+		for (i = updatespecs.begin(); i != updatespecs.end(); i++) {
+			StatementPtr	stmt = _database->statement(
+				i->insertquery(_tablename));
+			i->bind(stmt);
+			i->bindid(stmt, objectid);
+			stmt->execute();
+			objectids.push_back(objectid++);
+		}
+		_database->commit("addrows");
+	} catch (const std::exception& x) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "cannot add %d rows to %s: %s",
+			updatespecs.size(), _tablename.c_str(), x.what());
+		// rolling back to a savepoint keeps it open, release it
+		_database->rollback("addrows");
+		_database->commit("addrows");
+		throw;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%d rows added to %s",
+		objectids.size(), _tablename.c_str());
+	return objectids;
+}
+
 /**
  * \brief Update a row in the database
  */
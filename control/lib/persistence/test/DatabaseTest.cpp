@@ -11,6 +11,7 @@
 #include <iostream>
 #include <AstroPersistence.h>
 #include <math.h>
+#include <thread>
 
 using namespace astro::persistence;
 
@@ -27,6 +28,8 @@ public:
 	void	testSelectStatement();
 	void	testInsert();
 	void	testDelete();
+	void	testStatementCache();
+	void	testReaderIsolation();
 
 	CPPUNIT_TEST_SUITE(DatabaseTest);
 	CPPUNIT_TEST(testConstructor);
@@ -34,6 +37,8 @@ public:
 	CPPUNIT_TEST(testSelectStatement);
 	CPPUNIT_TEST(testInsert);
 	CPPUNIT_TEST(testDelete);
+	CPPUNIT_TEST(testStatementCache);
+	CPPUNIT_TEST(testReaderIsolation);
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -122,5 +127,47 @@ void	DatabaseTest::testDelete() {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "testDelete() end");
 }
 
+void	DatabaseTest::testStatementCache() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testStatementCache() begin");
+	// each connection has its own cache, so use only one connection
+	Database	database = DatabaseFactory::get("testdb.db", 0);
+	std::string	query("select count(*) from testtable");
+	for (int i = 0; i < 10; i++) {
+		StatementPtr	stmt = database->statement(query);
+		stmt->result();
+	}
+	DatabaseStatistics	statistics = database->statistics();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", statistics.toString().c_str());
+	CPPUNIT_ASSERT(statistics.cachemisses == 1);
+	CPPUNIT_ASSERT(statistics.cachehits == 9);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testStatementCache() end");
+}
+
+void	DatabaseTest::testReaderIsolation() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testReaderIsolation() begin");
+	Database	database = DatabaseFactory::get("testdb.db");
+	std::string	query("select count(*) from testtable");
+	int	before = database->query(query).front()[0]->intValue();
+	database->begin("isolation");
+	database->query("insert into testtable(intfield, floatfield, "
+		"stringfield, timefield, id) values (1, 1.0, 'x', "
+		"'2016-01-01 00:00:00', 100000)");
+	// this thread must see its own uncommitted row
+	CPPUNIT_ASSERT(database->query(query).front()[0]->intValue()
+		== before + 1);
+	// other threads only see committed data
+	int	other = -1;
+	std::thread	t([&]() {
+		other = database->query(query).front()[0]->intValue();
+	});
+	t.join();
+	database->rollback("isolation");
+	database->commit("isolation");
+	// the test database is a file, so it must be using reader connections
+	CPPUNIT_ASSERT(database->statistics().readerqueries > 0);
+	CPPUNIT_ASSERT(other == before);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testReaderIsolation() end");
+}
+
 } // namespace test
 } // namespace astro
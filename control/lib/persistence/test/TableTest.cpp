@@ -14,6 +14,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <iostream>
 #include <AstroPersistence.h>
+#include <AstroFormat.h>
 #include <math.h>
 #include "../Testtable.h"
 
@@ -31,12 +32,14 @@ public:
 	void	testInsert();
 	void	testUpdate();
 	void	testDelete();
+	void	testBulkInsert();
 
 	CPPUNIT_TEST_SUITE(TableTest);
 	CPPUNIT_TEST(testInsert);
 	CPPUNIT_TEST(testRetrieve);
 	CPPUNIT_TEST(testUpdate);
 	CPPUNIT_TEST(testDelete);
+	CPPUNIT_TEST(testBulkInsert);
 	CPPUNIT_TEST_SUITE_END();
 };
 
@@ -110,5 +113,34 @@ void	TableTest::testDelete() {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "testDelete() end");
 }
 
+void	TableTest::testBulkInsert() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testBulkInsert() begin");
+	DatabaseFactory	dbf;
+	Database	database = dbf.get("testdb.db");
+	Table<TestRecord, TesttableAdapter>	table(database);
+	long	count = table.count();
+	long	firstid = table.nextid();
+	std::vector<TestRecord>	entries;
+	for (int i = 0; i < 100; i++) {
+		TestRecord	entry(0);
+		entry.intfield(i);
+		entry.doublefield(i / 10.);
+		entry.stringfield(stringprintf("bulk%d", i));
+		entry.timefield(time(NULL));
+		entries.push_back(entry);
+	}
+	std::vector<long>	ids = table.add(entries);
+	CPPUNIT_ASSERT(ids.size() == 100);
+	CPPUNIT_ASSERT(ids.front() == firstid);
+	CPPUNIT_ASSERT(ids.back() == firstid + 99);
+	CPPUNIT_ASSERT(table.count() == count + 100);
+	TestRecord	entry = table.byid(ids[42]);
+	CPPUNIT_ASSERT(entry.intfield() == 42);
+	CPPUNIT_ASSERT(entry.stringfield() == "bulk42");
+	table.remove(std::list<long>(ids.begin(), ids.end()));
+	CPPUNIT_ASSERT(table.count() == count);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testBulkInsert() end");
+}
+
 } // namespace test
 } // namespace astro
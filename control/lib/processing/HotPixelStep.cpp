@@ -0,0 +1,48 @@
+/*
+ * HotPixelStep.cpp -- implementation of the hot pixel correction step
+ *
+ * (c) 2017 Prof Dr Andreas Müller, Hochschule Rapperswil
+ */
+#include <AstroProcess.h>
+#include <AstroAdapter.h>
+#include <sstream>
+
+namespace astro {
+namespace process {
+
+/**
+ * \brief Construct a new HotPixelStep
+ *
+ * By default, pixels deviating by more than 5 sigma from the median of
+ * the disk of radius 2 around them are corrected.
+ */
+HotPixelStep::HotPixelStep() : _radius(2), _threshold(5) {
+}
+
+/**
+ * \brief Work function for hot pixel correction
+ */
+ProcessingStep::state	HotPixelStep::do_work() {
+	try {
+		ImagePtr	precursor = precursorimage();
+		_image = adapter::hotpixelsptr(precursor, radius(),
+			threshold());
+		return ProcessingStep::complete;
+	} catch (const std::exception& x) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "processing error: %s", x.what());
+	}
+	return ProcessingStep::failed;
+}
+
+/**
+ * \brief Inform about what we are doing
+ */
+std::string	HotPixelStep::what() const {
+	std::ostringstream	out;
+	out << "Correct hot pixels: radius = " << radius()
+		<< ", threshold = " << threshold();
+	return out.str();
+}
+
+} // namespace process
+} // namespace astro
@@ -0,0 +1,38 @@
+/*
+ * ParseHotpixelsStep.cpp
+ *
+ * (c) 2017 Prof Dr Andreas Müller, Hochschule Rapperswil
+ */
+#include <includes.h>
+#include <AstroProcess.h>
+#include "ProcessorParser.h"
+
+namespace astro {
+namespace process {
+
+void	ProcessorParser::startHotpixels(const attr_t& attrs) {
+	// create the hot pixel step
+	HotPixelStep	*s = new HotPixelStep();
+	ProcessingStepPtr	step(s);
+
+	// remember everyhwere
+	_stepstack.push(step);
+
+	// parse attributes
+	attr_t::const_iterator	i;
+	if (attrs.end() != (i = attrs.find("radius"))) {
+		s->radius(std::stoi(i->second));
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "set radius to %d",
+			s->radius());
+	}
+	if (attrs.end() != (i = attrs.find("threshold"))) {
+		s->threshold(std::stod(i->second));
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "set threshold to %f",
+			s->threshold());
+	}
+
+	startCommon(attrs);
+}
+
+} // namespace process
+} // namespace astro
@@ -75,6 +75,10 @@ void	ProcessorParser::startElement(const std::string& name,
 		startDestar(attrs);
 		return;
 	}
+	if (name == std::string("hotpixels")) {
+		startHotpixels(attrs);
+		return;
+	}
 	if (name == std::string("hdr")) {
 		startHDR(attrs);
 		return;
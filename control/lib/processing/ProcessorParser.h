@@ -43,6 +43,7 @@ class ProcessorParser {
 	void	startHDR(const attr_t& attrs);
 	void	startRescale(const attr_t& attrs);
 	void	startDestar(const attr_t& attrs);
+	void	startHotpixels(const attr_t& attrs);
 	void	startLuminanceStretching(const attr_t& attrs);
 public:
 	ProcessorParser();
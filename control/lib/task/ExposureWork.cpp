@@ -15,6 +15,7 @@
 #include <AstroConfig.h>
 #include <AstroFormat.h>
 #include <ImageDirectory.h>
+#include <AstroMetrics.h>
 #include <errno.h>
 #include <string.h>
 #include <AstroIO.h>
@@ -134,6 +135,14 @@ public:
  * cancel is recognized.
  */
 void	ExposureWork::run() {
+	static metrics::Histogram&	worktime
+		= metrics::Metrics::histogram("task.exposure");
+	static metrics::Histogram&	downloadtime
+		= metrics::Metrics::histogram("task.exposure.download");
+	static metrics::Histogram&	savetime
+		= metrics::Metrics::histogram("task.exposure.save");
+	metrics::ScopedTimer	worktimer(worktime);
+
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "start ExposureWork");
 	// set the cooler
 	if (cooler) {
@@ -228,7 +237,9 @@ void	ExposureWork::run() {
 
 
 	// get the image from the ccd
+	double	start = Timer::gettime();
 	astro::image::ImagePtr	image = ccd->getImage();
+	downloadtime.record(Timer::gettime() - start);
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "image frame: %s",
 		image->getFrame().toString().c_str());
 
@@ -259,6 +270,8 @@ void	ExposureWork::run() {
 			std::string("PROJECT"), _task.project()));
 	}
 
+	// save the image
+	start = Timer::gettime();
 	if (_task.repository().size() > 0) {
 		// add the image to the repository
 		std::string	repository = _task.repository();
@@ -284,6 +297,8 @@ void	ExposureWork::run() {
 			filename.c_str());
 	}
 
+	savetime.record(Timer::gettime() - start);
+
 	// update the frame information
 	astro::camera::Exposure	exposure = _task.exposure();
 	_task.exposure(exposure);
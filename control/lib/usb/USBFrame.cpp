@@ -4,6 +4,7 @@
  * (c) 2013 Prof Dr Andreas Mueller, Hochschule Rapperswil
  */
 #include <AstroUSB.h>
+#include <AstroDebug.h>
 #include <string>
 
 using namespace astro::usb;
@@ -26,5 +27,73 @@ int	Frame::getHeight() const {
 	return height;
 }
 
+//////////////////////////////////////////////////////////////////////
+// FramePool implementation
+//////////////////////////////////////////////////////////////////////
+/**
+ * \brief Create a frame pool
+ *
+ * \param capacity	number of bytes to reserve in each frame
+ * \param maxfree	maximum number of unused frames kept in the pool
+ */
+FramePool::FramePool(int width, int height, size_t capacity, size_t maxfree)
+	: _width(width), _height(height), _capacity(capacity),
+	  _maxfree(maxfree), _allocated(0), _reused(0) {
+	_free.reserve(_maxfree);
+}
+
+/**
+ * \brief Destroy the pool and all unused frames
+ *
+ * Frames still in use keep the pool alive through their deleter, so
+ * at this point all frames are back in the free list.
+ */
+FramePool::~FramePool() {
+	for (auto i = _free.begin(); i != _free.end(); i++) {
+		delete *i;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "frame pool %dx%d: %lu allocated, "
+		"%lu reused", _width, _height, _allocated, _reused);
+}
+
+/**
+ * \brief Take a frame back into the pool
+ */
+void	FramePool::recycle(Frame *frame) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	if (_free.size() >= _maxfree) {
+		delete frame;
+		return;
+	}
+	frame->clear();
+	_free.push_back(frame);
+}
+
+/**
+ * \brief Get an empty frame from the pool
+ *
+ * The frame returned has enough capacity to hold a complete video frame,
+ * appending payload data to it does not reallocate the buffer.
+ */
+FramePtr	FramePool::get() {
+	Frame	*frame = NULL;
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		if (_free.size() > 0) {
+			frame = _free.back();
+			_free.pop_back();
+			_reused++;
+		} else {
+			_allocated++;
+		}
+	}
+	if (NULL == frame) {
+		frame = new Frame(_width, _height);
+		frame->reserve(_capacity);
+	}
+	FramePoolPtr	pool = shared_from_this();
+	return FramePtr(frame, [pool](Frame *f) { pool->recycle(f); });
+}
+
 } // namespace usb
 } // namespace astro
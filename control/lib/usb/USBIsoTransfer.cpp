@@ -105,6 +105,24 @@ int	IsoSegment::extract(std::list<std::string>& packets) {
 	return packetcounter;
 }	
 
+/**
+ * \brief Hand the packets of the segment to a sink
+ *
+ * The packets are passed directly from the transfer buffer, without
+ * copying them.
+ */
+int	IsoSegment::extract(PacketSink& sink) {
+	int	packetcounter = 0;
+	for (int i = 0; i < transfer->num_iso_packets; i++) {
+		if (0 == transfer->iso_packet_desc[i].status) {
+			sink.packet(libusb_get_iso_packet_buffer(transfer, i),
+				transfer->iso_packet_desc[i].actual_length);
+			packetcounter++;
+		}
+	}
+	return packetcounter;
+}
+
 //////////////////////////////////////////////////////////////////////
 // IsoTransfer implementation
 //////////////////////////////////////////////////////////////////////
@@ -0,0 +1,165 @@
+/*
+ * USBPacket.cpp -- packet sinks, recording and replay of payload packets
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroUSB.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroUtils.h>
+#include <cerrno>
+#include <random>
+
+namespace astro {
+namespace usb {
+
+//////////////////////////////////////////////////////////////////////
+// PacketList implementation
+//////////////////////////////////////////////////////////////////////
+void	PacketList::packet(const unsigned char *data, size_t length) {
+	packets.push_back(std::string((const char *)data, length));
+}
+
+//////////////////////////////////////////////////////////////////////
+// PacketRecorder implementation
+//////////////////////////////////////////////////////////////////////
+const char	*PacketRecorder::magic = "USBPKT01";
+
+/**
+ * \brief Open a recording file
+ *
+ * \param filename	name of the file to record to
+ * \param next		sink to forward the packets to, may be NULL
+ */
+PacketRecorder::PacketRecorder(const std::string& filename, PacketSink *next)
+	: _next(next), _packets(0) {
+	_file = fopen(filename.c_str(), "wb");
+	if (NULL == _file) {
+		std::string	msg = stringprintf("cannot open %s: %s",
+			filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	fwrite(magic, 1, strlen(magic), _file);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "recording packets to %s",
+		filename.c_str());
+}
+
+PacketRecorder::~PacketRecorder() {
+	fclose(_file);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%lu packets recorded", _packets);
+}
+
+/**
+ * \brief Record a packet and forward it
+ */
+void	PacketRecorder::packet(const unsigned char *data, size_t length) {
+	unsigned char	header[4];
+	header[0] = length & 0xff;
+	header[1] = (length >> 8) & 0xff;
+	header[2] = (length >> 16) & 0xff;
+	header[3] = (length >> 24) & 0xff;
+	if ((4 != fwrite(header, 1, 4, _file))
+		|| (length != fwrite(data, 1, length, _file))) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "cannot record packet: %s",
+			strerror(errno));
+	}
+	_packets++;
+	if (_next) {
+		_next->packet(data, length);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// PacketReplay implementation
+//////////////////////////////////////////////////////////////////////
+/**
+ * \brief Read a packet recording
+ */
+PacketReplay::PacketReplay(const std::string& filename) : _elapsed(0) {
+	FILE	*file = fopen(filename.c_str(), "rb");
+	if (NULL == file) {
+		std::string	msg = stringprintf("cannot open %s: %s",
+			filename.c_str(), strerror(errno));
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	char	buffer[65536];
+	size_t	n;
+	while (0 < (n = fread(buffer, 1, sizeof(buffer), file))) {
+		_data.append(buffer, n);
+	}
+	fclose(file);
+
+	// verify the magic string
+	size_t	offset = strlen(PacketRecorder::magic);
+	if ((_data.size() < offset)
+		|| (_data.compare(0, offset, PacketRecorder::magic) != 0)) {
+		std::string	msg = stringprintf("%s is not a packet recording",
+			filename.c_str());
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+
+	// build the packet index
+	const unsigned char	*p = (const unsigned char *)_data.data();
+	while (offset + 4 <= _data.size()) {
+		size_t	length = p[offset] | (p[offset + 1] << 8)
+			| (p[offset + 2] << 16) | ((size_t)p[offset + 3] << 24);
+		offset += 4;
+		if (offset + length > _data.size()) {
+			debug(LOG_WARNING, DEBUG_LOG, 0,
+				"recording %s truncated", filename.c_str());
+			break;
+		}
+		_packets.push_back(std::make_pair(offset, length));
+		offset += length;
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s: %d packets, %lu bytes",
+		filename.c_str(), _packets.size(), bytes());
+}
+
+/**
+ * \brief Total number of packet bytes in the recording
+ */
+size_t	PacketReplay::bytes() const {
+	size_t	result = 0;
+	for (auto i = _packets.begin(); i != _packets.end(); i++) {
+		result += i->second;
+	}
+	return result;
+}
+
+/**
+ * \brief Feed the recorded packets to a sink
+ *
+ * \param sink		the sink to feed the packets to
+ * \param loss		probability that a packet is dropped
+ * \param seed		seed for the random number generator used to
+ *			decide which packets to drop
+ * \return		the number of packets delivered
+ */
+unsigned long	PacketReplay::replay(PacketSink& sink, double loss,
+	unsigned int seed) {
+	std::minstd_rand	generator(seed);
+	std::uniform_real_distribution<double>	uniform(0., 1.);
+	const unsigned char	*p = (const unsigned char *)_data.data();
+	unsigned long	delivered = 0;
+	Timer	timer;
+	timer.start();
+	for (auto i = _packets.begin(); i != _packets.end(); i++) {
+		if ((loss > 0) && (uniform(generator) < loss)) {
+			continue;
+		}
+		sink.packet(p + i->first, i->second);
+		delivered++;
+	}
+	timer.end();
+	_elapsed = timer.elapsed();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%lu of %d packets replayed in %.6fs",
+		delivered, _packets.size(), _elapsed);
+	return delivered;
+}
+
+} // namespace usb
+} // namespace astro
@@ -7,6 +7,8 @@
 #include <sstream>
 #include <ostream>
 #include <AstroDebug.h>
+#include <algorithm>
+#include <cstdlib>
 
 using namespace astro::usb::uvc;
 
@@ -97,6 +99,13 @@ void	UVCCamera::getCur(uint8_t interface) {
 UVCCamera::UVCCamera(Device& _device, bool /* force */) : device(_device) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "create a UVC camera object");
 
+	// packets can be recorded for later replay by setting the
+	// UVC_PACKET_RECORD environment variable to a file name
+	const char	*recordfile = getenv("UVC_PACKET_RECORD");
+	if (NULL != recordfile) {
+		packetfile = std::string(recordfile);
+	}
+
 	// make sure the camera is open, this most probably will not have
 	// any effect
 	device.open();
@@ -717,6 +726,54 @@ int	UVCCamera::preferredAltSetting(uint8_t interface) {
 	throw USBError("no alternate setting with enough bandwidth found");
 }
 
+/**
+ * \brief Minimum size of a complete frame in the current format
+ */
+size_t	UVCCamera::minframesize() const {
+	return width * height * (bitsPerPixel / 8);
+}
+
+/**
+ * \brief Get the frame pool for the current format
+ *
+ * The pool is kept as long as the frame size does not change, so that
+ * frame buffers are reused across calls to getFrames().
+ */
+FramePoolPtr	UVCCamera::getFramePool() {
+	size_t	capacity = std::max(minframesize(), (size_t)maxvideoframesize);
+	if ((!framepool) || (framepool->width() != width)
+		|| (framepool->height() != height)
+		|| (framepool->capacity() != capacity)) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "new frame pool %dx%d, %d bytes",
+			width, height, capacity);
+		framepool = FramePoolPtr(new FramePool(width, height, capacity));
+	}
+	return framepool;
+}
+
+/**
+ * \brief Retrieve the frames from an assembler after a transfer
+ */
+std::vector<FramePtr>	UVCCamera::assembledFrames(FrameAssembler& assembler) {
+	assembler.flush();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", assembler.toString().c_str());
+	if (assembler.frames.size() == 0) {
+		debug(LOG_ERR, DEBUG_LOG, 0, "no frames received");
+		throw std::length_error("no frames received");
+	}
+	return assembler.frames;
+}
+
+/**
+ * \brief Record all payload packets of subsequent transfers to a file
+ *
+ * The recording can be replayed with the PacketReplay class to analyze
+ * frame assembly without a camera. An empty filename stops recording.
+ */
+void	UVCCamera::recordPackets(const std::string& filename) {
+	packetfile = filename;
+}
+
 /**
  * \brief Get a sequence of frames via a bulk transfer
  *
@@ -739,8 +796,15 @@ std::vector<FramePtr>	UVCCamera::getBulkFrames(uint8_t interface,
 
 	// get the Endpoint for this alternate setting
 	EndpointDescriptorPtr	endpoint = (*ifdescptr)[0];
+	FrameAssembler	assembler(getFramePool(), minframesize());
+	std::unique_ptr<PacketRecorder>	recorder;
+	if (packetfile.size() > 0) {
+		recorder.reset(new PacketRecorder(packetfile, &assembler));
+	}
+	PacketSink	*sink = (recorder) ? (PacketSink *)recorder.get()
+					: (PacketSink *)&assembler;
 	UVCBulkTransfer	transfer(endpoint, nframes, maxpayloadtransfersize,
-		maxvideoframesize);
+		maxvideoframesize, *sink);
 
 	// submit the transfer, submit will return when all the data has
 	// been transferred
@@ -754,9 +818,8 @@ std::vector<FramePtr>	UVCCamera::getBulkFrames(uint8_t interface,
 			x.what());
 	}
 
-	// convert the retrieved data to an image
-	FrameFactory	ff(width, height, bitsPerPixel / 8);
-	return ff(transfer.packets);
+	// return the frames assembled during the transfer
+	return assembledFrames(assembler);
 }
 
 /**
@@ -788,7 +851,15 @@ std::vector<FramePtr>	UVCCamera::getIsoFrames(uint8_t interface,
 
 	// now do the transfer with this alt setting, for this we first have
 	// to decide for how many microframes we want to transfer anything
-	UVCIsochronousTransfer	transfer(endpoint, nframes, frameinterval);
+	FrameAssembler	assembler(getFramePool(), minframesize());
+	std::unique_ptr<PacketRecorder>	recorder;
+	if (packetfile.size() > 0) {
+		recorder.reset(new PacketRecorder(packetfile, &assembler));
+	}
+	PacketSink	*sink = (recorder) ? (PacketSink *)recorder.get()
+					: (PacketSink *)&assembler;
+	UVCIsochronousTransfer	transfer(endpoint, nframes, frameinterval,
+		*sink);
 
 	// submit this transfer to the device
 	try {
@@ -810,9 +881,8 @@ std::vector<FramePtr>	UVCCamera::getIsoFrames(uint8_t interface,
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "release failed: %s", x.what());
 	}
 
-	// convert the retrieved data to an image
-	FrameFactory	ff(width, height, bitsPerPixel / 8);
-	return ff(transfer.packets);
+	// return the frames assembled during the transfer
+	return assembledFrames(assembler);
 }
 
 /**
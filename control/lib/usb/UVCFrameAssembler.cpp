@@ -0,0 +1,121 @@
+/*
+ * UVCFrameAssembler.cpp -- assemble frames from payload packets as they
+ *                          arrive
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroUVC.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+
+namespace astro {
+namespace usb {
+namespace uvc {
+
+#define	UVC_FID	(1 << 0)
+#define	UVC_EOF	(1 << 1)
+#define	UVC_ERR	(1 << 6)
+
+/**
+ * \brief Create a frame assembler
+ *
+ * \param pool		the pool to take the frame buffers from
+ * \param minsize	minimum number of bytes of a complete frame
+ */
+FrameAssembler::FrameAssembler(FramePoolPtr pool, size_t minsize)
+	: _pool(pool), _minsize(minsize), _fid(false), _error(false),
+	  packets(0), bytes(0), ignored(0), errors(0), dropped(0) {
+}
+
+/**
+ * \brief Complete the current frame
+ */
+void	FrameAssembler::finish() {
+	if (!_current) {
+		return;
+	}
+	if ((!_error) && (_current->size() >= _minsize)) {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "adding frame of size %d",
+			_current->size());
+		frames.push_back(_current);
+	} else {
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "dropping frame of size %d%s",
+			_current->size(), (_error) ? " (error)" : "");
+		dropped++;
+	}
+	_current.reset();
+	_error = false;
+}
+
+/**
+ * \brief Process a payload packet
+ *
+ * \param data		packet data including the payload header
+ * \param length	length of the packet
+ */
+void	FrameAssembler::packet(const unsigned char *data, size_t length) {
+	packets++;
+	// the header length must be at least 2 (for the header length and
+	// the header flags) and must fit into the packet
+	if (length < 2) {
+		ignored++;
+		return;
+	}
+	size_t	hle = data[0];
+	if ((hle < 2) || (hle > length)) {
+		ignored++;
+		return;
+	}
+	uint8_t	bfh = data[1];
+	bool	fid = (bfh & UVC_FID) ? true : false;
+
+	// a toggled frame id means the previous frame is complete
+	if (_current && (fid != _fid)) {
+		finish();
+	}
+	_fid = fid;
+
+	// append the payload to the current frame
+	size_t	payloadlength = length - hle;
+	if (payloadlength > 0) {
+		if (!_current) {
+			_current = _pool->get();
+		}
+		_current->append((const char *)data + hle, payloadlength);
+		bytes += payloadlength;
+	}
+	if (bfh & UVC_ERR) {
+		errors++;
+		if (_current) {
+			_error = true;
+		}
+	}
+	if (bfh & UVC_EOF) {
+		finish();
+	}
+}
+
+/**
+ * \brief Complete the frame in progress, if it is large enough
+ *
+ * A frame that is too short at this point was cut off by the end of the
+ * transfer, it is discarded without counting it as dropped.
+ */
+void	FrameAssembler::flush() {
+	if (_current && (_current->size() < _minsize)) {
+		_current.reset();
+		_error = false;
+		return;
+	}
+	finish();
+}
+
+std::string	FrameAssembler::toString() const {
+	return stringprintf("packets=%lu, bytes=%lu, ignored=%lu, errors=%lu, "
+		"frames=%d, dropped=%lu", packets, bytes, ignored, errors,
+		frames.size(), dropped);
+}
+
+} // namespace uvc
+} // namespace usb
+} // namespace astro
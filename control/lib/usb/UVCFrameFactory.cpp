@@ -22,77 +22,24 @@ FrameFactory::FrameFactory(int _width, int _height, int _bytesperpixel)
  */
 std::vector<FramePtr>	FrameFactory::operator()(const std::list<std::string>& packets)
 	const {
-	// prepare a vector of frames that we can later return
-	std::vector<FramePtr>	frames;
-	Frame	*currentframe = new Frame(width, height);
-	int	packetcounter = 0;
-	int	processed = 0;
-	int	framecounter = 0;
-
 	// compute the size of frames that we expect
-	int	minsize = width * height * bytesperpixel;
+	size_t	minsize = width * height * bytesperpixel;
+	FramePoolPtr	pool(new FramePool(width, height, minsize));
+	FrameAssembler	assembler(pool, minsize);
 
 	// go through the packet list and put together all the data
-	bool	fid = false;
 	std::list<std::string>::const_iterator	i;
 	for (i = packets.begin(); i != packets.end(); i++) {
-		try {
-			UVCPayloadPacket	uvcpayload(*i);
-			if (i->length() > 12) {
-				debug(LOG_DEBUG, DEBUG_LOG, 0, "%d: %u, %u, %u, %d",
-					(int)uvcpayload.hle(), 
-					uvcpayload.ptsValue(), 
-					uvcpayload.fid(), 
-					uvcpayload.pts(),
-					i->length() - 12);
-					
-			}
-			if (uvcpayload.fid() == fid) {
-				if (NULL == currentframe) {
-					currentframe = new Frame(width, height);
-				}
-				currentframe->append(uvcpayload.payload());
-			} else {
-				// cast below to make compiler happy
-				if ((currentframe) && ((int)currentframe->size() >= minsize)) {
-					debug(LOG_DEBUG, DEBUG_LOG, 0,
-						"adding frame of size %d",
-						currentframe->size());
-					frames.push_back(FramePtr(currentframe));
-					framecounter++;
-				}
-				currentframe = new Frame(width, height);
-				currentframe->append(uvcpayload.payload());
-				fid = uvcpayload.fid();
-			}
-			processed++;
-		} catch (std::exception& x) {
-			//debug(LOG_DEBUG, DEBUG_LOG, 0, "packet %d ignored: %s",
-			//	packetcounter, x.what());
-		}
-		packetcounter++;
-	}
-	if (currentframe) {
-		delete currentframe;
-	}
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "processed packets: %d, frames: %d",
-		processed, framecounter);
-
-	// show how large the frames are:
-	std::vector<FramePtr>::const_iterator	j;
-	framecounter = 0;
-	for (j = frames.begin(); j != frames.end(); j++, framecounter++) {
-#if 1
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "frame %d: %d bytes",
-			framecounter, (*j)->size());
-#endif
+		assembler.packet((const unsigned char *)i->data(), i->size());
 	}
-	if (framecounter == 0) {
+	assembler.flush();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", assembler.toString().c_str());
+	if (assembler.frames.size() == 0) {
 		throw std::length_error("no frames received");
 	}
 
 	// return all the frames
-	return	frames;
+	return	assembler.frames;
 }
 
 } // namespace uvc
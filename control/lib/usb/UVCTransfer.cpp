@@ -36,12 +36,13 @@ static void uvcbulk_callback(struct libusb_transfer *transfer) {
  * \param endpoint
  * \param _payloadtransfersize
  * \param _maxframesize
+ * \param _sink		sink that receives the payload packets
  */
 UVCBulkTransfer::UVCBulkTransfer(EndpointDescriptorPtr endpoint, int _nframes,
-	size_t _payloadtransfersize, size_t _maxframesize)
+	size_t _payloadtransfersize, size_t _maxframesize, PacketSink& _sink)
 	: Transfer(endpoint),
 	  payloadtransfersize(_payloadtransfersize),
-	  maxframesize(_maxframesize), nframes(_nframes) {
+	  maxframesize(_maxframesize), nframes(_nframes), sink(_sink) {
 	submitted = 0;
 
 	// compute the number of transfers required for all the frames
@@ -113,15 +114,14 @@ void	UVCBulkTransfer::submit(libusb_device_handle *devhandle) {
 /**
  * \brief Callback for UVC bulk transfers
  *
- * The callback just packs the packets into the packet list.
+ * The callback hands the packet to the sink directly from the transfer
+ * buffer, before the buffer is resubmitted.
  */
 void	UVCBulkTransfer::callback(libusb_transfer *transfer) {
 	debug(LOG_DEBUG, DEBUG_LOG, 0,
 		"UVCBulkTransfer callback: %d bytes", transfer->actual_length);
-	if (transfer->actual_length >= 12) {
-		// create a new payload packet from the transferred data
-		packets.push_back(std::string((char *)transfer->buffer,
-			transfer->actual_length));
+	if (transfer->actual_length >= 2) {
+		sink.packet(transfer->buffer, transfer->actual_length);
 	} else {
 		debug(LOG_DEBUG, DEBUG_LOG, 0, "ignoring short packet: %d",
 			transfer->actual_length);
@@ -152,7 +152,8 @@ static void uvcisochronous_callback(struct libusb_transfer *transfer) {
 /**
  * \brief Callback for UVC isochronous transfers
  *
- * The callback just packs the packets into the packet list.
+ * The callback hands all packets to the sink directly from the transfer
+ * buffer, before the buffer is resubmitted.
  * \param transfer	the currently processed transfer
  */
 void	UVCIsochronousTransfer::callback(libusb_transfer *transfer) {
@@ -161,14 +162,17 @@ void	UVCIsochronousTransfer::callback(libusb_transfer *transfer) {
 	for (int i = 0; i < transfer->num_iso_packets; i++) {
 		int	length = transfer->iso_packet_desc[i].actual_length;
 		int	status = transfer->iso_packet_desc[i].status;
-		if ((0 == status) && (length >= 12)) {
-			char	*data = (char *)libusb_get_iso_packet_buffer_simple(transfer, i);
-			// create a new payload packet from the transferred data
-			packets.push_back(std::string(data, length));
+		if ((0 == status) && (length >= 2)) {
+			unsigned char	*data
+				= libusb_get_iso_packet_buffer_simple(transfer, i);
+			sink.packet(data, length);
 
 			// count the data bytes (not frame headers) transferred
-			bytes += length - 12;
-			bytestransferred += length - 12;
+			int	hle = data[0];
+			if (length > hle) {
+				bytes += length - hle;
+				bytestransferred += length - hle;
+			}
 		}
 	}
 
@@ -192,14 +196,15 @@ void	UVCIsochronousTransfer::callback(libusb_transfer *transfer) {
  *
  * 
  * \param endpoint
- * \param _payloadtransfersize
- * \param _maxframesize
+ * \param _nframes
+ * \param _frameinterval
+ * \param _sink		sink that receives the payload packets
  */
 static int	isochunk = 400;
 UVCIsochronousTransfer::UVCIsochronousTransfer(EndpointDescriptorPtr endpoint,
-	int _nframes, int _frameinterval)
+	int _nframes, int _frameinterval, PacketSink& _sink)
 	: Transfer(endpoint), nframes(_nframes),
-	  frameinterval(_frameinterval) {
+	  frameinterval(_frameinterval), sink(_sink) {
 	submitted = 0;
 	bytestransferred = 0;
 	completed = 0;
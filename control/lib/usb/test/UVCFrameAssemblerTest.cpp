@@ -0,0 +1,200 @@
+/*
+ * UVCFrameAssemblerTest.cpp -- tests for frame assembly from payload packets
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroUSB.h>
+#include <AstroUVC.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <config.h>
+#include <AstroDebug.h>
+#include <unistd.h>
+
+using namespace astro::usb;
+using namespace astro::usb::uvc;
+
+namespace astro {
+namespace test {
+
+class UVCFrameAssemblerTest : public CppUnit::TestFixture {
+public:
+	void	setUp() { }
+	void	tearDown() { }
+	void	testAssemble();
+	void	testError();
+	void	testPool();
+	void	testReplay();
+
+	CPPUNIT_TEST_SUITE(UVCFrameAssemblerTest);
+	CPPUNIT_TEST(testAssemble);
+	CPPUNIT_TEST(testError);
+	CPPUNIT_TEST(testPool);
+	CPPUNIT_TEST(testReplay);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+#define	WIDTH	64
+#define	HEIGHT	48
+#define	FRAMESIZE	(WIDTH * HEIGHT * 2)
+#define	PAYLOAD	1000
+
+/**
+ * \brief Create the packets of a synthetic video stream
+ *
+ * Each frame is split into packets with a 12 byte header, the frame id
+ * toggles with each frame, the last packet of a frame has the end of
+ * frame bit set. The payload byte at offset i of frame f is (f + i) % 251.
+ */
+static std::list<std::string>	stream(int nframes, int errorframe = -1) {
+	std::list<std::string>	packets;
+	for (int f = 0; f < nframes; f++) {
+		for (int offset = 0; offset < FRAMESIZE; offset += PAYLOAD) {
+			int	length = std::min(PAYLOAD, FRAMESIZE - offset);
+			std::string	packet(12 + length, '\0');
+			packet[0] = 12;
+			uint8_t	bfh = (f & 1);
+			if (offset + length == FRAMESIZE) {
+				bfh |= 0x02;
+			}
+			if ((f == errorframe) && (offset == 0)) {
+				bfh |= 0x40;
+			}
+			packet[1] = bfh;
+			for (int i = 0; i < length; i++) {
+				packet[12 + i] = (f + offset + i) % 251;
+			}
+			packets.push_back(packet);
+		}
+	}
+	return packets;
+}
+
+static void	feed(PacketSink& sink, const std::list<std::string>& packets) {
+	for (auto i = packets.begin(); i != packets.end(); i++) {
+		sink.packet((const unsigned char *)i->data(), i->size());
+	}
+}
+
+static bool	verify(const Frame& frame) {
+	if (frame.size() != FRAMESIZE) {
+		return false;
+	}
+	int	f = (unsigned char)frame[0];
+	for (int i = 0; i < FRAMESIZE; i++) {
+		if ((unsigned char)frame[i] != (f + i) % 251) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void	UVCFrameAssemblerTest::testAssemble() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testAssemble() begin");
+	FramePoolPtr	pool(new FramePool(WIDTH, HEIGHT, FRAMESIZE));
+	FrameAssembler	assembler(pool, FRAMESIZE);
+	feed(assembler, stream(5));
+	assembler.flush();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", assembler.toString().c_str());
+	CPPUNIT_ASSERT(assembler.frames.size() == 5);
+	CPPUNIT_ASSERT(assembler.dropped == 0);
+	CPPUNIT_ASSERT(assembler.bytes == 5 * FRAMESIZE);
+	for (int f = 0; f < 5; f++) {
+		CPPUNIT_ASSERT(verify(*assembler.frames[f]));
+		CPPUNIT_ASSERT((unsigned char)(*assembler.frames[f])[0] == f);
+	}
+
+	// the frame factory must give the same result
+	FrameFactory	ff(WIDTH, HEIGHT, 2);
+	std::vector<FramePtr>	frames = ff(stream(5));
+	CPPUNIT_ASSERT(frames.size() == 5);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testAssemble() end");
+}
+
+void	UVCFrameAssemblerTest::testError() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testError() begin");
+	FramePoolPtr	pool(new FramePool(WIDTH, HEIGHT, FRAMESIZE));
+	FrameAssembler	assembler(pool, FRAMESIZE);
+	feed(assembler, stream(5, 2));
+	// a packet with an invalid header length must be ignored
+	unsigned char	bad[4] = { 40, 0, 0, 0 };
+	assembler.packet(bad, sizeof(bad));
+	assembler.flush();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", assembler.toString().c_str());
+	CPPUNIT_ASSERT(assembler.frames.size() == 4);
+	CPPUNIT_ASSERT(assembler.dropped == 1);
+	CPPUNIT_ASSERT(assembler.errors == 1);
+	CPPUNIT_ASSERT(assembler.ignored == 1);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testError() end");
+}
+
+void	UVCFrameAssemblerTest::testPool() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPool() begin");
+	FramePoolPtr	pool(new FramePool(WIDTH, HEIGHT, FRAMESIZE));
+	for (int i = 0; i < 3; i++) {
+		FrameAssembler	assembler(pool, FRAMESIZE);
+		feed(assembler, stream(4));
+		assembler.flush();
+		CPPUNIT_ASSERT(assembler.frames.size() == 4);
+	}
+	// after the first round, all frames come from the pool
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "allocated = %lu, reused = %lu",
+		pool->allocated(), pool->reused());
+	CPPUNIT_ASSERT(pool->allocated() == 4);
+	CPPUNIT_ASSERT(pool->reused() == 8);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPool() end");
+}
+
+void	UVCFrameAssemblerTest::testReplay() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testReplay() begin");
+	char	filename[] = "/tmp/uvcpacketsXXXXXX";
+	int	fd = mkstemp(filename);
+	CPPUNIT_ASSERT(fd >= 0);
+	close(fd);
+
+	// record a stream while assembling it
+	FramePoolPtr	pool(new FramePool(WIDTH, HEIGHT, FRAMESIZE));
+	{
+		FrameAssembler	assembler(pool, FRAMESIZE);
+		PacketRecorder	recorder(filename, &assembler);
+		feed(recorder, stream(20));
+		assembler.flush();
+		CPPUNIT_ASSERT(assembler.frames.size() == 20);
+	}
+
+	// replaying without loss must give the same frames
+	PacketReplay	replay(filename);
+	unlink(filename);
+	CPPUNIT_ASSERT(replay.bytes() == 20 * (FRAMESIZE + 12 * 7));
+	{
+		FrameAssembler	assembler(pool, FRAMESIZE);
+		CPPUNIT_ASSERT(replay.replay(assembler) == replay.packets());
+		assembler.flush();
+		CPPUNIT_ASSERT(assembler.frames.size() == 20);
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "%.1f MB/s",
+			replay.bytes() / replay.elapsed() / 1000000.);
+	}
+
+	// with packet loss, damaged frames must be dropped
+	{
+		FrameAssembler	assembler(pool, FRAMESIZE);
+		replay.replay(assembler, 0.05, 4711);
+		assembler.flush();
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "%s",
+			assembler.toString().c_str());
+		CPPUNIT_ASSERT(assembler.frames.size() < 20);
+		CPPUNIT_ASSERT(assembler.frames.size() + assembler.dropped
+			<= 20);
+		for (auto i = assembler.frames.begin();
+			i != assembler.frames.end(); i++) {
+			CPPUNIT_ASSERT(verify(**i));
+		}
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testReplay() end");
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UVCFrameAssemblerTest);
+
+} // namespace test
+} // namespace astro
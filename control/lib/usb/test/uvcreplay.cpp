@@ -0,0 +1,90 @@
+/*
+ * uvcreplay.cpp -- replay recorded UVC payload packets through the frame
+ *                  assembler to measure throughput and frame drops
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroUSB.h>
+#include <AstroUVC.h>
+#include <AstroDebug.h>
+#include <includes.h>
+#include <cstdlib>
+#include <iostream>
+
+using namespace astro::usb;
+using namespace astro::usb::uvc;
+
+static void	usage(const char *progname) {
+	std::cout << "usage: " << progname << " [ -d ] [ -l loss ] "
+		"[ -r repeat ] width height bytesperpixel recording"
+		<< std::endl;
+	std::cout << "replay the payload packets recorded with "
+		"UVC_PACKET_RECORD=<recording>" << std::endl;
+	std::cout << "through the frame assembler" << std::endl;
+	std::cout << " -d         increase debug level" << std::endl;
+	std::cout << " -l loss    drop packets with probability <loss>"
+		<< std::endl;
+	std::cout << " -r repeat  number of times to replay the recording"
+		<< std::endl;
+}
+
+int	main(int argc, char *argv[]) {
+	int	c;
+	double	loss = 0;
+	int	repeat = 10;
+	while (EOF != (c = getopt(argc, argv, "dl:r:h?")))
+		switch (c) {
+		case 'd':
+			debuglevel = LOG_DEBUG;
+			break;
+		case 'l':
+			loss = atof(optarg);
+			break;
+		case 'r':
+			repeat = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	if (4 != (argc - optind)) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	int	width = atoi(argv[optind++]);
+	int	height = atoi(argv[optind++]);
+	int	bytesperpixel = atoi(argv[optind++]);
+	size_t	minsize = width * height * bytesperpixel;
+
+	try {
+		PacketReplay	replay(argv[optind]);
+		FramePoolPtr	pool(new FramePool(width, height, minsize));
+		double	elapsed = 0;
+		unsigned long	frames = 0;
+		unsigned long	dropped = 0;
+		for (int r = 0; r < repeat; r++) {
+			FrameAssembler	assembler(pool, minsize);
+			replay.replay(assembler, loss, r);
+			assembler.flush();
+			elapsed += replay.elapsed();
+			frames += assembler.frames.size();
+			dropped += assembler.dropped;
+			if (0 == r) {
+				std::cout << assembler.toString() << std::endl;
+			}
+		}
+		std::cout << "packets:    " << replay.packets() << std::endl;
+		std::cout << "bytes:      " << replay.bytes() << std::endl;
+		std::cout << "frames:     " << frames << std::endl;
+		std::cout << "dropped:    " << dropped << std::endl;
+		std::cout << "throughput: "
+			<< (repeat * replay.bytes() / elapsed / 1000000.)
+			<< " MB/s" << std::endl;
+		std::cout << "buffers:    " << pool->allocated() << " allocated, "
+			<< pool->reused() << " reused" << std::endl;
+	} catch (std::exception& x) {
+		std::cerr << "replay failed: " << x.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
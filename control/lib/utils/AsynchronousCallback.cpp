@@ -0,0 +1,222 @@
+/*
+ * AsynchronousCallback.cpp -- deliver callbacks from a worker thread
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroCallback.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroUtils.h>
+#include <typeinfo>
+#include <chrono>
+
+namespace astro {
+namespace callback {
+
+CallbackStatistics::CallbackStatistics() : delivered(0), dropped(0),
+	coalesced(0), failed(0), queued(0), maxqueued(0), lag(0), maxlag(0) {
+}
+
+std::string	CallbackStatistics::toString() const {
+	return stringprintf("%s: delivered=%lu, dropped=%lu, coalesced=%lu, "
+		"failed=%lu, queued=%lu (max %lu), lag=%.3fs (max %.3fs)",
+		subscriber.c_str(), delivered, dropped, coalesced, failed,
+		(unsigned long)queued, (unsigned long)maxqueued, lag, maxlag);
+}
+
+/**
+ * \brief Construct an asynchronous dispatcher for a callback
+ *
+ * \param callback	the callback that will process the data
+ * \param capacity	the maximum number of data objects waiting
+ * \param coalesce	whether new data replaces queued data of the same type
+ */
+AsynchronousCallback::AsynchronousCallback(CallbackPtr callback,
+	size_t capacity, bool coalesce)
+	: _callback(callback), _coalesce(coalesce), _queue(capacity),
+	  _head(0), _count(0), _terminate(false), _busy(false) {
+	if (!_callback) {
+		std::string	msg("no callback to dispatch to");
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	if (capacity == 0) {
+		std::string	msg("callback queue capacity must be positive");
+		debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+		throw std::runtime_error(msg);
+	}
+	_statistics.subscriber = demangle(typeid(*_callback).name());
+	_thread = std::thread(main, this);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "asynchronous %s, capacity %lu%s",
+		_statistics.subscriber.c_str(), (unsigned long)capacity,
+		(_coalesce) ? ", coalescing" : "");
+}
+
+AsynchronousCallback::~AsynchronousCallback() {
+	stop();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s",
+		_statistics.toString().c_str());
+}
+
+/**
+ * \brief Stop the worker thread
+ *
+ * Data still waiting in the queue is counted as dropped. A callback
+ * that is being processed is completed before the method returns.
+ */
+void	AsynchronousCallback::stop() {
+	{
+		std::unique_lock<std::mutex>	lock(_mutex);
+		_terminate = true;
+		while (_count > 0) {
+			_queue[_head].data.reset();
+			_head = (_head + 1) % _queue.size();
+			_count--;
+			_statistics.dropped++;
+		}
+		_statistics.queued = 0;
+		_condition.notify_all();
+	}
+	if (_thread.joinable()
+		&& (_thread.get_id() != std::this_thread::get_id())) {
+		_thread.join();
+	}
+}
+
+/**
+ * \brief Queue the data for the worker thread
+ *
+ * This method never blocks on the subscriber. It returns the data
+ * unchanged, as the subscriber's result is not available yet.
+ */
+CallbackDataPtr	AsynchronousCallback::operator()(CallbackDataPtr data) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	if (_terminate) {
+		_statistics.dropped++;
+		return data;
+	}
+
+	// replace queued data of the same type, but keep the time when
+	// the entry was queued, so that the lag is still visible
+	if ((_coalesce) && (data)) {
+		const std::type_info&	type = typeid(*data);
+		for (size_t i = 0; i < _count; i++) {
+			entry&	e = _queue[(_head + i) % _queue.size()];
+			if ((e.data) && (typeid(*e.data) == type)) {
+				e.data = data;
+				_statistics.coalesced++;
+				return data;
+			}
+		}
+	}
+
+	// if the queue is full, the oldest entry has to go
+	if (_count == _queue.size()) {
+		_queue[_head].data.reset();
+		_head = (_head + 1) % _queue.size();
+		_count--;
+		_statistics.dropped++;
+		debug(LOG_DEBUG, DEBUG_LOG, 0, "%s cannot keep up, %lu dropped",
+			_statistics.subscriber.c_str(), _statistics.dropped);
+	}
+	entry&	e = _queue[(_head + _count) % _queue.size()];
+	e.data = data;
+	e.when = Timer::gettime();
+	_count++;
+	_statistics.queued = _count;
+	if (_count > _statistics.maxqueued) {
+		_statistics.maxqueued = _count;
+	}
+	_condition.notify_all();
+	return data;
+}
+
+void	AsynchronousCallback::main(AsynchronousCallback *callback) {
+	callback->run();
+}
+
+/**
+ * \brief Worker thread main function
+ */
+void	AsynchronousCallback::run() {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	while (true) {
+		while ((!_terminate) && (_count == 0)) {
+			_condition.wait(lock);
+		}
+		if (_terminate) {
+			break;
+		}
+		CallbackDataPtr	data = _queue[_head].data;
+		double	when = _queue[_head].when;
+		_queue[_head].data.reset();
+		_head = (_head + 1) % _queue.size();
+		_count--;
+		_statistics.queued = _count;
+		_statistics.lag = Timer::gettime() - when;
+		if (_statistics.lag > _statistics.maxlag) {
+			_statistics.maxlag = _statistics.lag;
+		}
+		_busy = true;
+		lock.unlock();
+
+		// the subscriber runs without the lock, so that the producer
+		// can keep queueing
+		bool	success = false;
+		try {
+			(*_callback)(data);
+			success = true;
+		} catch (const std::exception& x) {
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s failed: %s, cause: %s",
+				_statistics.subscriber.c_str(),
+				demangle(typeid(x).name()).c_str(), x.what());
+		} catch (...) {
+			debug(LOG_ERR, DEBUG_LOG, 0, "%s failed: unknown error",
+				_statistics.subscriber.c_str());
+		}
+		data.reset();
+
+		lock.lock();
+		_busy = false;
+		if (success) {
+			_statistics.delivered++;
+		} else {
+			_statistics.failed++;
+		}
+		_condition.notify_all();
+	}
+}
+
+/**
+ * \brief Get a consistent copy of the delivery statistics
+ */
+CallbackStatistics	AsynchronousCallback::statistics() const {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	return _statistics;
+}
+
+/**
+ * \brief Wait until all queued data has been processed
+ *
+ * \param timeout	maximum time to wait in seconds
+ * \return		true if the queue is empty and the subscriber idle
+ */
+bool	AsynchronousCallback::wait(double timeout) {
+	std::unique_lock<std::mutex>	lock(_mutex);
+	std::chrono::steady_clock::time_point	deadline
+		= std::chrono::steady_clock::now()
+		+ std::chrono::microseconds((long)(timeout * 1000000));
+	while ((_count > 0) || (_busy)) {
+		if (_terminate) {
+			return false;
+		}
+		if (std::cv_status::timeout
+			== _condition.wait_until(lock, deadline)) {
+			return (_count == 0) && (!_busy);
+		}
+	}
+	return true;
+}
+
+} // namespace callback
+} // namespace astro
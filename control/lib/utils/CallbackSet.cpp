@@ -58,5 +58,20 @@ CallbackDataPtr	CallbackSet::operator()(CallbackDataPtr data) {
 	return data;
 }
 
+/**
+ * \brief Collect the statistics of all asynchronous subscribers
+ */
+std::vector<CallbackStatistics>	CallbackSet::statistics() const {
+	std::vector<CallbackStatistics>	result;
+	for (const_iterator i = begin(); i != end(); i++) {
+		AsynchronousCallbackPtr	a
+			= std::dynamic_pointer_cast<AsynchronousCallback>(*i);
+		if (a) {
+			result.push_back(a->statistics());
+		}
+	}
+	return result;
+}
+
 } // namespace callback
 } // namespace astro
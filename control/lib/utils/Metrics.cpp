@@ -0,0 +1,250 @@
+/*
+ * Metrics.cpp -- counters, gauges and latency histograms
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroMetrics.h>
+#include <AstroFormat.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace astro {
+namespace metrics {
+
+//////////////////////////////////////////////////////////////////////
+// Histogram implementation
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Upper bound of a bucket in seconds
+ */
+double	Histogram::upperbound(int bucket) {
+	return (double)((uint64_t)1 << bucket) / 1000000.;
+}
+
+Histogram::Histogram(const std::string& name) : _name(name) {
+	reset();
+}
+
+/**
+ * \brief Record a duration
+ *
+ * The bucket is the smallest k such that the duration in microseconds
+ * does not exceed 2^k, the last bucket also takes all longer durations.
+ */
+void	Histogram::record(double seconds) {
+	uint64_t	us = (seconds > 0) ? (uint64_t)(seconds * 1000000.) : 0;
+	int	bucket = 0;
+	if (us > 1) {
+		bucket = 64 - __builtin_clzll(us - 1);
+		if (bucket >= nbuckets) {
+			bucket = nbuckets - 1;
+		}
+	}
+	_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_sum.fetch_add(us, std::memory_order_relaxed);
+	uint64_t	m = _max.load(std::memory_order_relaxed);
+	while ((us > m) && !_max.compare_exchange_weak(m, us,
+		std::memory_order_relaxed)) { }
+}
+
+double	Histogram::sum() const {
+	return _sum.load(std::memory_order_relaxed) / 1000000.;
+}
+
+double	Histogram::max() const {
+	return _max.load(std::memory_order_relaxed) / 1000000.;
+}
+
+/**
+ * \brief Estimate a quantile from the buckets
+ *
+ * The result is the upper bound of the bucket containing the quantile,
+ * but never more than the largest duration recorded.
+ */
+double	Histogram::quantile(double q) const {
+	uint64_t	n = count();
+	if (n == 0) {
+		return 0;
+	}
+	uint64_t	limit = (uint64_t)(q * n);
+	if (limit >= n) {
+		limit = n - 1;
+	}
+	uint64_t	cumulative = 0;
+	for (int bucket = 0; bucket < nbuckets; bucket++) {
+		cumulative += _buckets[bucket].load(std::memory_order_relaxed);
+		if (cumulative > limit) {
+			double	u = upperbound(bucket);
+			return (u < max()) ? u : max();
+		}
+	}
+	return max();
+}
+
+void	Histogram::reset() {
+	for (int bucket = 0; bucket < nbuckets; bucket++) {
+		_buckets[bucket].store(0, std::memory_order_relaxed);
+	}
+	_count.store(0, std::memory_order_relaxed);
+	_sum.store(0, std::memory_order_relaxed);
+	_max.store(0, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Snapshot values
+//////////////////////////////////////////////////////////////////////
+
+std::string	MetricValue::type2string(metric_type t) {
+	switch (t) {
+	case counter:	return std::string("counter");
+	case gauge:	return std::string("gauge");
+	case histogram:	return std::string("histogram");
+	}
+	throw std::runtime_error("unknown metric type");
+}
+
+MetricValue::MetricValue() : type(counter), count(0), value(0), mean(0),
+	p50(0), p90(0), p99(0), max(0) {
+}
+
+std::string	MetricValue::toString() const {
+	switch (type) {
+	case counter:
+		return stringprintf("%-9s %-40s %lu", "counter", name.c_str(),
+			(unsigned long)count);
+	case gauge:
+		return stringprintf("%-9s %-40s %.0f", "gauge", name.c_str(),
+			value);
+	case histogram:
+		break;
+	}
+	return stringprintf("%-9s %-40s count=%lu mean=%.3fms p50=%.3fms "
+		"p90=%.3fms p99=%.3fms max=%.3fms", "histogram", name.c_str(),
+		(unsigned long)count, 1000 * mean, 1000 * p50, 1000 * p90,
+		1000 * p99, 1000 * max);
+}
+
+std::string	MetricsSnapshot::toString() const {
+	std::string	result;
+	for (auto ptr = begin(); ptr != end(); ptr++) {
+		result += ptr->toString() + "\n";
+	}
+	return result;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Registry
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Container for all metrics
+ *
+ * The registry is never destroyed, because hot paths keep references
+ * to metrics in static variables that may be used during process exit.
+ */
+class MetricsRegistry {
+public:
+	std::mutex	mutex;
+	std::map<std::string, std::unique_ptr<Counter> >	counters;
+	std::map<std::string, std::unique_ptr<Gauge> >	gauges;
+	std::map<std::string, std::unique_ptr<Histogram> >	histograms;
+	static MetricsRegistry&	get() {
+		static MetricsRegistry	*registry = new MetricsRegistry();
+		return *registry;
+	}
+};
+
+template<typename M>
+static M&	lookup(std::map<std::string, std::unique_ptr<M> >& metrics,
+			const std::string& name) {
+	auto	i = metrics.find(name);
+	if (i == metrics.end()) {
+		i = metrics.insert(std::make_pair(name,
+			std::unique_ptr<M>(new M(name)))).first;
+	}
+	return *(i->second);
+}
+
+Counter&	Metrics::counter(const std::string& name) {
+	MetricsRegistry&	registry = MetricsRegistry::get();
+	std::unique_lock<std::mutex>	lock(registry.mutex);
+	return lookup(registry.counters, name);
+}
+
+Gauge&	Metrics::gauge(const std::string& name) {
+	MetricsRegistry&	registry = MetricsRegistry::get();
+	std::unique_lock<std::mutex>	lock(registry.mutex);
+	return lookup(registry.gauges, name);
+}
+
+Histogram&	Metrics::histogram(const std::string& name) {
+	MetricsRegistry&	registry = MetricsRegistry::get();
+	std::unique_lock<std::mutex>	lock(registry.mutex);
+	return lookup(registry.histograms, name);
+}
+
+/**
+ * \brief Get the current values of all metrics, sorted by type and name
+ */
+MetricsSnapshot	Metrics::snapshot() {
+	MetricsRegistry&	registry = MetricsRegistry::get();
+	std::unique_lock<std::mutex>	lock(registry.mutex);
+	MetricsSnapshot	result;
+	for (auto& c : registry.counters) {
+		MetricValue	v;
+		v.name = c.first;
+		v.type = MetricValue::counter;
+		v.count = c.second->value();
+		v.value = v.count;
+		result.push_back(v);
+	}
+	for (auto& g : registry.gauges) {
+		MetricValue	v;
+		v.name = g.first;
+		v.type = MetricValue::gauge;
+		v.value = g.second->value();
+		result.push_back(v);
+	}
+	for (auto& h : registry.histograms) {
+		MetricValue	v;
+		v.name = h.first;
+		v.type = MetricValue::histogram;
+		v.count = h.second->count();
+		v.value = h.second->sum();
+		v.mean = (v.count > 0) ? (v.value / v.count) : 0;
+		v.p50 = h.second->quantile(0.5);
+		v.p90 = h.second->quantile(0.9);
+		v.p99 = h.second->quantile(0.99);
+		v.max = h.second->max();
+		result.push_back(v);
+	}
+	return result;
+}
+
+/**
+ * \brief Text dump of all metrics, one line per metric
+ */
+std::string	Metrics::dump() {
+	return snapshot().toString();
+}
+
+/**
+ * \brief Reset counters and histograms, gauges keep their value
+ */
+void	Metrics::reset() {
+	MetricsRegistry&	registry = MetricsRegistry::get();
+	std::unique_lock<std::mutex>	lock(registry.mutex);
+	for (auto& c : registry.counters) {
+		c.second->reset();
+	}
+	for (auto& h : registry.histograms) {
+		h.second->reset();
+	}
+}
+
+} // namespace metrics
+} // namespace astro
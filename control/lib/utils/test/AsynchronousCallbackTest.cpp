@@ -0,0 +1,180 @@
+/*
+ * AsynchronousCallbackTest.cpp -- test the asynchronous callback dispatcher
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <AstroDebug.h>
+#include <AstroCallback.h>
+#include <AstroUtils.h>
+
+using namespace astro::callback;
+
+namespace astro {
+namespace test {
+
+class CountData : public CallbackData {
+public:
+	int	value;
+	CountData(int v) : value(v) { }
+};
+
+class OtherData : public CallbackData {
+};
+
+/**
+ * \brief Callback that remembers the values it sees, slowly if requested
+ */
+class SlowCallback : public Callback {
+	double	_delay;
+	std::mutex	_mutex;
+	std::vector<int>	_values;
+public:
+	SlowCallback(double delay) : _delay(delay) { }
+	std::vector<int>	values() {
+		std::unique_lock<std::mutex>	lock(_mutex);
+		return _values;
+	}
+	virtual CallbackDataPtr	operator()(CallbackDataPtr data) {
+		Timer::sleep(_delay);
+		CountData	*c = dynamic_cast<CountData *>(&*data);
+		if (NULL == c) {
+			throw std::runtime_error("not a count");
+		}
+		std::unique_lock<std::mutex>	lock(_mutex);
+		_values.push_back(c->value);
+		return data;
+	}
+};
+
+class AsynchronousCallbackTest: public CppUnit::TestFixture {
+public:
+	void	setUp();
+	void	tearDown();
+	void	testOrder();
+	void	testDrop();
+	void	testCoalesce();
+	void	testFailure();
+	void	testPool();
+
+	CPPUNIT_TEST_SUITE(AsynchronousCallbackTest);
+	CPPUNIT_TEST(testOrder);
+	CPPUNIT_TEST(testDrop);
+	CPPUNIT_TEST(testCoalesce);
+	CPPUNIT_TEST(testFailure);
+	CPPUNIT_TEST(testPool);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AsynchronousCallbackTest);
+
+void	AsynchronousCallbackTest::setUp() {
+}
+
+void	AsynchronousCallbackTest::tearDown() {
+}
+
+void	AsynchronousCallbackTest::testOrder() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testOrder() begin");
+	std::shared_ptr<SlowCallback>	slow(new SlowCallback(0));
+	AsynchronousCallback	async(slow, 100);
+	for (int i = 0; i < 50; i++) {
+		async(CallbackDataPtr(new CountData(i)));
+	}
+	CPPUNIT_ASSERT(async.wait(10));
+	std::vector<int>	values = slow->values();
+	CPPUNIT_ASSERT(values.size() == 50);
+	for (int i = 0; i < 50; i++) {
+		CPPUNIT_ASSERT(values[i] == i);
+	}
+	CallbackStatistics	s = async.statistics();
+	CPPUNIT_ASSERT(s.delivered == 50);
+	CPPUNIT_ASSERT(s.dropped == 0);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", s.toString().c_str());
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testOrder() end");
+}
+
+void	AsynchronousCallbackTest::testDrop() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testDrop() begin");
+	std::shared_ptr<SlowCallback>	slow(new SlowCallback(0.05));
+	AsynchronousCallback	async(slow, 3);
+	// queueing must not wait for the slow subscriber
+	Timer	timer;
+	timer.start();
+	for (int i = 0; i < 20; i++) {
+		async(CallbackDataPtr(new CountData(i)));
+	}
+	timer.end();
+	CPPUNIT_ASSERT(timer.elapsed() < 0.05);
+	CPPUNIT_ASSERT(async.wait(10));
+	CallbackStatistics	s = async.statistics();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", s.toString().c_str());
+	CPPUNIT_ASSERT(s.delivered + s.dropped == 20);
+	CPPUNIT_ASSERT(s.dropped >= 16);
+	CPPUNIT_ASSERT(s.maxqueued == 3);
+	// the newest values survive
+	std::vector<int>	values = slow->values();
+	CPPUNIT_ASSERT(values.back() == 19);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testDrop() end");
+}
+
+void	AsynchronousCallbackTest::testCoalesce() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testCoalesce() begin");
+	std::shared_ptr<SlowCallback>	slow(new SlowCallback(0.05));
+	AsynchronousCallback	async(slow, 2, true);
+	for (int i = 0; i < 20; i++) {
+		async(CallbackDataPtr(new CountData(i)));
+	}
+	CPPUNIT_ASSERT(async.wait(10));
+	CallbackStatistics	s = async.statistics();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%s", s.toString().c_str());
+	CPPUNIT_ASSERT(s.dropped == 0);
+	CPPUNIT_ASSERT(s.delivered + s.coalesced == 20);
+	CPPUNIT_ASSERT(s.delivered <= 2);
+	CPPUNIT_ASSERT(s.maxqueued == 1);
+	CPPUNIT_ASSERT(slow->values().back() == 19);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testCoalesce() end");
+}
+
+void	AsynchronousCallbackTest::testFailure() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testFailure() begin");
+	std::shared_ptr<SlowCallback>	slow(new SlowCallback(0));
+	CallbackSet	set;
+	set.insert(CallbackPtr(new AsynchronousCallback(slow, 10)));
+	set(CallbackDataPtr(new OtherData()));
+	set(CallbackDataPtr(new CountData(7)));
+	AsynchronousCallbackPtr	async
+		= std::dynamic_pointer_cast<AsynchronousCallback>(*set.begin());
+	CPPUNIT_ASSERT(async->wait(10));
+	std::vector<CallbackStatistics>	s = set.statistics();
+	CPPUNIT_ASSERT(s.size() == 1);
+	CPPUNIT_ASSERT(s[0].failed == 1);
+	CPPUNIT_ASSERT(s[0].delivered == 1);
+	CPPUNIT_ASSERT(slow->values().size() == 1);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testFailure() end");
+}
+
+void	AsynchronousCallbackTest::testPool() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPool() begin");
+	CallbackDataPool<CountData>	pool(2, CountData(0));
+	std::shared_ptr<CountData>	a = pool.get(CountData(1));
+	std::shared_ptr<CountData>	b = pool.get(CountData(2));
+	CPPUNIT_ASSERT(pool.misses() == 0);
+	// both pool objects are in use, so a new one has to be allocated
+	std::shared_ptr<CountData>	c = pool.get(CountData(3));
+	CPPUNIT_ASSERT(pool.misses() == 1);
+	CPPUNIT_ASSERT(a->value == 1);
+	CountData	*p = &*a;
+	a.reset();
+	std::shared_ptr<CountData>	d = pool.get(CountData(4));
+	CPPUNIT_ASSERT(&*d == p);
+	CPPUNIT_ASSERT(d->value == 4);
+	CPPUNIT_ASSERT(b->value == 2);
+	CPPUNIT_ASSERT(pool.misses() == 1);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testPool() end");
+}
+
+} // namespace test
+} // namespace astro
@@ -0,0 +1,121 @@
+/*
+ * MetricsTest.cpp -- test counters, gauges and histograms
+ *
+ * (c) 2017 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <AstroDebug.h>
+#include <AstroMetrics.h>
+#include <cmath>
+#include <thread>
+
+using namespace astro::metrics;
+
+namespace astro {
+namespace test {
+
+class MetricsTest: public CppUnit::TestFixture {
+public:
+	void	setUp();
+	void	tearDown();
+	void	testCounter();
+	void	testGauge();
+	void	testHistogram();
+	void	testSnapshot();
+
+	CPPUNIT_TEST_SUITE(MetricsTest);
+	CPPUNIT_TEST(testCounter);
+	CPPUNIT_TEST(testGauge);
+	CPPUNIT_TEST(testHistogram);
+	CPPUNIT_TEST(testSnapshot);
+	CPPUNIT_TEST_SUITE_END();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MetricsTest);
+
+void	MetricsTest::setUp() {
+}
+
+void	MetricsTest::tearDown() {
+}
+
+void	MetricsTest::testCounter() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testCounter() begin");
+	Counter&	c = Metrics::counter("test.counter");
+	CPPUNIT_ASSERT(&c == &Metrics::counter("test.counter"));
+	c.reset();
+	std::vector<std::thread>	threads;
+	for (int t = 0; t < 4; t++) {
+		threads.push_back(std::thread([&c]() {
+			for (int i = 0; i < 10000; i++) {
+				c.increment();
+			}
+		}));
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+	CPPUNIT_ASSERT(c.value() == 40000);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testCounter() end");
+}
+
+void	MetricsTest::testGauge() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testGauge() begin");
+	Gauge&	g = Metrics::gauge("test.gauge");
+	g.set(10);
+	g.add(-3);
+	CPPUNIT_ASSERT(g.value() == 7);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testGauge() end");
+}
+
+void	MetricsTest::testHistogram() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testHistogram() begin");
+	Histogram&	h = Metrics::histogram("test.histogram");
+	h.reset();
+	// 90 durations of 1ms, 10 durations of 100ms
+	for (int i = 0; i < 90; i++) {
+		h.record(0.001);
+	}
+	for (int i = 0; i < 10; i++) {
+		h.record(0.1);
+	}
+	CPPUNIT_ASSERT(h.count() == 100);
+	CPPUNIT_ASSERT(fabs(h.sum() - 1.09) < 1e-6);
+	CPPUNIT_ASSERT(fabs(h.max() - 0.1) < 1e-6);
+	// quantiles are bucket bounds, i.e. accurate to a factor of 2
+	double	p50 = h.quantile(0.5);
+	CPPUNIT_ASSERT((p50 >= 0.001) && (p50 < 0.002));
+	double	p99 = h.quantile(0.99);
+	CPPUNIT_ASSERT(fabs(p99 - 0.1) < 1e-6);
+	{
+		ScopedTimer	timer(h);
+	}
+	CPPUNIT_ASSERT(h.count() == 101);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testHistogram() end");
+}
+
+void	MetricsTest::testSnapshot() {
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSnapshot() begin");
+	Metrics::counter("test.snapshot").increment(5);
+	MetricsSnapshot	snapshot = Metrics::snapshot();
+	bool	found = false;
+	for (auto& v : snapshot) {
+		if (v.name == "test.snapshot") {
+			CPPUNIT_ASSERT(v.type == MetricValue::counter);
+			CPPUNIT_ASSERT(v.count == 5);
+			found = true;
+		}
+	}
+	CPPUNIT_ASSERT(found);
+	std::string	dump = Metrics::dump();
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "metrics:\n%s", dump.c_str());
+	CPPUNIT_ASSERT(dump.find("test.snapshot") != std::string::npos);
+	Metrics::reset();
+	CPPUNIT_ASSERT(Metrics::counter("test.snapshot").value() == 0);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "testSnapshot() end");
+}
+
+} // namespace test
+} // namespace astro
@@ -0,0 +1,178 @@
+/*
+ * buildindex.cpp -- utility to build a tiled star index
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroCatalog.h>
+#include <AstroFormat.h>
+#include "../lib/catalogs/StarIndex.h"
+#include "../lib/catalogs/CutoverConditions.h"
+#include <includes.h>
+#include <iostream>
+#include <AstroUtils.h>
+
+using namespace astro::catalog;
+
+namespace astro {
+namespace app {
+namespace buildindex {
+
+static void	addfromcatalog(IndexBackendCreator& index, CatalogPtr catalog,
+			CutoverCondition& condition, int loginterval) {
+	int	counter = 0;
+	int	steps = 0;
+	CatalogIterator	i;
+	for (i = catalog->begin(); i != catalog->end(); ++i) {
+		steps++;
+		try {
+			Star	s = *i;
+			if (condition(s)) {
+				index.add(s);
+				counter++;
+				if (0 == (counter % loginterval)) {
+					debug(LOG_DEBUG, DEBUG_LOG, 0,
+						"%d stars added from %s,"
+						" %d skipped",
+						counter,
+						catalog->name().c_str(),
+						steps - counter);
+				}
+			}
+		} catch (const std::exception& x) {
+		}
+	}
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "%d stars added from %s, %s",
+		counter, catalog->name().c_str(), condition.toString().c_str());
+}
+
+static struct option	longopts[] = {
+{ "all",	required_argument,	NULL,		'a' }, /* 0 */
+{ "bsc",	required_argument,	NULL,		'B' }, /* 1 */
+{ "debug",	no_argument,		NULL,		'd' }, /* 2 */
+{ "help",	no_argument,		NULL,		'h' }, /* 3 */
+{ "hipparcos",	required_argument,	NULL,		'H' }, /* 4 */
+{ "tycho2",	required_argument,	NULL,		'T' }, /* 5 */
+{ "ucac4",	required_argument,	NULL,		'U' }, /* 6 */
+{ "zone",	required_argument,	NULL,		'z' }, /* 7 */
+{ NULL,		0,			NULL,		0   }
+};
+
+static void	usage(const char *progname) {
+	std::cout << "merges stars from the specified catalogs into a tiled "
+		"star index" << std::endl;
+	std::cout << "usage: " << std::endl;
+	std::cout << "    " << progname << " [ options ] indexfile" << std::endl;
+	std::cout << "options:" << std::endl;
+	std::cout << " -d,--debug            increase debug level" << std::endl;
+	std::cout << " -h,-?,--help          display this help message";
+	std::cout << std::endl;
+	std::cout << " -a,--all=dir          base directory for all catalogs";
+	std::cout << std::endl;
+	std::cout << " -B,--bsc=dir          Bright Star Catalog directory";
+	std::cout << std::endl;
+	std::cout << " -H,--hipparcos=dir    Hipparcos catalog directory";
+	std::cout << std::endl;
+	std::cout << " -T,--tycho2=dir       Tycho2 catalog directory";
+	std::cout << std::endl;
+	std::cout << " -U,--ucac4=dir        Ucac4 catalog directory";
+	std::cout << std::endl;
+	std::cout << " -z,--zone=<deg>       height of the declination zones "
+		"in degrees (default 1)";
+	std::cout << std::endl;
+}
+
+int	main(int argc, char *argv[]) {
+	int	c;
+	int	longindex;
+	std::string	bscdir;
+	std::string	hipparcosfile;
+	std::string	tycho2file;
+	std::string	ucac4dir;
+	double	zoneheight = 1;
+	while (EOF != (c = getopt_long(argc, argv, "a:B:dhH:T:U:z:?", longopts,
+		&longindex)))
+		switch (c) {
+		case 'a':
+			bscdir = std::string(optarg) + "/bsc";
+			hipparcosfile = std::string(optarg) + "/hipparcos";
+			tycho2file = std::string(optarg) + "/tycho2";
+			ucac4dir = std::string(optarg) + "/u4";
+			break;
+		case 'B':
+			bscdir = std::string(optarg);
+			break;
+		case 'd':
+			debuglevel = LOG_DEBUG;
+			break;
+		case 'h':
+		case '?':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		case 'H':
+			hipparcosfile = std::string(optarg);
+			break;
+		case 'T':
+			tycho2file = std::string(optarg);
+			break;
+		case 'U':
+			ucac4dir = std::string(optarg);
+			break;
+		case 'z':
+			zoneheight = std::stod(optarg);
+			break;
+		default:
+			throw std::runtime_error("unknown option");
+		}
+
+	// the remaining argument is the index file name
+	if (optind >= argc) {
+		throw std::runtime_error("index filename argument missing");
+	}
+	std::string	indexfilename(argv[optind++]);
+
+	// collect the stars from all catalogs with the same cutover
+	// conditions as the database catalog
+	IndexBackendCreator	index(indexfilename,
+					Angle::degrees_to_radians(zoneheight));
+	if (bscdir.size()) {
+		CatalogPtr	catalog
+			= CatalogFactory::get(CatalogFactory::BSC, bscdir);
+		BSCCondition	condition(CutoverCondition::unlimited);
+		addfromcatalog(index, catalog, condition, 100000);
+	}
+	if (hipparcosfile.size()) {
+		CatalogPtr	catalog
+			= CatalogFactory::get(CatalogFactory::Hipparcos,
+				hipparcosfile);
+		HipparcosCondition	condition;
+		addfromcatalog(index, catalog, condition, 10000);
+	}
+	if (tycho2file.size()) {
+		CatalogPtr	catalog
+			= CatalogFactory::get(CatalogFactory::Tycho2,
+				tycho2file);
+		Tycho2Condition	condition;
+		addfromcatalog(index, catalog, condition, 100000);
+	}
+	if (ucac4dir.size()) {
+		CatalogPtr	catalog
+			= CatalogFactory::get(CatalogFactory::Ucac4,
+				ucac4dir);
+		Ucac4Condition	condition;
+		addfromcatalog(index, catalog, condition, 1000000);
+	}
+
+	// sort the tiles and write the index
+	index.finalize();
+	std::cout << index.count() << " stars written to " << indexfilename
+		<< std::endl;
+	return EXIT_SUCCESS;
+}
+
+} // namespace buildindex
+} // namespace app
+} // namespace astro
+
+int	main(int argc, char *argv[]) {
+	return astro::main_function<astro::app::buildindex::main>(argc, argv);
+}
@@ -0,0 +1,213 @@
+/*
+ * platesolve.cpp -- build plate solver indices and solve images
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <AstroCatalog.h>
+#include <AstroSolver.h>
+#include <AstroFormat.h>
+#include <AstroDebug.h>
+#include <AstroIO.h>
+#include <includes.h>
+#include <iostream>
+#include <AstroUtils.h>
+
+using namespace astro::catalog;
+using namespace astro::io;
+
+namespace astro {
+namespace app {
+namespace platesolve {
+
+#define	ARCSEC	(M_PI / (180 * 3600))
+
+static double	magnitude = 10;
+static double	quadsize = 2;
+static int	starspertile = 10;
+static int	numberofstars = 30;
+static double	minscale = 0;
+static double	maxscale = 0;
+
+static CatalogFactory::BackendType	gettype(const std::string& type) {
+	if (type == "BSC") {
+		return CatalogFactory::BSC;
+	}
+	if (type == "Hipparcos") {
+		return CatalogFactory::Hipparcos;
+	}
+	if (type == "Tycho2") {
+		return CatalogFactory::Tycho2;
+	}
+	if (type == "Ucac4") {
+		return CatalogFactory::Ucac4;
+	}
+	if (type == "Combined") {
+		return CatalogFactory::Combined;
+	}
+	if (type == "Database") {
+		return CatalogFactory::Database;
+	}
+	if (type == "Index") {
+		return CatalogFactory::Index;
+	}
+	std::string	msg = stringprintf("'%s' is not a known backend type",
+		type.c_str());
+	debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+	throw std::runtime_error(msg);
+}
+
+/**
+ * \brief Build a solver index from a catalog
+ */
+static int	build(const std::string& type, const std::string& path,
+			const std::string& indexfilename) {
+	CatalogPtr	catalog = CatalogFactory::get(gettype(type), path);
+	StarTablePtr	stars = catalog->findTable(SkyWindow::all,
+				MagnitudeRange(-30, magnitude));
+	std::cout << stars->size() << " stars up to magnitude " << magnitude
+		<< std::endl;
+	SolverIndex	index(*stars, quadsize * M_PI / 180, starspertile);
+	index.save(indexfilename);
+	std::cout << index.numberOfStars() << " stars and "
+		<< index.numberOfQuads() << " quads written to "
+		<< indexfilename << std::endl;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * \brief Solve an image, and optionally write it with the WCS keywords
+ */
+static int	solve(const std::string& indexfilename,
+			const std::string& imagefilename,
+			const std::string& outfilename) {
+	SolverIndexPtr	index = SolverIndex::get(indexfilename);
+	FITSin	in(imagefilename);
+	ImagePtr	image = in.read();
+	PlateSolver	solver(index);
+	solver.numberofstars(numberofstars);
+	if (maxscale > 0) {
+		solver.scalerange(minscale * ARCSEC, maxscale * ARCSEC);
+	}
+	WCS	wcs = solver(image);
+	std::cout << wcs.toString() << std::endl;
+	if (outfilename.size()) {
+		wcs.addMetadata(*image);
+		FITSout	out(outfilename);
+		out.setPrecious(false);
+		out.write(image);
+	}
+	return EXIT_SUCCESS;
+}
+
+static struct option	longopts[] = {
+{ "debug",	no_argument,		NULL,		'd' }, /* 0 */
+{ "help",	no_argument,		NULL,		'h' }, /* 1 */
+{ "magnitude",	required_argument,	NULL,		'm' }, /* 2 */
+{ "number",	required_argument,	NULL,		'n' }, /* 3 */
+{ "quadsize",	required_argument,	NULL,		'q' }, /* 4 */
+{ "stars",	required_argument,	NULL,		's' }, /* 5 */
+{ "minscale",	required_argument,	NULL,		'l' }, /* 6 */
+{ "maxscale",	required_argument,	NULL,		'u' }, /* 7 */
+{ NULL,		0,			NULL,		0   }
+};
+
+static void	usage(const char *progname) {
+	std::cout << "usage:" << std::endl;
+	std::cout << "    " << progname
+		<< " [ options ] build <type> <catalog> <indexfile>"
+		<< std::endl;
+	std::cout << "    " << progname
+		<< " [ options ] solve <indexfile> <image> [ <outimage> ]"
+		<< std::endl;
+	std::cout << "build a quad index from a star catalog, or find the "
+		"sky coordinates of an image" << std::endl;
+	std::cout << "options:" << std::endl;
+	std::cout << " -d,--debug            increase debug level" << std::endl;
+	std::cout << " -h,-?,--help          display this help message";
+	std::cout << std::endl;
+	std::cout << " -m,--magnitude=<m>    limiting magnitude for the index "
+		"(default 10)" << std::endl;
+	std::cout << " -q,--quadsize=<deg>   maximum quad size of the index, "
+		"somewhat smaller than" << std::endl;
+	std::cout << "                       the field of view (default 2)"
+		<< std::endl;
+	std::cout << " -s,--stars=<n>        stars kept per index tile "
+		"(default 10)" << std::endl;
+	std::cout << " -n,--number=<n>       number of image stars to use "
+		"(default 30)" << std::endl;
+	std::cout << " -l,--minscale=<s>     minimum pixel scale in arc "
+		"seconds" << std::endl;
+	std::cout << " -u,--maxscale=<s>     maximum pixel scale in arc "
+		"seconds" << std::endl;
+}
+
+int	main(int argc, char *argv[]) {
+	int	c;
+	int	longindex;
+	while (EOF != (c = getopt_long(argc, argv, "dhl:m:n:q:s:u:?", longopts,
+		&longindex)))
+		switch (c) {
+		case 'd':
+			debuglevel = LOG_DEBUG;
+			break;
+		case 'h':
+		case '?':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		case 'l':
+			minscale = std::stod(optarg);
+			break;
+		case 'm':
+			magnitude = std::stod(optarg);
+			break;
+		case 'n':
+			numberofstars = std::stoi(optarg);
+			break;
+		case 'q':
+			quadsize = std::stod(optarg);
+			break;
+		case 's':
+			starspertile = std::stoi(optarg);
+			break;
+		case 'u':
+			maxscale = std::stod(optarg);
+			break;
+		default:
+			throw std::runtime_error("unknown option");
+		}
+
+	if (optind >= argc) {
+		throw std::runtime_error("command missing");
+	}
+	std::string	command(argv[optind++]);
+	if (command == "build") {
+		if (argc - optind != 3) {
+			throw std::runtime_error("build needs type, catalog "
+				"and index file arguments");
+		}
+		return build(argv[optind], argv[optind + 1], argv[optind + 2]);
+	}
+	if (command == "solve") {
+		if ((argc - optind < 2) || (argc - optind > 3)) {
+			throw std::runtime_error("solve needs index file and "
+				"image arguments");
+		}
+		std::string	outfilename;
+		if (argc - optind == 3) {
+			outfilename = argv[optind + 2];
+		}
+		return solve(argv[optind], argv[optind + 1], outfilename);
+	}
+	std::string	msg = stringprintf("unknown command '%s'",
+		command.c_str());
+	debug(LOG_ERR, DEBUG_LOG, 0, "%s", msg.c_str());
+	throw std::runtime_error(msg);
+}
+
+} // namespace platesolve
+} // namespace app
+} // namespace astro
+
+int	main(int argc, char *argv[]) {
+	return astro::main_function<astro::app::platesolve::main>(argc, argv);
+}
@@ -0,0 +1,200 @@
+/*
+ * fitscompress.cpp -- benchmark FITS tile compression methods
+ *
+ * (c) 2016 Prof Dr Andreas Mueller, Hochschule Rapperswil
+ */
+#include <includes.h>
+#include <AstroDebug.h>
+#include <AstroFormat.h>
+#include <AstroUtils.h>
+#include <AstroIO.h>
+#include <iostream>
+#include <vector>
+
+using namespace astro;
+using namespace astro::io;
+
+namespace astro {
+namespace app {
+namespace fitscompress {
+
+static struct option	longopts[] = {
+/* name		argument?		int*		int */
+{ "debug",	no_argument,		NULL,		'd' }, /* 0 */
+{ "help",	no_argument,		NULL,		'h' }, /* 1 */
+{ "method",	required_argument,	NULL,		'm' }, /* 2 */
+{ "repeat",	required_argument,	NULL,		'r' }, /* 3 */
+{ "tmpdir",	required_argument,	NULL,		't' }, /* 4 */
+{ NULL,		0,			NULL,		 0  }
+};
+
+/**
+ * \brief usage
+ */
+static void	usage(const char *progname) {
+	Path	p(progname);
+	std::cout << "usage:" << std::endl;
+	std::cout << std::endl;
+	std::cout << "    " << p.basename() << " [ options ] image.fits ..."
+		<< std::endl;
+	std::cout << std::endl;
+	std::cout << "Write each image with different FITS tile compression "
+		"methods and report" << std::endl;
+	std::cout << "the compression ratio and the encode/decode speed in "
+		"MB/s of raw pixel data." << std::endl;
+	std::cout << std::endl;
+	std::cout << "options:" << std::endl;
+	std::cout << std::endl;
+	std::cout << "  -d,--debug            increase debug level"
+		<< std::endl;
+	std::cout << "  -h,-?,--help          show this help message"
+		<< std::endl;
+	std::cout << "  -m,--method=<m>[:<q>] compression method to test, "
+		"can be given multiple" << std::endl;
+	std::cout << "                        times, default is none, rice, "
+		"gzip and hcompress" << std::endl;
+	std::cout << "  -r,--repeat=<n>       repeat each measurement <n> "
+		"times (default 3)" << std::endl;
+	std::cout << "  -t,--tmpdir=<dir>     directory for temporary files "
+		"(default /tmp)" << std::endl;
+}
+
+/**
+ * \brief Result of a single benchmark run
+ */
+class CompressionResult {
+public:
+	FITScompression	compression;
+	size_t	rawsize;
+	size_t	filesize;
+	double	encodetime;
+	double	decodetime;
+	CompressionResult(const FITScompression& c) : compression(c),
+		rawsize(0), filesize(0), encodetime(0), decodetime(0) { }
+	double	ratio() const {
+		return (filesize > 0) ? (double)rawsize / filesize : 0;
+	}
+	double	encodespeed() const {
+		return (encodetime > 0) ? rawsize / (1048576. * encodetime) : 0;
+	}
+	double	decodespeed() const {
+		return (decodetime > 0) ? rawsize / (1048576. * decodetime) : 0;
+	}
+};
+
+/**
+ * \brief Measure write and read performance for a compression method
+ */
+static CompressionResult	measure(ImagePtr image,
+		const FITScompression& compression,
+		const std::string& tmpfile, int repeat) {
+	CompressionResult	result(compression);
+	result.rawsize = image->size().getPixels() * image->bytesPerPixel();
+	for (int i = 0; i < repeat; i++) {
+		// encode
+		Timer	timer;
+		timer.start();
+		FITSout	out(tmpfile);
+		out.setPrecious(false);
+		out.setCompression(compression);
+		out.write(image);
+		timer.end();
+		result.encodetime += timer.elapsed();
+
+		// decode
+		timer.start();
+		FITSin	in(tmpfile);
+		ImagePtr	readback = in.read();
+		timer.end();
+		result.decodetime += timer.elapsed();
+	}
+	result.encodetime /= repeat;
+	result.decodetime /= repeat;
+
+	struct stat	sb;
+	if (stat(tmpfile.c_str(), &sb) == 0) {
+		result.filesize = sb.st_size;
+	}
+	unlink(tmpfile.c_str());
+	return result;
+}
+
+/**
+ * \brief Main function in astro namespace
+ */
+int	main(int argc, char *argv[]) {
+	debug_set_ident("fitscompress");
+	int	c;
+	int	longindex;
+	int	repeat = 3;
+	std::string	tmpdir("/tmp");
+	std::vector<FITScompression>	methods;
+	while (EOF != (c = getopt_long(argc, argv, "d?hm:r:t:",
+		longopts, &longindex)))
+		switch (c) {
+		case 'd':
+			debuglevel = LOG_DEBUG;
+			break;
+		case 'm':
+			methods.push_back(FITScompression(std::string(optarg)));
+			break;
+		case 'r':
+			repeat = std::stoi(optarg);
+			if (repeat < 1) {
+				throw std::runtime_error("repeat must be >= 1");
+			}
+			break;
+		case 't':
+			tmpdir = std::string(optarg);
+			break;
+		case '?':
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			throw std::runtime_error("unknown option");
+		}
+
+	if (optind >= argc) {
+		std::cerr << "no images to compress" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// default set of methods
+	if (methods.size() == 0) {
+		methods.push_back(FITScompression(FITScompression::NONE));
+		methods.push_back(FITScompression(FITScompression::RICE));
+		methods.push_back(FITScompression(FITScompression::GZIP));
+		methods.push_back(FITScompression(FITScompression::HCOMPRESS));
+	}
+
+	std::string	tmpfile = stringprintf("%s/fitscompress-%d.fits",
+		tmpdir.c_str(), getpid());
+
+	std::cout << "image                method       ratio  encode MB/s "
+		"decode MB/s" << std::endl;
+	for (; optind < argc; optind++) {
+		std::string	filename(argv[optind]);
+		FITSin	in(filename);
+		ImagePtr	image = in.read();
+		for (auto mi = methods.begin(); mi != methods.end(); mi++) {
+			CompressionResult	r = measure(image, *mi, tmpfile,
+							repeat);
+			std::cout << stringprintf("%-20.20s %-12.12s %6.2f "
+				"%11.1f %11.1f",
+				Path(filename).basename().c_str(),
+				r.compression.toString().c_str(), r.ratio(),
+				r.encodespeed(), r.decodespeed()) << std::endl;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+} // namespace fitscompress
+} // namespace app
+} // namespace astro
+
+int	main(int argc, char *argv[]) {
+	return astro::main_function<astro::app::fitscompress::main>(argc, argv);
+}
@@ -167,7 +167,7 @@ int	main(int argc, char *argv[]) {
 	char	fitserrmsg[80];
 	int	status = 0;
 	fitsfile	*fits = NULL;
-	if (fits_open_file(&fits, filename.c_str(),
+	if (fits_open_image(&fits, filename.c_str(),
 		(readonly) ? READONLY : READWRITE, &status)) {
 		fits_get_errstatus(status, fitserrmsg);
 		std::string	msg = stringprintf("FITS error: %s",
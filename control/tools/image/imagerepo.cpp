@@ -243,6 +243,39 @@ int	command_synchronize(const std::string& repo1name,
 	return EXIT_SUCCESS;
 }
 
+/**
+ * \brief Command to display or set the compression of a repository
+ */
+int	command_compression(const std::string& reponame,
+		const std::vector<std::string>& arguments) {
+	ConfigurationPtr	configuration = Configuration::get();
+	ImageRepoConfigurationPtr	imagerepos
+		= ImageRepoConfiguration::get(configuration);
+	if (arguments.size() > 2) {
+		imagerepos->setCompression(reponame, arguments[2]);
+	}
+	std::cout << imagerepos->compression(reponame) << std::endl;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * \brief Command to rescan the directory of a repository
+ */
+int	command_scan(const std::string& reponame,
+		const std::vector<std::string>& arguments) {
+	int	threads = 0;
+	if (arguments.size() > 2) {
+		threads = std::stoi(arguments[2]);
+	}
+	ConfigurationPtr	configuration = Configuration::get();
+	ImageRepoConfigurationPtr	imagerepos
+		= ImageRepoConfiguration::get(configuration);
+	ImageRepoPtr	repo = imagerepos->repo(reponame);
+	ImageRepoScanStatistics	statistics = repo->scan(threads);
+	std::cout << statistics.toString() << std::endl;
+	return EXIT_SUCCESS;
+}
+
 /**
  * \brief Command to show all info about an image
  */
@@ -334,6 +367,24 @@ static void	usage(const char *progname) {
 	std::cout << "replicate images from <srcrepo> to <targetrepo>, synchronize two repositories";
 	std::cout << std::endl;
 	std::cout << std::endl;
+	std::cout << "    " << path.basename() << " [ options ] <repo> compression [ <method>[:<q>] ]";
+	std::cout << std::endl;
+	std::cout << std::endl;
+	std::cout << "display or set the FITS compression for new images in <repo>. <method> is one";
+	std::cout << std::endl;
+	std::cout << "of none, rice, gzip, hcompress or plio, <q> is the quantization level for";
+	std::cout << std::endl;
+	std::cout << "floating point images (0 means lossless)";
+	std::cout << std::endl;
+	std::cout << std::endl;
+	std::cout << "    " << path.basename() << " [ options ] <repo> scan [ <threads> ]";
+	std::cout << std::endl;
+	std::cout << std::endl;
+	std::cout << "index new or modified FITS files in the directory of <repo>, reading headers";
+	std::cout << std::endl;
+	std::cout << "with <threads> threads (default: one per processor core)";
+	std::cout << std::endl;
+	std::cout << std::endl;
 	std::cout << "Options:" << std::endl;
 	std::cout << "  -c,--config=<cfg>    use configuration file <cfg>";
 	std::cout << std::endl;
@@ -437,6 +488,12 @@ int	main(int argc, char *argv[]) {
 	if (command == "synchronize") {
 		return command_synchronize(reponame, arguments);
 	}
+	if (command == "compression") {
+		return command_compression(reponame, arguments);
+	}
+	if (command == "scan") {
+		return command_scan(reponame, arguments);
+	}
 
 	// get the image server from the configuration
 	return EXIT_SUCCESS;
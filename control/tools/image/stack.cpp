@@ -27,6 +27,12 @@ static struct option	longopts[] = {
 { "patchsize",		required_argument,	NULL,	'p' }, /* 4 */
 { "searchradius",	required_argument,	NULL,	's' }, /* 5 */
 { "transform",		required_argument,	NULL,	't' }, /* 6 */
+{ "rejection",		required_argument,	NULL,	'r' }, /* 7 */
+{ "kappa",		required_argument,	NULL,	'k' }, /* 8 */
+{ "clip",		required_argument,	NULL,	'c' }, /* 9 */
+{ "unweighted",		no_argument,		NULL,	'u' }, /* 10 */
+{ "scratch",		required_argument,	NULL,	'S' }, /* 11 */
+{ "threads",		required_argument,	NULL,	'j' }, /* 12 */
 { NULL,			0,			NULL,	 0  }
 };
 
@@ -43,15 +49,36 @@ static void	usage(const char *progname) {
 		"All images are aligned with" << std::endl;
 	std::cout << "the first image in the list and added to it. "
 		"The resulting image is then" << std::endl;
-	std::cout << "output to the output file." << std::endl;
+	std::cout << "output to the output file. With a rejection method, "
+		"the aligned images are" << std::endl;
+	std::cout << "kept in a scratch file, and the result is the weighted "
+		"mean of the pixel" << std::endl;
+	std::cout << "values that survive the rejection." << std::endl;
 	std::cout << std::endl;
 	std::cout << "options:" << std::endl;
+	std::cout << " -c,--clip=<f>          fraction of samples to reject at "
+		"each end for" << std::endl;
+	std::cout << "                        percentile rejection (default 0.2)"
+		<< std::endl;
 	std::cout << " -d,--debug             increase debug level" << std::endl;
+	std::cout << " -j,--threads=<n>       number of registration threads "
+		"(default: one" << std::endl;
+	std::cout << "                        per core)" << std::endl;
+	std::cout << " -k,--kappa=<k>         clipping limit in standard "
+		"deviations (default 3)" << std::endl;
 	std::cout << " -n,--number=<n>        number of stars to evaluate" << std::endl;
 	std::cout << " -o,--output=<outfile>  filename of output file" << std::endl;
 	std::cout << " -p,--patchsize=<s>     use patch size <s> for translation analysis" << std::endl;
+	std::cout << " -r,--rejection=<m>     reject outliers with method <m>, "
+		"one of none," << std::endl;
+	std::cout << "                        sigmaclip, winsorized or "
+		"percentile" << std::endl;
 	std::cout << " -s,--searchradius=<s>  use radius <s> when searching for stars" << std::endl;
+	std::cout << " -S,--scratch=<dir>     directory for the scratch file "
+		"(default $TMPDIR)" << std::endl;
 	std::cout << " -t,--transform         don't transform the images when stacking" << std::endl;
+	std::cout << " -u,--unweighted        don't weight images by their "
+		"noise" << std::endl;
 	std::cout << " -h,-?,--help           display this help" << std::endl;
 }
 
@@ -66,12 +93,27 @@ int	main(int argc, char *argv[]) {
 	int	numberofstars = 20;
 	int	searchradius = 10;
 	bool	notransform = false;
-	while (EOF != (c = getopt_long(argc, argv, "dh?o:p:n:s:t", longopts,
-		&longindex))) {
+	Stacker::rejection_method	rejection = Stacker::none;
+	double	kappa = 3;
+	double	clip = 0.2;
+	bool	weighted = true;
+	std::string	scratch;
+	int	threads = 0;
+	while (EOF != (c = getopt_long(argc, argv, "c:dh?j:k:o:p:n:r:s:S:tu",
+		longopts, &longindex))) {
 		switch (c) {
+		case 'c':
+			clip = std::stod(optarg);
+			break;
 		case 'd':
 			debuglevel = LOG_DEBUG;
 			break;
+		case 'j':
+			threads = std::stoi(optarg);
+			break;
+		case 'k':
+			kappa = std::stod(optarg);
+			break;
 		case 'n':
 			numberofstars = std::stoi(optarg);
 			break;
@@ -81,12 +123,21 @@ int	main(int argc, char *argv[]) {
 		case 'p':
 			patchsize = std::stoi(optarg);
 			break;
+		case 'r':
+			rejection = Stacker::string2rejection(optarg);
+			break;
 		case 's':
 			searchradius = std::stoi(optarg);
 			break;
+		case 'S':
+			scratch = std::string(optarg);
+			break;
 		case 't':
 			notransform = true;
 			break;
+		case 'u':
+			weighted = false;
+			break;
 		case 'h':
 		case '?':
 			usage(argv[0]);
@@ -115,13 +166,21 @@ int	main(int argc, char *argv[]) {
 	stacker->numberofstars(numberofstars);
 	stacker->searchradius(searchradius);
 	stacker->notransform(notransform);
+	stacker->rejection(rejection);
+	stacker->klow(kappa);
+	stacker->khigh(kappa);
+	stacker->clipfraction(clip);
+	stacker->weighted(weighted);
+	stacker->scratchdirectory(scratch);
 
-	// read all the images
+	// read, register and add all the images
+	std::vector<std::string>	filenames;
 	while (optind < argc) {
-		FITSin	in(argv[optind++]);
-		ImagePtr	image = in.read();
-		stacker->add(image);
+		filenames.push_back(std::string(argv[optind++]));
 	}
+	StackingPipeline	pipeline(stacker);
+	pipeline.threads(threads);
+	pipeline(filenames);
 
 	// now do the stacking
 	ImagePtr	stackedimage = stacker->image();
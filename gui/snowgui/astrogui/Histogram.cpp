@@ -49,6 +49,21 @@ int	HistogramBase::bucketindex(int width, int x) const {
 	return bi;
 }
 
+/**
+ * \brief Add bucket counts collected elsewhere
+ *
+ * The counts vector has one entry per bucket, color histograms have the
+ * three color planes one after the other. This allows threads to count
+ * in a private array and update the shared buckets only once.
+ */
+void	HistogramBase::accumulate(const std::vector<int>& counts) {
+	for (size_t i = 0; i < counts.size(); i++) {
+		if (counts[i]) {
+			_buckets[i] += counts[i];
+		}
+	}
+}
+
 double	HistogramBase::value(int y) const {
 	if (_logarithmic) {
 		if (y > 0) {
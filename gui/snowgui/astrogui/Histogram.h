@@ -9,6 +9,7 @@
 #include <QPixmap>
 #include <AstroPixel.h>
 #include <atomic>
+#include <vector>
 
 using namespace astro::image;
 
@@ -31,6 +32,7 @@ public:
 	HistogramBase(int size);
 	virtual	~HistogramBase();
 	virtual QPixmap	*pixmap(int width, int height) const = 0;
+	void	accumulate(const std::vector<int>& counts);
 };
 typedef std::shared_ptr<HistogramBase>	HistogramPtr;
 
@@ -8,6 +8,9 @@
 #include <AstroAdapter.h>
 #include <AstroDemosaicAdapter.h>
 #include <AstroUtils.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 using namespace astro::image;
 using namespace astro::adapter;
@@ -62,167 +65,56 @@ static ImageSize	scaledSize(int scale, const ImageSize& origsize) {
 }
 
 /**
- * \brief class to handle the gain/brightness settings
+ * \brief Mapping of pixel values to display values
  *
- * This is a mixin class for the Basic gain adapters.
+ * A channel value c is displayed as trunc((scale * c + offset) * gain
+ * + brightness), limited to the range 0-255. For 8 and 16 bit pixels
+ * all possible values are mapped in advance, so that converting a pixel
+ * is a single table lookup. Other pixel types compute the value.
  */
-class GainSettings {
-protected:
+template<typename Pixel>
+class GainMap {
 	double	_gain;
 	double	_brightness;
-	int	_scale;
-	double	_colorscales[3];
-	double	_coloroffsets[3];
-	void	initcolor() {
-		for (int i = 0; i < 3; i++) {
-			_colorscales[i] = 1.;
-			_coloroffsets[i] = 0.;
-		}
-	}
+	double	_scale;
+	double	_offset;
+	std::vector<unsigned char>	_table;
 public:
-	GainSettings() : _gain(1), _brightness(0), _scale(0) {
-		initcolor();
-	}
-	GainSettings(int scale) : _gain(1), _brightness(0), _scale(scale) {
-		initcolor();
-	}
-	GainSettings(double gain, double brightness, int scale)
-		: _gain(gain), _brightness(brightness), _scale(scale) {
-		initcolor();
-	}
-	GainSettings(const GainSettings& other) {
-		_gain = other._gain;
-		_brightness = other._brightness;
-		_scale = other._scale;
-		for (int i = 0; i < 3; i++) {
-			_colorscales[i] = other._colorscales[i];
-			_coloroffsets[i] = other._coloroffsets[i];
+	GainMap(double gain, double brightness, double scale = 1.,
+		double offset = 0.)
+		: _gain(gain), _brightness(brightness),
+		  _scale(scale), _offset(offset) {
+		int	levels = 0;
+		if (typeid(Pixel) == typeid(unsigned char)) {
+			levels = 256;
 		}
-	}
-	void	gain(double g) {
-		_gain = g;
-	}
-	void	brightness(double b) {
-		_brightness = b;
-	}
-	void	setColorScales(double r, double b, double g) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0,
-			"setting scales to %.2f, %.2f, %.2f", r, g, b);
-		_colorscales[0] = r;
-		_colorscales[1] = g;
-		_colorscales[2] = b;
-	}
-	void	setColorOffsets(double r, double b, double g) {
-		_coloroffsets[0] = r;
-		_coloroffsets[1] = g;
-		_coloroffsets[2] = b;
-	}
-	void	setColorScales(double *colorscales) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0,
-			"setting scales to %.2f, %.2f, %.2f",
-			colorscales[0], colorscales[1], colorscales[2]);
-		for (int i = 0; i < 3; i++) {
-			_colorscales[i] = colorscales[i];
+		if (typeid(Pixel) == typeid(unsigned short)) {
+			levels = 65536;
 		}
-	}
-	void	setColorOffsets(double *coloroffsets) {
-		for (int i = 0; i < 3; i++) {
-			_coloroffsets[i] = coloroffsets[i];
+		_table.resize(levels);
+		for (int i = 0; i < levels; i++) {
+			_table[i] = map((double)i);
 		}
 	}
-};
-
-/**
- * \brief Base class for the gain adapters
- *
- * The base class adds the gain and brightness settings to the image
- * adapter
- */
-class BasicGainAdapter : public ConstImageAdapter<unsigned char>,
-			public GainSettings {
-public:
-	BasicGainAdapter(const ImageSize& imagesize, int scale)
-		: ConstImageAdapter<unsigned char>(imagesize),
-		  GainSettings(scale) {
-	}
-	BasicGainAdapter(const ImageSize& imagesize,
-		double gain, double brightness, int scale)
-		: ConstImageAdapter<unsigned char>(imagesize),
-		  GainSettings(gain, brightness, scale) {
-	}
-};
-
-/**
- * \brief Gain adapter to convert a monochrome image
- *
- * This adapter expands pixel values according to the settings in the
- * gain and brightness attributes, and limits the values to 0-255.
- */
-template<typename Pixel>
-class GainAdapter : public BasicGainAdapter {
-	const ConstImageAdapter<Pixel>&	_image;
-	unsigned char	rescale(double value) const {
-		if (value > 255) {
+	unsigned char	map(double c) const {
+		double	v = trunc((_scale * c + _offset) * _gain + _brightness);
+		if (v > 255) {
 			return 255;
 		}
-		if (value < 0) {
+		if (v < 0) {
 			return 0;
 		}
-		unsigned char	result = value;
-		return result;
-	}
-	unsigned char	normalPixel(int x, int y) const {
-		double	value = _image.pixel(x, y) * _gain + _brightness;
-		return rescale(value);
-	}
-	unsigned char	downscalePixel(int x, int y) const {
-		int	startx = x << -_scale;
-		int	starty = y << -_scale;
-		int	endx = startx + (1 << -_scale);
-		int	endy = starty + (1 << -_scale);
-		double	s = 0;
-		int	counter = 0;
-		for (int x = startx; x < endx; x++) {
-			for (int y = starty; y < endy; y++) {
-				s += _image.pixel(x, y) * _gain + _brightness;
-				counter++;
-			}
-		}
-		return rescale(s / counter);
-	}
-	unsigned char	upscalePixel(int x, int y) const {
-		return normalPixel(x >> _scale, y >> _scale);
-	}
-public:
-	GainAdapter(const ConstImageAdapter<Pixel>& image, int scale = 0)
-		: BasicGainAdapter(scaledSize(scale, image.getSize()), scale),
-		  _image(image) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "%s adapter Pixel type %s, "
-			"scale = %d",
-			getSize().toString().c_str(),
-			astro::demangle(typeid(Pixel).name()).c_str(), _scale);
-	}
-	GainAdapter(const ConstImageAdapter<Pixel>& image, double gain,
-		double brightness, int scale = 0)
-		: BasicGainAdapter(scaledSize(scale, image.getSize()),
-		  gain, brightness, scale), _image(image) {
-		debug(LOG_DEBUG, DEBUG_LOG, 0, "%s adapter Pixel type %s, "
-			"gain = %f, brightness = %f, scale = %d",
-			getSize().toString().c_str(),
-			astro::demangle(typeid(Pixel).name()).c_str(),
-			_gain, _brightness, _scale);
+		return (unsigned char)v;
 	}
-	virtual unsigned char	pixel(int x, int y) const {
-		if (_scale > 0) {
-			return upscalePixel(x, y);
-		}
-		if (_scale < 0) {
-			return downscalePixel(x, y);
+	unsigned char	operator()(const Pixel& p) const {
+		if (_table.size() > 0) {
+			return _table[(size_t)p];
 		}
-		return normalPixel(x, y);
+		return map((double)p);
 	}
 };
 
+
 /**
  * \brief Compute the rectangle to be used for the image
  */
@@ -308,136 +200,69 @@ QImage	*Image2Pixmap::convertMono(const ConstImageAdapter<Pixel>& image) {
 	// create a windowadapter
 	WindowAdapter<Pixel>	windowadapter(image, r);
 
-	// create a gain adapter
-	GainAdapter<Pixel>	gainadapter(windowadapter, _scale);
-
-	gainadapter.gain(_gain);
-	gainadapter.brightness(_brightness);
+	// lookup table for gain and brightness
+	GainMap<Pixel>	gainmap(_gain, _brightness);
 
 	// dimensions
-	int	w = gainadapter.getSize().width();
-	int	h = gainadapter.getSize().height();
+	ImageSize	scaledsize = scaledSize(_scale, windowadapter.getSize());
+	int	w = scaledsize.width();
+	int	h = scaledsize.height();
 
 	// prepare the result
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "preparing QImage(%d,%d)", w, h);
 	QImage	*qimage = new QImage(w, h, QImage::Format_RGB32);
-
-	// fill the image into the result
-#pragma omp parallel for
-	for (int x = 0; x < w; x++) {
-		for (int y = 0; y < h; y++) {
-			unsigned char	v = gainadapter.pixel(x, y);
-			histo->add((double)v);
-			unsigned long	value = convert(v);
-			qimage->setPixel(x, h - 1 - y, value);
+	uchar	*bits = qimage->bits();
+	int	bytesperline = qimage->bytesPerLine();
+
+	// fill the image into the result, the rows are distributed among
+	// the threads and each thread keeps its own histogram counts
+#pragma omp parallel
+	{
+	int	s = (_scale < 0) ? -_scale : _scale;
+	int	sw = (_scale < 0) ? (w << s) : ((_scale > 0) ? (w >> s) : w);
+	std::vector<Pixel>	row(sw + 1);
+	std::vector<double>	sum(w);
+	std::vector<unsigned char>	v(w);
+	std::vector<int>	counts(256, 0);
+#pragma omp for schedule(static)
+	for (int y = 0; y < h; y++) {
+		if (_scale < 0) {
+			// average blocks of 2^s x 2^s pixels
+			std::fill(sum.begin(), sum.end(), 0.);
+			for (int j = 0; j < (1 << s); j++) {
+				windowadapter.fillRow((y << s) + j, 0, sw, &row[0]);
+				for (int x = 0; x < sw; x++) {
+					sum[x >> s] += row[x];
+				}
+			}
+			double	n = 1 << (2 * s);
+			for (int x = 0; x < w; x++) {
+				v[x] = gainmap.map(sum[x] / n);
+			}
+		} else {
+			// map every source pixel once, replicate when upscaling
+			windowadapter.fillRow(y >> s, 0, sw, &row[0]);
+			for (int x = 0; x < w; x++) {
+				v[x] = gainmap(row[x >> s]);
+			}
+		}
+		QRgb	*out = (QRgb *)(bits + (h - 1 - y) * bytesperline);
+		for (int x = 0; x < w; x++) {
+			counts[v[x]]++;
+			out[x] = convert(v[x]);
 		}
 	}
+	histo->accumulate(counts);
+	}
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "image data set");
 
 	return qimage;
 }
 
-/**
- * \brief Base class for color gain adapters
- *
- * By mixing in the GainSettings, this class adds gain information to the
- * basic image adapter
- */
-class BasicGainRGBAdapter : public ConstImageAdapter<RGB<unsigned char> >,
-			    public GainSettings {
-public:
-	BasicGainRGBAdapter(const ImageSize& imagesize, int scale)
-		: ConstImageAdapter<RGB<unsigned char> >(imagesize),
-		  GainSettings(scale) {
-	}
-	BasicGainRGBAdapter(const ImageSize& imagesize,
-		double gain, double brightness, int scale)
-		: ConstImageAdapter<RGB<unsigned char> >(imagesize),
-		  GainSettings(gain, brightness, scale) {
-	}
-};
-
-/**
- * \brief Template class to adapt gain in color images
- */
-template<typename Pixel>
-class GainRGBAdapter : public BasicGainRGBAdapter {
-	const ConstImageAdapter<RGB<Pixel> >&	_image;
-	unsigned char	rescale(double i) const {
-		double	v = trunc(i * _gain + _brightness);
-		if (v > 255) {
-			return 255;
-		}
-		if (v < 0) {
-			return 0;
-		}
-		return (unsigned char)v;
-	}
-	unsigned char	colorRescale(int i, double c) const {
-		return rescale(_colorscales[i] * c + _coloroffsets[i]);
-	}
-	RGB<unsigned char>	rescale(const RGB<Pixel> i) const {
-		return RGB<unsigned char>( colorRescale(0, i.R),
-					   colorRescale(1, i.G),
-					   colorRescale(2, i.B));
-	}
-	RGB<unsigned char>	normalPixel(int x, int y) const {
-if ((x == 0) && (y == 0)) {
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "scales: %.2f, %.2f, %.2f",
-		_colorscales[0], _colorscales[1], _colorscales[2]);
-	debug(LOG_DEBUG, DEBUG_LOG, 0, "offsets: %.2f, %.2f, %.2f",
-		_coloroffsets[0], _coloroffsets[1], _coloroffsets[2]);
-}
-		return rescale(_image.pixel(x, y));
-	}
-	RGB<unsigned char>	upscalePixel(int x, int y) const {
-		return normalPixel(x >> _scale, y >> _scale);
-	}
-	RGB<unsigned char>	downscalePixel(int x, int y) const {
-		int	startx = x << -_scale;
-		int	starty = y << -_scale;
-		int	endx = startx + (1 << -_scale);
-		int	endy = starty + (1 << -_scale);
-		double	r = 0, g = 0, b = 0;
-		int	counter = 0;
-		for (int x = startx; x < endx; x++) {
-			for (int y = starty; y < endy; y++) {
-				RGB<Pixel>	t = _image.pixel(x,y);
-				r += t.R;
-				g += t.G;
-				b += t.B;
-				counter++;
-			}
-		}
-		return RGB<unsigned char>( colorRescale(0, r / counter),
-					   colorRescale(1, g / counter),
-					   colorRescale(2, b / counter));
-	}
-public:
-	GainRGBAdapter(const ConstImageAdapter<RGB<Pixel> >& image, int scale)
-		: BasicGainRGBAdapter(scaledSize(scale, image.getSize()),
-		  scale), _image(image) {
-	}
-	GainRGBAdapter(const ConstImageAdapter<RGB<Pixel> >& image, double gain,
-		double brightness, int scale)
-		: BasicGainRGBAdapter(scaledSize(scale, image.getSize()),
-		  gain, brightness, scale), _image(image) {
-	}
-	virtual RGB<unsigned char>	pixel(int x, int y) const {
-		if (_scale > 0) {
-			return upscalePixel(x, y);
-		}
-		if (_scale < 0) {
-			return downscalePixel(x, y);
-		}
-		return normalPixel(x, y);
-	}
-};
-
 /**
  * \brief Convert a RGB astro::image::ImagePtr to a QImage
  *
- * Because this adapter works with a RGB image adapter, it can be
+ * Because this method works with a RGB image adapter, it can be
  * be used on RGB images or on DemosaicAdapter<Pixel> without change.
  */
 template<typename Pixel>
@@ -458,28 +283,76 @@ QImage	*Image2Pixmap::convertRGB(const ConstImageAdapter<RGB<Pixel> >& image) {
 	ImageRectangle	r = rectangle(image);
 
 	WindowAdapter<RGB<Pixel> >	windowadapter(image, r);
-	GainRGBAdapter<Pixel>	gainadapter(windowadapter, _scale);
-	gainadapter.gain(_gain);
-	gainadapter.brightness(_brightness);
-	gainadapter.setColorScales(_colorscales);
-	gainadapter.setColorOffsets(_coloroffsets);
+
+	// lookup tables for the three color channels
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "scales: %.2f, %.2f, %.2f",
+		_colorscales[0], _colorscales[1], _colorscales[2]);
+	debug(LOG_DEBUG, DEBUG_LOG, 0, "offsets: %.2f, %.2f, %.2f",
+		_coloroffsets[0], _coloroffsets[1], _coloroffsets[2]);
+	GainMap<Pixel>	red(_gain, _brightness,
+				_colorscales[0], _coloroffsets[0]);
+	GainMap<Pixel>	green(_gain, _brightness,
+				_colorscales[1], _coloroffsets[1]);
+	GainMap<Pixel>	blue(_gain, _brightness,
+				_colorscales[2], _coloroffsets[2]);
 
 	// dimensions
-	int	w = gainadapter.getSize().width();
-	int	h = gainadapter.getSize().height();
+	ImageSize	scaledsize = scaledSize(_scale, windowadapter.getSize());
+	int	w = scaledsize.width();
+	int	h = scaledsize.height();
 
 	// prepare result structuren
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "create QImage(%d, %d)", w, h);
 	QImage	*qimage = new QImage(w, h, QImage::Format_RGB32);
-
-#pragma omp parallel for
-	for (int x = 0; x < w; x++) {
-		for (int y = 0; y < h; y++) {
-			RGB<unsigned char>	p = gainadapter.pixel(x, y);
-			histo->add(RGB<double>(p));
-			unsigned long	value = convert(p);
-			qimage->setPixel(x, h - 1 - y, value);
+	uchar	*bits = qimage->bits();
+	int	bytesperline = qimage->bytesPerLine();
+
+#pragma omp parallel
+	{
+	int	s = (_scale < 0) ? -_scale : _scale;
+	int	sw = (_scale < 0) ? (w << s) : ((_scale > 0) ? (w >> s) : w);
+	std::vector<RGB<Pixel> >	row(sw + 1);
+	std::vector<RGB<double> >	sum(w);
+	std::vector<RGB<unsigned char> >	v(w);
+	std::vector<int>	counts(3 * 256, 0);
+#pragma omp for schedule(static)
+	for (int y = 0; y < h; y++) {
+		if (_scale < 0) {
+			// average blocks of 2^s x 2^s pixels
+			std::fill(sum.begin(), sum.end(), RGB<double>(0.));
+			for (int j = 0; j < (1 << s); j++) {
+				windowadapter.fillRow((y << s) + j, 0, sw, &row[0]);
+				for (int x = 0; x < sw; x++) {
+					RGB<double>&	t = sum[x >> s];
+					t.R += row[x].R;
+					t.G += row[x].G;
+					t.B += row[x].B;
+				}
+			}
+			double	n = 1 << (2 * s);
+			for (int x = 0; x < w; x++) {
+				v[x] = RGB<unsigned char>(red.map(sum[x].R / n),
+					green.map(sum[x].G / n),
+					blue.map(sum[x].B / n));
+			}
+		} else {
+			// map every source pixel once, replicate when upscaling
+			windowadapter.fillRow(y >> s, 0, sw, &row[0]);
+			for (int x = 0; x < w; x++) {
+				const RGB<Pixel>&	p = row[x >> s];
+				v[x] = RGB<unsigned char>(red(p.R), green(p.G),
+					blue(p.B));
+			}
 		}
+		QRgb	*out = (QRgb *)(bits + (h - 1 - y) * bytesperline);
+		for (int x = 0; x < w; x++) {
+			counts[v[x].R]++;
+			counts[v[x].G + 256]++;
+			counts[v[x].B + 512]++;
+			out[x] = convert(v[x]);
+		}
+	}
+	histo->accumulate(counts);
 	}
 
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "QImage complete");
@@ -557,8 +430,12 @@ QPixmap	*Image2Pixmap::operator()(ImagePtr image) {
 		}
 		break;
 	}
+	if (NULL == qimage) {
+		return NULL;
+	}
 	QPixmap	*result = new QPixmap(size.width(), size.height());
 	result->convertFromImage(*qimage);
+	delete qimage;
 
 	return result;;
 }
@@ -9,6 +9,7 @@
 #include <AstroIO.h>
 #include <repository.h>
 #include <IceConversions.h>
+#include <ChunkedTransfer.h>
 
 namespace snowgui {
 
@@ -63,7 +64,8 @@ void	downloadthread::run() {
 		snowstar::RepositoryPrx	repository
 			= _repositories->get(item.reponame());
 		snowstar::ImageFile	image
-			= repository->getImage(item.imageid());
+			= snowstar::chunkedgetimage(repository,
+				item.imageid());
 		astro::image::ImagePtr	imageptr = snowstar::convertfile(image);
 
 		// get the file name
@@ -8,6 +8,7 @@
 #include <CommunicatorSingleton.h>
 #include <imagedisplaywidget.h>
 #include <IceConversions.h>
+#include <ChunkedTransfer.h>
 #include <QFileDialog>
 #include <AstroIO.h>
 #include <QMessageBox>
@@ -292,7 +293,8 @@ astro::image::ImagePtr	exposewidget::currentImage() {
 		return ImagePtr();
 	}
 	try {
-		snowstar::ImageFile	imagefile = _repository->getImage(_imageid);
+		snowstar::ImageFile	imagefile
+			= snowstar::chunkedgetimage(_repository, _imageid);
 		return snowstar::convertfile(imagefile);
 	} catch (const std::exception& x) {
 	}
@@ -9,6 +9,7 @@
 #include <AstroDebug.h>
 #include <AstroIO.h>
 #include <IceConversions.h>
+#include <ChunkedTransfer.h>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <ImageForwarder.h>
@@ -96,8 +97,7 @@ void	imagedetailwidget::setImage(snowstar::ImagePrx image) {
  */
 void	imagedetailwidget::loadImage() {
 	debug(LOG_DEBUG, DEBUG_LOG, 0, "load image %s", _image->name().c_str());
-	snowstar::ImageFile	file = _image->file();
-	_imageptr = snowstar::convertfile(file);
+	_imageptr = snowstar::convert(_image);
 	if (_imageptr) {
 		ui->saveButton->setEnabled(true);
 		emit offerImage(_imageptr, std::string());
@@ -7,11 +7,12 @@
 #define _PreviewImageSink_h
 
 #include <camera.h>
+#include <ImageSinkI.h>
 #include <previewwindow.h>
 
 namespace snowgui {
 
-class PreviewImageSink : public snowstar::ImageSink {
+class PreviewImageSink : public snowstar::ImageSinkI {
 	PreviewWindow	*_preview;
 public:
 	PreviewImageSink(PreviewWindow *preview);
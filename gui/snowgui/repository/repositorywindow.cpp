@@ -10,6 +10,7 @@
 #include <QMessageBox>
 #include <AstroIO.h>
 #include <IceConversions.h>
+#include <ChunkedTransfer.h>
 #include <imagedisplaywidget.h>
 #include "repositorysavedialog.h"
 
@@ -228,7 +229,8 @@ void	repositorywindow::closeEvent(QCloseEvent * /* event */) {
  */
 astro::image::ImagePtr	repositorywindow::currentImage() {
 	snowstar::RepositoryPrx	repository = _repositories->get(_reponame);
-	snowstar::ImageFile	image = repository->getImage(_imageid);
+	snowstar::ImageFile	image = snowstar::chunkedgetimage(repository,
+					_imageid);
 	ImagePtr	imageptr = snowstar::convertfile(image);
 	return imageptr;
 }
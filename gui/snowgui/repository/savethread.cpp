@@ -7,6 +7,7 @@
 #include <AstroDebug.h>
 #include <AstroIO.h>
 #include <IceConversions.h>
+#include <ChunkedTransfer.h>
 #include <repository.h>
 
 namespace snowgui {
@@ -42,7 +43,8 @@ void	savethread::run() {
 		snowstar::ImageInfo	info = repository->getInfo(imageid);
 		std::string	filename = astro::stringprintf("%s/%s",
 			_directory.c_str(), info.filename.c_str());
-		snowstar::ImageFile	image = repository->getImage(imageid);
+		snowstar::ImageFile	image = snowstar::chunkedgetimage(repository,
+						imageid);
 		astro::image::ImagePtr	imageptr = snowstar::convertfile(image);
 
 		// get the file name from the image
@@ -9,6 +9,7 @@
 #include <AstroDebug.h>
 #include <AstroCamera.h>
 #include <IceConversions.h>
+#include <ChunkedTransfer.h>
 
 namespace snowgui {
 
@@ -429,7 +430,7 @@ void	taskqueuemanagerwidget::imageClicked() {
 				return;
 			}
 			imageptr = snowstar::convertfile(
-				repository->getImage(imageid));
+				snowstar::chunkedgetimage(repository, imageid));
 		} else {
 			debug(LOG_DEBUG, DEBUG_LOG, 0, "get image %s from dir",
 				info.filename.c_str());